@@ -0,0 +1,154 @@
+/**
+ * @brief Measures blockchain_serialize throughput.
+ * 
+ * Builds a chain of BENCH_NUM_BLOCKS blocks, each with
+ * BENCH_NUM_TRANSACTIONS_PER_BLOCK signed transactions, serializes it
+ * BENCH_NUM_REPETITIONS times, and prints the best time and throughput. Reads
+ * the same base64-encoded keys as the app.
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "include/base64.h"
+#include "include/blockchain.h"
+#include "include/block.h"
+#include "include/transaction.h"
+
+#define BENCH_NUM_BLOCKS 2000
+#define BENCH_NUM_TRANSACTIONS_PER_BLOCK 50
+#define BENCH_NUM_REPETITIONS 10
+#define PRIVATE_KEY_ENVIRONMENT_VARIABLE "LEOCOIN_PRIVATE_KEY"
+#define PUBLIC_KEY_ENVIRONMENT_VARIABLE "LEOCOIN_PUBLIC_KEY"
+
+return_code_t read_key_from_environment(char *variable, ssh_key_t *key) {
+    return_code_t return_code = SUCCESS;
+    char *key_contents_base64 = getenv(variable);
+    if (NULL == key_contents_base64) {
+        fprintf(stderr, "Set %s to a base64-encoded key\n", variable);
+        return_code = FAILURE_INVALID_COMMAND_LINE_ARGS;
+        goto end;
+    }
+    size_t decoded_length =
+        (size_t)ceil(strlen(key_contents_base64) * 3 / 4) + 1;
+    if (decoded_length > sizeof(key->bytes)) {
+        fprintf(stderr, "%s is too long\n", variable);
+        return_code = FAILURE_INVALID_COMMAND_LINE_ARGS;
+        goto end;
+    }
+    return_code = base64_decode(
+        key_contents_base64, strlen(key_contents_base64), key->bytes);
+end:
+    return return_code;
+}
+
+return_code_t build_blockchain(
+    blockchain_t **blockchain,
+    ssh_key_t *public_key,
+    ssh_key_t *private_key
+) {
+    return_code_t return_code = SUCCESS;
+    // Signing dominates setup, so every transaction is a copy of one.
+    transaction_t *signed_transaction = NULL;
+    return_code = transaction_create(
+        &signed_transaction, public_key, public_key, 1, private_key);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    blockchain_t *new_blockchain = NULL;
+    return_code = blockchain_create(&new_blockchain, 1);
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    sha_256_t previous_block_hash = {0};
+    for (size_t block_idx = 0; block_idx < BENCH_NUM_BLOCKS; block_idx++) {
+        linked_list_t *transaction_list = NULL;
+        return_code = linked_list_create(
+            &transaction_list, (free_function_t *)transaction_destroy, NULL);
+        if (SUCCESS != return_code) {
+            blockchain_destroy(new_blockchain);
+            goto cleanup;
+        }
+        for (size_t transaction_idx = 0;
+            transaction_idx < BENCH_NUM_TRANSACTIONS_PER_BLOCK &&
+                SUCCESS == return_code;
+            transaction_idx++) {
+            transaction_t *transaction = NULL;
+            return_code = transaction_copy(&transaction, signed_transaction);
+            if (SUCCESS == return_code) {
+                return_code = linked_list_append(
+                    transaction_list, transaction);
+            }
+        }
+        block_t *block = NULL;
+        if (SUCCESS == return_code) {
+            return_code = block_create(
+                &block, transaction_list, 0, previous_block_hash);
+        }
+        if (SUCCESS == return_code) {
+            return_code = blockchain_add_block(new_blockchain, block);
+        }
+        if (SUCCESS != return_code) {
+            blockchain_destroy(new_blockchain);
+            goto cleanup;
+        }
+    }
+    *blockchain = new_blockchain;
+cleanup:
+    transaction_destroy(signed_transaction);
+end:
+    return return_code;
+}
+
+int main(void) {
+    ssh_key_t public_key = {0};
+    return_code_t return_code = read_key_from_environment(
+        PUBLIC_KEY_ENVIRONMENT_VARIABLE, &public_key);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    ssh_key_t private_key = {0};
+    return_code = read_key_from_environment(
+        PRIVATE_KEY_ENVIRONMENT_VARIABLE, &private_key);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    blockchain_t *blockchain = NULL;
+    return_code = build_blockchain(&blockchain, &public_key, &private_key);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    double best_seconds = INFINITY;
+    uint64_t buffer_size = 0;
+    for (size_t idx = 0; idx < BENCH_NUM_REPETITIONS; idx++) {
+        unsigned char *buffer = NULL;
+        struct timespec start_time = {0};
+        clock_gettime(CLOCK_MONOTONIC, &start_time);
+        return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+        struct timespec end_time = {0};
+        clock_gettime(CLOCK_MONOTONIC, &end_time);
+        if (SUCCESS != return_code) {
+            blockchain_destroy(blockchain);
+            goto end;
+        }
+        free(buffer);
+        double seconds =
+            (double)(end_time.tv_sec - start_time.tv_sec) +
+            (double)(end_time.tv_nsec - start_time.tv_nsec) / 1e9;
+        if (seconds < best_seconds) {
+            best_seconds = seconds;
+        }
+    }
+    printf(
+        "Serialized %d blocks (%.1f MB) in %.2f ms: %.0f MB/s\n",
+        BENCH_NUM_BLOCKS,
+        buffer_size / 1e6,
+        best_seconds * 1e3,
+        buffer_size / 1e6 / best_seconds);
+    blockchain_destroy(blockchain);
+end:
+    return return_code;
+}
@@ -5,6 +5,22 @@
 #ifndef INCLUDE_BLOCK_H_
 #define INCLUDE_BLOCK_H_
 #define GENESIS_BLOCK_PROOF_OF_WORK 2017
+// The size of a serialized block header: created_at, previous_block_hash,
+// merkle_root, extra_nonce, and proof_of_work.
+#define BLOCK_HEADER_SIZE 88
+// The number of leading header bytes that do not depend on proof_of_work, in
+// whole SHA-256 blocks. Miners hash these bytes once per candidate block.
+#define BLOCK_HEADER_MIDSTATE_LENGTH 64
+// The offset of the big endian extra_nonce in the header's final SHA-256 block.
+// See block_header_final_block.
+#define BLOCK_HEADER_FINAL_BLOCK_EXTRA_NONCE_OFFSET 8
+// The offset of the big endian proof_of_work in the header's final SHA-256
+// block. See block_header_final_block.
+#define BLOCK_HEADER_FINAL_BLOCK_PROOF_OF_WORK_OFFSET 16
+// The bytes prepended to Merkle tree leaves and parents so that a parent can
+// never be passed off as a transaction hash, or vice versa.
+#define BLOCK_MERKLE_LEAF_PREFIX 0x00
+#define BLOCK_MERKLE_NODE_PREFIX 0x01
 
 #include <stdint.h>
 #include <sys/time.h>
@@ -20,15 +36,44 @@
  * @param proof_of_work A number such that the hash of the block_t contains
  * some number of leading zeros. It has no meaning other than as part of the
  * hash.
+ * @param extra_nonce Extends the space of proofs of work beyond 64 bits.
+ * Miners increment this when they run out of values for proof_of_work. Since
+ * it sits in the header after the Merkle root, changing it never requires
+ * rebuilding the block's transactions or re-signing them. It is initially
+ * zero.
  * @param previous_block_hash The hash of the previous block.
  */
 typedef struct block_t {
     time_t created_at;
     linked_list_t *transaction_list;
     uint64_t proof_of_work;
+    uint64_t extra_nonce;
     sha_256_t previous_block_hash;
 } block_t;
 
+/**
+ * @brief Contains the fixed-size fields of a block that its hash covers.
+ * 
+ * The header commits to the block's transactions through the Merkle root, so
+ * hashing the header costs the same regardless of how many transactions the
+ * block contains. Miners compute the header once per candidate block and only
+ * change extra_nonce and proof_of_work between attempts.
+ * 
+ * @param created_at The datetime at which the user created the block.
+ * @param previous_block_hash The hash of the previous block.
+ * @param merkle_root The root of the Merkle tree over the block's transaction
+ * hashes.
+ * @param extra_nonce The block's extra nonce.
+ * @param proof_of_work The block's proof of work.
+ */
+typedef struct block_header_t {
+    time_t created_at;
+    sha_256_t previous_block_hash;
+    sha_256_t merkle_root;
+    uint64_t extra_nonce;
+    uint64_t proof_of_work;
+} block_header_t;
+
 /**
  * @brief Fills block with a pointer to the newly allocated block.
  * 
@@ -67,9 +112,130 @@ return_code_t block_create_genesis_block(block_t **block);
  */
 return_code_t block_destroy(block_t *block);
 
+/**
+ * @brief Fills merkle_root with the root of the block's transaction Merkle
+ * tree.
+ * 
+ * The leaves of the tree are the hashes of BLOCK_MERKLE_LEAF_PREFIX followed
+ * by each transaction hash, in list order. Each parent is the hash of
+ * BLOCK_MERKLE_NODE_PREFIX followed by its two children. If a level has an odd
+ * number of nodes, the last node moves up to the next level unchanged. The
+ * Merkle root is the hash of the big endian number of transactions followed by
+ * the top of the tree, so repeating transactions always changes the root. A
+ * block with no transactions has an all-zero Merkle root.
+ * 
+ * @param block The block.
+ * @param merkle_root A pointer to fill with the Merkle root.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t block_merkle_root(block_t *block, sha_256_t *merkle_root);
+
+/**
+ * @brief Fills merkle_root with the root of the Merkle tree over the given
+ * transaction hashes.
+ * 
+ * The tree is the same as in block_merkle_root, so callers that have the
+ * transaction hashes without a block_t, such as blockchain views, get the same
+ * root.
+ * 
+ * @param transaction_hashes The transaction hashes, in block order. The
+ * function builds the tree in place, so it overwrites them.
+ * @param num_transactions The number of transaction hashes.
+ * @param merkle_root A pointer to fill with the Merkle root.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t block_merkle_root_from_transaction_hashes(
+    sha_256_t *transaction_hashes,
+    uint64_t num_transactions,
+    sha_256_t *merkle_root
+);
+
+/**
+ * @brief Fills header with the block's header.
+ * 
+ * This function computes the block's Merkle root, so callers that hash the
+ * same block repeatedly with different proofs of work should get the header
+ * once and call block_header_hash.
+ * 
+ * @param block The block.
+ * @param header A pointer to fill with the block's header.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t block_get_header(block_t *block, block_header_t *header);
+
+/**
+ * @brief Fills hash with the hash of the block header.
+ * 
+ * The hash covers the header serialized as BLOCK_HEADER_SIZE bytes: created_at,
+ * the hashes, extra_nonce, and proof_of_work, with the numbers in big endian.
+ * 
+ * @param header The block header.
+ * @param hash A pointer to fill with the header's hash.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t block_header_hash(block_header_t *header, sha_256_t *hash);
+
+/**
+ * @brief Fills midstate with the SHA-256 state over the header's invariant
+ * prefix.
+ * 
+ * The first BLOCK_HEADER_MIDSTATE_LENGTH bytes of the serialized header do not
+ * depend on extra_nonce or proof_of_work. Miners compute this midstate once per
+ * candidate block and then call block_header_hash_from_midstate for each proof
+ * of work, which costs a single SHA-256 compression.
+ * 
+ * @param header The block header.
+ * @param midstate A pointer to fill with the midstate.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t block_header_midstate(
+    block_header_t *header,
+    sha_256_midstate_t *midstate
+);
+
+/**
+ * @brief Fills hash with the hash of the block header using a midstate.
+ * 
+ * @param midstate The midstate from block_header_midstate. The header must not
+ * have changed since then, except for extra_nonce and proof_of_work.
+ * @param header The block header.
+ * @param hash A pointer to fill with the header's hash. This is the same value
+ * that block_header_hash produces.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t block_header_hash_from_midstate(
+    sha_256_midstate_t *midstate,
+    block_header_t *header,
+    sha_256_t *hash
+);
+
+/**
+ * @brief Fills final_block with the header's padded final SHA-256 block.
+ * 
+ * The final block holds the header bytes after the midstate and the SHA-256
+ * padding. Only the 8 bytes at BLOCK_HEADER_FINAL_BLOCK_PROOF_OF_WORK_OFFSET
+ * depend on proof_of_work, so miners pass the final block to
+ * hash_batch_finalize to hash many consecutive proofs of work at once. To roll
+ * the extra nonce, miners overwrite the 8 bytes at
+ * BLOCK_HEADER_FINAL_BLOCK_EXTRA_NONCE_OFFSET in place; the midstate does not
+ * change.
+ * 
+ * @param midstate The midstate from block_header_midstate.
+ * @param header The block header.
+ * @param final_block A buffer of SHA_256_BLOCK_LENGTH bytes to fill.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t block_header_final_block(
+    sha_256_midstate_t *midstate,
+    block_header_t *header,
+    unsigned char *final_block
+);
+
 /**
  * @brief Fills hash with the block's hash.
  * 
+ * The block's hash is the hash of its header. See block_get_header.
+ * 
  * @param block The block.
  * @param hash A pointer to fill with the block's hash.
  * @return return_code_t A return code indicating success or failure.
@@ -10,19 +10,156 @@
 
 #include <stdint.h>
 #include <sys/time.h>
+#include <time.h>
 #include <stdatomic.h>
 #include <pthread.h>
 #include "include/block.h"
+#include "include/key_table.h"
+#include "include/lru_cache.h"
 #include "include/return_codes.h"
+#include "include/transaction.h"
+
+// The number of proofs of work each mining worker tries between checks of
+// whether to stop.
+#define MINING_DEFAULT_BATCH_SIZE 4096
+// The number of idle mining pools kept for reuse by the mining functions that
+// do not take a pool.
+#define MINING_NUM_SHARED_POOLS 4
+// The number of transaction hashes whose signatures blockchain_verify remembers
+// as valid. Each entry takes about 100 bytes.
+#define VERIFIED_SIGNATURE_CACHE_CAPACITY 16384
+// The number of 64-bit words in a proof of work target.
+#define BLOCKCHAIN_TARGET_NUM_WORDS 4
+// The value of num_leading_zero_bytes_required_in_block_hash for a blockchain
+// whose target is not a whole number of leading zero bytes.
+#define NUM_LEADING_ZERO_BYTES_CUSTOM_TARGET SIZE_MAX
+// The first 8 bytes of a serialized blockchain, "LEOCOIN" and a format
+// version. Unversioned blockchains, serialized before the format had a magic
+// number, start with the number of leading zero bytes instead.
+#define BLOCKCHAIN_SERIALIZATION_MAGIC 0x4c454f434f494e03
+// The first 8 bytes of a block log file, "LEOCOINL".
+#define BLOCKCHAIN_LOG_MAGIC 0x4c454f434f494e4c
+// The block log record types. A log starts with one target record, and each
+// block record only refers to keys from earlier keys records.
+#define BLOCKCHAIN_LOG_RECORD_TARGET 1
+#define BLOCKCHAIN_LOG_RECORD_KEYS 2
+#define BLOCKCHAIN_LOG_RECORD_BLOCK 3
+// The size of the staging buffer through which blockchain_serialize_to_sink
+// writes. It holds the largest key, block header, or transaction.
+#define BLOCKCHAIN_SERIALIZATION_STAGING_SIZE 65536
+// The largest serialized block or block log record body that blockchain
+// writers produce and readers accept. A decoder rejects a larger length prefix
+// as soon as it reads it rather than buffering the record, so a peer cannot
+// make it hold more than one record's worth of memory.
+#define BLOCKCHAIN_MAX_RECORD_SIZE (32 * 1024 * 1024)
+// The number of keys in each keys record of a block log, so that a record of
+// the longest keys still fits in BLOCKCHAIN_MAX_RECORD_SIZE.
+#define BLOCKCHAIN_LOG_MAX_KEYS_PER_RECORD \
+    ((BLOCKCHAIN_MAX_RECORD_SIZE - sizeof(uint64_t)) / \
+    (sizeof(uint64_t) + MAX_SSH_KEY_LENGTH))
+// The number of bytes that blockchain_read_from_fd reads at a time.
+#define BLOCKCHAIN_READ_CHUNK_SIZE 65536
+// The number of transactions that blockchain_view_verify decodes and verifies
+// at a time. Each takes about 600 bytes.
+#define BLOCKCHAIN_VIEW_VERIFICATION_CHUNK_SIZE 4096
+// The bytes a block log record adds to its body: the length and type before it
+// and the checksum after it.
+#define BLOCKCHAIN_LOG_RECORD_OVERHEAD \
+    (2 * sizeof(uint64_t) + sizeof(sha_256_t))
+
+/**
+ * @brief A 256-bit proof of work target.
+ * 
+ * A block hash meets the target if, read as a 256-bit big endian number, it is
+ * at most the target. Requiring n leading zero bytes is the same as the target
+ * with n zero bytes followed by all one bits, but a target can also express
+ * any difficulty in between.
+ * 
+ * A byte-count difficulty converts to the equivalent target, so it keeps its
+ * meaning. That does not make older chains valid. The fixed-size block header,
+ * with its Merkle root and extra nonce, changed every block hash, so no block
+ * mined before it meets its target or links to its predecessor, and those
+ * chains fail blockchain_verify.
+ * 
+ * @param words The target as 64-bit words, most significant word first.
+ */
+typedef struct blockchain_target_t {
+    uint64_t words[BLOCKCHAIN_TARGET_NUM_WORDS];
+} blockchain_target_t;
+
+/**
+ * @brief When blockchain_write_to_file_with_sync_policy forces appended blocks
+ * to disk with fsync.
+ * 
+ * Syncing less often makes each save faster, but a crash of the machine (not
+ * just the process) may then lose the blocks saved since the last sync.
+ */
+typedef enum blockchain_sync_mode_t {
+    BLOCKCHAIN_SYNC_EVERY_BLOCK,
+    BLOCKCHAIN_SYNC_EVERY_NUM_BLOCKS,
+    BLOCKCHAIN_SYNC_EVERY_INTERVAL,
+} blockchain_sync_mode_t;
+
+/**
+ * @brief A policy for syncing a block log to disk.
+ * 
+ * A zeroed policy syncs every block.
+ * 
+ * @param mode When to sync.
+ * @param num_blocks_between_syncs With BLOCKCHAIN_SYNC_EVERY_NUM_BLOCKS, sync
+ * once this many blocks have been appended since the last sync.
+ * @param milliseconds_between_syncs With BLOCKCHAIN_SYNC_EVERY_INTERVAL, sync
+ * on the first save at least this many milliseconds after the last sync.
+ */
+typedef struct blockchain_sync_policy_t {
+    blockchain_sync_mode_t mode;
+    uint64_t num_blocks_between_syncs;
+    uint64_t milliseconds_between_syncs;
+} blockchain_sync_policy_t;
 
 /**
  * @brief Represents a blockchain.
  * 
  * @param block_list The list of blocks in the chain.
+ * @param num_leading_zero_bytes_required_in_block_hash The number of leading
+ * zero bytes that target requires, or NUM_LEADING_ZERO_BYTES_CUSTOM_TARGET if
+ * the target is not a whole number of leading zero bytes.
+ * @param target The proof of work target that every block hash must meet.
+ * @param num_verified_blocks The verification watermark's height: the number
+ * of leading blocks that blockchain_verify or blockchain_verify_incremental
+ * last found valid. It is initially zero.
+ * @param last_verified_block_hash The verification watermark's hash: the hash
+ * of the last verified block. It is only meaningful if num_verified_blocks is
+ * nonzero.
+ * @param key_table The distinct public keys in the chain's transactions. Every
+ * transaction in a block added with blockchain_add_block refers to keys in
+ * this table.
+ * @param log_path The block log that blockchain_write_to_file last wrote or
+ * blockchain_read_from_file last read, or NULL if there is none. It is
+ * initially NULL.
+ * @param log_size The number of valid bytes in the block log.
+ * @param num_logged_keys The number of leading keys in key_table that the block
+ * log holds.
+ * @param last_logged_block_node The node of the last block that the block log
+ * holds, or NULL if it holds no blocks.
+ * @param num_unsynced_logged_blocks The number of blocks appended to the block
+ * log since it was last synced to disk.
+ * @param log_synced_at When the block log was last synced to disk, from
+ * CLOCK_MONOTONIC.
  */
 typedef struct blockchain_t {
     linked_list_t *block_list;
     size_t num_leading_zero_bytes_required_in_block_hash;
+    blockchain_target_t target;
+    uint64_t num_verified_blocks;
+    sha_256_t last_verified_block_hash;
+    key_table_t *key_table;
+    char *log_path;
+    uint64_t log_size;
+    size_t num_logged_keys;
+    node_t *last_logged_block_node;
+    uint64_t num_unsynced_logged_blocks;
+    struct timespec log_synced_at;
 } blockchain_t;
 
 /**
@@ -42,12 +179,50 @@ typedef struct synchronized_blockchain_t {
     pthread_mutex_t mutex;
 } synchronized_blockchain_t;
 
+/**
+ * @brief A pool of long-lived mining worker threads.
+ * 
+ * Creating threads for every block would put thread creation on the path of
+ * every switch to a new chain tip. Instead, the pool's workers sleep between
+ * searches and pick up each new work package as soon as it is published. A
+ * work package holds the block header template and the nonce range to search.
+ * Workers claim batches of the range from an atomic counter, so they never
+ * take a lock while mining. A work package is handed off under the pool's
+ * mutex rather than through a lock-free queue: there is only ever one package
+ * per block, so the handoff costs one lock and one broadcast per block.
+ * 
+ * @param num_workers The number of worker threads.
+ * @param threads The worker threads. Each is pinned to one of the processors
+ * on which the process may run, where the platform supports it.
+ * @param search The current work package, or NULL if the workers are idle.
+ * @param generation Incremented whenever a work package is published or
+ * retired. Workers only run a work package whose generation is current, so
+ * they drop stale work.
+ * @param should_shut_down Set when the pool is being destroyed.
+ * @param mutex Protects search, should_shut_down, and the worker counts in
+ * search. Workers only take it between work packages.
+ * @param work_available Signaled when a work package is published or the pool
+ * is shutting down.
+ * @param work_finished Signaled when the last worker leaves a work package.
+ */
+typedef struct mining_pool_t {
+    size_t num_workers;
+    pthread_t *threads;
+    struct proof_of_work_search_t *search;
+    atomic_uint_fast64_t generation;
+    bool should_shut_down;
+    pthread_mutex_t mutex;
+    pthread_cond_t work_available;
+    pthread_cond_t work_finished;
+} mining_pool_t;
+
 /**
  * @brief Fills blockchain with a pointer to the newly allocated blockchain.
  * 
  * @param blockchain A pointer to fill with the blockchain's address.
  * @param num_leading_zero_bytes_required_in_block_hash The number of leading
- * zero bytes to make a block hash a valid proof of work.
+ * zero bytes to make a block hash a valid proof of work. This must be at most
+ * the length of a hash.
  * @return return_code_t A return code indicating success or failure.
  */
 return_code_t blockchain_create(
@@ -55,6 +230,47 @@ return_code_t blockchain_create(
     size_t num_leading_zero_bytes_required_in_block_hash
 );
 
+/**
+ * @brief Fills blockchain with a pointer to the newly allocated blockchain.
+ * 
+ * @param blockchain A pointer to fill with the blockchain's address.
+ * @param target The proof of work target that every block hash must meet.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_create_with_target(
+    blockchain_t **blockchain,
+    blockchain_target_t target
+);
+
+/**
+ * @brief Fills target with the target requiring leading zero bytes.
+ * 
+ * @param num_leading_zero_bytes The number of leading zero bytes. This must be
+ * at most the length of a hash.
+ * @param target A pointer to fill with the target.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_target_from_num_leading_zero_bytes(
+    size_t num_leading_zero_bytes,
+    blockchain_target_t *target
+);
+
+/**
+ * @brief Fills target with the target requiring leading zero bits.
+ * 
+ * Each extra bit doubles the expected number of attempts, rather than
+ * multiplying it by 256 like each extra byte.
+ * 
+ * @param num_leading_zero_bits The number of leading zero bits. This must be
+ * at most the length of a hash in bits.
+ * @param target A pointer to fill with the target.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_target_from_num_leading_zero_bits(
+    size_t num_leading_zero_bits,
+    blockchain_target_t *target
+);
+
 /**
  * @brief Frees all memory associated with a blockchain.
  * 
@@ -87,6 +303,10 @@ return_code_t synchronized_blockchain_destroy(synchronized_blockchain_t *sync);
 /**
  * @brief Appends a block to the blockchain.
  * 
+ * This function points the block's transactions at the blockchain's key table
+ * entries for their keys, adding new keys to the table, so that each distinct
+ * key is in memory once.
+ * 
  * @param blockchain The blockchain.
  * @param block The block to add.
  * @return return_code_t A return code indicating success or failure.
@@ -96,8 +316,7 @@ return_code_t blockchain_add_block(blockchain_t *blockchain, block_t *block);
 /**
  * @brief Fills is_valid_block_hash with true or false.
  * 
- * A valid block hash begins with the number of leading zeroes specified in the
- * blockchain struct.
+ * A valid block hash meets the blockchain's target. See blockchain_target_t.
  * 
  * @param blockchain The blockchain.
  * @param block_hash The block hash to check.
@@ -110,28 +329,175 @@ return_code_t blockchain_is_valid_block_hash(
     bool *is_valid_block_hash
 );
 
+/**
+ * @brief A function that the mining core calls to decide whether to stop.
+ * 
+ * Every mining worker calls this function once per batch, possibly at the same
+ * time as other workers, so it must be thread-safe.
+ * 
+ * @param args The abort arguments given to the mining core.
+ * @return return_code_t SUCCESS to keep mining, or the return code with which
+ * to abort the search.
+ */
+typedef return_code_t (mining_abort_function_t(void *args));
+
+/**
+ * @brief Fills pool with a pointer to a newly allocated mining pool.
+ * 
+ * @param pool A pointer to fill with the pool's address.
+ * @param num_threads The number of worker threads to start. If zero, the
+ * function starts one worker thread per online processor.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t mining_pool_create(mining_pool_t **pool, size_t num_threads);
+
+/**
+ * @brief Stops the pool's worker threads and frees the pool.
+ * 
+ * Callers must not destroy a pool while a search is running on it.
+ * 
+ * @param pool The pool.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t mining_pool_destroy(mining_pool_t *pool);
+
 /**
  * @brief Fills block's proof_of_work with a number that produces a valid hash.
  * 
+ * This is the mining core that blockchain_mine_block and
+ * synchronized_blockchain_mine_block share. The function publishes a work
+ * package to the pool's workers and waits for them to finish it. Each worker
+ * claims batches of batch_size consecutive proofs of work and calls
+ * abort_function once before each batch, so larger batches spread the cost of
+ * the check over more hashes at the price of reacting to an abort later. The
+ * function always finds the smallest valid proof of work, regardless of the
+ * number of workers or the batch size.
+ * 
+ * The search starts at the batch containing the block's proof_of_work under
+ * its extra_nonce. When it runs out of proofs of work, it increments the extra
+ * nonce and starts again from zero. Rolling the extra nonce leaves the
+ * transactions and the header's midstate untouched, so workers never stall on
+ * rebuilding the block.
+ * 
+ * If the search finds a valid proof of work, the function sets the block's
+ * extra_nonce and proof_of_work and returns SUCCESS, even if abort_function
+ * aborted the search afterward. Otherwise, the function returns the abort
+ * code, or FAILURE_COULD_NOT_FIND_VALID_PROOF_OF_WORK if the search tried
+ * about 2^64 candidates without success.
+ * 
+ * @param pool The pool whose workers run the search. Only one search may run
+ * on a pool at a time.
  * @param blockchain The blockchain.
  * @param block The block for which to calculate a proof of work.
  * @param print_progress If true, display progress on the screen.
+ * @param batch_size The number of consecutive proofs of work each worker tries
+ * between calls to abort_function. If zero, the function uses
+ * MINING_DEFAULT_BATCH_SIZE. The function rounds this up to a multiple of the
+ * SIMD kernel's number of lanes.
+ * @param abort_function The function that decides whether to stop.
+ * @param abort_args The argument to abort_function.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t mining_pool_search_for_proof_of_work(
+    mining_pool_t *pool,
+    blockchain_t *blockchain,
+    block_t *block,
+    bool print_progress,
+    uint64_t batch_size,
+    mining_abort_function_t *abort_function,
+    void *abort_args
+);
+
+/**
+ * @brief Fills block's proof_of_work with a number that produces a valid hash.
+ * 
+ * This function runs mining_pool_search_for_proof_of_work on a pool of
+ * num_threads workers. It reuses an idle pool of that size from earlier calls
+ * if there is one, and keeps the pool for later calls afterward, so repeated
+ * calls do not start new threads. Concurrent calls each get their own pool.
+ * The module owns the idle pools, whose workers stay alive until
+ * mining_pools_destroy_shared stops them.
+ * 
+ * If the search finds a valid proof of work, the function sets it and
+ * returns SUCCESS, even if abort_function aborted the search afterward.
+ * Otherwise, the function returns the abort code, or
+ * FAILURE_COULD_NOT_FIND_VALID_PROOF_OF_WORK if the nonce space ran out.
+ * 
+ * @param blockchain The blockchain.
+ * @param block The block for which to calculate a proof of work.
+ * @param print_progress If true, display progress on the screen.
+ * @param num_threads The number of worker threads to use. If zero, the function
+ * uses one worker thread per online processor.
+ * @param batch_size The number of consecutive proofs of work each worker tries
+ * between calls to abort_function. If zero, the function uses
+ * MINING_DEFAULT_BATCH_SIZE. The function rounds this up to a multiple of the
+ * SIMD kernel's number of lanes.
+ * @param abort_function The function that decides whether to stop.
+ * @param abort_args The argument to abort_function.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_search_for_proof_of_work(
+    blockchain_t *blockchain,
+    block_t *block,
+    bool print_progress,
+    size_t num_threads,
+    uint64_t batch_size,
+    mining_abort_function_t *abort_function,
+    void *abort_args
+);
+
+/**
+ * @brief Stops and frees the idle mining pools kept by the mining functions.
+ * 
+ * blockchain_search_for_proof_of_work and blockchain_mine_block keep up to
+ * MINING_NUM_SHARED_POOLS idle pools, and their worker threads, for reuse.
+ * Programs should call this function before exiting so that no worker threads
+ * outlive them. It must not run concurrently with those mining functions.
+ * Later mining calls start new pools as needed.
+ * 
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t mining_pools_destroy_shared(void);
+
+/**
+ * @brief Fills block's proof_of_work with a number that produces a valid hash.
+ * 
+ * The search is split across num_threads worker threads. Each worker hashes
+ * batches of consecutive proofs of work with the widest SIMD kernel the CPU
+ * supports (see hash_batch_get_best_kernel). Workers claim disjoint batches of
+ * the nonce space from a shared counter and check should_stop once per batch
+ * of MINING_DEFAULT_BATCH_SIZE proofs of work. See
+ * mining_pool_search_for_proof_of_work. The function always finds the smallest
+ * valid proof of work, regardless of the number of threads or the kernel.
+ * 
+ * @param blockchain The blockchain.
+ * @param block The block for which to calculate a proof of work.
+ * @param print_progress If true, display progress on the screen. A separate
+ * reporter thread prints the best hash so far and the hashrate at a fixed
+ * interval, so workers never do I/O.
  * @param should_stop This should initially be false. Setting this flag while
  * the function is running requests that the function terminate gracefully.
  * Users should expect the function to terminate in a timely manner (on the
  * order of seconds), but not necessarily immediately.
+ * @param num_threads The number of worker threads to use. If zero, the function
+ * uses one worker thread per online processor.
  * @return return_code_t A return code indicating success or failure.
  */
 return_code_t blockchain_mine_block(
     blockchain_t *blockchain,
     block_t *block,
     bool print_progress,
-    atomic_bool *should_stop
+    atomic_bool *should_stop,
+    size_t num_threads
 );
 
 /**
  * @brief Fills block's proof_of_work with a number that produces a valid hash.
  * 
+ * Like blockchain_search_for_proof_of_work, this function reuses idle pools
+ * across calls. Callers that already keep a pool should call
+ * synchronized_blockchain_mine_block_with_pool.
+ * 
  * @param sync The synchronized blockchain.
  * @param block The block for which to calculate a proof of work.
  * @param print_progress If true, display progress on the screen.
@@ -143,6 +509,8 @@ return_code_t blockchain_mine_block(
  * synchronized blockchain that this function is currently mining. When the user
  * updates this number (from another thread), this function stops and returns
  * FAILURE_LONGER_BLOCKCHAIN_DETECTED.
+ * @param num_threads The number of worker threads to use. If zero, the function
+ * uses one worker thread per online processor. See blockchain_mine_block.
  * @return return_code_t A return code indicating success or failure.
  */
 return_code_t synchronized_blockchain_mine_block(
@@ -150,7 +518,37 @@ return_code_t synchronized_blockchain_mine_block(
     block_t *block,
     bool print_progress,
     atomic_bool *should_stop,
-    atomic_size_t *sync_version_currently_mined
+    atomic_size_t *sync_version_currently_mined,
+    size_t num_threads
+);
+
+/**
+ * @brief Fills block's proof_of_work with a number that produces a valid hash.
+ * 
+ * This function is the same as synchronized_blockchain_mine_block, but mines
+ * on the workers of an existing pool instead of starting new threads. When the
+ * synchronized blockchain's version changes, the workers drop the current work
+ * package within one batch and are immediately ready for the next one.
+ * 
+ * @param sync The synchronized blockchain.
+ * @param block The block for which to calculate a proof of work.
+ * @param print_progress If true, display progress on the screen.
+ * @param should_stop This should initially be false. Setting this flag while
+ * the function is running requests that the function terminate gracefully.
+ * @param sync_version_currently_mined Contains the version number of the
+ * synchronized blockchain that this function is currently mining. When the
+ * synchronized blockchain's version differs, this function stops and returns
+ * FAILURE_LONGER_BLOCKCHAIN_DETECTED.
+ * @param pool The pool whose workers run the search.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t synchronized_blockchain_mine_block_with_pool(
+    synchronized_blockchain_t *sync,
+    block_t *block,
+    bool print_progress,
+    atomic_bool *should_stop,
+    atomic_size_t *sync_version_currently_mined,
+    mining_pool_t *pool
 );
 
 /**
@@ -164,10 +562,9 @@ void blockchain_print(blockchain_t *blockchain);
  * A blockchain is valid if it meets the following conditions.
  * 
  * 1. Every block has a valid proof of work. For every block other than the
- * genesis block, the block must hash to a value that contains the number of
- * leading zero bytes in the blockchain data structure. The genesis block must
- * have the magic number proof of work GENESIS_BLOCK_PROOF_OF_WORK and be the
- * first block.
+ * genesis block, the block must hash to a value that meets the blockchain's
+ * target. The genesis block must have the magic number proof of work
+ * GENESIS_BLOCK_PROOF_OF_WORK and be the first block.
  * 2. Every block must have a correct previous block hash. For the genesis
  * block, the previous block hash must be zero.
  * 3. Every block except the genesis block must have a minting transaction as
@@ -175,6 +572,24 @@ void blockchain_print(blockchain_t *blockchain);
  * both sender and recipient keys set to the miner.
  * 4. Every transaction in every block must have a valid digital signature.
  * 
+ * The function runs the structural checks sequentially, then verifies the
+ * transaction signatures on one thread per online processor, since they are
+ * by far the most expensive step. Each thread verifies batches of consecutive
+ * signatures with transaction_verify_signatures, and blocks may mix RSA and
+ * Ed25519 transactions. The first invalid block is the same as if every check
+ * ran in chain order.
+ * 
+ * Signatures that any earlier verification in the process found valid are not
+ * checked again. The function looks up each transaction's hash, which covers
+ * the signature, in the process-wide verified signature cache, and adds the
+ * hashes of newly verified transactions to it. So re-verifying a chain after
+ * reloading it or receiving it from a peer costs a hash per known transaction
+ * rather than a signature verification.
+ * 
+ * The function checks every block and moves the blockchain's verification
+ * watermark to the last block that it found valid. See
+ * blockchain_verify_incremental.
+ * 
  * @param blockchain The blockchain.
  * @param is_valid_blockchain A pointer to fill with the result.
  * @param first_invalid_block If the blockchain is invalid and this argument is
@@ -187,9 +602,57 @@ return_code_t blockchain_verify(
     block_t **first_invalid_block
 );
 
+/**
+ * @brief Fills cache with the process-wide verified signature cache.
+ * 
+ * The cache maps the hashes of transactions whose signatures blockchain_verify
+ * found valid to NULL values. It holds at most
+ * VERIFIED_SIGNATURE_CACHE_CAPACITY entries and evicts the least recently used.
+ * 
+ * @param cache A pointer to fill with the cache.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_get_verified_signature_cache(lru_cache_t **cache);
+
+/**
+ * @brief Verifies only the blocks past the blockchain's verification watermark.
+ * 
+ * Every successful call to blockchain_verify or this function records the
+ * height and hash of the last verified block in the blockchain. This function
+ * then only checks the blocks added since, as blockchain_verify would, so its
+ * cost depends on the number of new blocks rather than the chain's height. If
+ * the block at the watermark's height no longer has the watermark's hash, or
+ * the blockchain has no watermark, the function verifies the whole chain.
+ * 
+ * Blocks below the watermark are not checked again, so callers that modify a
+ * verified block in place must call blockchain_verify instead.
+ * 
+ * @param blockchain The blockchain.
+ * @param is_valid_blockchain A pointer to fill with the result.
+ * @param first_invalid_block If the blockchain is invalid and this argument is
+ * not NULL, the function fills this pointer with the first invalid block.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_verify_incremental(
+    blockchain_t *blockchain,
+    bool *is_valid_blockchain,
+    block_t **first_invalid_block
+);
+
 /**
  * @brief Serializes the blockchain into a buffer for file or network I/O.
  * 
+ * The buffer starts with BLOCKCHAIN_SERIALIZATION_MAGIC and the number of
+ * leading zero bytes that the target requires. If the target is not a whole
+ * number of bytes, that field is UINT64_MAX and the target's words follow it.
+ * The key table comes next: the number of keys, then each key's length and
+ * bytes. Transactions then refer to keys by their 32-byte IDs, or by 32 zero
+ * bytes for a missing key, so the buffer holds each distinct key once. The
+ * function does not change the blockchain; it relies on blockchain_add_block
+ * having put every transaction's keys in the key table. A block larger than
+ * BLOCKCHAIN_MAX_RECORD_SIZE fails with FAILURE_INVALID_BLOCKCHAIN, since
+ * decoders would reject it.
+ * 
  * @param blockchain The blockchain.
  * @param buffer A pointer to fill with the bytes representing the blockchain.
  * Callers can write the bytes to a file or send on the network and reconstruct
@@ -204,9 +667,65 @@ return_code_t blockchain_serialize(
     uint64_t *buffer_size
 );
 
+/**
+ * @brief A function to which blockchain_serialize_to_sink writes bytes.
+ * 
+ * @param bytes The next bytes of the serialized blockchain. They are only
+ * valid until the function returns.
+ * @param num_bytes The number of bytes.
+ * @param args The sink arguments given to blockchain_serialize_to_sink.
+ * @return return_code_t SUCCESS if the sink took every byte, or the return code
+ * with which to stop serializing.
+ */
+typedef return_code_t (blockchain_sink_function_t(
+    unsigned char *bytes,
+    size_t num_bytes,
+    void *args));
+
+/**
+ * @brief Serializes the blockchain into a sink, one block at a time.
+ * 
+ * This function writes the same bytes as blockchain_serialize, but encodes
+ * keys, block headers, and transactions into a staging buffer of
+ * BLOCKCHAIN_SERIALIZATION_STAGING_SIZE bytes and hands the buffer to the sink
+ * whenever the next item does not fit. Memory use does not grow with the chain,
+ * and the sink can write the first bytes while the rest are being encoded. If
+ * a block is invalid, nothing is written.
+ * 
+ * @param blockchain The blockchain.
+ * @param sink_function The function to which to write the bytes.
+ * @param sink_args The arguments to pass to sink_function.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_serialize_to_sink(
+    blockchain_t *blockchain,
+    blockchain_sink_function_t *sink_function,
+    void *sink_args
+);
+
+/**
+ * @brief Serializes the blockchain into a file descriptor.
+ * 
+ * See blockchain_serialize_to_sink. The descriptor may be a file, pipe, or
+ * socket; partial and interrupted writes are retried.
+ * 
+ * @param blockchain The blockchain.
+ * @param fd The file descriptor to which to write the blockchain.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_serialize_to_fd(blockchain_t *blockchain, int fd);
+
 /**
  * @brief Reconstructs the blockchain from a buffer.
  * 
+ * The buffer may also hold an unversioned blockchain, which starts with the
+ * number of leading zero bytes rather than BLOCKCHAIN_SERIALIZATION_MAGIC.
+ * Its block headers have no extra nonce, and its transactions are RSA
+ * transactions with both keys and the signature in fixed-size, zero-padded
+ * fields. Such blockchains load, but they do not verify: their blocks were
+ * mined against the old block hash, which did not cover a Merkle root. Buffers
+ * that start with any other value fail with FAILURE_INVALID_BLOCKCHAIN.
+ * 
  * @param blockchain A pointer to fill with the reconstructed blockchain.
  * Callers are responsible for calling blockchain_destroy when finished.
  * @param buffer An array containing the serialized blockchain.
@@ -220,7 +739,166 @@ return_code_t blockchain_deserialize(
 );
 
 /**
- * @brief Saves the blockchain to a file.
+ * @brief A function to which a blockchain decoder hands each decoded block.
+ * 
+ * @param block The block, in chain order. The function takes ownership of it,
+ * even if it fails.
+ * @param args The block function arguments given to the decoder.
+ * @return return_code_t SUCCESS to keep decoding, or the return code with which
+ * to stop.
+ */
+typedef return_code_t (blockchain_decoder_block_function_t(
+    block_t *block,
+    void *args));
+
+/**
+ * @brief What a blockchain decoder expects next.
+ */
+typedef enum blockchain_decoder_state_t {
+    BLOCKCHAIN_DECODER_STATE_MAGIC,
+    BLOCKCHAIN_DECODER_STATE_TARGET,
+    BLOCKCHAIN_DECODER_STATE_NUM_KEYS,
+    BLOCKCHAIN_DECODER_STATE_KEY,
+    BLOCKCHAIN_DECODER_STATE_NUM_BLOCKS,
+    BLOCKCHAIN_DECODER_STATE_BLOCK,
+    BLOCKCHAIN_DECODER_STATE_LOG_RECORD,
+    BLOCKCHAIN_DECODER_STATE_DONE,
+} blockchain_decoder_state_t;
+
+/**
+ * @brief Decodes a serialized blockchain or block log that arrives in chunks.
+ * 
+ * The decoder reads buffers that start with BLOCKCHAIN_SERIALIZATION_MAGIC or
+ * BLOCKCHAIN_LOG_MAGIC. It only holds on to the bytes of the key, block, or log
+ * record that is incomplete at the end of a chunk, so its memory is bounded by
+ * the largest of those plus the largest chunk rather than by the chain. Since
+ * blocks and log records larger than BLOCKCHAIN_MAX_RECORD_SIZE are rejected,
+ * that bound holds even for untrusted input.
+ * 
+ * @param block_function The function to which to hand each block.
+ * @param block_function_args The arguments to pass to block_function.
+ * @param state What the decoder expects next.
+ * @param has_target Whether the decoder has read the target yet.
+ * @param target The chain's proof of work target, once has_target is set.
+ * @param key_table The keys read so far, to which decoded transactions refer.
+ * @param num_items_remaining The number of keys or blocks left in the current
+ * section of a serialized blockchain.
+ * @param has_corrupt_record Whether the decoder has read a log record that
+ * failed its checksum. That is only allowed as the last record.
+ * @param buffer The bytes of the incomplete item.
+ * @param buffer_size The number of bytes in buffer.
+ * @param buffer_capacity The number of bytes allocated for buffer.
+ * @param num_bytes_needed The number of bytes that the incomplete item needs
+ * before it is worth decoding again.
+ * @param num_bytes_decoded The number of bytes decoded so far, not counting a
+ * corrupt log record.
+ */
+typedef struct blockchain_decoder_t {
+    blockchain_decoder_block_function_t *block_function;
+    void *block_function_args;
+    blockchain_decoder_state_t state;
+    bool has_target;
+    blockchain_target_t target;
+    key_table_t *key_table;
+    uint64_t num_items_remaining;
+    bool has_corrupt_record;
+    unsigned char *buffer;
+    size_t buffer_size;
+    size_t buffer_capacity;
+    size_t num_bytes_needed;
+    uint64_t num_bytes_decoded;
+} blockchain_decoder_t;
+
+/**
+ * @brief Fills decoder with a pointer to a newly allocated blockchain decoder.
+ * 
+ * @param decoder A pointer to fill with the decoder's address. Callers are
+ * responsible for calling blockchain_decoder_destroy when finished.
+ * @param block_function The function to which to hand each decoded block.
+ * @param block_function_args The arguments to pass to block_function.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_decoder_create(
+    blockchain_decoder_t **decoder,
+    blockchain_decoder_block_function_t *block_function,
+    void *block_function_args
+);
+
+/**
+ * @brief Frees all memory associated with the decoder.
+ * 
+ * Blocks already handed to the block function keep their keys.
+ * 
+ * @param decoder The decoder.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_decoder_destroy(blockchain_decoder_t *decoder);
+
+/**
+ * @brief Decodes the next chunk of a serialized blockchain or block log.
+ * 
+ * Each block that the chunk completes is handed to the block function before
+ * this function returns, so callers can add and verify blocks while the rest
+ * of the chain is still arriving. A block or log record whose size prefix
+ * exceeds BLOCKCHAIN_MAX_RECORD_SIZE fails with FAILURE_INVALID_BLOCKCHAIN as
+ * soon as the prefix arrives. After a failure, the decoder must not be used
+ * again.
+ * 
+ * @param decoder The decoder.
+ * @param chunk The next bytes. The chunk may have any length and may end in
+ * the middle of a field.
+ * @param chunk_size The number of bytes in chunk.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_decoder_write(
+    blockchain_decoder_t *decoder,
+    unsigned char *chunk,
+    size_t chunk_size
+);
+
+/**
+ * @brief Checks that the decoder has received a whole blockchain.
+ * 
+ * A serialized blockchain must be complete. A block log may end with an
+ * incomplete or corrupt record, as an interrupted append leaves it, which the
+ * decoder drops; num_bytes_decoded then ends before it.
+ * 
+ * @param decoder The decoder.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_decoder_finish(blockchain_decoder_t *decoder);
+
+/**
+ * @brief Saves the blockchain to a block log file.
+ * 
+ * A block log is the magic number BLOCKCHAIN_LOG_MAGIC followed by records.
+ * Each record is its length, type, and body, followed by the SHA-256 checksum
+ * of everything before it in the record. If outfile is the log that this
+ * blockchain last wrote or read and it has not changed size since, this
+ * function only appends records for the keys and blocks added since then, so
+ * saving after each new block takes time proportional to that block rather than
+ * to the chain. Blocks must therefore only be appended to the chain between
+ * calls. Otherwise it writes the whole log to a temporary file next to outfile,
+ * syncs it, and renames it over outfile, so a crash leaves either the old log
+ * or the new one. An interrupted append leaves an incomplete last record, which
+ * blockchain_read_from_file drops. Appends are synced according to
+ * sync_policy.
+ * 
+ * @param blockchain The blockchain.
+ * @param outfile The path to the file to which to write the blockchain.
+ * @param sync_policy When to sync appended blocks to disk.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_write_to_file_with_sync_policy(
+    blockchain_t *blockchain,
+    char *outfile,
+    blockchain_sync_policy_t sync_policy
+);
+
+/**
+ * @brief Saves the blockchain to a block log file, syncing every block.
+ * 
+ * See blockchain_write_to_file_with_sync_policy.
  * 
  * @param blockchain The blockchain.
  * @param outfile The path to the file to which to write the blockchain.
@@ -234,6 +912,14 @@ return_code_t blockchain_write_to_file(
 /**
  * @brief Reads the blockchain from a file.
  * 
+ * The file may be a block log or a blockchain in any format that
+ * blockchain_deserialize reads. A block log is replayed record by record. If
+ * its last record is incomplete or fails its checksum, as happens when a write
+ * is interrupted, replay stops before it; any other invalid record is an
+ * error. The next blockchain_write_to_file to infile appends to the log. The
+ * file is memory-mapped while it is parsed rather than copied into a heap
+ * buffer.
+ * 
  * @param blockchain A pointer to fill with the reconstructed blockchain.
  * Callers are responsible for calling blockchain_destroy when finished.
  * @param infile The path to the file from which to read the blockchain.
@@ -244,4 +930,189 @@ return_code_t blockchain_read_from_file(
     char *infile
 );
 
+/**
+ * @brief Reads a blockchain from a file descriptor until end of file.
+ * 
+ * The descriptor may be a file, pipe, or socket holding a serialized
+ * blockchain or block log. Apart from the blocks themselves, this function
+ * only holds one read chunk and one incomplete item in memory.
+ * 
+ * @param blockchain A pointer to fill with the reconstructed blockchain.
+ * Callers are responsible for calling blockchain_destroy when finished.
+ * @param fd The file descriptor from which to read the blockchain.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_read_from_fd(blockchain_t **blockchain, int fd);
+
+/**
+ * @brief A read-only block in a blockchain view.
+ * 
+ * The header fields are decoded, but the transactions stay in the view's
+ * mapping until blockchain_view_read_transaction decodes one of them.
+ * 
+ * @param created_at The datetime at which the user created the block.
+ * @param previous_block_hash The hash of the previous block.
+ * @param extra_nonce The block's extra nonce.
+ * @param proof_of_work The block's proof of work.
+ * @param num_transactions The number of transactions in the block.
+ * @param transactions The block's serialized transactions in the mapping.
+ * @param transactions_size The number of bytes in transactions.
+ */
+typedef struct block_view_t {
+    time_t created_at;
+    sha_256_t previous_block_hash;
+    uint64_t extra_nonce;
+    uint64_t proof_of_work;
+    uint64_t num_transactions;
+    unsigned char *transactions;
+    size_t transactions_size;
+} block_view_t;
+
+/**
+ * @brief A read-only blockchain over a memory-mapped chain file.
+ * 
+ * Opening a view parses the target and keys and records where each block
+ * starts, but creates no blocks or transactions. Callers read blocks in place
+ * and only turn the ones they change into heap objects with
+ * blockchain_view_materialize_block, so loading and verifying a chain needs
+ * memory for its keys and block index rather than for every transaction.
+ * 
+ * @param buffer The mapped file.
+ * @param buffer_size The number of bytes in buffer.
+ * @param target The chain's proof of work target.
+ * @param key_table The chain's keys, to which its transactions refer.
+ * @param block_offsets The offset in buffer of each serialized block.
+ * @param block_sizes The number of bytes in each serialized block.
+ * @param num_blocks The number of blocks in the chain.
+ */
+typedef struct blockchain_view_t {
+    unsigned char *buffer;
+    size_t buffer_size;
+    blockchain_target_t target;
+    key_table_t *key_table;
+    uint64_t *block_offsets;
+    uint64_t *block_sizes;
+    uint64_t num_blocks;
+} blockchain_view_t;
+
+/**
+ * @brief Fills view with a pointer to a new read-only view of a chain file.
+ * 
+ * The file may be a block log or a blockchain serialized with
+ * BLOCKCHAIN_SERIALIZATION_MAGIC. Older formats hold their keys in each
+ * transaction, so callers read them with blockchain_read_from_file instead.
+ * As in blockchain_read_from_file, a corrupt or incomplete last log record is
+ * left out of the view. The function checks the framing of every block, but
+ * not the blocks themselves; see blockchain_view_verify.
+ * 
+ * @param view A pointer to fill with the view. Callers are responsible for
+ * calling blockchain_view_close when finished.
+ * @param infile The path to the file to view.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_view_open(blockchain_view_t **view, char *infile);
+
+/**
+ * @brief Unmaps the file and frees all memory associated with the view.
+ * 
+ * Blocks materialized from the view keep their keys.
+ * 
+ * @param view The view.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_view_close(blockchain_view_t *view);
+
+/**
+ * @brief Fills block with the block at block_idx in the view.
+ * 
+ * @param view The view.
+ * @param block_idx The index of the block, where the genesis block is 0.
+ * @param block A pointer to fill with the block. It points into the view's
+ * mapping, so it is only valid until the view is closed.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_view_get_block(
+    blockchain_view_t *view,
+    uint64_t block_idx,
+    block_view_t *block
+);
+
+/**
+ * @brief Decodes one of a block's transactions into caller-owned memory.
+ * 
+ * The function allocates nothing. The transaction's keys are borrowed from the
+ * view, so callers must not pass the transaction to transaction_destroy or use
+ * it after closing the view.
+ * 
+ * @param view The view.
+ * @param block A block from blockchain_view_get_block.
+ * @param offset The offset in block->transactions of the transaction to read.
+ * The function advances it to the next transaction, so a block's transactions
+ * are read in order starting from 0.
+ * @param transaction A pointer to the transaction to fill.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_view_read_transaction(
+    blockchain_view_t *view,
+    block_view_t *block,
+    size_t *offset,
+    transaction_t *transaction
+);
+
+/**
+ * @brief Fills hash with the hash of a block in the view.
+ * 
+ * The hash is the same as block_hash gives for the materialized block.
+ * 
+ * @param view The view.
+ * @param block A block from blockchain_view_get_block.
+ * @param hash A pointer to fill with the block's hash.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_view_block_hash(
+    blockchain_view_t *view,
+    block_view_t *block,
+    sha_256_t *hash
+);
+
+/**
+ * @brief Verifies the viewed chain as blockchain_verify would.
+ * 
+ * The function makes the same checks in the same order and shares the
+ * verified signature cache with blockchain_verify. It decodes transactions
+ * into a scratch buffer of BLOCKCHAIN_VIEW_VERIFICATION_CHUNK_SIZE
+ * transactions and verifies their signatures in parallel one buffer at a
+ * time, so its memory does not grow with the chain.
+ * 
+ * @param view The view.
+ * @param is_valid_blockchain A pointer to fill with the result.
+ * @param first_invalid_block_idx If the chain is invalid and this argument is
+ * not NULL, the function fills this pointer with the index of the first
+ * invalid block.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_view_verify(
+    blockchain_view_t *view,
+    bool *is_valid_blockchain,
+    uint64_t *first_invalid_block_idx
+);
+
+/**
+ * @brief Fills block with a heap copy of the block at block_idx in the view.
+ * 
+ * Callers use this for blocks that they need to change or keep after closing
+ * the view.
+ * 
+ * @param view The view.
+ * @param block_idx The index of the block, where the genesis block is 0.
+ * @param block A pointer to fill with the block. Callers are responsible for
+ * calling block_destroy when finished.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_view_materialize_block(
+    blockchain_view_t *view,
+    uint64_t block_idx,
+    block_t **block
+);
+
 #endif  // INCLUDE_BLOCKCHAIN_H_
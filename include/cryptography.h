@@ -12,6 +12,9 @@
 #define MAX_SSH_KEY_LENGTH 4096
 // OpenSSL digital signatures are 1/8 the size of the key length.
 #define MAX_SSH_SIGNATURE_LENGTH 512
+// Ed25519 keys are stored raw at the start of an ssh_key_t.
+#define ED25519_KEY_LENGTH 32
+#define ED25519_SIGNATURE_LENGTH 64
 
 /**
  * @brief Contains an SSH key.
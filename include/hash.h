@@ -5,16 +5,231 @@
 #ifndef INCLUDE_HASH_H_
 #define INCLUDE_HASH_H_
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <openssl/evp.h>
 #include <openssl/sha.h>
+#include "include/return_codes.h"
+
+#define SHA_256_BLOCK_LENGTH 64
 
 typedef struct sha_256_t {
     unsigned char digest[SHA256_DIGEST_LENGTH];
 } sha_256_t;
 
+/**
+ * @brief Contains a SHA-256 computation partway through a message.
+ * 
+ * Hashing many messages that share a long prefix only requires processing the
+ * prefix once. Callers create a midstate over the prefix, then finalize copies
+ * of it with each message's suffix.
+ * 
+ * @param state The eight 32-bit SHA-256 chaining values.
+ * @param num_bytes The number of message bytes already processed. This is
+ * always a multiple of SHA_256_BLOCK_LENGTH.
+ */
+typedef struct sha_256_midstate_t {
+    uint32_t state[8];
+    uint64_t num_bytes;
+} sha_256_midstate_t;
+
+/**
+ * @brief A function that runs the SHA-256 compression function on state.
+ * 
+ * @param state The eight 32-bit chaining values to update.
+ * @param blocks The message blocks.
+ * @param num_blocks The number of SHA_256_BLOCK_LENGTH-byte blocks.
+ */
+typedef void (hash_compress_function_t(
+    uint32_t state[8],
+    const unsigned char *blocks,
+    size_t num_blocks));
+
+/**
+ * @brief A function that fills hash with the SHA-256 hash of a whole message.
+ */
+typedef return_code_t (hash_digest_function_t(
+    const unsigned char *message,
+    size_t message_length,
+    sha_256_t *hash));
+
+/**
+ * @brief A function that reports whether the CPU can run a backend.
+ */
+typedef bool (hash_backend_supported_function_t(void));
+
+/**
+ * @brief An implementation of SHA-256.
+ * 
+ * The hash module selects one backend the first time it hashes anything and
+ * uses it for the rest of the program. The SHA-NI backend uses the Intel SHA
+ * extensions for both compression and whole messages. The OpenSSL backend,
+ * which every CPU supports, hashes whole messages with OpenSSL using the
+ * thread's reusable context and compresses midstates with portable C. Neither
+ * backend allocates memory per hash.
+ * 
+ * @param name A human-readable name for the backend.
+ * @param is_supported Reports whether the CPU can run the backend.
+ * @param compress The compression function for midstates.
+ * @param digest The function that hashes whole messages.
+ */
+typedef struct hash_backend_t {
+    char *name;
+    hash_backend_supported_function_t *is_supported;
+    hash_compress_function_t *compress;
+    hash_digest_function_t *digest;
+} hash_backend_t;
+
 /**
  * @brief Prints the hash value.
  */
 void hash_print(sha_256_t *hash);
 
+/**
+ * @brief Returns the index of the hash's bucket in a hash table.
+ * 
+ * SHA-256 hashes are uniformly distributed, so this function uses the leading
+ * bytes of the digest directly, without further mixing. Hash tables keyed by
+ * hashes, like the LRU cache and the key table, use it to pick buckets.
+ * 
+ * @param hash The hash.
+ * @param num_buckets The number of buckets. Must be a power of two.
+ * @return size_t The bucket index, less than num_buckets.
+ */
+size_t hash_bucket_index(sha_256_t *hash, size_t num_buckets);
+
+/**
+ * @brief Fills backends with every hash backend compiled into the program.
+ * 
+ * The backends are ordered from most to least preferred. The last is the
+ * OpenSSL backend, which every CPU supports. Some backends may not be
+ * supported by the current CPU; check is_supported before using them.
+ * 
+ * @param backends A pointer to fill with the array of backends.
+ * @param num_backends A pointer to fill with the length of the array.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t hash_get_backends(
+    const hash_backend_t **backends,
+    size_t *num_backends
+);
+
+/**
+ * @brief Fills backend with the backend that the hash module uses.
+ * 
+ * This is the most preferred backend that the CPU supports.
+ * 
+ * @param backend A pointer to fill with the backend.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t hash_get_backend(const hash_backend_t **backend);
+
+/**
+ * @brief Fills hash with the SHA-256 hash of the message.
+ * 
+ * This function uses the selected backend. It is fastest for short messages
+ * like block headers and Merkle tree nodes, where the SHA-NI backend avoids
+ * OpenSSL's per-call overhead.
+ * 
+ * @param message The message.
+ * @param message_length The length of the message.
+ * @param hash A pointer to fill with the hash.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t hash_sha_256(
+    const unsigned char *message,
+    size_t message_length,
+    sha_256_t *hash
+);
+
+/**
+ * @brief Fills context with the calling thread's reusable digest context.
+ * 
+ * Creating an EVP_MD_CTX allocates memory, so rather than creating one per
+ * hash, signature, or verification, each thread creates one on first use and
+ * reuses it until the thread exits. The context is reset before it is handed
+ * out. Callers must not free the context, and must be done with it before
+ * calling any other function that uses it, including hash_sha_256.
+ * 
+ * @param context A pointer to fill with the context.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t hash_get_thread_context(EVP_MD_CTX **context);
+
+/**
+ * @brief Fills md with the SHA-256 message digest.
+ * 
+ * Passing EVP_sha256() to OpenSSL makes it look up the implementation on every
+ * call. This function looks it up once and gives the same digest to every
+ * caller. Callers must not free it.
+ * 
+ * @param md A pointer to fill with the message digest.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t hash_get_sha_256_md(const EVP_MD **md);
+
+/**
+ * @brief Runs the selected backend's SHA-256 compression function on state.
+ * 
+ * @param state The eight 32-bit chaining values to update.
+ * @param block The SHA_256_BLOCK_LENGTH-byte message block.
+ */
+void hash_sha_256_compress(uint32_t state[8], const unsigned char *block);
+
+/**
+ * @brief Fills midstate with the SHA-256 state after processing prefix.
+ * 
+ * @param midstate A pointer to fill with the midstate.
+ * @param prefix The message prefix.
+ * @param prefix_length The length of the prefix. This must be a multiple of
+ * SHA_256_BLOCK_LENGTH.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t hash_midstate_create(
+    sha_256_midstate_t *midstate,
+    const unsigned char *prefix,
+    size_t prefix_length
+);
+
+/**
+ * @brief Fills hash with the SHA-256 hash of the midstate's prefix and suffix.
+ * 
+ * This function does not modify midstate, so callers can finalize the same
+ * midstate with many suffixes.
+ * 
+ * @param midstate The midstate over the message prefix.
+ * @param suffix The rest of the message.
+ * @param suffix_length The length of the suffix.
+ * @param hash A pointer to fill with the hash of the whole message.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t hash_midstate_finalize(
+    const sha_256_midstate_t *midstate,
+    const unsigned char *suffix,
+    size_t suffix_length,
+    sha_256_t *hash
+);
+
+/**
+ * @brief Fills final_block with the suffix and SHA-256 padding.
+ * 
+ * The final block is the last block that SHA-256 compresses when finalizing
+ * the midstate with the suffix. Batch kernels use it as a template that only
+ * differs between messages in a counter.
+ * 
+ * @param midstate The midstate over the message prefix.
+ * @param suffix The rest of the message.
+ * @param suffix_length The length of the suffix. The suffix and padding must
+ * fit in one block, so this must be at most SHA_256_BLOCK_LENGTH - 9.
+ * @param final_block A buffer of SHA_256_BLOCK_LENGTH bytes to fill.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t hash_midstate_final_block(
+    const sha_256_midstate_t *midstate,
+    const unsigned char *suffix,
+    size_t suffix_length,
+    unsigned char *final_block
+);
+
 #endif  // INCLUDE_HASH_H_
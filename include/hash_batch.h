@@ -0,0 +1,121 @@
+/**
+ * @brief Defines multi-lane SHA-256 kernels for hashing many nonces at once.
+ * 
+ * Miners hash the same block header over and over with different proofs of
+ * work. After the midstate, every attempt hashes one 64-byte block that only
+ * differs in the 8-byte proof of work. A batch kernel runs that final
+ * compression for several consecutive proofs of work at once, one per SIMD
+ * lane. The fastest kernel the CPU supports is chosen at runtime.
+ */
+
+#ifndef INCLUDE_HASH_BATCH_H_
+#define INCLUDE_HASH_BATCH_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "include/hash.h"
+#include "include/return_codes.h"
+
+// The largest number of lanes of any batch kernel.
+#define HASH_BATCH_MAX_LANES 16
+// The number of hashes each kernel computes per timing trial when choosing the
+// fastest kernel.
+#define HASH_BATCH_CALIBRATION_HASHES 16384
+// The number of timing trials per kernel. The fastest trial counts.
+#define HASH_BATCH_CALIBRATION_TRIALS 2
+
+/**
+ * @brief A function that compresses one final block for many counters.
+ * 
+ * @param state The eight 32-bit midstate chaining values.
+ * @param block_words The final block as sixteen big endian 32-bit words.
+ * @param counter_word The index of the word holding the upper half of the
+ * 64-bit big endian counter. The next word holds the lower half.
+ * @param first_counter The counter for lane 0. Lane i uses first_counter + i.
+ * @param output_states An array of 8 * num_lanes words to fill with the final
+ * chaining values. Word j of lane i is at index j * num_lanes + i.
+ */
+typedef void (hash_batch_function_t(
+    const uint32_t *state,
+    const uint32_t *block_words,
+    size_t counter_word,
+    uint64_t first_counter,
+    uint32_t *output_states));
+
+/**
+ * @brief A function that reports whether the CPU can run a kernel.
+ */
+typedef bool (hash_batch_supported_function_t(void));
+
+/**
+ * @brief A batch SHA-256 kernel.
+ * 
+ * @param name A human-readable name for the kernel.
+ * @param num_lanes The number of hashes the kernel computes per call.
+ * @param is_supported Reports whether the CPU can run the kernel.
+ * @param function The kernel.
+ */
+typedef struct hash_batch_kernel_t {
+    char *name;
+    size_t num_lanes;
+    hash_batch_supported_function_t *is_supported;
+    hash_batch_function_t *function;
+} hash_batch_kernel_t;
+
+/**
+ * @brief Fills kernels with every batch kernel compiled into the program.
+ * 
+ * The kernels are ordered from most to fewest lanes. The last is a scalar
+ * kernel that every CPU supports. Some kernels may not be supported by the
+ * current CPU; check is_supported before using them.
+ * 
+ * @param kernels A pointer to fill with the array of kernels.
+ * @param num_kernels A pointer to fill with the length of the array.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t hash_batch_get_kernels(
+    const hash_batch_kernel_t **kernels,
+    size_t *num_kernels
+);
+
+/**
+ * @brief Fills kernel with the fastest batch kernel the CPU supports.
+ * 
+ * The first call times a short run of every supported kernel and remembers the
+ * one that computed the most hashes per second. Later calls return the same
+ * kernel. On CPUs with the Intel SHA extensions this is the SHA-NI kernel
+ * unless a wide vector kernel measures faster.
+ * 
+ * @param kernel A pointer to fill with the kernel.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t hash_batch_get_best_kernel(const hash_batch_kernel_t **kernel);
+
+/**
+ * @brief Fills hashes with one SHA-256 hash per lane of the kernel.
+ * 
+ * Each hash covers the midstate's prefix followed by final_block with the
+ * 64-bit big endian counter at counter_offset set to first_counter plus the
+ * lane index.
+ * 
+ * @param kernel The batch kernel.
+ * @param midstate The midstate over the message prefix.
+ * @param final_block The last SHA_256_BLOCK_LENGTH bytes of the message,
+ * including SHA-256 padding. See hash_midstate_final_block.
+ * @param counter_offset The offset of the counter in final_block. This must be
+ * a multiple of 4.
+ * @param first_counter The counter value for the first hash.
+ * @param hashes An array of kernel->num_lanes hashes to fill.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t hash_batch_finalize(
+    const hash_batch_kernel_t *kernel,
+    const sha_256_midstate_t *midstate,
+    const unsigned char *final_block,
+    size_t counter_offset,
+    uint64_t first_counter,
+    sha_256_t *hashes
+);
+
+#endif  // INCLUDE_HASH_BATCH_H_
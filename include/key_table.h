@@ -0,0 +1,94 @@
+/**
+ * @brief Defines a table that interns public keys by ID.
+ */
+
+#ifndef INCLUDE_KEY_TABLE_H_
+#define INCLUDE_KEY_TABLE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "include/hash.h"
+#include "include/public_key.h"
+#include "include/return_codes.h"
+
+// The number of keys a new key table has room for before it grows.
+#define KEY_TABLE_INITIAL_CAPACITY 16
+
+/**
+ * @brief A table holding one shared object for each distinct public key.
+ *
+ * A blockchain usually has far fewer distinct keys than transactions; each
+ * miner key, for instance, appears in every block that miner mined. Interning
+ * keys through a table makes equal keys the same object, so memory and
+ * serialized size grow with the number of distinct keys. The table holds one
+ * reference to each key and looks keys up by ID in an open addressing hash
+ * table. Like blockchain_t, a key table is not thread-safe.
+ *
+ * @param num_keys The number of keys in the table.
+ * @param capacity The number of keys the keys array has room for.
+ * @param keys The keys in the order they were added.
+ * @param num_buckets The number of hash table buckets, a power of two at least
+ * twice capacity.
+ * @param buckets The hash table. Each bucket holds one plus the index of a key
+ * in keys, or zero if the bucket is empty.
+ */
+typedef struct key_table_t {
+    size_t num_keys;
+    size_t capacity;
+    public_key_t **keys;
+    size_t num_buckets;
+    size_t *buckets;
+} key_table_t;
+
+/**
+ * @brief Fills table with a pointer to the newly allocated, empty key table.
+ *
+ * @param table A pointer to fill with the table's address.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t key_table_create(key_table_t **table);
+
+/**
+ * @brief Releases the table's references to its keys and frees the table.
+ *
+ * @param table The table to destroy.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t key_table_destroy(key_table_t *table);
+
+/**
+ * @brief Fills interned_key with the table's key equal to public_key.
+ *
+ * If the table has no key with public_key's ID, the table adds public_key
+ * itself.
+ *
+ * @param table The table.
+ * @param public_key The key to intern.
+ * @param interned_key A pointer to fill with the table's key. The caller owns
+ * a new reference to it and must release it.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t key_table_intern(
+    key_table_t *table,
+    public_key_t *public_key,
+    public_key_t **interned_key
+);
+
+/**
+ * @brief Looks up the key with the given ID.
+ *
+ * @param table The table.
+ * @param id The ID of the key to look up.
+ * @param public_key If the key is in the table, a pointer to fill with the key.
+ * The table keeps ownership of the key.
+ * @param is_found A pointer to fill with true if the key is in the table.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t key_table_find(
+    key_table_t *table,
+    sha_256_t *id,
+    public_key_t **public_key,
+    bool *is_found
+);
+
+#endif  // INCLUDE_KEY_TABLE_H_
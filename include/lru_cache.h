@@ -0,0 +1,137 @@
+/**
+ * @brief Defines a bounded, thread-safe cache with least recently used
+ * eviction.
+ */
+
+#ifndef INCLUDE_LRU_CACHE_H_
+#define INCLUDE_LRU_CACHE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+#include "include/hash.h"
+#include "include/linked_list.h"
+#include "include/return_codes.h"
+
+/**
+ * @brief A user-defined function that takes an extra reference to a value.
+ *
+ * The cache calls this function while it holds its lock, so that a value it
+ * hands out stays alive even if another thread evicts it immediately after.
+ */
+typedef void (retain_function_t(void *value));
+
+/**
+ * @brief An entry in an LRU cache.
+ *
+ * @param key The entry's key.
+ * @param value The entry's value. The cache owns one reference to it.
+ * @param newer The next more recently used entry, or NULL if this entry is the
+ * most recently used.
+ * @param older The next less recently used entry, or NULL if this entry is the
+ * least recently used.
+ * @param next_in_bucket The next entry in the same hash table bucket, or NULL.
+ */
+typedef struct lru_cache_entry_t {
+    sha_256_t key;
+    void *value;
+    struct lru_cache_entry_t *newer;
+    struct lru_cache_entry_t *older;
+    struct lru_cache_entry_t *next_in_bucket;
+} lru_cache_entry_t;
+
+/**
+ * @brief A bounded, thread-safe cache keyed by SHA-256 hashes.
+ *
+ * Lookups go through a hash table, and a doubly linked list orders the entries
+ * by recency. When the cache is full, inserting a new entry evicts the least
+ * recently used one. A single mutex protects the cache; every operation holds
+ * it only for a few pointer updates, so callers should cache values that are
+ * expensive to compute.
+ *
+ * @param capacity The maximum number of entries.
+ * @param num_entries The current number of entries.
+ * @param num_buckets The number of hash table buckets, a power of two.
+ * @param buckets The hash table. Each bucket is a list of entries chained with
+ * next_in_bucket.
+ * @param newest The most recently used entry, or NULL if the cache is empty.
+ * @param oldest The least recently used entry, or NULL if the cache is empty.
+ * @param free_function A user-defined function that releases the cache's
+ * reference to a value. May be NULL.
+ * @param retain_function A user-defined function that takes an extra reference
+ * to a value for the caller of lru_cache_get. May be NULL, in which case values
+ * must outlive the cache.
+ * @param mutex Protects all other fields.
+ */
+typedef struct lru_cache_t {
+    size_t capacity;
+    size_t num_entries;
+    size_t num_buckets;
+    lru_cache_entry_t **buckets;
+    lru_cache_entry_t *newest;
+    lru_cache_entry_t *oldest;
+    free_function_t *free_function;
+    retain_function_t *retain_function;
+    pthread_mutex_t mutex;
+} lru_cache_t;
+
+/**
+ * @brief Fills cache with a pointer to the newly allocated cache.
+ *
+ * @param cache A pointer to fill with the cache's address.
+ * @param capacity The maximum number of entries. Must be positive.
+ * @param free_function A user-defined function that releases the cache's
+ * reference to a value. May be NULL.
+ * @param retain_function A user-defined function that takes an extra reference
+ * to a value. May be NULL.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t lru_cache_create(
+    lru_cache_t **cache,
+    size_t capacity,
+    free_function_t *free_function,
+    retain_function_t *retain_function
+);
+
+/**
+ * @brief Frees all memory associated with the cache, including its values.
+ *
+ * @param cache The cache to destroy.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t lru_cache_destroy(lru_cache_t *cache);
+
+/**
+ * @brief Looks up key and marks the entry as the most recently used.
+ *
+ * @param cache The cache.
+ * @param key The key to look up.
+ * @param value If not NULL and the key is in the cache, a pointer to fill with
+ * the value. If the cache has a retain function, the caller owns the extra
+ * reference it takes and must release it.
+ * @param is_found A pointer to fill with true if the key is in the cache.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t lru_cache_get(
+    lru_cache_t *cache,
+    sha_256_t *key,
+    void **value,
+    bool *is_found
+);
+
+/**
+ * @brief Inserts value under key as the most recently used entry.
+ *
+ * The cache takes ownership of the caller's reference to value. If the key is
+ * already in the cache, the cache keeps the existing value and releases value
+ * with the free function. If the cache is full, it evicts the least recently
+ * used entry.
+ *
+ * @param cache The cache.
+ * @param key The key.
+ * @param value The value. May be NULL.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t lru_cache_put(lru_cache_t *cache, sha_256_t *key, void *value);
+
+#endif  // INCLUDE_LRU_CACHE_H_
@@ -23,13 +23,20 @@
  * @param miner_public_key The public key with which to mine blocks. This
  * function uses it to create the minting transaction.
  * @param miner_private_key The private key with which to mine blocks. This
- * function uses it to digitally sign the minting transaction.
+ * function parses it once and uses it to digitally sign every minting
+ * transaction.
  * @param print_progress If true, display progress on the screen.
+ * @param num_threads The number of worker threads with which to search for
+ * each block's proof of work. If zero, mine_blocks uses one worker thread per
+ * online processor. mine_blocks starts these threads once in a mining pool and
+ * reuses them for every block, including after switching to a longer chain.
  * @param outfile If not NULL, this function will save the blockchain to this
  * filename every time it mines a new block. If NULL, this function will only
  * keep the blockchain in memory. Unless you are just testing, you should
  * provide this argument. Otherwise there is no local record of your mining and
  * you may lose all the coin you have mined thus far.
+ * @param outfile_sync_policy When to sync the blocks saved to outfile to disk.
+ * A zeroed policy syncs every block.
  * @param should_stop This should initially be false. Setting this flag while
  * the function is running requests that the function terminate gracefully.
  * Users should expect the function to terminate in a timely manner (on the
@@ -62,7 +69,9 @@ typedef struct mine_blocks_args_t {
     ssh_key_t *miner_public_key;
     ssh_key_t *miner_private_key;
     bool print_progress;
+    size_t num_threads;
     char *outfile;
+    blockchain_sync_policy_t outfile_sync_policy;
     atomic_bool *should_stop;
     bool *exit_ready;
     pthread_cond_t exit_ready_cond;
@@ -0,0 +1,82 @@
+/**
+ * @brief Defines variable-length, shared public keys.
+ */
+
+#ifndef INCLUDE_PUBLIC_KEY_H_
+#define INCLUDE_PUBLIC_KEY_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "include/hash.h"
+#include "include/return_codes.h"
+
+/**
+ * @brief An immutable public key that many transactions can share.
+ * 
+ * Keys hold only their actual bytes rather than a fixed-size buffer, and
+ * transactions refer to them by pointer, so a transaction costs the same
+ * memory no matter how long its keys are. The key is freed when its last
+ * reference is released.
+ * 
+ * @param num_references The number of holders of this key.
+ * @param id The SHA-256 hash of the key's bytes, which identifies the key in
+ * key tables, caches, and serialized blockchains.
+ * @param length The number of bytes in the key.
+ * @param bytes The key.
+ */
+typedef struct public_key_t {
+    atomic_size_t num_references;
+    sha_256_t id;
+    size_t length;
+    unsigned char bytes[];
+} public_key_t;
+
+/**
+ * @brief Fills public_key with a newly allocated key holding one reference.
+ * 
+ * @param public_key The pointer to fill with the new key.
+ * @param bytes The key's bytes. May be NULL if length is zero.
+ * @param length The number of bytes in the key.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t public_key_create(
+    public_key_t **public_key,
+    const unsigned char *bytes,
+    size_t length
+);
+
+/**
+ * @brief Takes another reference to the key.
+ * 
+ * @param public_key The key.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t public_key_retain(public_key_t *public_key);
+
+/**
+ * @brief Releases a reference to the key, freeing it if it was the last one.
+ * 
+ * @param public_key The key.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t public_key_release(public_key_t *public_key);
+
+/**
+ * @brief Fills is_equal with whether the keys have the same bytes.
+ * 
+ * Keys with the same length and ID are equal, so this function does not
+ * compare the bytes themselves.
+ * 
+ * @param public_key1 The first key.
+ * @param public_key2 The second key.
+ * @param is_equal A pointer to fill with the result.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t public_key_equals(
+    public_key_t *public_key1,
+    public_key_t *public_key2,
+    bool *is_equal
+);
+
+#endif  // INCLUDE_PUBLIC_KEY_H_
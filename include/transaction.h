@@ -8,32 +8,80 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <sys/time.h>
+#include <openssl/evp.h>
 #include "include/return_codes.h"
 #include "include/cryptography.h"
+#include "include/hash.h"
+#include "include/public_key.h"
 
 #define AMOUNT_GENERATED_DURING_MINTING 1
+// The number of parsed sender public keys that signature verification keeps.
+// A chain usually has few distinct senders, so a small cache avoids almost
+// all PEM parsing.
+#define TRANSACTION_PUBLIC_KEY_CACHE_CAPACITY 64
+// Transactions signed with RSA PEM keys. Zero so that zeroed transactions and
+// transactions from before versions existed are RSA transactions.
+#define TRANSACTION_VERSION_RSA 0
+// Transactions signed with raw Ed25519 keys.
+#define TRANSACTION_VERSION_ED25519 1
+// The length of the message an Ed25519 transaction signature covers: the
+// version, created_at, both raw keys, and amount.
+#define TRANSACTION_ED25519_MESSAGE_LENGTH \
+    (3 * sizeof(uint64_t) + 2 * ED25519_KEY_LENGTH)
+// The length of the message an RSA transaction signature covers: created_at,
+// both keys zero padded to MAX_SSH_KEY_LENGTH bytes, and amount, all in the
+// layout transaction_t had when it stored keys inline.
+#define TRANSACTION_RSA_MESSAGE_LENGTH \
+    (2 * sizeof(uint64_t) + 2 * MAX_SSH_KEY_LENGTH)
 
 /**
  * @brief Represents a transaction.
  * 
  * @param created_at The datetime at which the user created this block.
- * @param sender_public_key The sender's public key. Set to zero to represent
- * coins generated during the mining process.
- * @param recipient_public_key The recipient's public key.
+ * @param sender_public_key The sender's public key, which the transaction holds
+ * a reference to. An empty key represents coins generated during the mining
+ * process. RSA transactions hold PEM keys without their zero padding, and
+ * Ed25519 transactions hold ED25519_KEY_LENGTH byte raw keys.
+ * @param recipient_public_key The recipient's public key, in the same format as
+ * sender_public_key. It may be the same object as sender_public_key.
  * @param amount The amount transferred from sender to recipient.
  * @param sender_signature The digital signature the sender creates to provide
- * authentication, integrity, and non-repudiation for the transaction. The
- * signature covers all fields in this data structure except for the signature
- * itself.
+ * authentication, integrity, and non-repudiation for the transaction. In RSA
+ * transactions, it covers the TRANSACTION_RSA_MESSAGE_LENGTH byte message that
+ * encodes created_at, the padded keys, and amount. In Ed25519 transactions, it
+ * covers the TRANSACTION_ED25519_MESSAGE_LENGTH byte message that encodes
+ * version, created_at, the raw keys, and amount.
+ * @param version The signature scheme, TRANSACTION_VERSION_RSA or
+ * TRANSACTION_VERSION_ED25519.
  */
 typedef struct transaction_t {
     time_t created_at;
-    ssh_key_t sender_public_key;
-    ssh_key_t recipient_public_key;
+    public_key_t *sender_public_key;
+    public_key_t *recipient_public_key;
     uint64_t amount;
     ssh_signature_t sender_signature;
+    uint64_t version;
 } transaction_t;
 
+/**
+ * @brief Signs transactions with one private key.
+ * 
+ * Creating a signer parses the private key and initializes a signing context
+ * once, so that long-running signers such as the miner do no key parsing per
+ * transaction. A signer is immutable after creation and multiple threads may
+ * sign with it concurrently.
+ * 
+ * @param version The version of the transactions this signer signs.
+ * @param private_key The parsed private key.
+ * @param md_ctx A signing context initialized with private_key. Each signature
+ * starts from a copy of this context.
+ */
+typedef struct transaction_signer_t {
+    uint64_t version;
+    EVP_PKEY *private_key;
+    EVP_MD_CTX *md_ctx;
+} transaction_signer_t;
+
 /**
  * @brief Fills transaction with a newly allocated transaction.
  * 
@@ -55,22 +103,157 @@ return_code_t transaction_create(
     ssh_key_t *sender_private_key
 );
 
+/**
+ * @brief Fills transaction with a newly allocated transaction signed by signer.
+ * 
+ * The transaction has the signer's version, so the public keys must be in that
+ * version's format. The transaction takes its own references to the keys.
+ * 
+ * @param transaction The pointer to fill with the new transaction.
+ * @param sender_public_key The sender's public key.
+ * @param recipient_public_key The recipient's public key.
+ * @param amount The amount transferred from sender to recipient.
+ * @param signer A signer holding the sender's private key.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t transaction_create_with_signer(
+    transaction_t **transaction,
+    public_key_t *sender_public_key,
+    public_key_t *recipient_public_key,
+    uint64_t amount,
+    transaction_signer_t *signer
+);
+
 /**
  * @brief Frees all memory associated with the transaction.
  * 
+ * This function releases the transaction's references to its keys.
+ * 
  * @param transaction The transaction.
  * @return return_code_t A return code indicating success or failure.
  */
 return_code_t transaction_destroy(transaction_t *transaction);
 
+/**
+ * @brief Fills copy with a newly allocated copy of the transaction.
+ * 
+ * The copy shares the transaction's keys.
+ * 
+ * @param copy The pointer to fill with the copy.
+ * @param transaction The transaction to copy.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t transaction_copy(
+    transaction_t **copy,
+    transaction_t *transaction
+);
+
+/**
+ * @brief Fills public_key with a newly allocated key for a transaction.
+ * 
+ * @param public_key The pointer to fill with the new key.
+ * @param ssh_key The key. RSA keys are PEM strings whose zero padding this
+ * function removes. Ed25519 keys are raw keys in the first ED25519_KEY_LENGTH
+ * bytes.
+ * @param version The version of the transactions that will use the key.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t transaction_public_key_create(
+    public_key_t **public_key,
+    ssh_key_t *ssh_key,
+    uint64_t version
+);
+
+/**
+ * @brief Fills has_canonical_keys with whether the keys have one encoding.
+ * 
+ * RSA transactions sign and hash their keys zero-padded to MAX_SSH_KEY_LENGTH
+ * bytes, so an RSA key with trailing zero bytes would sign the same message
+ * and give the same transaction hash as the key without them, yet serialize
+ * differently. Such keys are not canonical, and transactions holding them are
+ * invalid. Ed25519 keys have a fixed length and may end in zero bytes.
+ * 
+ * @param transaction The transaction.
+ * @param has_canonical_keys A pointer to fill with the result.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t transaction_has_canonical_keys(
+    transaction_t *transaction,
+    bool *has_canonical_keys
+);
+
+/**
+ * @brief Fills signer with a newly allocated signer for the private key.
+ * 
+ * @param signer The pointer to fill with the new signer.
+ * @param private_key The PEM-encoded RSA private key.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t transaction_signer_create(
+    transaction_signer_t **signer,
+    ssh_key_t *private_key
+);
+
+/**
+ * @brief Fills signer with a newly allocated signer for an Ed25519 key.
+ * 
+ * The signer signs TRANSACTION_VERSION_ED25519 transactions.
+ * 
+ * @param signer The pointer to fill with the new signer.
+ * @param private_key The raw Ed25519 private key in the first
+ * ED25519_KEY_LENGTH bytes.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t transaction_signer_create_ed25519(
+    transaction_signer_t **signer,
+    ssh_key_t *private_key
+);
+
+/**
+ * @brief Fills public_key and private_key with a new Ed25519 key pair.
+ * 
+ * @param public_key The key to fill with the raw public key, zero padded.
+ * @param private_key The key to fill with the raw private key, zero padded.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t transaction_generate_ed25519_key_pair(
+    ssh_key_t *public_key,
+    ssh_key_t *private_key
+);
+
+/**
+ * @brief Frees all memory associated with the signer.
+ * 
+ * @param signer The signer.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t transaction_signer_destroy(transaction_signer_t *signer);
+
+/**
+ * @brief Fills signature with the signer's signature for the transaction.
+ * 
+ * @param signature The pointer to fill with the signature.
+ * @param transaction The transaction for which to generate a signature. The
+ * transaction should have all fields filled out except sender_signature, and
+ * its version must match the signer's.
+ * @param signer A signer holding the sender's private key.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t transaction_signer_sign(
+    ssh_signature_t *signature,
+    transaction_t *transaction,
+    transaction_signer_t *signer
+);
+
 /**
  * @brief Fills signature with the sender's signature for the transaction.
  * 
  * @param signature The pointer to fill with the signature.
  * @param transaction The transaction for which to generate a signature. The
  * transaction should have all fields filled out except sender_signature. This
- * function generates a value to fill that field.
- * @param sender_private_key The sender's private key.
+ * function generates a value to fill that field. It must be an RSA
+ * transaction.
+ * @param sender_private_key The sender's PEM-encoded RSA private key.
  * @return return_code_t A return code indicating success or failure.
  */
 return_code_t transaction_generate_signature(
@@ -82,11 +265,16 @@ return_code_t transaction_generate_signature(
 /**
  * @brief Fills is_valid_signature with the signature's correctness.
  * 
+ * Parsed sender public keys are kept in a bounded, process-wide cache keyed by
+ * the key's ID, so verifying many transactions from the same sender parses the
+ * key only once.
+ * 
  * @param is_valid_signature The pointer to fill with the result. A signature is
  * valid if decrypting the signature with the public key produces the original
  * message (or message hash).
  * @param transaction The transaction whose signature to verify. The signature
- * must cover all fields in the transaction except the signature itself.
+ * must cover the fields its version requires; see transaction_t. Transactions
+ * with unknown versions have invalid signatures.
  * @return return_code_t A return code indicating success or failure.
  */
 return_code_t transaction_verify_signature(
@@ -94,4 +282,88 @@ return_code_t transaction_verify_signature(
     transaction_t *transaction
 );
 
+/**
+ * @brief Fills are_valid_signatures with each transaction's signature
+ * correctness.
+ * 
+ * This function verifies a batch of transactions of any mix of versions, as
+ * transaction_verify_signature would. It looks up each sender's public key
+ * only when the sender differs from the previous transaction's.
+ * 
+ * @param are_valid_signatures An array of num_transactions results to fill.
+ * @param transactions The transactions whose signatures to verify.
+ * @param num_transactions The number of transactions.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t transaction_verify_signatures(
+    bool *are_valid_signatures,
+    transaction_t **transactions,
+    size_t num_transactions
+);
+
+/**
+ * @brief Fills hash with the transaction's hash.
+ * 
+ * The hash covers every field in the transaction, including the signature.
+ * Blocks commit to their transactions through the Merkle tree of these hashes.
+ * RSA transactions hash the same bytes they did when transaction_t stored keys
+ * inline, so existing blocks keep their hashes. Other transactions hash their
+ * serialized form.
+ * 
+ * @param transaction The transaction.
+ * @param hash A pointer to fill with the transaction's hash.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t transaction_hash(transaction_t *transaction, sha_256_t *hash);
+
+/**
+ * @brief Fills size with the number of bytes transaction_serialize writes.
+ * 
+ * @param transaction The transaction.
+ * @param size A pointer to fill with the size.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t transaction_get_serialized_size(
+    transaction_t *transaction,
+    size_t *size
+);
+
+/**
+ * @brief Writes the transaction to buffer.
+ * 
+ * The format is the version, created_at, the sender key's length and bytes,
+ * the recipient key's length and bytes, amount, and the signature's length and
+ * bytes. All integers are 64-bit big endian. Keys and signatures take only as
+ * many bytes as they hold.
+ * 
+ * @param transaction The transaction.
+ * @param buffer The buffer to fill.
+ * @param buffer_size The number of bytes available in buffer.
+ * @param num_bytes_written A pointer to fill with the number of bytes written.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t transaction_serialize(
+    transaction_t *transaction,
+    unsigned char *buffer,
+    size_t buffer_size,
+    size_t *num_bytes_written
+);
+
+/**
+ * @brief Fills transaction with a newly allocated transaction read from buffer.
+ * 
+ * @param transaction The pointer to fill with the new transaction.
+ * @param buffer A buffer that starts with a transaction in the format that
+ * transaction_serialize writes.
+ * @param buffer_size The number of bytes available in buffer.
+ * @param num_bytes_read A pointer to fill with the number of bytes read.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t transaction_deserialize(
+    transaction_t **transaction,
+    unsigned char *buffer,
+    size_t buffer_size,
+    size_t *num_bytes_read
+);
+
 #endif  // INCLUDE_TRANSACTION_H_
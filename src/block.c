@@ -1,7 +1,8 @@
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
-#include <openssl/evp.h>
 #include "include/block.h"
+#include "include/endian.h"
 #include "include/linked_list.h"
 #include "include/transaction.h"
 
@@ -25,6 +26,7 @@ return_code_t block_create(
     new_block->created_at = created_at;
     new_block->transaction_list = transaction_list;
     new_block->proof_of_work = proof_of_work;
+    new_block->extra_nonce = 0;
     new_block->previous_block_hash = previous_block_hash;
     *block = new_block;
 end:
@@ -67,34 +69,256 @@ end:
     return return_code;
 }
 
-return_code_t block_hash(block_t *block, sha_256_t *hash) {
+return_code_t block_merkle_root_from_transaction_hashes(
+    sha_256_t *transaction_hashes,
+    uint64_t num_transactions,
+    sha_256_t *merkle_root
+) {
     return_code_t return_code = SUCCESS;
-    if (NULL == block || NULL == hash) {
+    if ((NULL == transaction_hashes && 0 != num_transactions) ||
+        NULL == merkle_root) {
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
-    const EVP_MD *md = EVP_sha256();
-    EVP_MD_CTX *mdctx = EVP_MD_CTX_new();
-    EVP_DigestInit_ex(mdctx, md, NULL);
-    EVP_DigestUpdate(
-        mdctx, (void *)&block->created_at, sizeof(block->created_at));
-    EVP_DigestUpdate(
-        mdctx, (void *)&block->proof_of_work, sizeof(block->proof_of_work));
-    EVP_DigestUpdate(
-        mdctx,
-        (void *)&block->previous_block_hash,
-        sizeof(block->previous_block_hash));
+    if (0 == num_transactions) {
+        memset(merkle_root, 0, sizeof(sha_256_t));
+        goto end;
+    }
+    sha_256_t *level = transaction_hashes;
+    for (uint64_t idx = 0; idx < num_transactions; idx++) {
+        unsigned char leaf[1 + sizeof(sha_256_t)];
+        leaf[0] = BLOCK_MERKLE_LEAF_PREFIX;
+        memcpy(leaf + 1, &level[idx], sizeof(sha_256_t));
+        return_code = hash_sha_256(leaf, sizeof(leaf), &level[idx]);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+    }
+    // Replace each level with its parents in place until only the root is left.
+    uint64_t level_size = num_transactions;
+    while (level_size > 1) {
+        uint64_t parent_level_size = 0;
+        for (uint64_t idx = 0; idx < level_size; idx += 2) {
+            // An odd node moves up unchanged rather than being paired with
+            // itself, which would let a repeated last transaction keep the
+            // same root.
+            if (idx + 1 == level_size) {
+                level[parent_level_size] = level[idx];
+                parent_level_size++;
+                continue;
+            }
+            unsigned char parent[1 + 2 * sizeof(sha_256_t)];
+            parent[0] = BLOCK_MERKLE_NODE_PREFIX;
+            memcpy(parent + 1, &level[idx], 2 * sizeof(sha_256_t));
+            return_code = hash_sha_256(
+                parent, sizeof(parent), &level[parent_level_size]);
+            if (SUCCESS != return_code) {
+                goto end;
+            }
+            parent_level_size++;
+        }
+        level_size = parent_level_size;
+    }
+    unsigned char root[sizeof(uint64_t) + sizeof(sha_256_t)];
+    *(uint64_t *)root = htobe64(num_transactions);
+    memcpy(root + sizeof(uint64_t), &level[0], sizeof(sha_256_t));
+    return_code = hash_sha_256(root, sizeof(root), merkle_root);
+end:
+    return return_code;
+}
+
+return_code_t block_merkle_root(block_t *block, sha_256_t *merkle_root) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == block || NULL == merkle_root) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    uint64_t num_transactions = 0;
+    return_code = linked_list_length(
+        block->transaction_list, &num_transactions);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    // Allocate at least one element so that an empty block is not an error.
+    sha_256_t *transaction_hashes = malloc(
+        (num_transactions + 1) * sizeof(sha_256_t));
+    if (NULL == transaction_hashes) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    uint64_t transaction_idx = 0;
     for (node_t *node = block->transaction_list->head;
         NULL != node;
-        node = node->next) {
-        transaction_t *transaction = (transaction_t *)node->data;
-        // We can just hash the entire transaction directly because it contains
-        // no pointers. Memory locations don't have meaning, so we can't hash
-        // pointers.
-        EVP_DigestUpdate(mdctx, (void *)transaction, sizeof(*transaction));
-    }
-    EVP_DigestFinal_ex(mdctx, hash->digest, NULL);
-    EVP_MD_CTX_free(mdctx);
+        node = node->next, transaction_idx++) {
+        return_code = transaction_hash(
+            (transaction_t *)node->data,
+            &transaction_hashes[transaction_idx]);
+        if (SUCCESS != return_code) {
+            goto cleanup;
+        }
+    }
+    return_code = block_merkle_root_from_transaction_hashes(
+        transaction_hashes, num_transactions, merkle_root);
+cleanup:
+    free(transaction_hashes);
+end:
+    return return_code;
+}
+
+return_code_t block_get_header(block_t *block, block_header_t *header) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == block || NULL == header) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    sha_256_t merkle_root = {0};
+    return_code = block_merkle_root(block, &merkle_root);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    header->created_at = block->created_at;
+    header->previous_block_hash = block->previous_block_hash;
+    header->merkle_root = merkle_root;
+    header->extra_nonce = block->extra_nonce;
+    header->proof_of_work = block->proof_of_work;
+end:
+    return return_code;
+}
+
+void _block_header_serialize(
+    block_header_t *header,
+    unsigned char buffer[BLOCK_HEADER_SIZE]
+) {
+    // Serialize the header so that struct padding and host endianness do not
+    // affect the hash. extra_nonce and proof_of_work come last so that miners
+    // can reuse the midstate over everything before them.
+    unsigned char *next_spot_in_buffer = buffer;
+    uint64_t created_at = htobe64(header->created_at);
+    memcpy(next_spot_in_buffer, &created_at, sizeof(created_at));
+    next_spot_in_buffer += sizeof(created_at);
+    memcpy(
+        next_spot_in_buffer,
+        &header->previous_block_hash,
+        sizeof(header->previous_block_hash));
+    next_spot_in_buffer += sizeof(header->previous_block_hash);
+    memcpy(
+        next_spot_in_buffer,
+        &header->merkle_root,
+        sizeof(header->merkle_root));
+    next_spot_in_buffer += sizeof(header->merkle_root);
+    uint64_t extra_nonce = htobe64(header->extra_nonce);
+    memcpy(next_spot_in_buffer, &extra_nonce, sizeof(extra_nonce));
+    next_spot_in_buffer += sizeof(extra_nonce);
+    uint64_t proof_of_work = htobe64(header->proof_of_work);
+    memcpy(next_spot_in_buffer, &proof_of_work, sizeof(proof_of_work));
+}
+
+return_code_t block_header_hash(block_header_t *header, sha_256_t *hash) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == header || NULL == hash) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    sha_256_midstate_t midstate = {0};
+    return_code = block_header_midstate(header, &midstate);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    return_code = block_header_hash_from_midstate(&midstate, header, hash);
+end:
+    return return_code;
+}
+
+return_code_t block_header_midstate(
+    block_header_t *header,
+    sha_256_midstate_t *midstate
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == header || NULL == midstate) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    unsigned char buffer[BLOCK_HEADER_SIZE];
+    _block_header_serialize(header, buffer);
+    return_code = hash_midstate_create(
+        midstate, buffer, BLOCK_HEADER_MIDSTATE_LENGTH);
+end:
+    return return_code;
+}
+
+void _block_header_suffix(
+    block_header_t *header,
+    unsigned char suffix[BLOCK_HEADER_SIZE - BLOCK_HEADER_MIDSTATE_LENGTH]
+) {
+    // The suffix is the tail of the Merkle root followed by the extra nonce and
+    // the proof of work.
+    size_t merkle_root_tail_length =
+        BLOCK_HEADER_SIZE - BLOCK_HEADER_MIDSTATE_LENGTH - 2 * sizeof(uint64_t);
+    memcpy(
+        suffix,
+        header->merkle_root.digest +
+            sizeof(header->merkle_root) - merkle_root_tail_length,
+        merkle_root_tail_length);
+    uint64_t extra_nonce = htobe64(header->extra_nonce);
+    memcpy(
+        suffix + merkle_root_tail_length,
+        &extra_nonce,
+        sizeof(extra_nonce));
+    uint64_t proof_of_work = htobe64(header->proof_of_work);
+    memcpy(
+        suffix + merkle_root_tail_length + sizeof(extra_nonce),
+        &proof_of_work,
+        sizeof(proof_of_work));
+}
+
+return_code_t block_header_hash_from_midstate(
+    sha_256_midstate_t *midstate,
+    block_header_t *header,
+    sha_256_t *hash
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == midstate || NULL == header || NULL == hash) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    unsigned char suffix[BLOCK_HEADER_SIZE - BLOCK_HEADER_MIDSTATE_LENGTH];
+    _block_header_suffix(header, suffix);
+    return_code = hash_midstate_finalize(
+        midstate, suffix, sizeof(suffix), hash);
+end:
+    return return_code;
+}
+
+return_code_t block_header_final_block(
+    sha_256_midstate_t *midstate,
+    block_header_t *header,
+    unsigned char *final_block
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == midstate || NULL == header || NULL == final_block) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    unsigned char suffix[BLOCK_HEADER_SIZE - BLOCK_HEADER_MIDSTATE_LENGTH];
+    _block_header_suffix(header, suffix);
+    return_code = hash_midstate_final_block(
+        midstate, suffix, sizeof(suffix), final_block);
+end:
+    return return_code;
+}
+
+return_code_t block_hash(block_t *block, sha_256_t *hash) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == block || NULL == hash) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    block_header_t header = {0};
+    return_code = block_get_header(block, &header);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    return_code = block_header_hash(&header, hash);
 end:
     return return_code;
 }
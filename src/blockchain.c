@@ -1,22 +1,129 @@
+// Exposes pthread_setaffinity_np for pinning mining workers.
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <sched.h>
 #include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
 #include "include/block.h"
 #include "include/blockchain.h"
 #include "include/endian.h"
 #include "include/hash.h"
+#include "include/hash_batch.h"
 #include "include/linked_list.h"
+#include "include/lru_cache.h"
 #include "include/return_codes.h"
 #include "include/transaction.h"
 
 #define ANSI_COLOR_GREEN "\x1b[32m"
 #define ANSI_COLOR_LIGHT_BLUE "\x1b[94m"
 #define ANSI_COLOR_RESET "\x1b[0m"
+#define ANSI_CLEAR_LINE "\r\x1b[2K"
+#define MINING_PROGRESS_INTERVAL_NANOSECONDS 500000000
+// Signature verification workers claim this many signatures at a time. Each
+// batch costs one atomic operation and one call to
+// transaction_verify_signatures, which reuses the public key across
+// consecutive transactions from the same sender. Verification only starts
+// another thread for each full batch, so that verifying a few new blocks stays
+// on the calling thread.
+#define SIGNATURE_VERIFICATION_BATCH_SIZE 16
+// The sizes of a block header and a transaction in blockchains serialized
+// before the format had a magic number. Headers had no extra nonce, and
+// transactions held both keys zero-padded to MAX_SSH_KEY_LENGTH bytes and an
+// RSA signature padded to MAX_SSH_SIGNATURE_LENGTH bytes.
+#define BLOCKCHAIN_UNVERSIONED_BLOCK_HEADER_SIZE \
+    (4 * sizeof(uint64_t) + sizeof(sha_256_t))
+#define BLOCKCHAIN_UNVERSIONED_TRANSACTION_SIZE \
+    (3 * sizeof(uint64_t) + 2 * MAX_SSH_KEY_LENGTH + MAX_SSH_SIGNATURE_LENGTH)
+// The size of a serialized transaction without its signature bytes: the
+// version, created_at, both key IDs, amount, and signature length.
+#define BLOCKCHAIN_SERIALIZED_TRANSACTION_FIXED_SIZE \
+    (4 * sizeof(uint64_t) + 2 * sizeof(sha_256_t))
+// The size of a serialized block without its transactions: created_at, the
+// previous block hash, extra_nonce, proof_of_work, and the transaction count.
+#define BLOCKCHAIN_SERIALIZED_BLOCK_HEADER_SIZE \
+    (4 * sizeof(uint64_t) + sizeof(sha_256_t))
 
-return_code_t blockchain_create(
+return_code_t blockchain_target_from_num_leading_zero_bits(
+    size_t num_leading_zero_bits,
+    blockchain_target_t *target
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == target || num_leading_zero_bits > 8 * sizeof(sha_256_t)) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    for (size_t idx = 0; idx < BLOCKCHAIN_TARGET_NUM_WORDS; idx++) {
+        size_t word_start_bit = 64 * idx;
+        if (num_leading_zero_bits <= word_start_bit) {
+            target->words[idx] = UINT64_MAX;
+        } else if (num_leading_zero_bits >= word_start_bit + 64) {
+            target->words[idx] = 0;
+        } else {
+            target->words[idx] =
+                UINT64_MAX >> (num_leading_zero_bits - word_start_bit);
+        }
+    }
+end:
+    return return_code;
+}
+
+return_code_t blockchain_target_from_num_leading_zero_bytes(
+    size_t num_leading_zero_bytes,
+    blockchain_target_t *target
+) {
+    return_code_t return_code = SUCCESS;
+    if (num_leading_zero_bytes > sizeof(sha_256_t)) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    return_code = blockchain_target_from_num_leading_zero_bits(
+        8 * num_leading_zero_bytes, target);
+end:
+    return return_code;
+}
+
+size_t _blockchain_target_num_leading_zero_bytes(blockchain_target_t *target) {
+    for (size_t num_bytes = 0; num_bytes <= sizeof(sha_256_t); num_bytes++) {
+        blockchain_target_t byte_target = {0};
+        blockchain_target_from_num_leading_zero_bytes(num_bytes, &byte_target);
+        if (0 == memcmp(target, &byte_target, sizeof(blockchain_target_t))) {
+            return num_bytes;
+        }
+    }
+    return NUM_LEADING_ZERO_BYTES_CUSTOM_TARGET;
+}
+
+bool _blockchain_hash_meets_target(
+    blockchain_target_t *target,
+    sha_256_t *hash
+) {
+    // Compare the hash and target as big endian numbers one word at a time.
+    // Nearly all hashes differ from the target in the first word.
+    for (size_t idx = 0; idx < BLOCKCHAIN_TARGET_NUM_WORDS; idx++) {
+        uint64_t hash_word = 0;
+        memcpy(
+            &hash_word,
+            hash->digest + idx * sizeof(uint64_t),
+            sizeof(hash_word));
+        hash_word = betoh64(hash_word);
+        if (hash_word != target->words[idx]) {
+            return hash_word < target->words[idx];
+        }
+    }
+    return true;
+}
+
+return_code_t blockchain_create_with_target(
     blockchain_t **blockchain,
-    size_t num_leading_zero_bytes_required_in_block_hash
+    blockchain_target_t target
 ) {
     return_code_t return_code = SUCCESS;
     if (NULL == blockchain) {
@@ -37,14 +144,54 @@ return_code_t blockchain_create(
         free(new_blockchain);
         goto end;
     }
+    key_table_t *key_table = NULL;
+    return_code = key_table_create(&key_table);
+    if (SUCCESS != return_code) {
+        linked_list_destroy(block_list);
+        free(new_blockchain);
+        goto end;
+    }
     new_blockchain->block_list = block_list;
+    new_blockchain->key_table = key_table;
     new_blockchain->num_leading_zero_bytes_required_in_block_hash =
-        num_leading_zero_bytes_required_in_block_hash;
+        _blockchain_target_num_leading_zero_bytes(&target);
+    new_blockchain->target = target;
+    new_blockchain->num_verified_blocks = 0;
+    memset(
+        &new_blockchain->last_verified_block_hash,
+        0,
+        sizeof(new_blockchain->last_verified_block_hash));
+    new_blockchain->log_path = NULL;
+    new_blockchain->log_size = 0;
+    new_blockchain->num_logged_keys = 0;
+    new_blockchain->last_logged_block_node = NULL;
+    new_blockchain->num_unsynced_logged_blocks = 0;
+    clock_gettime(CLOCK_MONOTONIC, &new_blockchain->log_synced_at);
     *blockchain = new_blockchain;
 end:
     return return_code;
 }
 
+return_code_t blockchain_create(
+    blockchain_t **blockchain,
+    size_t num_leading_zero_bytes_required_in_block_hash
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    blockchain_target_t target = {0};
+    return_code = blockchain_target_from_num_leading_zero_bytes(
+        num_leading_zero_bytes_required_in_block_hash, &target);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    return_code = blockchain_create_with_target(blockchain, target);
+end:
+    return return_code;
+}
+
 return_code_t blockchain_destroy(blockchain_t *blockchain) {
     return_code_t return_code = SUCCESS;
     if (NULL == blockchain) {
@@ -52,6 +199,10 @@ return_code_t blockchain_destroy(blockchain_t *blockchain) {
         goto end;
     }
     return_code = linked_list_destroy(blockchain->block_list);
+    // Destroy the table after the blocks so that it releases the last
+    // reference to each key.
+    key_table_destroy(blockchain->key_table);
+    free(blockchain->log_path);
     free(blockchain);
 end:
     return return_code;
@@ -92,12 +243,59 @@ done:
     return return_code;
 }
 
+return_code_t _blockchain_intern_key(
+    key_table_t *key_table,
+    public_key_t **public_key
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == *public_key) {
+        goto end;
+    }
+    public_key_t *interned_key = NULL;
+    return_code = key_table_intern(key_table, *public_key, &interned_key);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    public_key_release(*public_key);
+    *public_key = interned_key;
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_intern_block_keys(
+    key_table_t *key_table,
+    block_t *block
+) {
+    return_code_t return_code = SUCCESS;
+    for (node_t *transaction_node = block->transaction_list->head;
+        NULL != transaction_node;
+        transaction_node = transaction_node->next) {
+        transaction_t *transaction = (transaction_t *)transaction_node->data;
+        return_code = _blockchain_intern_key(
+            key_table, &transaction->sender_public_key);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        return_code = _blockchain_intern_key(
+            key_table, &transaction->recipient_public_key);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+    }
+end:
+    return return_code;
+}
+
 return_code_t blockchain_add_block(blockchain_t *blockchain, block_t *block) {
     return_code_t return_code = SUCCESS;
     if (NULL == blockchain || NULL == block) {
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
+    return_code = _blockchain_intern_block_keys(blockchain->key_table, block);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
     return_code = linked_list_append(blockchain->block_list, block);
 end:
     return return_code;
@@ -113,751 +311,3898 @@ return_code_t blockchain_is_valid_block_hash(
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
-    bool is_valid = true;
-    for (size_t idx = 0;
-        idx < blockchain->num_leading_zero_bytes_required_in_block_hash;
-        idx++) {
-        if (block_hash.digest[idx] != 0) {
-            is_valid = false;
+    *is_valid_block_hash = _blockchain_hash_meets_target(
+        &blockchain->target, &block_hash);
+end:
+    return return_code;
+}
+
+/**
+ * @brief Contains the state shared by all workers in a proof of work search.
+ * 
+ * @param blockchain The blockchain whose difficulty the search must meet.
+ * @param block The block for which to find a proof of work. Workers never
+ * modify this block.
+ * @param header The block's header. Workers hash their own copies of the header
+ * with different proofs of work, so the Merkle root is only computed once.
+ * @param midstate The SHA-256 midstate over the header's invariant prefix, so
+ * each attempt only runs the final compression.
+ * @param final_block The header's padded final SHA-256 block with the first
+ * extra nonce, which the batch kernel fills with each proof of work. Workers
+ * copy it and overwrite the extra nonce when they roll it.
+ * @param kernel The batch kernel. Each call hashes kernel->num_lanes
+ * consecutive proofs of work.
+ * @param pool The pool whose workers run the search.
+ * @param generation The pool generation under which this search was published.
+ * Workers drop the search once the pool's generation moves past it.
+ * @param batch_size The number of consecutive proofs of work in a batch. This
+ * is a multiple of the kernel's number of lanes.
+ * @param print_progress If true, workers record the best hash and a reporter
+ * thread displays progress on the screen.
+ * @param abort_function Called by each worker once per batch. The search
+ * aborts with the first return code other than SUCCESS.
+ * @param abort_args The argument to abort_function.
+ * @param first_extra_nonce The extra nonce with which the search starts.
+ * @param first_batch_idx The index, within first_extra_nonce, of the first
+ * batch to search. Batch i of an extra nonce holds proofs of work
+ * i * batch_size to (i + 1) * batch_size - 1.
+ * @param last_batch_idx The index of the last whole batch in an extra nonce.
+ * The search skips the few proofs of work past it and moves on to the next
+ * extra nonce.
+ * @param next_batch_idx The number of batches that workers have claimed so far,
+ * which is also the index of the next batch to claim, counted from the start
+ * of the search across extra nonces. Workers claim batches in increasing
+ * order.
+ * @param best_position The position of the first valid proof of work found so
+ * far, or UINT64_MAX if no worker has found one. The position counts proofs of
+ * work from the start of the search, so it orders candidates across extra
+ * nonces. Workers stop once their next batch would start past this value.
+ * @param abort_code SUCCESS until a worker aborts the search, then the return
+ * code describing why. Only the first worker to abort sets this value.
+ * @param num_attempts The number of hashes all workers have computed so far.
+ * @param best_hash_prefix If print_progress is true, the first 8 bytes of
+ * best_hash as a big endian number. Workers read this without locking to
+ * decide whether a hash might be a new best.
+ * @param best_hash If print_progress is true, the smallest hash any worker has
+ * computed so far.
+ * @param report_mutex Protects best_hash and is_done.
+ * @param report_condition Signaled when the search is done, so that the
+ * reporter thread exits without waiting out its interval.
+ * @param is_done True once all workers have finished.
+ * @param num_workers_running The number of workers currently running the
+ * search. Protected by the pool's mutex.
+ * @param num_workers_finished The number of workers that have left the search.
+ * Once this is nonzero, no new worker joins. Protected by the pool's mutex.
+ */
+typedef struct proof_of_work_search_t {
+    blockchain_t *blockchain;
+    block_t *block;
+    block_header_t header;
+    sha_256_midstate_t midstate;
+    unsigned char final_block[SHA_256_BLOCK_LENGTH];
+    const hash_batch_kernel_t *kernel;
+    mining_pool_t *pool;
+    uint_fast64_t generation;
+    uint64_t batch_size;
+    bool print_progress;
+    mining_abort_function_t *abort_function;
+    void *abort_args;
+    uint64_t first_extra_nonce;
+    uint64_t first_batch_idx;
+    uint64_t last_batch_idx;
+    atomic_uint_fast64_t next_batch_idx;
+    atomic_uint_fast64_t best_position;
+    atomic_int abort_code;
+    atomic_uint_fast64_t num_attempts;
+    atomic_uint_fast64_t best_hash_prefix;
+    sha_256_t best_hash;
+    pthread_mutex_t report_mutex;
+    pthread_cond_t report_condition;
+    bool is_done;
+    size_t num_workers_running;
+    size_t num_workers_finished;
+} proof_of_work_search_t;
+
+size_t _get_num_worker_threads(size_t num_threads) {
+    if (0 != num_threads) {
+        return num_threads;
+    }
+    long num_processors = sysconf(_SC_NPROCESSORS_ONLN);
+    return num_processors > 0 ? (size_t)num_processors : 1;
+}
+
+void _print_mining_progress(
+    sha_256_t *best_hash,
+    uint64_t num_attempts,
+    double hashes_per_second
+) {
+    // Overwrite the previous progress line.
+    printf(ANSI_CLEAR_LINE "Mining LeoCoin block: ");
+    for (size_t idx = 0; idx < sizeof(best_hash->digest); idx++) {
+        printf("%02x", best_hash->digest[idx]);
+    }
+    printf(
+        " %"PRIu64" attempts, %.2f MH/s",
+        num_attempts,
+        hashes_per_second / 1e6);
+    fflush(stdout);
+}
+
+void *_proof_of_work_reporter(void *args) {
+    proof_of_work_search_t *search = (proof_of_work_search_t *)args;
+    struct timespec previous_time = {0};
+    clock_gettime(CLOCK_MONOTONIC, &previous_time);
+    uint64_t previous_num_attempts = 0;
+    pthread_mutex_lock(&search->report_mutex);
+    while (!search->is_done) {
+        struct timespec wake_time = {0};
+        clock_gettime(CLOCK_REALTIME, &wake_time);
+        wake_time.tv_nsec += MINING_PROGRESS_INTERVAL_NANOSECONDS;
+        wake_time.tv_sec += wake_time.tv_nsec / 1000000000;
+        wake_time.tv_nsec %= 1000000000;
+        pthread_cond_timedwait(
+            &search->report_condition, &search->report_mutex, &wake_time);
+        if (search->is_done) {
             break;
         }
+        sha_256_t best_hash = search->best_hash;
+        pthread_mutex_unlock(&search->report_mutex);
+        struct timespec current_time = {0};
+        clock_gettime(CLOCK_MONOTONIC, &current_time);
+        uint64_t num_attempts = atomic_load(&search->num_attempts);
+        double elapsed_seconds =
+            (double)(current_time.tv_sec - previous_time.tv_sec) +
+            (double)(current_time.tv_nsec - previous_time.tv_nsec) / 1e9;
+        double hashes_per_second = elapsed_seconds > 0 ?
+            (double)(num_attempts - previous_num_attempts) / elapsed_seconds :
+            0;
+        _print_mining_progress(&best_hash, num_attempts, hashes_per_second);
+        previous_time = current_time;
+        previous_num_attempts = num_attempts;
+        pthread_mutex_lock(&search->report_mutex);
     }
-    *is_valid_block_hash = is_valid;
-end:
-    return return_code;
+    pthread_mutex_unlock(&search->report_mutex);
+    return NULL;
 }
 
-return_code_t blockchain_mine_block(
-    blockchain_t *blockchain,
-    block_t *block,
-    bool print_progress,
-    atomic_bool *should_stop
+void _record_best_hash(proof_of_work_search_t *search, sha_256_t *hash) {
+    uint64_t hash_prefix = 0;
+    memcpy(&hash_prefix, hash->digest, sizeof(hash_prefix));
+    hash_prefix = betoh64(hash_prefix);
+    if (hash_prefix >= atomic_load(&search->best_hash_prefix)) {
+        return;
+    }
+    pthread_mutex_lock(&search->report_mutex);
+    if (hash_prefix < atomic_load(&search->best_hash_prefix)) {
+        search->best_hash = *hash;
+        atomic_store(&search->best_hash_prefix, hash_prefix);
+    }
+    pthread_mutex_unlock(&search->report_mutex);
+}
+
+void _print_mining_result(sha_256_t *hash, char *color) {
+    printf(ANSI_CLEAR_LINE "Mining LeoCoin block: %s", color);
+    for (size_t idx = 0; idx < sizeof(hash->digest); idx++) {
+        printf("%02x", hash->digest[idx]);
+    }
+    printf("%s\n", ANSI_COLOR_RESET);
+}
+
+void _abort_proof_of_work_search(
+    proof_of_work_search_t *search,
+    return_code_t return_code
 ) {
-    return_code_t return_code = SUCCESS;
-    if (NULL == blockchain || NULL == block || NULL == should_stop) {
-        return_code = FAILURE_INVALID_INPUT;
-        goto end;
+    int expected = SUCCESS;
+    atomic_compare_exchange_strong(&search->abort_code, &expected, return_code);
+}
+
+bool _proof_of_work_search_locate_batch(
+    proof_of_work_search_t *search,
+    uint64_t batch_idx,
+    uint64_t *extra_nonce,
+    uint64_t *batch_start
+) {
+    // The search runs through the rest of the first extra nonce's batches,
+    // then through every batch of each following extra nonce.
+    uint64_t num_later_first_batches =
+        search->last_batch_idx - search->first_batch_idx;
+    uint64_t extra_nonce_offset = 0;
+    uint64_t batch_idx_in_extra_nonce = 0;
+    if (batch_idx <= num_later_first_batches) {
+        batch_idx_in_extra_nonce = search->first_batch_idx + batch_idx;
+    } else {
+        uint64_t num_remaining_batches =
+            batch_idx - num_later_first_batches - 1;
+        if (UINT64_MAX == search->last_batch_idx) {
+            // Each extra nonce has 2^64 batches of one proof of work.
+            extra_nonce_offset = 1;
+            batch_idx_in_extra_nonce = num_remaining_batches;
+        } else {
+            extra_nonce_offset =
+                1 + num_remaining_batches / (search->last_batch_idx + 1);
+            batch_idx_in_extra_nonce =
+                num_remaining_batches % (search->last_batch_idx + 1);
+        }
     }
-    size_t best_leading_zeroes = 0;
-    size_t print_frequency = 20000;
-    sha_256_t hash = {0};
+    if (extra_nonce_offset > UINT64_MAX - search->first_extra_nonce) {
+        return false;
+    }
+    *extra_nonce = search->first_extra_nonce + extra_nonce_offset;
+    *batch_start = batch_idx_in_extra_nonce * search->batch_size;
+    return true;
+}
+
+void _proof_of_work_search_worker(proof_of_work_search_t *search) {
+    size_t num_lanes = search->kernel->num_lanes;
+    uint64_t batch_size = search->batch_size;
+    uint64_t max_batch_idx = (UINT64_MAX - (batch_size - 1)) / batch_size;
+    unsigned char final_block[SHA_256_BLOCK_LENGTH];
+    memcpy(final_block, search->final_block, sizeof(final_block));
+    uint64_t current_extra_nonce = search->first_extra_nonce;
+    sha_256_t hashes[HASH_BATCH_MAX_LANES];
     bool is_valid_block_hash = false;
-    for (uint64_t new_proof = 0; new_proof < UINT64_MAX; new_proof++) {
-        if (*should_stop) {
-            return_code = FAILURE_STOPPED_EARLY;
-            goto end;
+    while (true) {
+        // Batches are claimed in increasing order, so every batch below the
+        // best position is searched in full.
+        uint64_t batch_idx = atomic_fetch_add(&search->next_batch_idx, 1);
+        if (batch_idx >= max_batch_idx) {
+            break;
+        }
+        // Check whether to stop only once per batch so that the cost is spread
+        // over many hashes.
+        uint64_t batch_position = batch_idx * batch_size;
+        if (batch_position >= atomic_load(&search->best_position)) {
+            break;
+        }
+        if (SUCCESS != atomic_load(&search->abort_code)) {
+            break;
+        }
+        if (search->generation != atomic_load(&search->pool->generation)) {
+            _abort_proof_of_work_search(search, FAILURE_STOPPED_EARLY);
+            break;
         }
-        block->proof_of_work = new_proof;
-        return_code = block_hash(block, &hash);
+        return_code_t return_code = search->abort_function(search->abort_args);
         if (SUCCESS != return_code) {
-            goto end;
+            _abort_proof_of_work_search(search, return_code);
+            break;
         }
-        if (print_progress) {
-            size_t num_zeroes = 0;
-            for (size_t idx = 0; idx < sizeof(hash.digest); idx++) {
-                unsigned char upper_nybble = hash.digest[idx] >> 4;
-                if (upper_nybble != 0) {
-                    break;
-                }
-                num_zeroes++;
-                if (hash.digest[idx] != 0) {
-                    break;
-                }
-                num_zeroes++;
-            }
-            bool print_this_iteration = new_proof % print_frequency == 0;
-            if (num_zeroes > best_leading_zeroes) {
-                best_leading_zeroes = num_zeroes;
-                print_this_iteration = true;
+        uint64_t extra_nonce = 0;
+        uint64_t batch_start = 0;
+        if (!_proof_of_work_search_locate_batch(
+                search, batch_idx, &extra_nonce, &batch_start)) {
+            break;
+        }
+        if (extra_nonce != current_extra_nonce) {
+            // The extra nonce follows the midstate, so rolling it only changes
+            // the final block.
+            uint64_t extra_nonce_big_endian = htobe64(extra_nonce);
+            memcpy(
+                final_block + BLOCK_HEADER_FINAL_BLOCK_EXTRA_NONCE_OFFSET,
+                &extra_nonce_big_endian,
+                sizeof(extra_nonce_big_endian));
+            current_extra_nonce = extra_nonce;
+        }
+        for (uint64_t first_proof = batch_start;
+            first_proof - batch_start < batch_size;
+            first_proof += num_lanes) {
+            return_code = hash_batch_finalize(
+                search->kernel,
+                &search->midstate,
+                final_block,
+                BLOCK_HEADER_FINAL_BLOCK_PROOF_OF_WORK_OFFSET,
+                first_proof,
+                hashes);
+            if (SUCCESS != return_code) {
+                _abort_proof_of_work_search(search, return_code);
+                break;
             }
-            if (print_this_iteration) {
-                // Remove the previous block hash from output.
-                printf("\rMining LeoCoin block: ");
-                // Print the best number of leading zeroes.
-                for (size_t idx = 0; idx < best_leading_zeroes; idx++) {
-                    printf("0");
+            // Check the lanes in order so that the first valid hash in the
+            // batch has the smallest position.
+            for (size_t lane = 0; lane < num_lanes; lane++) {
+                if (search->print_progress) {
+                    _record_best_hash(search, &hashes[lane]);
                 }
-                // Add the part of the new hash following the best number of
-                // leading zeroes. It's not the accurate hash, but it does give
-                // an idea of progress.
-                for (size_t idx = best_leading_zeroes;
-                    idx < 2 * sizeof(hash.digest);
-                    idx++) {
-                    size_t hash_idx = idx / 2;
-                    unsigned char nybble = 0;
-                    if (idx % 2 == 0) {
-                        nybble = hash.digest[hash_idx] >> 4;
-                    } else {
-                        nybble = hash.digest[hash_idx] & 0x0f;
-                    }
-                    // To give a better sense of progress, don't allow a
-                    // non-leading zero to follow the best number of leading
-                    // zeroes.
-                    if (idx == best_leading_zeroes && 0 == nybble) {
-                        nybble += 1;
+                is_valid_block_hash = _blockchain_hash_meets_target(
+                    &search->blockchain->target, &hashes[lane]);
+                if (is_valid_block_hash) {
+                    // Keep the smallest valid position so that the result
+                    // does not depend on thread scheduling.
+                    uint64_t new_position =
+                        batch_position + (first_proof - batch_start) + lane;
+                    uint_fast64_t best = atomic_load(&search->best_position);
+                    while (new_position < best &&
+                        !atomic_compare_exchange_weak(
+                            &search->best_position, &best, new_position)) {
                     }
-                    printf("%01x", nybble);
+                    break;
                 }
-                fflush(stdout);
+            }
+            if (is_valid_block_hash) {
+                break;
             }
         }
-        return_code = blockchain_is_valid_block_hash(
-            blockchain, hash, &is_valid_block_hash);
-        if (SUCCESS != return_code) {
-            goto end;
+        atomic_fetch_add_explicit(
+            &search->num_attempts, batch_size, memory_order_relaxed);
+        if (is_valid_block_hash || SUCCESS != return_code) {
+            break;
         }
-        if (is_valid_block_hash) {
-            if (print_progress) {
-                printf("\rMining LeoCoin block: %s", ANSI_COLOR_GREEN);
-                for (size_t idx = 0; idx < sizeof(hash.digest); idx++) {
-                    printf("%02x", hash.digest[idx]);
-                }
-                printf("%s\n", ANSI_COLOR_RESET);
-            }
-            goto end;
+    }
+}
+
+void _mining_pool_pin_worker(pthread_t thread, size_t worker_idx) {
+#ifdef __linux__
+    cpu_set_t allowed_cpus;
+    CPU_ZERO(&allowed_cpus);
+    if (0 != sched_getaffinity(0, sizeof(allowed_cpus), &allowed_cpus)) {
+        return;
+    }
+    size_t num_allowed_cpus = (size_t)CPU_COUNT(&allowed_cpus);
+    if (0 == num_allowed_cpus) {
+        return;
+    }
+    // Spread workers over the allowed processors in order.
+    size_t target_idx = worker_idx % num_allowed_cpus;
+    for (size_t cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed_cpus)) {
+            continue;
+        }
+        if (0 == target_idx) {
+            cpu_set_t worker_cpus;
+            CPU_ZERO(&worker_cpus);
+            CPU_SET(cpu, &worker_cpus);
+            // Pinning is only a hint; workers run correctly unpinned.
+            pthread_setaffinity_np(thread, sizeof(worker_cpus), &worker_cpus);
+            return;
         }
+        target_idx--;
     }
-    return_code = FAILURE_COULD_NOT_FIND_VALID_PROOF_OF_WORK;
-end:
-    return return_code;
+#else
+    (void)thread;
+    (void)worker_idx;
+#endif
 }
 
-return_code_t synchronized_blockchain_mine_block(
-    synchronized_blockchain_t *sync,
-    block_t *block,
-    bool print_progress,
-    atomic_bool *should_stop,
-    atomic_size_t *sync_version_currently_mined
-) {
+void *_mining_pool_worker(void *args) {
+    mining_pool_t *pool = (mining_pool_t *)args;
+    uint_fast64_t last_generation = 0;
+    pthread_mutex_lock(&pool->mutex);
+    while (true) {
+        while (!pool->should_shut_down &&
+            (NULL == pool->search ||
+            last_generation == pool->search->generation ||
+            0 != pool->search->num_workers_finished)) {
+            pthread_cond_wait(&pool->work_available, &pool->mutex);
+        }
+        if (pool->should_shut_down) {
+            break;
+        }
+        proof_of_work_search_t *search = pool->search;
+        last_generation = search->generation;
+        search->num_workers_running++;
+        pthread_mutex_unlock(&pool->mutex);
+        _proof_of_work_search_worker(search);
+        pthread_mutex_lock(&pool->mutex);
+        search->num_workers_running--;
+        search->num_workers_finished++;
+        if (0 == search->num_workers_running) {
+            pthread_cond_signal(&pool->work_finished);
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+return_code_t mining_pool_create(mining_pool_t **pool, size_t num_threads) {
     return_code_t return_code = SUCCESS;
-    if (NULL == sync ||
-        NULL == block ||
-        NULL == should_stop ||
-        NULL == sync_version_currently_mined) {
+    if (NULL == pool) {
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
-    if (0 != pthread_mutex_lock(&sync->mutex)) {
-        return_code = FAILURE_PTHREAD_FUNCTION;
+    mining_pool_t *new_pool = calloc(1, sizeof(mining_pool_t));
+    if (NULL == new_pool) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
         goto end;
     }
-    blockchain_t *blockchain = sync->blockchain;
-    if (0 != pthread_mutex_unlock(&sync->mutex)) {
+    new_pool->num_workers = _get_num_worker_threads(num_threads);
+    new_pool->threads = calloc(new_pool->num_workers, sizeof(pthread_t));
+    if (NULL == new_pool->threads) {
+        free(new_pool);
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    atomic_init(&new_pool->generation, 0);
+    if (0 != pthread_mutex_init(&new_pool->mutex, NULL)) {
+        free(new_pool->threads);
+        free(new_pool);
         return_code = FAILURE_PTHREAD_FUNCTION;
         goto end;
     }
-    size_t best_leading_zeroes = 0;
-    size_t print_frequency = 20000;
-    sha_256_t hash = {0};
-    bool is_valid_block_hash = false;
-    for (uint64_t new_proof = 0; new_proof < UINT64_MAX; new_proof++) {
-        if (*should_stop) {
-            return_code = FAILURE_STOPPED_EARLY;
-            goto end;
-        }
-        if (atomic_load(sync_version_currently_mined) !=
-            atomic_load(&sync->version)) {
-            if (print_progress) {
-                printf("\rMining LeoCoin block: %s", ANSI_COLOR_LIGHT_BLUE);
-                for (size_t idx = 0; idx < sizeof(hash.digest); idx++) {
-                    printf("%02x", hash.digest[idx]);
-                }
-                printf("%s\n", ANSI_COLOR_RESET);
-            }
-            return_code = FAILURE_LONGER_BLOCKCHAIN_DETECTED;
-            goto end;
-        }
-        block->proof_of_work = new_proof;
-        return_code = block_hash(block, &hash);
-        if (SUCCESS != return_code) {
-            goto end;
-        }
-        if (print_progress) {
-            size_t num_zeroes = 0;
-            for (size_t idx = 0; idx < sizeof(hash.digest); idx++) {
-                unsigned char upper_nybble = hash.digest[idx] >> 4;
-                if (upper_nybble != 0) {
-                    break;
-                }
-                num_zeroes++;
-                if (hash.digest[idx] != 0) {
-                    break;
-                }
-                num_zeroes++;
-            }
-            bool print_this_iteration = new_proof % print_frequency == 0;
-            if (num_zeroes > best_leading_zeroes) {
-                best_leading_zeroes = num_zeroes;
-                print_this_iteration = true;
-            }
-            if (print_this_iteration) {
-                // Remove the previous block hash from output.
-                printf("\rMining LeoCoin block: ");
-                // Print the best number of leading zeroes.
-                for (size_t idx = 0; idx < best_leading_zeroes; idx++) {
-                    printf("0");
-                }
-                // Add the part of the new hash following the best number of
-                // leading zeroes. It's not the accurate hash, but it does give
-                // an idea of progress.
-                for (size_t idx = best_leading_zeroes;
-                    idx < 2 * sizeof(hash.digest);
-                    idx++) {
-                    size_t hash_idx = idx / 2;
-                    unsigned char nybble = 0;
-                    if (idx % 2 == 0) {
-                        nybble = hash.digest[hash_idx] >> 4;
-                    } else {
-                        nybble = hash.digest[hash_idx] & 0x0f;
-                    }
-                    // To give a better sense of progress, don't allow a
-                    // non-leading zero to follow the best number of leading
-                    // zeroes.
-                    if (idx == best_leading_zeroes && 0 == nybble) {
-                        nybble += 1;
-                    }
-                    printf("%01x", nybble);
-                }
-                fflush(stdout);
-            }
-        }
-        return_code = blockchain_is_valid_block_hash(
-            blockchain, hash, &is_valid_block_hash);
-        if (SUCCESS != return_code) {
-            goto end;
-        }
-        if (is_valid_block_hash) {
-            if (print_progress) {
-                printf("\rMining LeoCoin block: %s", ANSI_COLOR_GREEN);
-                for (size_t idx = 0; idx < sizeof(hash.digest); idx++) {
-                    printf("%02x", hash.digest[idx]);
-                }
-                printf("%s\n", ANSI_COLOR_RESET);
-            }
-            goto end;
+    pthread_cond_init(&new_pool->work_available, NULL);
+    pthread_cond_init(&new_pool->work_finished, NULL);
+    size_t num_threads_started = 0;
+    for (size_t idx = 0; idx < new_pool->num_workers; idx++) {
+        if (0 != pthread_create(
+                &new_pool->threads[idx],
+                NULL,
+                _mining_pool_worker,
+                new_pool)) {
+            return_code = FAILURE_PTHREAD_FUNCTION;
+            break;
         }
+        _mining_pool_pin_worker(new_pool->threads[idx], idx);
+        num_threads_started++;
+    }
+    if (SUCCESS != return_code) {
+        new_pool->num_workers = num_threads_started;
+        mining_pool_destroy(new_pool);
+        goto end;
     }
-    return_code = FAILURE_COULD_NOT_FIND_VALID_PROOF_OF_WORK;
+    *pool = new_pool;
 end:
     return return_code;
 }
 
-void blockchain_print(blockchain_t *blockchain) {
-    if (NULL == blockchain) {
-        return;
+return_code_t mining_pool_destroy(mining_pool_t *pool) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == pool) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
     }
-    for (node_t *node = blockchain->block_list->head;
-        NULL != node;
-        node = node->next) {
-        block_t *block = (block_t *)node->data;
-        printf("%"PRIu64"->", block->proof_of_work);
+    pthread_mutex_lock(&pool->mutex);
+    pool->should_shut_down = true;
+    atomic_fetch_add(&pool->generation, 1);
+    pthread_cond_broadcast(&pool->work_available);
+    pthread_mutex_unlock(&pool->mutex);
+    for (size_t idx = 0; idx < pool->num_workers; idx++) {
+        pthread_join(pool->threads[idx], NULL);
     }
-    printf("\n");
+    pthread_cond_destroy(&pool->work_finished);
+    pthread_cond_destroy(&pool->work_available);
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool->threads);
+    free(pool);
+end:
+    return return_code;
 }
 
-return_code_t blockchain_verify(
+return_code_t mining_pool_search_for_proof_of_work(
+    mining_pool_t *pool,
     blockchain_t *blockchain,
-    bool *is_valid_blockchain,
-    block_t **first_invalid_block
+    block_t *block,
+    bool print_progress,
+    uint64_t batch_size,
+    mining_abort_function_t *abort_function,
+    void *abort_args
 ) {
     return_code_t return_code = SUCCESS;
-    if (NULL == blockchain || NULL == is_valid_blockchain) {
+    if (NULL == pool ||
+        NULL == blockchain ||
+        NULL == block ||
+        NULL == abort_function) {
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
-    if (NULL == blockchain->block_list->head) {
-        *is_valid_blockchain = true;
+    proof_of_work_search_t search = {0};
+    search.blockchain = blockchain;
+    search.block = block;
+    search.pool = pool;
+    search.print_progress = print_progress;
+    search.abort_function = abort_function;
+    search.abort_args = abort_args;
+    return_code = hash_batch_get_best_kernel(&search.kernel);
+    if (SUCCESS != return_code) {
         goto end;
     }
-    // Check the genesis block, which is unique.
-    block_t *genesis_block = (block_t *)blockchain->block_list->head->data;
-    bool genesis_block_transaction_list_is_empty = false;
-    return_code = linked_list_is_empty(
-        genesis_block->transaction_list,
-        &genesis_block_transaction_list_is_empty);
+    // Round the batch size up to a whole number of kernel calls.
+    if (0 == batch_size) {
+        batch_size = MINING_DEFAULT_BATCH_SIZE;
+    }
+    size_t num_lanes = search.kernel->num_lanes;
+    if (batch_size > UINT64_MAX - num_lanes) {
+        batch_size = UINT64_MAX - num_lanes;
+    }
+    search.batch_size = (batch_size + num_lanes - 1) / num_lanes * num_lanes;
+    // Resume from the batch containing the block's proof of work.
+    search.last_batch_idx =
+        (UINT64_MAX - (search.batch_size - 1)) / search.batch_size;
+    search.first_extra_nonce = block->extra_nonce;
+    search.first_batch_idx = block->proof_of_work / search.batch_size;
+    if (search.first_batch_idx > search.last_batch_idx) {
+        if (UINT64_MAX == search.first_extra_nonce) {
+            return_code = FAILURE_COULD_NOT_FIND_VALID_PROOF_OF_WORK;
+            goto end;
+        }
+        search.first_extra_nonce++;
+        search.first_batch_idx = 0;
+    }
+    return_code = block_get_header(block, &search.header);
     if (SUCCESS != return_code) {
         goto end;
     }
-    sha_256_t empty_block_hash = {0};
-    if (!genesis_block_transaction_list_is_empty ||
-        genesis_block->proof_of_work != GENESIS_BLOCK_PROOF_OF_WORK ||
-        0 != memcmp(
-            &genesis_block->previous_block_hash,
-            &empty_block_hash,
-            sizeof(sha_256_t))) {
-        *is_valid_blockchain = false;
-        if (NULL != first_invalid_block) {
-            *first_invalid_block = genesis_block;
-        }
+    search.header.extra_nonce = search.first_extra_nonce;
+    return_code = block_header_midstate(&search.header, &search.midstate);
+    if (SUCCESS != return_code) {
         goto end;
     }
-    sha_256_t previous_block_hash = {0};
-    block_hash(genesis_block, &previous_block_hash);
-    // Check the remaining blocks.
-    for (node_t *current_node = blockchain->block_list->head->next;
-        NULL != current_node;
-        current_node = current_node->next) {
-        block_t *current_block = (block_t *)current_node->data;
-        sha_256_t current_block_hash = {0};
-        return_code = block_hash(current_block, &current_block_hash);
+    return_code = block_header_final_block(
+        &search.midstate, &search.header, search.final_block);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    atomic_init(&search.next_batch_idx, 0);
+    atomic_init(&search.best_position, UINT64_MAX);
+    atomic_init(&search.abort_code, SUCCESS);
+    atomic_init(&search.num_attempts, 0);
+    atomic_init(&search.best_hash_prefix, UINT64_MAX);
+    memset(&search.best_hash, 0xff, sizeof(search.best_hash));
+    pthread_mutex_init(&search.report_mutex, NULL);
+    pthread_cond_init(&search.report_condition, NULL);
+    // Publish the work package. The workers only take the pool's mutex to join
+    // and leave it.
+    pthread_mutex_lock(&pool->mutex);
+    search.generation = atomic_fetch_add(&pool->generation, 1) + 1;
+    pool->search = &search;
+    pthread_cond_broadcast(&pool->work_available);
+    pthread_mutex_unlock(&pool->mutex);
+    // The reporter thread does all progress I/O so that workers never format
+    // or print.
+    pthread_t reporter_thread;
+    bool reporter_started =
+        print_progress &&
+        0 == pthread_create(
+            &reporter_thread, NULL, _proof_of_work_reporter, &search);
+    // Once any worker has left, the search is over; wait for the rest.
+    pthread_mutex_lock(&pool->mutex);
+    while (0 == search.num_workers_finished ||
+        0 != search.num_workers_running) {
+        pthread_cond_wait(&pool->work_finished, &pool->mutex);
+    }
+    // Retire the work package so that no worker picks it up again.
+    pool->search = NULL;
+    atomic_fetch_add(&pool->generation, 1);
+    pthread_mutex_unlock(&pool->mutex);
+    pthread_mutex_lock(&search.report_mutex);
+    search.is_done = true;
+    pthread_cond_signal(&search.report_condition);
+    pthread_mutex_unlock(&search.report_mutex);
+    if (reporter_started) {
+        pthread_join(reporter_thread, NULL);
+    }
+    uint64_t best_position = atomic_load(&search.best_position);
+    return_code = atomic_load(&search.abort_code);
+    // A valid proof of work stays valid even if the search aborted afterward.
+    if (UINT64_MAX != best_position) {
+        uint64_t extra_nonce = 0;
+        uint64_t batch_start = 0;
+        _proof_of_work_search_locate_batch(
+            &search,
+            best_position / search.batch_size,
+            &extra_nonce,
+            &batch_start);
+        block->extra_nonce = extra_nonce;
+        block->proof_of_work = batch_start + best_position % search.batch_size;
+        return_code = SUCCESS;
+        if (print_progress) {
+            sha_256_t hash = {0};
+            search.header.extra_nonce = block->extra_nonce;
+            search.header.proof_of_work = block->proof_of_work;
+            block_header_hash(&search.header, &hash);
+            _print_mining_result(&hash, ANSI_COLOR_GREEN);
+        }
+    } else if (FAILURE_LONGER_BLOCKCHAIN_DETECTED == return_code) {
+        if (print_progress) {
+            _print_mining_result(&search.best_hash, ANSI_COLOR_LIGHT_BLUE);
+        }
+    } else if (SUCCESS == return_code) {
+        return_code = FAILURE_COULD_NOT_FIND_VALID_PROOF_OF_WORK;
+    }
+    pthread_cond_destroy(&search.report_condition);
+    pthread_mutex_destroy(&search.report_mutex);
+end:
+    return return_code;
+}
+
+static mining_pool_t *shared_mining_pools[MINING_NUM_SHARED_POOLS] = {0};
+static pthread_mutex_t shared_mining_pools_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+return_code_t _mining_pool_acquire_shared(
+    mining_pool_t **pool,
+    size_t num_threads
+) {
+    return_code_t return_code = SUCCESS;
+    size_t num_workers = _get_num_worker_threads(num_threads);
+    mining_pool_t *idle_pool = NULL;
+    pthread_mutex_lock(&shared_mining_pools_mutex);
+    for (size_t idx = 0; idx < MINING_NUM_SHARED_POOLS; idx++) {
+        if (NULL != shared_mining_pools[idx] &&
+            num_workers == shared_mining_pools[idx]->num_workers) {
+            // Take the pool out of the list so that no other caller searches
+            // on it at the same time.
+            idle_pool = shared_mining_pools[idx];
+            shared_mining_pools[idx] = NULL;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&shared_mining_pools_mutex);
+    if (NULL == idle_pool) {
+        return_code = mining_pool_create(&idle_pool, num_workers);
         if (SUCCESS != return_code) {
             goto end;
         }
-        if (0 != memcmp(
-                &current_block_hash,
-                &empty_block_hash,
-                blockchain->num_leading_zero_bytes_required_in_block_hash)) {
-            *is_valid_blockchain = false;
-            if (NULL != first_invalid_block) {
-                *first_invalid_block = current_block;
-            }
-            goto end;
+    }
+    *pool = idle_pool;
+end:
+    return return_code;
+}
+
+void _mining_pool_release_shared(mining_pool_t *pool) {
+    pthread_mutex_lock(&shared_mining_pools_mutex);
+    for (size_t idx = 0; idx < MINING_NUM_SHARED_POOLS; idx++) {
+        if (NULL == shared_mining_pools[idx]) {
+            shared_mining_pools[idx] = pool;
+            pool = NULL;
+            break;
         }
-        if (0 != memcmp(
-            &current_block->previous_block_hash,
-            &previous_block_hash,
-            sizeof(sha_256_t))) {
-            *is_valid_blockchain = false;
-            if (NULL != first_invalid_block) {
-                *first_invalid_block = current_block;
+    }
+    pthread_mutex_unlock(&shared_mining_pools_mutex);
+    if (NULL != pool) {
+        mining_pool_destroy(pool);
+    }
+}
+
+return_code_t mining_pools_destroy_shared(void) {
+    return_code_t return_code = SUCCESS;
+    pthread_mutex_lock(&shared_mining_pools_mutex);
+    for (size_t idx = 0; idx < MINING_NUM_SHARED_POOLS; idx++) {
+        if (NULL != shared_mining_pools[idx]) {
+            return_code_t destroy_return_code = mining_pool_destroy(
+                shared_mining_pools[idx]);
+            if (SUCCESS == return_code) {
+                return_code = destroy_return_code;
             }
-            goto end;
+            shared_mining_pools[idx] = NULL;
         }
-        // Every block must contain at least the minting transaction.
-        bool block_transaction_list_is_empty = false;
-        return_code = linked_list_is_empty(
-            current_block->transaction_list,
-            &block_transaction_list_is_empty);
+    }
+    pthread_mutex_unlock(&shared_mining_pools_mutex);
+    return return_code;
+}
+
+return_code_t blockchain_search_for_proof_of_work(
+    blockchain_t *blockchain,
+    block_t *block,
+    bool print_progress,
+    size_t num_threads,
+    uint64_t batch_size,
+    mining_abort_function_t *abort_function,
+    void *abort_args
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || NULL == block || NULL == abort_function) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    mining_pool_t *pool = NULL;
+    return_code = _mining_pool_acquire_shared(&pool, num_threads);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    return_code = mining_pool_search_for_proof_of_work(
+        pool,
+        blockchain,
+        block,
+        print_progress,
+        batch_size,
+        abort_function,
+        abort_args);
+    _mining_pool_release_shared(pool);
+end:
+    return return_code;
+}
+
+return_code_t _should_stop_abort_function(void *args) {
+    atomic_bool *should_stop = (atomic_bool *)args;
+    return_code_t return_code = SUCCESS;
+    if (*should_stop) {
+        return_code = FAILURE_STOPPED_EARLY;
+    }
+    return return_code;
+}
+
+/**
+ * @brief Contains the arguments to _synchronized_abort_function.
+ * 
+ * @param should_stop The user's flag requesting that the search terminate.
+ * @param sync The synchronized blockchain being mined.
+ * @param sync_version_currently_mined The version of sync being mined.
+ */
+typedef struct synchronized_abort_args_t {
+    atomic_bool *should_stop;
+    synchronized_blockchain_t *sync;
+    atomic_size_t *sync_version_currently_mined;
+} synchronized_abort_args_t;
+
+return_code_t _synchronized_abort_function(void *args) {
+    synchronized_abort_args_t *abort_args = (synchronized_abort_args_t *)args;
+    return_code_t return_code = _should_stop_abort_function(
+        abort_args->should_stop);
+    if (SUCCESS == return_code &&
+        atomic_load(abort_args->sync_version_currently_mined) !=
+        atomic_load(&abort_args->sync->version)) {
+        return_code = FAILURE_LONGER_BLOCKCHAIN_DETECTED;
+    }
+    return return_code;
+}
+
+return_code_t blockchain_mine_block(
+    blockchain_t *blockchain,
+    block_t *block,
+    bool print_progress,
+    atomic_bool *should_stop,
+    size_t num_threads
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || NULL == block || NULL == should_stop) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    return_code = blockchain_search_for_proof_of_work(
+        blockchain,
+        block,
+        print_progress,
+        num_threads,
+        MINING_DEFAULT_BATCH_SIZE,
+        _should_stop_abort_function,
+        (void *)should_stop);
+end:
+    return return_code;
+}
+
+return_code_t synchronized_blockchain_mine_block(
+    synchronized_blockchain_t *sync,
+    block_t *block,
+    bool print_progress,
+    atomic_bool *should_stop,
+    atomic_size_t *sync_version_currently_mined,
+    size_t num_threads
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == sync ||
+        NULL == block ||
+        NULL == should_stop ||
+        NULL == sync_version_currently_mined) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    mining_pool_t *pool = NULL;
+    return_code = _mining_pool_acquire_shared(&pool, num_threads);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    return_code = synchronized_blockchain_mine_block_with_pool(
+        sync,
+        block,
+        print_progress,
+        should_stop,
+        sync_version_currently_mined,
+        pool);
+    _mining_pool_release_shared(pool);
+end:
+    return return_code;
+}
+
+return_code_t synchronized_blockchain_mine_block_with_pool(
+    synchronized_blockchain_t *sync,
+    block_t *block,
+    bool print_progress,
+    atomic_bool *should_stop,
+    atomic_size_t *sync_version_currently_mined,
+    mining_pool_t *pool
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == sync ||
+        NULL == block ||
+        NULL == should_stop ||
+        NULL == sync_version_currently_mined ||
+        NULL == pool) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    if (0 != pthread_mutex_lock(&sync->mutex)) {
+        return_code = FAILURE_PTHREAD_FUNCTION;
+        goto end;
+    }
+    blockchain_t *blockchain = sync->blockchain;
+    if (0 != pthread_mutex_unlock(&sync->mutex)) {
+        return_code = FAILURE_PTHREAD_FUNCTION;
+        goto end;
+    }
+    synchronized_abort_args_t abort_args = {0};
+    abort_args.should_stop = should_stop;
+    abort_args.sync = sync;
+    abort_args.sync_version_currently_mined = sync_version_currently_mined;
+    return_code = mining_pool_search_for_proof_of_work(
+        pool,
+        blockchain,
+        block,
+        print_progress,
+        MINING_DEFAULT_BATCH_SIZE,
+        _synchronized_abort_function,
+        &abort_args);
+end:
+    return return_code;
+}
+
+void blockchain_print(blockchain_t *blockchain) {
+    if (NULL == blockchain) {
+        return;
+    }
+    for (node_t *node = blockchain->block_list->head;
+        NULL != node;
+        node = node->next) {
+        block_t *block = (block_t *)node->data;
+        printf("%"PRIu64"->", block->proof_of_work);
+    }
+    printf("\n");
+}
+
+static lru_cache_t *verified_signature_cache = NULL;
+static return_code_t verified_signature_cache_init_return_code = SUCCESS;
+static pthread_once_t verified_signature_cache_once = PTHREAD_ONCE_INIT;
+
+void _blockchain_init_verified_signature_cache(void) {
+    // The cache only records which hashes were verified, so it holds no
+    // values and needs no free or retain functions.
+    verified_signature_cache_init_return_code = lru_cache_create(
+        &verified_signature_cache,
+        VERIFIED_SIGNATURE_CACHE_CAPACITY,
+        NULL,
+        NULL);
+}
+
+return_code_t blockchain_get_verified_signature_cache(lru_cache_t **cache) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == cache) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    pthread_once(
+        &verified_signature_cache_once,
+        _blockchain_init_verified_signature_cache);
+    return_code = verified_signature_cache_init_return_code;
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    *cache = verified_signature_cache;
+end:
+    return return_code;
+}
+
+/**
+ * @brief Contains the state shared by all workers verifying signatures.
+ * 
+ * @param transactions The transactions whose signatures to verify, in chain
+ * order.
+ * @param block_indices The index of each transaction's block among the blocks
+ * being verified.
+ * @param num_transactions The number of transactions.
+ * @param next_transaction_idx The index of the next transaction that a worker
+ * may claim. Workers claim transactions in chain order.
+ * @param first_invalid_block_idx The smallest index of a block with an invalid
+ * signature found so far, or UINT64_MAX if none.
+ * @param return_code SUCCESS unless a worker failed to verify a signature.
+ * @param cache The hashes of transactions whose signatures are known valid.
+ */
+typedef struct signature_verification_t {
+    transaction_t **transactions;
+    uint64_t *block_indices;
+    uint64_t num_transactions;
+    atomic_uint_fast64_t next_transaction_idx;
+    atomic_uint_fast64_t first_invalid_block_idx;
+    atomic_int return_code;
+    lru_cache_t *cache;
+} signature_verification_t;
+
+return_code_t _blockchain_verify_signature_batch(
+    bool *are_valid_signatures,
+    transaction_t **transactions,
+    size_t num_transactions,
+    lru_cache_t *cache
+) {
+    return_code_t return_code = SUCCESS;
+    // The transaction hash covers the signed fields and the signature, so a
+    // cached hash proves that this exact signature was already verified.
+    sha_256_t transaction_hashes[SIGNATURE_VERIFICATION_BATCH_SIZE];
+    transaction_t *unverified_transactions[SIGNATURE_VERIFICATION_BATCH_SIZE];
+    size_t unverified_indices[SIGNATURE_VERIFICATION_BATCH_SIZE];
+    bool are_valid_unverified_signatures[SIGNATURE_VERIFICATION_BATCH_SIZE];
+    size_t num_unverified_transactions = 0;
+    for (size_t idx = 0; idx < num_transactions; idx++) {
+        return_code = transaction_hash(
+            transactions[idx], &transaction_hashes[idx]);
         if (SUCCESS != return_code) {
             goto end;
         }
-        if (block_transaction_list_is_empty) {
-            *is_valid_blockchain = false;
+        bool is_found = false;
+        return_code = lru_cache_get(
+            cache, &transaction_hashes[idx], NULL, &is_found);
+        if (SUCCESS != return_code) {
             goto end;
         }
-        node_t *minting_transaction_node =
-            current_block->transaction_list->head;
-        transaction_t *minting_transaction =
-            (transaction_t *)minting_transaction_node->data;
-        if (AMOUNT_GENERATED_DURING_MINTING != minting_transaction->amount ||
-            0 != memcmp(
-                &minting_transaction->sender_public_key,
-                &minting_transaction->recipient_public_key,
-                sizeof(ssh_key_t))) {
-            *is_valid_blockchain = false;
-            if (NULL != first_invalid_block) {
-                *first_invalid_block = current_block;
-            }
+        are_valid_signatures[idx] = is_found;
+        if (!is_found) {
+            unverified_transactions[num_unverified_transactions] =
+                transactions[idx];
+            unverified_indices[num_unverified_transactions] = idx;
+            num_unverified_transactions++;
+        }
+    }
+    return_code = transaction_verify_signatures(
+        are_valid_unverified_signatures,
+        unverified_transactions,
+        num_unverified_transactions);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    for (size_t idx = 0; idx < num_unverified_transactions; idx++) {
+        if (!are_valid_unverified_signatures[idx]) {
+            continue;
+        }
+        size_t transaction_idx = unverified_indices[idx];
+        are_valid_signatures[transaction_idx] = true;
+        return_code = lru_cache_put(
+            cache, &transaction_hashes[transaction_idx], NULL);
+        if (SUCCESS != return_code) {
             goto end;
         }
-        // Check that every transaction has a valid signature.
-        for (node_t *transaction_node = minting_transaction_node;
-            NULL != transaction_node;
-            transaction_node = transaction_node->next) {
-            transaction_t *transaction =
-                (transaction_t *)transaction_node->data;
-            bool is_valid_signature = false;
-            return_code = transaction_verify_signature(
-                &is_valid_signature, transaction);
-            if (SUCCESS != return_code) {
-                goto end;
+    }
+end:
+    return return_code;
+}
+
+void *_signature_verification_worker(void *args) {
+    signature_verification_t *verification = (signature_verification_t *)args;
+    while (true) {
+        uint64_t first_transaction_idx = atomic_fetch_add(
+            &verification->next_transaction_idx,
+            SIGNATURE_VERIFICATION_BATCH_SIZE);
+        if (first_transaction_idx >= verification->num_transactions) {
+            break;
+        }
+        if (SUCCESS != atomic_load(&verification->return_code)) {
+            break;
+        }
+        // Once an earlier block has an invalid signature, later signatures
+        // cannot change which block is the first invalid one.
+        uint_fast64_t first_invalid_block_idx = atomic_load(
+            &verification->first_invalid_block_idx);
+        size_t num_transactions = 0;
+        while (num_transactions < SIGNATURE_VERIFICATION_BATCH_SIZE &&
+            first_transaction_idx + num_transactions <
+                verification->num_transactions &&
+            verification->block_indices[
+                first_transaction_idx + num_transactions] <
+                first_invalid_block_idx) {
+            num_transactions++;
+        }
+        if (0 == num_transactions) {
+            break;
+        }
+        bool are_valid_signatures[SIGNATURE_VERIFICATION_BATCH_SIZE];
+        return_code_t return_code = _blockchain_verify_signature_batch(
+            are_valid_signatures,
+            &verification->transactions[first_transaction_idx],
+            num_transactions,
+            verification->cache);
+        if (SUCCESS != return_code) {
+            int expected = SUCCESS;
+            atomic_compare_exchange_strong(
+                &verification->return_code, &expected, return_code);
+            break;
+        }
+        for (size_t idx = 0; idx < num_transactions; idx++) {
+            if (are_valid_signatures[idx]) {
+                continue;
             }
-            if (!is_valid_signature) {
-                *is_valid_blockchain = false;
-                if (NULL != first_invalid_block) {
-                    *first_invalid_block = current_block;
-                }
-                goto end;
+            uint64_t block_idx =
+                verification->block_indices[first_transaction_idx + idx];
+            uint_fast64_t first = atomic_load(
+                &verification->first_invalid_block_idx);
+            while (block_idx < first &&
+                !atomic_compare_exchange_weak(
+                    &verification->first_invalid_block_idx,
+                    &first,
+                    block_idx)) {
             }
+            break;
         }
-        memcpy(&previous_block_hash, &current_block_hash, sizeof(sha_256_t));
     }
-    *is_valid_blockchain = true;
+    return NULL;
+}
+
+return_code_t _blockchain_verify_signatures(
+    signature_verification_t *verification
+) {
+    return_code_t return_code = SUCCESS;
+    size_t num_threads = _get_num_worker_threads(0);
+    uint64_t max_useful_threads =
+        (verification->num_transactions +
+        SIGNATURE_VERIFICATION_BATCH_SIZE - 1) /
+        SIGNATURE_VERIFICATION_BATCH_SIZE;
+    if (num_threads > max_useful_threads) {
+        num_threads = max_useful_threads > 0 ? max_useful_threads : 1;
+    }
+    pthread_t *threads = calloc(num_threads, sizeof(pthread_t));
+    if (NULL == threads) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    // The calling thread verifies signatures too. If a thread fails to start,
+    // the others claim its share of the work.
+    size_t num_threads_started = 1;
+    for (size_t idx = 1; idx < num_threads; idx++) {
+        if (0 != pthread_create(
+                &threads[idx],
+                NULL,
+                _signature_verification_worker,
+                verification)) {
+            break;
+        }
+        num_threads_started++;
+    }
+    _signature_verification_worker(verification);
+    for (size_t idx = 1; idx < num_threads_started; idx++) {
+        pthread_join(threads[idx], NULL);
+    }
+    free(threads);
+    return_code = atomic_load(&verification->return_code);
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_is_valid_minting_transaction(
+    transaction_t *minting_transaction,
+    bool *is_valid_minting_transaction
+) {
+    return_code_t return_code = SUCCESS;
+    bool is_minted_to_sender = false;
+    if (NULL != minting_transaction->sender_public_key &&
+        NULL != minting_transaction->recipient_public_key) {
+        return_code = public_key_equals(
+            minting_transaction->sender_public_key,
+            minting_transaction->recipient_public_key,
+            &is_minted_to_sender);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+    }
+    *is_valid_minting_transaction =
+        AMOUNT_GENERATED_DURING_MINTING == minting_transaction->amount &&
+        is_minted_to_sender;
+end:
+    return return_code;
+}
+
+bool _blockchain_is_valid_genesis_block(
+    sha_256_t *previous_block_hash,
+    uint64_t proof_of_work,
+    uint64_t num_transactions
+) {
+    sha_256_t empty_block_hash = {0};
+    return 0 == num_transactions &&
+        GENESIS_BLOCK_PROOF_OF_WORK == proof_of_work &&
+        0 == memcmp(previous_block_hash, &empty_block_hash, sizeof(sha_256_t));
+}
+
+return_code_t _blockchain_is_valid_block(
+    blockchain_target_t *target,
+    sha_256_t *expected_previous_block_hash,
+    sha_256_t *previous_block_hash,
+    sha_256_t *block_hash,
+    transaction_t *minting_transaction,
+    bool *is_valid_block
+) {
+    return_code_t return_code = SUCCESS;
+    *is_valid_block = false;
+    if (!_blockchain_hash_meets_target(target, block_hash)) {
+        goto end;
+    }
+    if (0 != memcmp(
+        previous_block_hash,
+        expected_previous_block_hash,
+        sizeof(sha_256_t))) {
+        goto end;
+    }
+    // Every block must contain at least the minting transaction.
+    if (NULL == minting_transaction) {
+        goto end;
+    }
+    return_code = _blockchain_is_valid_minting_transaction(
+        minting_transaction, is_valid_block);
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_verify_blocks(
+    blockchain_t *blockchain,
+    node_t *first_node,
+    uint64_t num_previous_blocks,
+    sha_256_t previous_block_hash,
+    bool *is_valid_blockchain,
+    block_t **first_invalid_block
+) {
+    return_code_t return_code = SUCCESS;
+    sha_256_t last_previous_block_hash = previous_block_hash;
+    uint64_t num_blocks = 0;
+    uint64_t num_transactions = 0;
+    for (node_t *current_node = first_node;
+        NULL != current_node;
+        current_node = current_node->next) {
+        block_t *current_block = (block_t *)current_node->data;
+        uint64_t num_transactions_in_block = 0;
+        return_code = linked_list_length(
+            current_block->transaction_list, &num_transactions_in_block);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        num_blocks++;
+        num_transactions += num_transactions_in_block;
+    }
+    // Allocate at least one element so that an empty range is not an error.
+    block_t **blocks = calloc(num_blocks + 1, sizeof(block_t *));
+    sha_256_t *block_hashes = calloc(num_blocks + 1, sizeof(sha_256_t));
+    signature_verification_t verification = {0};
+    verification.transactions = calloc(
+        num_transactions + 1, sizeof(transaction_t *));
+    verification.block_indices = calloc(num_transactions + 1, sizeof(uint64_t));
+    atomic_init(&verification.next_transaction_idx, 0);
+    atomic_init(&verification.first_invalid_block_idx, UINT64_MAX);
+    atomic_init(&verification.return_code, SUCCESS);
+    if (NULL == blocks ||
+        NULL == block_hashes ||
+        NULL == verification.transactions ||
+        NULL == verification.block_indices) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto cleanup;
+    }
+    return_code = blockchain_get_verified_signature_cache(&verification.cache);
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    // Run the cheap structural checks sequentially and queue the expensive
+    // signature checks for the blocks that pass them.
+    uint64_t structurally_invalid_block_idx = UINT64_MAX;
+    uint64_t block_idx = 0;
+    for (node_t *current_node = first_node;
+        NULL != current_node;
+        current_node = current_node->next, block_idx++) {
+        block_t *current_block = (block_t *)current_node->data;
+        blocks[block_idx] = current_block;
+        sha_256_t current_block_hash = {0};
+        return_code = block_hash(current_block, &current_block_hash);
+        if (SUCCESS != return_code) {
+            goto cleanup;
+        }
+        node_t *minting_transaction_node =
+            current_block->transaction_list->head;
+        bool is_valid_block = false;
+        return_code = _blockchain_is_valid_block(
+            &blockchain->target,
+            &previous_block_hash,
+            &current_block->previous_block_hash,
+            &current_block_hash,
+            NULL == minting_transaction_node ?
+                NULL : (transaction_t *)minting_transaction_node->data,
+            &is_valid_block);
+        if (SUCCESS != return_code) {
+            goto cleanup;
+        }
+        if (!is_valid_block) {
+            structurally_invalid_block_idx = block_idx;
+            break;
+        }
+        // Every transaction must have a valid signature.
+        for (node_t *transaction_node = minting_transaction_node;
+            NULL != transaction_node;
+            transaction_node = transaction_node->next) {
+            uint64_t transaction_idx = verification.num_transactions;
+            verification.transactions[transaction_idx] =
+                (transaction_t *)transaction_node->data;
+            verification.block_indices[transaction_idx] = block_idx;
+            verification.num_transactions++;
+        }
+        block_hashes[block_idx] = current_block_hash;
+        memcpy(&previous_block_hash, &current_block_hash, sizeof(sha_256_t));
+    }
+    return_code = _blockchain_verify_signatures(&verification);
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    // Queued signatures all belong to blocks before any structurally invalid
+    // block, so the first invalid block is the earlier of the two.
+    uint64_t first_invalid_block_idx = atomic_load(
+        &verification.first_invalid_block_idx);
+    if (structurally_invalid_block_idx < first_invalid_block_idx) {
+        first_invalid_block_idx = structurally_invalid_block_idx;
+    }
+    uint64_t num_valid_blocks = num_blocks;
+    if (UINT64_MAX == first_invalid_block_idx) {
+        *is_valid_blockchain = true;
+    } else {
+        *is_valid_blockchain = false;
+        if (NULL != first_invalid_block) {
+            *first_invalid_block = blocks[first_invalid_block_idx];
+        }
+        num_valid_blocks = first_invalid_block_idx;
+    }
+    // Advance the watermark past the blocks that were found valid, even if a
+    // later block is invalid.
+    if (num_valid_blocks > 0) {
+        blockchain->num_verified_blocks =
+            num_previous_blocks + num_valid_blocks;
+        blockchain->last_verified_block_hash =
+            block_hashes[num_valid_blocks - 1];
+    } else if (num_previous_blocks > 0) {
+        blockchain->num_verified_blocks = num_previous_blocks;
+        blockchain->last_verified_block_hash = last_previous_block_hash;
+    }
+cleanup:
+    free(blocks);
+    free(block_hashes);
+    free(verification.transactions);
+    free(verification.block_indices);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_verify(
+    blockchain_t *blockchain,
+    bool *is_valid_blockchain,
+    block_t **first_invalid_block
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || NULL == is_valid_blockchain) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    blockchain->num_verified_blocks = 0;
+    if (NULL == blockchain->block_list->head) {
+        *is_valid_blockchain = true;
+        goto end;
+    }
+    // Check the genesis block, which is unique.
+    block_t *genesis_block = (block_t *)blockchain->block_list->head->data;
+    uint64_t num_genesis_block_transactions = 0;
+    return_code = linked_list_length(
+        genesis_block->transaction_list, &num_genesis_block_transactions);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    if (!_blockchain_is_valid_genesis_block(
+            &genesis_block->previous_block_hash,
+            genesis_block->proof_of_work,
+            num_genesis_block_transactions)) {
+        *is_valid_blockchain = false;
+        if (NULL != first_invalid_block) {
+            *first_invalid_block = genesis_block;
+        }
+        goto end;
+    }
+    sha_256_t previous_block_hash = {0};
+    block_hash(genesis_block, &previous_block_hash);
+    // Check the remaining blocks.
+    return_code = _blockchain_verify_blocks(
+        blockchain,
+        blockchain->block_list->head->next,
+        1,
+        previous_block_hash,
+        is_valid_blockchain,
+        first_invalid_block);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_verify_incremental(
+    blockchain_t *blockchain,
+    bool *is_valid_blockchain,
+    block_t **first_invalid_block
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || NULL == is_valid_blockchain) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    // Find the last verified block.
+    node_t *last_verified_node = NULL;
+    if (blockchain->num_verified_blocks > 0) {
+        last_verified_node = blockchain->block_list->head;
+        for (uint64_t idx = 1;
+            idx < blockchain->num_verified_blocks &&
+            NULL != last_verified_node;
+            idx++) {
+            last_verified_node = last_verified_node->next;
+        }
+    }
+    sha_256_t last_verified_block_hash = {0};
+    if (NULL != last_verified_node) {
+        return_code = block_hash(
+            (block_t *)last_verified_node->data, &last_verified_block_hash);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+    }
+    // Without a watermark that still matches the chain, check everything.
+    if (NULL == last_verified_node ||
+        0 != memcmp(
+            &last_verified_block_hash,
+            &blockchain->last_verified_block_hash,
+            sizeof(sha_256_t))) {
+        return_code = blockchain_verify(
+            blockchain, is_valid_blockchain, first_invalid_block);
+        goto end;
+    }
+    return_code = _blockchain_verify_blocks(
+        blockchain,
+        last_verified_node->next,
+        blockchain->num_verified_blocks,
+        last_verified_block_hash,
+        is_valid_blockchain,
+        first_invalid_block);
+end:
+    return return_code;
+}
+
+void _blockchain_serialize_key_id(
+    unsigned char *buffer,
+    public_key_t *public_key
+) {
+    if (NULL == public_key) {
+        memset(buffer, 0, sizeof(sha_256_t));
+    } else {
+        memcpy(buffer, public_key->id.digest, sizeof(sha_256_t));
+    }
+}
+
+void _blockchain_serialize_transaction(
+    transaction_t *transaction,
+    unsigned char *buffer
+) {
+    unsigned char *next_spot_in_buffer = buffer;
+    *(uint64_t *)next_spot_in_buffer = htobe64(transaction->version);
+    next_spot_in_buffer += sizeof(uint64_t);
+    *(uint64_t *)next_spot_in_buffer = htobe64(transaction->created_at);
+    next_spot_in_buffer += sizeof(uint64_t);
+    _blockchain_serialize_key_id(
+        next_spot_in_buffer, transaction->sender_public_key);
+    next_spot_in_buffer += sizeof(sha_256_t);
+    _blockchain_serialize_key_id(
+        next_spot_in_buffer, transaction->recipient_public_key);
+    next_spot_in_buffer += sizeof(sha_256_t);
+    *(uint64_t *)next_spot_in_buffer = htobe64(transaction->amount);
+    next_spot_in_buffer += sizeof(uint64_t);
+    *(uint64_t *)next_spot_in_buffer = htobe64(
+        transaction->sender_signature.length);
+    next_spot_in_buffer += sizeof(uint64_t);
+    memcpy(
+        next_spot_in_buffer,
+        transaction->sender_signature.bytes,
+        transaction->sender_signature.length);
+}
+
+uint64_t _blockchain_get_serialized_target_size(blockchain_t *blockchain) {
+    uint64_t size = sizeof(uint64_t);
+    if (NUM_LEADING_ZERO_BYTES_CUSTOM_TARGET ==
+        blockchain->num_leading_zero_bytes_required_in_block_hash) {
+        size += sizeof(blockchain->target.words);
+    }
+    return size;
+}
+
+void _blockchain_serialize_target(
+    blockchain_t *blockchain,
+    unsigned char *buffer
+) {
+    unsigned char *next_spot_in_buffer = buffer;
+    // Byte count chains keep the original format. Other targets write a
+    // sentinel byte count followed by the target.
+    if (NUM_LEADING_ZERO_BYTES_CUSTOM_TARGET ==
+        blockchain->num_leading_zero_bytes_required_in_block_hash) {
+        *(uint64_t *)next_spot_in_buffer = htobe64(UINT64_MAX);
+        next_spot_in_buffer += sizeof(uint64_t);
+        for (size_t idx = 0; idx < BLOCKCHAIN_TARGET_NUM_WORDS; idx++) {
+            *(uint64_t *)next_spot_in_buffer = htobe64(
+                blockchain->target.words[idx]);
+            next_spot_in_buffer += sizeof(uint64_t);
+        }
+    } else {
+        *(uint64_t *)next_spot_in_buffer = htobe64(
+            blockchain->num_leading_zero_bytes_required_in_block_hash);
+    }
+}
+
+uint64_t _blockchain_get_serialized_keys_size(
+    key_table_t *key_table,
+    size_t first_key_idx,
+    size_t end_key_idx
+) {
+    uint64_t size = sizeof(uint64_t);
+    for (size_t idx = first_key_idx; idx < end_key_idx; idx++) {
+        size += sizeof(uint64_t) + key_table->keys[idx]->length;
+    }
+    return size;
+}
+
+void _blockchain_serialize_keys(
+    key_table_t *key_table,
+    size_t first_key_idx,
+    size_t end_key_idx,
+    unsigned char *buffer
+) {
+    unsigned char *next_spot_in_buffer = buffer;
+    *(uint64_t *)next_spot_in_buffer = htobe64(end_key_idx - first_key_idx);
+    next_spot_in_buffer += sizeof(uint64_t);
+    for (size_t idx = first_key_idx; idx < end_key_idx; idx++) {
+        public_key_t *public_key = key_table->keys[idx];
+        *(uint64_t *)next_spot_in_buffer = htobe64(public_key->length);
+        next_spot_in_buffer += sizeof(uint64_t);
+        memcpy(next_spot_in_buffer, public_key->bytes, public_key->length);
+        next_spot_in_buffer += public_key->length;
+    }
+}
+
+return_code_t _blockchain_get_serialized_block_size(
+    block_t *block,
+    uint64_t *size
+) {
+    return_code_t return_code = SUCCESS;
+    uint64_t total_size = BLOCKCHAIN_SERIALIZED_BLOCK_HEADER_SIZE;
+    for (node_t *transaction_node = block->transaction_list->head;
+        NULL != transaction_node;
+        transaction_node = transaction_node->next) {
+        transaction_t *transaction = (transaction_t *)transaction_node->data;
+        if (transaction->sender_signature.length > MAX_SSH_SIGNATURE_LENGTH) {
+            return_code = FAILURE_SIGNATURE_TOO_LONG;
+            goto end;
+        }
+        total_size += BLOCKCHAIN_SERIALIZED_TRANSACTION_FIXED_SIZE +
+            transaction->sender_signature.length;
+    }
+    // Decoders would reject a larger block, so do not write one.
+    if (total_size > BLOCKCHAIN_MAX_RECORD_SIZE) {
+        return_code = FAILURE_INVALID_BLOCKCHAIN;
+        goto end;
+    }
+    *size = total_size;
+end:
+    return return_code;
+}
+
+void _blockchain_serialize_block_header(
+    block_t *block,
+    uint64_t num_transactions,
+    unsigned char *buffer
+) {
+    unsigned char *next_spot_in_buffer = buffer;
+    *(uint64_t *)next_spot_in_buffer = htobe64(block->created_at);
+    next_spot_in_buffer += sizeof(block->created_at);
+    memcpy(
+        next_spot_in_buffer,
+        block->previous_block_hash.digest,
+        sizeof(block->previous_block_hash));
+    next_spot_in_buffer += sizeof(block->previous_block_hash);
+    *(uint64_t *)next_spot_in_buffer = htobe64(block->extra_nonce);
+    next_spot_in_buffer += sizeof(block->extra_nonce);
+    *(uint64_t *)next_spot_in_buffer = htobe64(block->proof_of_work);
+    next_spot_in_buffer += sizeof(block->proof_of_work);
+    *(uint64_t *)next_spot_in_buffer = htobe64(num_transactions);
+}
+
+uint64_t _blockchain_serialize_block(block_t *block, unsigned char *buffer) {
+    unsigned char *next_spot_in_buffer =
+        buffer + BLOCKCHAIN_SERIALIZED_BLOCK_HEADER_SIZE;
+    uint64_t num_transactions = 0;
+    for (node_t *transaction_node = block->transaction_list->head;
+        NULL != transaction_node;
+        transaction_node = transaction_node->next) {
+        transaction_t *transaction = (transaction_t *)transaction_node->data;
+        _blockchain_serialize_transaction(transaction, next_spot_in_buffer);
+        next_spot_in_buffer += BLOCKCHAIN_SERIALIZED_TRANSACTION_FIXED_SIZE +
+            transaction->sender_signature.length;
+        num_transactions++;
+    }
+    // The transaction count is only known after walking the list, so write
+    // the header last.
+    _blockchain_serialize_block_header(block, num_transactions, buffer);
+    return next_spot_in_buffer - buffer;
+}
+
+return_code_t _blockchain_get_serialized_size(
+    blockchain_t *blockchain,
+    uint64_t *size
+) {
+    return_code_t return_code = SUCCESS;
+    // The magic number, the target, and the block count.
+    uint64_t total_size =
+        2 * sizeof(uint64_t) + _blockchain_get_serialized_target_size(
+            blockchain);
+    for (node_t *block_node = blockchain->block_list->head;
+        NULL != block_node;
+        block_node = block_node->next) {
+        block_t *block = (block_t *)block_node->data;
+        uint64_t block_size = 0;
+        return_code = _blockchain_get_serialized_block_size(
+            block, &block_size);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        total_size += block_size;
+    }
+    total_size += _blockchain_get_serialized_keys_size(
+        blockchain->key_table, 0, blockchain->key_table->num_keys);
+    *size = total_size;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_serialize(
+    blockchain_t *blockchain,
+    unsigned char **buffer,
+    uint64_t *buffer_size
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || NULL == buffer || NULL == buffer_size) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    // Compute the exact size first so that the buffer is allocated once and
+    // every field is written in place.
+    uint64_t size = 0;
+    return_code = _blockchain_get_serialized_size(blockchain, &size);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    unsigned char *serialization_buffer = malloc(size);
+    if (NULL == serialization_buffer) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    unsigned char *next_spot_in_buffer = serialization_buffer;
+    *(uint64_t *)next_spot_in_buffer = htobe64(BLOCKCHAIN_SERIALIZATION_MAGIC);
+    next_spot_in_buffer += sizeof(uint64_t);
+    _blockchain_serialize_target(blockchain, next_spot_in_buffer);
+    next_spot_in_buffer += _blockchain_get_serialized_target_size(blockchain);
+    key_table_t *key_table = blockchain->key_table;
+    _blockchain_serialize_keys(
+        key_table, 0, key_table->num_keys, next_spot_in_buffer);
+    next_spot_in_buffer += _blockchain_get_serialized_keys_size(
+        key_table, 0, key_table->num_keys);
+    unsigned char *num_blocks_spot_in_buffer = next_spot_in_buffer;
+    next_spot_in_buffer += sizeof(uint64_t);
+    uint64_t num_blocks = 0;
+    for (node_t *block_node = blockchain->block_list->head;
+        NULL != block_node;
+        block_node = block_node->next) {
+        next_spot_in_buffer += _blockchain_serialize_block(
+            (block_t *)block_node->data, next_spot_in_buffer);
+        num_blocks++;
+    }
+    *(uint64_t *)num_blocks_spot_in_buffer = htobe64(num_blocks);
+    *buffer = serialization_buffer;
+    *buffer_size = size;
+end:
+    return return_code;
+}
+
+/**
+ * @brief A staging buffer through which items are written to a sink.
+ * 
+ * @param buffer The staged bytes.
+ * @param size The number of staged bytes.
+ * @param sink_function The function to which to write full buffers.
+ * @param sink_args The arguments to pass to sink_function.
+ */
+typedef struct serialization_stage_t {
+    unsigned char *buffer;
+    size_t size;
+    blockchain_sink_function_t *sink_function;
+    void *sink_args;
+} serialization_stage_t;
+
+return_code_t _serialization_stage_flush(serialization_stage_t *stage) {
+    return_code_t return_code = SUCCESS;
+    if (0 == stage->size) {
+        goto end;
+    }
+    return_code = stage->sink_function(
+        stage->buffer, stage->size, stage->sink_args);
+    stage->size = 0;
+end:
+    return return_code;
+}
+
+return_code_t _serialization_stage_reserve(
+    serialization_stage_t *stage,
+    size_t num_bytes,
+    unsigned char **spot_in_buffer
+) {
+    return_code_t return_code = SUCCESS;
+    if (stage->size + num_bytes > BLOCKCHAIN_SERIALIZATION_STAGING_SIZE) {
+        return_code = _serialization_stage_flush(stage);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+    }
+    *spot_in_buffer = stage->buffer + stage->size;
+    stage->size += num_bytes;
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_serialize_blocks_to_stage(
+    blockchain_t *blockchain,
+    serialization_stage_t *stage
+) {
+    return_code_t return_code = SUCCESS;
+    unsigned char *spot_in_buffer = NULL;
+    return_code = _serialization_stage_reserve(
+        stage, sizeof(uint64_t), &spot_in_buffer);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    *(uint64_t *)spot_in_buffer = htobe64(BLOCKCHAIN_SERIALIZATION_MAGIC);
+    return_code = _serialization_stage_reserve(
+        stage,
+        _blockchain_get_serialized_target_size(blockchain),
+        &spot_in_buffer);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    _blockchain_serialize_target(blockchain, spot_in_buffer);
+    key_table_t *key_table = blockchain->key_table;
+    return_code = _serialization_stage_reserve(
+        stage, sizeof(uint64_t), &spot_in_buffer);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    *(uint64_t *)spot_in_buffer = htobe64(key_table->num_keys);
+    for (size_t idx = 0; idx < key_table->num_keys; idx++) {
+        public_key_t *public_key = key_table->keys[idx];
+        return_code = _serialization_stage_reserve(
+            stage, sizeof(uint64_t) + public_key->length, &spot_in_buffer);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        *(uint64_t *)spot_in_buffer = htobe64(public_key->length);
+        memcpy(
+            spot_in_buffer + sizeof(uint64_t),
+            public_key->bytes,
+            public_key->length);
+    }
+    uint64_t num_blocks = 0;
+    return_code = linked_list_length(blockchain->block_list, &num_blocks);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    return_code = _serialization_stage_reserve(
+        stage, sizeof(uint64_t), &spot_in_buffer);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    *(uint64_t *)spot_in_buffer = htobe64(num_blocks);
+    for (node_t *block_node = blockchain->block_list->head;
+        NULL != block_node;
+        block_node = block_node->next) {
+        block_t *block = (block_t *)block_node->data;
+        uint64_t num_transactions = 0;
+        return_code = linked_list_length(
+            block->transaction_list, &num_transactions);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        return_code = _serialization_stage_reserve(
+            stage, BLOCKCHAIN_SERIALIZED_BLOCK_HEADER_SIZE, &spot_in_buffer);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        _blockchain_serialize_block_header(
+            block, num_transactions, spot_in_buffer);
+        for (node_t *transaction_node = block->transaction_list->head;
+            NULL != transaction_node;
+            transaction_node = transaction_node->next) {
+            transaction_t *transaction = (transaction_t *)
+                transaction_node->data;
+            return_code = _serialization_stage_reserve(
+                stage,
+                BLOCKCHAIN_SERIALIZED_TRANSACTION_FIXED_SIZE +
+                    transaction->sender_signature.length,
+                &spot_in_buffer);
+            if (SUCCESS != return_code) {
+                goto end;
+            }
+            _blockchain_serialize_transaction(transaction, spot_in_buffer);
+        }
+    }
+    return_code = _serialization_stage_flush(stage);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_serialize_to_sink(
+    blockchain_t *blockchain,
+    blockchain_sink_function_t *sink_function,
+    void *sink_args
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || NULL == sink_function) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    // Check every block before writing anything, so that an invalid chain
+    // writes nothing.
+    for (node_t *block_node = blockchain->block_list->head;
+        NULL != block_node;
+        block_node = block_node->next) {
+        block_t *block = (block_t *)block_node->data;
+        uint64_t block_size = 0;
+        return_code = _blockchain_get_serialized_block_size(
+            block, &block_size);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+    }
+    serialization_stage_t stage = {0};
+    stage.buffer = malloc(BLOCKCHAIN_SERIALIZATION_STAGING_SIZE);
+    if (NULL == stage.buffer) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    stage.sink_function = sink_function;
+    stage.sink_args = sink_args;
+    return_code = _blockchain_serialize_blocks_to_stage(blockchain, &stage);
+    free(stage.buffer);
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_write_to_fd(
+    unsigned char *bytes,
+    size_t num_bytes,
+    void *args
+) {
+    return_code_t return_code = SUCCESS;
+    int fd = *(int *)args;
+    size_t num_bytes_written = 0;
+    // Pipes and sockets may take fewer bytes than asked.
+    while (num_bytes_written < num_bytes) {
+        ssize_t result = write(
+            fd, bytes + num_bytes_written, num_bytes - num_bytes_written);
+        if (result < 0 && EINTR == errno) {
+            continue;
+        }
+        if (result < 0) {
+            return_code = FAILURE_FILE_IO;
+            goto end;
+        }
+        num_bytes_written += result;
+    }
+end:
+    return return_code;
+}
+
+return_code_t blockchain_serialize_to_fd(blockchain_t *blockchain, int fd) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || fd < 0) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    return_code = blockchain_serialize_to_sink(
+        blockchain, _blockchain_write_to_fd, &fd);
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_deserialize_unversioned_transaction(
+    transaction_t **transaction,
+    unsigned char *buffer,
+    size_t buffer_size
+) {
+    return_code_t return_code = SUCCESS;
+    if (buffer_size < BLOCKCHAIN_UNVERSIONED_TRANSACTION_SIZE) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    transaction_t *new_transaction = calloc(1, sizeof(transaction_t));
+    if (NULL == new_transaction) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    new_transaction->version = TRANSACTION_VERSION_RSA;
+    unsigned char *next_spot_in_buffer = buffer;
+    new_transaction->created_at = betoh64(*(uint64_t *)next_spot_in_buffer);
+    next_spot_in_buffer += sizeof(uint64_t);
+    unsigned char *sender_public_key = next_spot_in_buffer;
+    next_spot_in_buffer += MAX_SSH_KEY_LENGTH;
+    unsigned char *recipient_public_key = next_spot_in_buffer;
+    next_spot_in_buffer += MAX_SSH_KEY_LENGTH;
+    new_transaction->amount = betoh64(*(uint64_t *)next_spot_in_buffer);
+    next_spot_in_buffer += sizeof(uint64_t);
+    uint64_t signature_length = betoh64(*(uint64_t *)next_spot_in_buffer);
+    next_spot_in_buffer += sizeof(uint64_t);
+    if (signature_length > MAX_SSH_SIGNATURE_LENGTH) {
+        return_code = FAILURE_SIGNATURE_TOO_LONG;
+        goto cleanup;
+    }
+    new_transaction->sender_signature.length = signature_length;
+    memcpy(
+        new_transaction->sender_signature.bytes,
+        next_spot_in_buffer,
+        MAX_SSH_SIGNATURE_LENGTH);
+    return_code = transaction_public_key_create(
+        &new_transaction->sender_public_key,
+        (ssh_key_t *)sender_public_key,
+        TRANSACTION_VERSION_RSA);
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    return_code = transaction_public_key_create(
+        &new_transaction->recipient_public_key,
+        (ssh_key_t *)recipient_public_key,
+        TRANSACTION_VERSION_RSA);
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    *transaction = new_transaction;
+    goto end;
+cleanup:
+    transaction_destroy(new_transaction);
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_deserialize_unversioned_block(
+    block_t **block,
+    unsigned char *buffer,
+    size_t buffer_size,
+    size_t *num_bytes_read
+) {
+    return_code_t return_code = SUCCESS;
+    if (buffer_size < BLOCKCHAIN_UNVERSIONED_BLOCK_HEADER_SIZE) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    unsigned char *next_spot_in_buffer = buffer;
+    time_t created_at = betoh64(*(uint64_t *)next_spot_in_buffer);
+    next_spot_in_buffer += sizeof(uint64_t);
+    sha_256_t previous_block_hash = {0};
+    memcpy(
+        previous_block_hash.digest,
+        next_spot_in_buffer,
+        sizeof(previous_block_hash));
+    next_spot_in_buffer += sizeof(previous_block_hash);
+    uint64_t proof_of_work = betoh64(*(uint64_t *)next_spot_in_buffer);
+    next_spot_in_buffer += sizeof(uint64_t);
+    uint64_t num_transactions = betoh64(*(uint64_t *)next_spot_in_buffer);
+    next_spot_in_buffer += sizeof(uint64_t);
+    // Check the count against the buffer before allocating anything for it.
+    if ((size_t)(buffer + buffer_size - next_spot_in_buffer) /
+        BLOCKCHAIN_UNVERSIONED_TRANSACTION_SIZE < num_transactions) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    linked_list_t *transaction_list = NULL;
+    return_code = linked_list_create(
+        &transaction_list, (free_function_t *)transaction_destroy, NULL);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    for (uint64_t transaction_idx = 0;
+        transaction_idx < num_transactions;
+        transaction_idx++) {
+        transaction_t *transaction = NULL;
+        return_code = _blockchain_deserialize_unversioned_transaction(
+            &transaction,
+            next_spot_in_buffer,
+            buffer + buffer_size - next_spot_in_buffer);
+        if (SUCCESS != return_code) {
+            linked_list_destroy(transaction_list);
+            goto end;
+        }
+        next_spot_in_buffer += BLOCKCHAIN_UNVERSIONED_TRANSACTION_SIZE;
+        return_code = linked_list_append(transaction_list, transaction);
+        if (SUCCESS != return_code) {
+            linked_list_destroy(transaction_list);
+            transaction_destroy(transaction);
+            goto end;
+        }
+    }
+    block_t *new_block = NULL;
+    return_code = block_create(
+        &new_block, transaction_list, proof_of_work, previous_block_hash);
+    if (SUCCESS != return_code) {
+        linked_list_destroy(transaction_list);
+        goto end;
+    }
+    new_block->created_at = created_at;
+    *block = new_block;
+    *num_bytes_read = next_spot_in_buffer - buffer;
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_deserialize_key_table(
+    key_table_t *key_table,
+    unsigned char *buffer,
+    size_t buffer_size,
+    size_t *num_bytes_read
+) {
+    return_code_t return_code = SUCCESS;
+    unsigned char *next_spot_in_buffer = buffer;
+    unsigned char *buffer_end = buffer + buffer_size;
+    if (buffer_size < sizeof(uint64_t)) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    uint64_t num_keys = betoh64(*(uint64_t *)next_spot_in_buffer);
+    next_spot_in_buffer += sizeof(uint64_t);
+    for (uint64_t key_idx = 0; key_idx < num_keys; key_idx++) {
+        if ((size_t)(buffer_end - next_spot_in_buffer) < sizeof(uint64_t)) {
+            return_code = FAILURE_BUFFER_TOO_SMALL;
+            goto end;
+        }
+        uint64_t length = betoh64(*(uint64_t *)next_spot_in_buffer);
+        next_spot_in_buffer += sizeof(uint64_t);
+        if (length > MAX_SSH_KEY_LENGTH) {
+            return_code = FAILURE_INVALID_INPUT;
+            goto end;
+        }
+        if ((size_t)(buffer_end - next_spot_in_buffer) < length) {
+            return_code = FAILURE_BUFFER_TOO_SMALL;
+            goto end;
+        }
+        // Only Ed25519 keys, which have a fixed length, may end in a zero
+        // byte. Any other such key is an RSA key with part of its padding,
+        // which would give a second encoding of the same transactions.
+        if (ED25519_KEY_LENGTH != length &&
+            0 != length &&
+            0 == next_spot_in_buffer[length - 1]) {
+            return_code = FAILURE_INVALID_BLOCKCHAIN;
+            goto end;
+        }
+        public_key_t *public_key = NULL;
+        return_code = public_key_create(
+            &public_key, next_spot_in_buffer, length);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        next_spot_in_buffer += length;
+        public_key_t *interned_key = NULL;
+        return_code = key_table_intern(key_table, public_key, &interned_key);
+        public_key_release(public_key);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        public_key_release(interned_key);
+    }
+    *num_bytes_read = next_spot_in_buffer - buffer;
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_deserialize_key_id(
+    public_key_t **public_key,
+    unsigned char *buffer,
+    key_table_t *key_table
+) {
+    return_code_t return_code = SUCCESS;
+    sha_256_t id = {0};
+    memcpy(id.digest, buffer, sizeof(id.digest));
+    sha_256_t missing_key_id = {0};
+    if (0 == memcmp(&id, &missing_key_id, sizeof(id))) {
+        *public_key = NULL;
+        goto end;
+    }
+    bool is_found = false;
+    return_code = key_table_find(key_table, &id, public_key, &is_found);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    if (!is_found) {
+        return_code = FAILURE_INVALID_BLOCKCHAIN;
+        goto end;
+    }
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_deserialize_transaction_fields(
+    transaction_t *transaction,
+    unsigned char *buffer,
+    size_t buffer_size,
+    key_table_t *key_table,
+    size_t *num_bytes_read
+) {
+    return_code_t return_code = SUCCESS;
+    if (buffer_size < BLOCKCHAIN_SERIALIZED_TRANSACTION_FIXED_SIZE) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    unsigned char *next_spot_in_buffer = buffer;
+    transaction->version = betoh64(*(uint64_t *)next_spot_in_buffer);
+    next_spot_in_buffer += sizeof(uint64_t);
+    transaction->created_at = betoh64(*(uint64_t *)next_spot_in_buffer);
+    next_spot_in_buffer += sizeof(uint64_t);
+    return_code = _blockchain_deserialize_key_id(
+        &transaction->sender_public_key, next_spot_in_buffer, key_table);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    next_spot_in_buffer += sizeof(sha_256_t);
+    return_code = _blockchain_deserialize_key_id(
+        &transaction->recipient_public_key, next_spot_in_buffer, key_table);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    next_spot_in_buffer += sizeof(sha_256_t);
+    transaction->amount = betoh64(*(uint64_t *)next_spot_in_buffer);
+    next_spot_in_buffer += sizeof(uint64_t);
+    uint64_t signature_length = betoh64(*(uint64_t *)next_spot_in_buffer);
+    next_spot_in_buffer += sizeof(uint64_t);
+    if (signature_length > MAX_SSH_SIGNATURE_LENGTH) {
+        return_code = FAILURE_SIGNATURE_TOO_LONG;
+        goto end;
+    }
+    if (buffer_size - BLOCKCHAIN_SERIALIZED_TRANSACTION_FIXED_SIZE <
+        signature_length) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    bool has_canonical_keys = false;
+    return_code = transaction_has_canonical_keys(
+        transaction, &has_canonical_keys);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    if (!has_canonical_keys) {
+        return_code = FAILURE_INVALID_BLOCKCHAIN;
+        goto end;
+    }
+    transaction->sender_signature.length = signature_length;
+    memcpy(
+        transaction->sender_signature.bytes,
+        next_spot_in_buffer,
+        signature_length);
+    *num_bytes_read =
+        BLOCKCHAIN_SERIALIZED_TRANSACTION_FIXED_SIZE + signature_length;
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_deserialize_transaction(
+    transaction_t **transaction,
+    unsigned char *buffer,
+    size_t buffer_size,
+    key_table_t *key_table,
+    size_t *num_bytes_read
+) {
+    return_code_t return_code = SUCCESS;
+    transaction_t *new_transaction = calloc(1, sizeof(transaction_t));
+    if (NULL == new_transaction) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    return_code = _blockchain_deserialize_transaction_fields(
+        new_transaction, buffer, buffer_size, key_table, num_bytes_read);
+    if (SUCCESS != return_code) {
+        free(new_transaction);
+        goto end;
+    }
+    // The fields borrow the key table's keys, but the transaction holds its
+    // own references.
+    if (NULL != new_transaction->sender_public_key) {
+        public_key_retain(new_transaction->sender_public_key);
+    }
+    if (NULL != new_transaction->recipient_public_key) {
+        public_key_retain(new_transaction->recipient_public_key);
+    }
+    *transaction = new_transaction;
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_deserialize_target(
+    blockchain_target_t *target,
+    unsigned char *buffer,
+    size_t buffer_size,
+    size_t *num_bytes_read
+) {
+    return_code_t return_code = SUCCESS;
+    unsigned char *next_spot_in_buffer = buffer;
+    if (buffer_size < sizeof(uint64_t)) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    uint64_t num_leading_zero_bytes_required_in_block_hash = betoh64(
+        *(uint64_t *)next_spot_in_buffer);
+    next_spot_in_buffer += sizeof(
+        num_leading_zero_bytes_required_in_block_hash);
+    if (UINT64_MAX == num_leading_zero_bytes_required_in_block_hash) {
+        if (buffer_size < sizeof(uint64_t) + sizeof(target->words)) {
+            return_code = FAILURE_BUFFER_TOO_SMALL;
+            goto end;
+        }
+        for (size_t idx = 0; idx < BLOCKCHAIN_TARGET_NUM_WORDS; idx++) {
+            target->words[idx] = betoh64(*(uint64_t *)next_spot_in_buffer);
+            next_spot_in_buffer += sizeof(uint64_t);
+        }
+    } else {
+        return_code = blockchain_target_from_num_leading_zero_bytes(
+            num_leading_zero_bytes_required_in_block_hash, target);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+    }
+    *num_bytes_read = next_spot_in_buffer - buffer;
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_deserialize_block_header(
+    block_view_t *block,
+    unsigned char *buffer,
+    size_t buffer_size
+) {
+    return_code_t return_code = SUCCESS;
+    if (buffer_size < BLOCKCHAIN_SERIALIZED_BLOCK_HEADER_SIZE) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    unsigned char *next_spot_in_buffer = buffer;
+    block->created_at = betoh64(*(uint64_t *)next_spot_in_buffer);
+    next_spot_in_buffer += sizeof(uint64_t);
+    memcpy(
+        block->previous_block_hash.digest,
+        next_spot_in_buffer,
+        sizeof(block->previous_block_hash));
+    next_spot_in_buffer += sizeof(block->previous_block_hash);
+    block->extra_nonce = betoh64(*(uint64_t *)next_spot_in_buffer);
+    next_spot_in_buffer += sizeof(uint64_t);
+    block->proof_of_work = betoh64(*(uint64_t *)next_spot_in_buffer);
+    next_spot_in_buffer += sizeof(uint64_t);
+    block->num_transactions = betoh64(*(uint64_t *)next_spot_in_buffer);
+    next_spot_in_buffer += sizeof(uint64_t);
+    block->transactions = next_spot_in_buffer;
+    block->transactions_size = buffer + buffer_size - next_spot_in_buffer;
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_deserialize_block(
+    block_t **block,
+    unsigned char *buffer,
+    size_t buffer_size,
+    key_table_t *key_table,
+    size_t *num_bytes_read
+) {
+    return_code_t return_code = SUCCESS;
+    block_view_t header = {0};
+    return_code = _blockchain_deserialize_block_header(
+        &header, buffer, buffer_size);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    unsigned char *next_spot_in_buffer = header.transactions;
+    uint64_t num_transactions = header.num_transactions;
+    linked_list_t *transaction_list = NULL;
+    return_code = linked_list_create(
+        &transaction_list, (free_function_t *)transaction_destroy, NULL);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    for (uint64_t transaction_idx = 0;
+        transaction_idx < num_transactions;
+        transaction_idx++) {
+        transaction_t *transaction = NULL;
+        size_t num_transaction_bytes_read = 0;
+        size_t num_bytes_remaining =
+            buffer + buffer_size - next_spot_in_buffer;
+        return_code = _blockchain_deserialize_transaction(
+            &transaction,
+            next_spot_in_buffer,
+            num_bytes_remaining,
+            key_table,
+            &num_transaction_bytes_read);
+        if (SUCCESS != return_code) {
+            linked_list_destroy(transaction_list);
+            goto end;
+        }
+        next_spot_in_buffer += num_transaction_bytes_read;
+        return_code = linked_list_append(transaction_list, transaction);
+        if (SUCCESS != return_code) {
+            linked_list_destroy(transaction_list);
+            transaction_destroy(transaction);
+            goto end;
+        }
+    }
+    block_t *new_block = NULL;
+    return_code = block_create(
+        &new_block,
+        transaction_list,
+        header.proof_of_work,
+        header.previous_block_hash);
+    if (SUCCESS != return_code) {
+        linked_list_destroy(transaction_list);
+        goto end;
+    }
+    new_block->created_at = header.created_at;
+    new_block->extra_nonce = header.extra_nonce;
+    *block = new_block;
+    *num_bytes_read = next_spot_in_buffer - buffer;
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_deserialize_unversioned(
+    blockchain_t **blockchain,
+    unsigned char *buffer,
+    uint64_t buffer_size
+) {
+    return_code_t return_code = SUCCESS;
+    unsigned char *next_spot_in_buffer = buffer;
+    unsigned char *buffer_end = buffer + buffer_size;
+    if (buffer_size < 2 * sizeof(uint64_t)) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    uint64_t num_leading_zero_bytes_required_in_block_hash = betoh64(
+        *(uint64_t *)next_spot_in_buffer);
+    next_spot_in_buffer += sizeof(uint64_t);
+    blockchain_t *new_blockchain = NULL;
+    return_code = blockchain_create(
+        &new_blockchain, num_leading_zero_bytes_required_in_block_hash);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    uint64_t num_blocks = betoh64(*(uint64_t *)next_spot_in_buffer);
+    next_spot_in_buffer += sizeof(num_blocks);
+    for (uint64_t block_idx = 0; block_idx < num_blocks; block_idx++) {
+        block_t *block = NULL;
+        size_t num_bytes_read = 0;
+        return_code = _blockchain_deserialize_unversioned_block(
+            &block,
+            next_spot_in_buffer,
+            buffer_end - next_spot_in_buffer,
+            &num_bytes_read);
+        if (SUCCESS != return_code) {
+            goto cleanup;
+        }
+        next_spot_in_buffer += num_bytes_read;
+        return_code = blockchain_add_block(new_blockchain, block);
+        if (SUCCESS != return_code) {
+            block_destroy(block);
+            goto cleanup;
+        }
+    }
+    *blockchain = new_blockchain;
+    goto end;
+cleanup:
+    blockchain_destroy(new_blockchain);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_deserialize(
+    blockchain_t **blockchain,
+    unsigned char *buffer,
+    uint64_t buffer_size
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || NULL == buffer) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    unsigned char *next_spot_in_buffer = buffer;
+    unsigned char *buffer_end = buffer + buffer_size;
+    if (buffer_size < sizeof(uint64_t)) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    // Unversioned buffers start with a number of leading zero bytes, which is
+    // never more than the length of a hash and so never a magic number.
+    uint64_t magic = betoh64(*(uint64_t *)next_spot_in_buffer);
+    if (magic <= sizeof(sha_256_t)) {
+        return_code = _blockchain_deserialize_unversioned(
+            blockchain, buffer, buffer_size);
+        goto end;
+    }
+    if (BLOCKCHAIN_SERIALIZATION_MAGIC != magic) {
+        return_code = FAILURE_INVALID_BLOCKCHAIN;
+        goto end;
+    }
+    next_spot_in_buffer += sizeof(uint64_t);
+    blockchain_target_t target = {0};
+    size_t num_bytes_read = 0;
+    return_code = _blockchain_deserialize_target(
+        &target,
+        next_spot_in_buffer,
+        buffer_end - next_spot_in_buffer,
+        &num_bytes_read);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    next_spot_in_buffer += num_bytes_read;
+    blockchain_t *new_blockchain = NULL;
+    return_code = blockchain_create_with_target(&new_blockchain, target);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    return_code = _blockchain_deserialize_key_table(
+        new_blockchain->key_table,
+        next_spot_in_buffer,
+        buffer_end - next_spot_in_buffer,
+        &num_bytes_read);
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    next_spot_in_buffer += num_bytes_read;
+    if ((size_t)(buffer_end - next_spot_in_buffer) < sizeof(uint64_t)) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto cleanup;
+    }
+    uint64_t num_blocks = betoh64(*(uint64_t *)next_spot_in_buffer);
+    next_spot_in_buffer += sizeof(num_blocks);
+    for (uint64_t block_idx = 0; block_idx < num_blocks; block_idx++) {
+        block_t *block = NULL;
+        return_code = _blockchain_deserialize_block(
+            &block,
+            next_spot_in_buffer,
+            buffer_end - next_spot_in_buffer,
+            new_blockchain->key_table,
+            &num_bytes_read);
+        if (SUCCESS != return_code) {
+            goto cleanup;
+        }
+        next_spot_in_buffer += num_bytes_read;
+        return_code = blockchain_add_block(new_blockchain, block);
+        if (SUCCESS != return_code) {
+            block_destroy(block);
+            goto cleanup;
+        }
+    }
+    *blockchain = new_blockchain;
+    goto end;
+cleanup:
+    blockchain_destroy(new_blockchain);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_decoder_create(
+    blockchain_decoder_t **decoder,
+    blockchain_decoder_block_function_t *block_function,
+    void *block_function_args
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == decoder || NULL == block_function) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    blockchain_decoder_t *new_decoder = calloc(1, sizeof(blockchain_decoder_t));
+    if (NULL == new_decoder) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    return_code = key_table_create(&new_decoder->key_table);
+    if (SUCCESS != return_code) {
+        free(new_decoder);
+        goto end;
+    }
+    new_decoder->block_function = block_function;
+    new_decoder->block_function_args = block_function_args;
+    new_decoder->state = BLOCKCHAIN_DECODER_STATE_MAGIC;
+    *decoder = new_decoder;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_decoder_destroy(blockchain_decoder_t *decoder) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == decoder) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    key_table_destroy(decoder->key_table);
+    free(decoder->buffer);
+    free(decoder);
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_get_block_size_in_buffer(
+    unsigned char *buffer,
+    size_t buffer_size,
+    size_t *block_size,
+    size_t *num_bytes_needed
+) {
+    return_code_t return_code = SUCCESS;
+    size_t size = BLOCKCHAIN_SERIALIZED_BLOCK_HEADER_SIZE;
+    *block_size = 0;
+    if (buffer_size < size) {
+        *num_bytes_needed = size;
+        goto end;
+    }
+    uint64_t num_transactions = betoh64(
+        *(uint64_t *)(buffer + size - sizeof(uint64_t)));
+    // Reject blocks larger than BLOCKCHAIN_MAX_RECORD_SIZE before waiting for
+    // their bytes.
+    if (num_transactions > (BLOCKCHAIN_MAX_RECORD_SIZE - size) /
+        BLOCKCHAIN_SERIALIZED_TRANSACTION_FIXED_SIZE) {
+        return_code = FAILURE_INVALID_BLOCKCHAIN;
+        goto end;
+    }
+    for (uint64_t idx = 0; idx < num_transactions; idx++) {
+        size_t fixed_size_end = size +
+            BLOCKCHAIN_SERIALIZED_TRANSACTION_FIXED_SIZE;
+        if (buffer_size < fixed_size_end) {
+            *num_bytes_needed = fixed_size_end;
+            goto end;
+        }
+        uint64_t signature_length = betoh64(
+            *(uint64_t *)(buffer + fixed_size_end - sizeof(uint64_t)));
+        if (signature_length > MAX_SSH_SIGNATURE_LENGTH) {
+            return_code = FAILURE_SIGNATURE_TOO_LONG;
+            goto end;
+        }
+        size = fixed_size_end + signature_length;
+        if (size > BLOCKCHAIN_MAX_RECORD_SIZE) {
+            return_code = FAILURE_INVALID_BLOCKCHAIN;
+            goto end;
+        }
+    }
+    if (buffer_size < size) {
+        *num_bytes_needed = size;
+        goto end;
+    }
+    *block_size = size;
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_decoder_decode_block(
+    blockchain_decoder_t *decoder,
+    unsigned char *buffer,
+    size_t buffer_size
+) {
+    return_code_t return_code = SUCCESS;
+    block_t *block = NULL;
+    size_t num_bytes_read = 0;
+    return_code = _blockchain_deserialize_block(
+        &block,
+        buffer,
+        buffer_size,
+        decoder->key_table,
+        &num_bytes_read);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    if (num_bytes_read != buffer_size) {
+        block_destroy(block);
+        return_code = FAILURE_INVALID_BLOCKCHAIN;
+        goto end;
+    }
+    return_code = decoder->block_function(
+        block, decoder->block_function_args);
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_check_log_record(
+    unsigned char *buffer,
+    size_t buffer_size,
+    size_t *record_size,
+    size_t *num_bytes_needed,
+    bool *is_intact_record
+) {
+    return_code_t return_code = SUCCESS;
+    *record_size = 0;
+    if (buffer_size < BLOCKCHAIN_LOG_RECORD_OVERHEAD) {
+        *num_bytes_needed = BLOCKCHAIN_LOG_RECORD_OVERHEAD;
+        goto end;
+    }
+    uint64_t body_size = betoh64(*(uint64_t *)buffer);
+    if (body_size > BLOCKCHAIN_MAX_RECORD_SIZE) {
+        return_code = FAILURE_INVALID_BLOCKCHAIN;
+        goto end;
+    }
+    if (body_size > buffer_size - BLOCKCHAIN_LOG_RECORD_OVERHEAD) {
+        *num_bytes_needed = BLOCKCHAIN_LOG_RECORD_OVERHEAD + body_size;
+        goto end;
+    }
+    size_t checksum_offset = 2 * sizeof(uint64_t) + body_size;
+    sha_256_t checksum = {0};
+    return_code = hash_sha_256(buffer, checksum_offset, &checksum);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    *is_intact_record =
+        0 == memcmp(&checksum, buffer + checksum_offset, sizeof(checksum));
+    *record_size = BLOCKCHAIN_LOG_RECORD_OVERHEAD + body_size;
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_decoder_decode_log_record(
+    blockchain_decoder_t *decoder,
+    unsigned char *buffer,
+    size_t buffer_size,
+    size_t *num_bytes_consumed
+) {
+    return_code_t return_code = SUCCESS;
+    size_t record_size = 0;
+    bool is_intact_record = false;
+    return_code = _blockchain_check_log_record(
+        buffer,
+        buffer_size,
+        &record_size,
+        &decoder->num_bytes_needed,
+        &is_intact_record);
+    if (SUCCESS != return_code || 0 == record_size) {
+        goto end;
+    }
+    *num_bytes_consumed = record_size;
+    // An interrupted append leaves a corrupt last record, but only
+    // blockchain_decoder_finish knows whether this record is the last.
+    if (!is_intact_record) {
+        decoder->has_corrupt_record = true;
+        goto end;
+    }
+    size_t body_size = record_size - BLOCKCHAIN_LOG_RECORD_OVERHEAD;
+    uint64_t type = betoh64(*(uint64_t *)(buffer + sizeof(uint64_t)));
+    unsigned char *body = buffer + 2 * sizeof(uint64_t);
+    size_t num_bytes_read = body_size;
+    if (!decoder->has_target) {
+        if (BLOCKCHAIN_LOG_RECORD_TARGET != type) {
+            return_code = FAILURE_INVALID_BLOCKCHAIN;
+            goto end;
+        }
+        return_code = _blockchain_deserialize_target(
+            &decoder->target, body, body_size, &num_bytes_read);
+        decoder->has_target = SUCCESS == return_code;
+    } else if (BLOCKCHAIN_LOG_RECORD_KEYS == type) {
+        return_code = _blockchain_deserialize_key_table(
+            decoder->key_table, body, body_size, &num_bytes_read);
+    } else if (BLOCKCHAIN_LOG_RECORD_BLOCK == type) {
+        return_code = _blockchain_decoder_decode_block(
+            decoder, body, body_size);
+    } else {
+        return_code = FAILURE_INVALID_BLOCKCHAIN;
+    }
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    if (num_bytes_read != body_size) {
+        return_code = FAILURE_INVALID_BLOCKCHAIN;
+        goto end;
+    }
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_decoder_decode_item(
+    blockchain_decoder_t *decoder,
+    unsigned char *buffer,
+    size_t buffer_size,
+    size_t *num_bytes_consumed
+) {
+    return_code_t return_code = SUCCESS;
+    *num_bytes_consumed = 0;
+    if (decoder->has_corrupt_record ||
+        BLOCKCHAIN_DECODER_STATE_DONE == decoder->state) {
+        return_code = FAILURE_INVALID_BLOCKCHAIN;
+        goto end;
+    }
+    // Every item except a key, block, or log record starts with a u64.
+    if (buffer_size < sizeof(uint64_t)) {
+        decoder->num_bytes_needed = sizeof(uint64_t);
+        goto end;
+    }
+    uint64_t value = betoh64(*(uint64_t *)buffer);
+    switch (decoder->state) {
+        case BLOCKCHAIN_DECODER_STATE_MAGIC:
+            if (BLOCKCHAIN_SERIALIZATION_MAGIC == value) {
+                decoder->state = BLOCKCHAIN_DECODER_STATE_TARGET;
+            } else if (BLOCKCHAIN_LOG_MAGIC == value) {
+                decoder->state = BLOCKCHAIN_DECODER_STATE_LOG_RECORD;
+            } else {
+                return_code = FAILURE_INVALID_BLOCKCHAIN;
+                goto end;
+            }
+            *num_bytes_consumed = sizeof(uint64_t);
+            break;
+        case BLOCKCHAIN_DECODER_STATE_TARGET:
+            if (UINT64_MAX == value &&
+                buffer_size < sizeof(uint64_t) + sizeof(decoder->target)) {
+                decoder->num_bytes_needed =
+                    sizeof(uint64_t) + sizeof(decoder->target);
+                goto end;
+            }
+            return_code = _blockchain_deserialize_target(
+                &decoder->target, buffer, buffer_size, num_bytes_consumed);
+            if (SUCCESS != return_code) {
+                goto end;
+            }
+            decoder->has_target = true;
+            decoder->state = BLOCKCHAIN_DECODER_STATE_NUM_KEYS;
+            break;
+        case BLOCKCHAIN_DECODER_STATE_NUM_KEYS:
+        case BLOCKCHAIN_DECODER_STATE_NUM_BLOCKS:
+            decoder->num_items_remaining = value;
+            *num_bytes_consumed = sizeof(uint64_t);
+            decoder->state = BLOCKCHAIN_DECODER_STATE_NUM_KEYS ==
+                decoder->state ?
+                BLOCKCHAIN_DECODER_STATE_KEY :
+                BLOCKCHAIN_DECODER_STATE_BLOCK;
+            break;
+        case BLOCKCHAIN_DECODER_STATE_KEY: {
+            if (value > MAX_SSH_KEY_LENGTH) {
+                return_code = FAILURE_INVALID_INPUT;
+                goto end;
+            }
+            size_t key_size = sizeof(uint64_t) + value;
+            if (buffer_size < key_size) {
+                decoder->num_bytes_needed = key_size;
+                goto end;
+            }
+            public_key_t *public_key = NULL;
+            return_code = public_key_create(
+                &public_key, buffer + sizeof(uint64_t), value);
+            if (SUCCESS != return_code) {
+                goto end;
+            }
+            public_key_t *interned_key = NULL;
+            return_code = key_table_intern(
+                decoder->key_table, public_key, &interned_key);
+            public_key_release(public_key);
+            if (SUCCESS != return_code) {
+                goto end;
+            }
+            public_key_release(interned_key);
+            *num_bytes_consumed = key_size;
+            decoder->num_items_remaining--;
+            break;
+        }
+        case BLOCKCHAIN_DECODER_STATE_BLOCK: {
+            size_t block_size = 0;
+            return_code = _blockchain_get_block_size_in_buffer(
+                buffer, buffer_size, &block_size, &decoder->num_bytes_needed);
+            if (SUCCESS != return_code || 0 == block_size) {
+                goto end;
+            }
+            return_code = _blockchain_decoder_decode_block(
+                decoder, buffer, block_size);
+            if (SUCCESS != return_code) {
+                goto end;
+            }
+            *num_bytes_consumed = block_size;
+            decoder->num_items_remaining--;
+            break;
+        }
+        case BLOCKCHAIN_DECODER_STATE_LOG_RECORD:
+            return_code = _blockchain_decoder_decode_log_record(
+                decoder, buffer, buffer_size, num_bytes_consumed);
+            goto end;
+        default:
+            return_code = FAILURE_INVALID_BLOCKCHAIN;
+            goto end;
+    }
+    // Move past sections that have no items left.
+    if (BLOCKCHAIN_DECODER_STATE_KEY == decoder->state &&
+        0 == decoder->num_items_remaining) {
+        decoder->state = BLOCKCHAIN_DECODER_STATE_NUM_BLOCKS;
+    } else if (BLOCKCHAIN_DECODER_STATE_BLOCK == decoder->state &&
+        0 == decoder->num_items_remaining) {
+        decoder->state = BLOCKCHAIN_DECODER_STATE_DONE;
+    }
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_decoder_decode_buffer(
+    blockchain_decoder_t *decoder,
+    unsigned char *buffer,
+    size_t buffer_size,
+    size_t *num_bytes_consumed
+) {
+    return_code_t return_code = SUCCESS;
+    size_t offset = 0;
+    while (offset < buffer_size &&
+        buffer_size - offset >= decoder->num_bytes_needed) {
+        size_t num_item_bytes_consumed = 0;
+        return_code = _blockchain_decoder_decode_item(
+            decoder,
+            buffer + offset,
+            buffer_size - offset,
+            &num_item_bytes_consumed);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        if (0 == num_item_bytes_consumed) {
+            break;
+        }
+        offset += num_item_bytes_consumed;
+        decoder->num_bytes_needed = 0;
+        if (!decoder->has_corrupt_record) {
+            decoder->num_bytes_decoded += num_item_bytes_consumed;
+        }
+    }
+    *num_bytes_consumed = offset;
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_decoder_buffer_bytes(
+    blockchain_decoder_t *decoder,
+    unsigned char *bytes,
+    size_t num_bytes
+) {
+    return_code_t return_code = SUCCESS;
+    if (decoder->buffer_size + num_bytes > decoder->buffer_capacity) {
+        size_t new_capacity = decoder->buffer_size + num_bytes;
+        if (new_capacity < 2 * decoder->buffer_capacity) {
+            new_capacity = 2 * decoder->buffer_capacity;
+        }
+        unsigned char *new_buffer = realloc(decoder->buffer, new_capacity);
+        if (NULL == new_buffer) {
+            return_code = FAILURE_COULD_NOT_MALLOC;
+            goto end;
+        }
+        decoder->buffer = new_buffer;
+        decoder->buffer_capacity = new_capacity;
+    }
+    memcpy(decoder->buffer + decoder->buffer_size, bytes, num_bytes);
+    decoder->buffer_size += num_bytes;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_decoder_write(
+    blockchain_decoder_t *decoder,
+    unsigned char *chunk,
+    size_t chunk_size
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == decoder || (NULL == chunk && 0 != chunk_size)) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    size_t num_bytes_consumed = 0;
+    // Without an incomplete item, decode straight from the chunk and only
+    // copy what is left over.
+    if (0 == decoder->buffer_size) {
+        return_code = _blockchain_decoder_decode_buffer(
+            decoder, chunk, chunk_size, &num_bytes_consumed);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        return_code = _blockchain_decoder_buffer_bytes(
+            decoder,
+            chunk + num_bytes_consumed,
+            chunk_size - num_bytes_consumed);
+        goto end;
+    }
+    return_code = _blockchain_decoder_buffer_bytes(decoder, chunk, chunk_size);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    return_code = _blockchain_decoder_decode_buffer(
+        decoder, decoder->buffer, decoder->buffer_size, &num_bytes_consumed);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    decoder->buffer_size -= num_bytes_consumed;
+    memmove(
+        decoder->buffer,
+        decoder->buffer + num_bytes_consumed,
+        decoder->buffer_size);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_decoder_finish(blockchain_decoder_t *decoder) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == decoder) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    bool is_complete = decoder->has_target && (
+        BLOCKCHAIN_DECODER_STATE_LOG_RECORD == decoder->state ||
+        (BLOCKCHAIN_DECODER_STATE_DONE == decoder->state &&
+        0 == decoder->buffer_size));
+    if (!is_complete) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_finish_log_record(
+    unsigned char *record,
+    uint64_t type,
+    uint64_t body_size
+) {
+    *(uint64_t *)record = htobe64(body_size);
+    *(uint64_t *)(record + sizeof(uint64_t)) = htobe64(type);
+    size_t checksum_offset = 2 * sizeof(uint64_t) + body_size;
+    return hash_sha_256(
+        record, checksum_offset, (sha_256_t *)(record + checksum_offset));
+}
+
+bool _blockchain_should_sync_log(
+    blockchain_t *blockchain,
+    blockchain_sync_policy_t sync_policy,
+    struct timespec *now
+) {
+    bool should_sync = false;
+    if (0 == blockchain->num_unsynced_logged_blocks) {
+        goto end;
+    }
+    switch (sync_policy.mode) {
+        case BLOCKCHAIN_SYNC_EVERY_NUM_BLOCKS:
+            should_sync = blockchain->num_unsynced_logged_blocks >=
+                sync_policy.num_blocks_between_syncs;
+            break;
+        case BLOCKCHAIN_SYNC_EVERY_INTERVAL: {
+            int64_t milliseconds_since_sync =
+                (now->tv_sec - blockchain->log_synced_at.tv_sec) * 1000 +
+                (now->tv_nsec - blockchain->log_synced_at.tv_nsec) / 1000000;
+            should_sync = milliseconds_since_sync >=
+                (int64_t)sync_policy.milliseconds_between_syncs;
+            break;
+        }
+        case BLOCKCHAIN_SYNC_EVERY_BLOCK:
+        default:
+            should_sync = true;
+            break;
+    }
+end:
+    return should_sync;
+}
+
+return_code_t _blockchain_write_log_record(
+    unsigned char *record,
+    uint64_t type,
+    uint64_t body_size,
+    FILE *f
+) {
+    return_code_t return_code = _blockchain_finish_log_record(
+        record, type, body_size);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    size_t record_size = BLOCKCHAIN_LOG_RECORD_OVERHEAD + body_size;
+    if (record_size != fwrite(record, 1, record_size, f)) {
+        return_code = FAILURE_FILE_IO;
+    }
+end:
+    return return_code;
+}
+
+size_t _blockchain_get_log_keys_record_end(
+    key_table_t *key_table,
+    size_t first_key_idx
+) {
+    size_t end_key_idx = first_key_idx + BLOCKCHAIN_LOG_MAX_KEYS_PER_RECORD;
+    if (end_key_idx > key_table->num_keys) {
+        end_key_idx = key_table->num_keys;
+    }
+    return end_key_idx;
+}
+
+return_code_t _blockchain_append_to_log(blockchain_t *blockchain, FILE *f) {
+    return_code_t return_code = SUCCESS;
+    bool is_new_log = 0 == blockchain->log_size;
+    node_t *first_new_block_node = NULL == blockchain->last_logged_block_node ?
+        blockchain->block_list->head :
+        blockchain->last_logged_block_node->next;
+    uint64_t size = 0;
+    // Records are encoded one at a time into a buffer that fits the largest,
+    // so rewriting a long chain does not hold all of it in memory.
+    uint64_t max_body_size = 0;
+    if (is_new_log) {
+        max_body_size = _blockchain_get_serialized_target_size(blockchain);
+        size += sizeof(uint64_t) + BLOCKCHAIN_LOG_RECORD_OVERHEAD +
+            max_body_size;
+    }
+    for (node_t *block_node = first_new_block_node;
+        NULL != block_node;
+        block_node = block_node->next) {
+        block_t *block = (block_t *)block_node->data;
+        uint64_t block_size = 0;
+        return_code = _blockchain_get_serialized_block_size(
+            block, &block_size);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        size += BLOCKCHAIN_LOG_RECORD_OVERHEAD + block_size;
+        if (block_size > max_body_size) {
+            max_body_size = block_size;
+        }
+    }
+    // New keys go in as many keys records as BLOCKCHAIN_MAX_RECORD_SIZE needs.
+    key_table_t *key_table = blockchain->key_table;
+    for (size_t first_key_idx = blockchain->num_logged_keys;
+        first_key_idx < key_table->num_keys;
+        first_key_idx += BLOCKCHAIN_LOG_MAX_KEYS_PER_RECORD) {
+        uint64_t keys_size = _blockchain_get_serialized_keys_size(
+            key_table,
+            first_key_idx,
+            _blockchain_get_log_keys_record_end(key_table, first_key_idx));
+        size += BLOCKCHAIN_LOG_RECORD_OVERHEAD + keys_size;
+        if (keys_size > max_body_size) {
+            max_body_size = keys_size;
+        }
+    }
+    if (0 == size) {
+        goto end;
+    }
+    unsigned char *record = malloc(
+        BLOCKCHAIN_LOG_RECORD_OVERHEAD + max_body_size);
+    if (NULL == record) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    unsigned char *body = record + 2 * sizeof(uint64_t);
+    if (is_new_log) {
+        uint64_t magic = htobe64(BLOCKCHAIN_LOG_MAGIC);
+        if (1 != fwrite(&magic, sizeof(magic), 1, f)) {
+            return_code = FAILURE_FILE_IO;
+            goto cleanup;
+        }
+        _blockchain_serialize_target(blockchain, body);
+        return_code = _blockchain_write_log_record(
+            record,
+            BLOCKCHAIN_LOG_RECORD_TARGET,
+            _blockchain_get_serialized_target_size(blockchain),
+            f);
+        if (SUCCESS != return_code) {
+            goto cleanup;
+        }
+    }
+    // The keys come before the blocks that refer to them.
+    for (size_t first_key_idx = blockchain->num_logged_keys;
+        first_key_idx < key_table->num_keys;
+        first_key_idx += BLOCKCHAIN_LOG_MAX_KEYS_PER_RECORD) {
+        size_t end_key_idx = _blockchain_get_log_keys_record_end(
+            key_table, first_key_idx);
+        _blockchain_serialize_keys(key_table, first_key_idx, end_key_idx, body);
+        return_code = _blockchain_write_log_record(
+            record,
+            BLOCKCHAIN_LOG_RECORD_KEYS,
+            _blockchain_get_serialized_keys_size(
+                key_table, first_key_idx, end_key_idx),
+            f);
+        if (SUCCESS != return_code) {
+            goto cleanup;
+        }
+    }
+    node_t *last_block_node = blockchain->last_logged_block_node;
+    uint64_t num_new_blocks = 0;
+    for (node_t *block_node = first_new_block_node;
+        NULL != block_node;
+        block_node = block_node->next) {
+        uint64_t body_size = _blockchain_serialize_block(
+            (block_t *)block_node->data, body);
+        return_code = _blockchain_write_log_record(
+            record, BLOCKCHAIN_LOG_RECORD_BLOCK, body_size, f);
+        if (SUCCESS != return_code) {
+            goto cleanup;
+        }
+        last_block_node = block_node;
+        num_new_blocks++;
+    }
+    if (0 != fflush(f)) {
+        return_code = FAILURE_FILE_IO;
+        goto cleanup;
+    }
+    blockchain->log_size += size;
+    blockchain->num_logged_keys = key_table->num_keys;
+    blockchain->last_logged_block_node = last_block_node;
+    blockchain->num_unsynced_logged_blocks += num_new_blocks;
+cleanup:
+    free(record);
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_sync_log(blockchain_t *blockchain, FILE *f) {
+    return_code_t return_code = SUCCESS;
+    if (0 != fsync(fileno(f))) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    blockchain->num_unsynced_logged_blocks = 0;
+    clock_gettime(CLOCK_MONOTONIC, &blockchain->log_synced_at);
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_sync_parent_directory(char *path) {
+    return_code_t return_code = SUCCESS;
+    // dirname may modify its argument.
+    char *path_copy = strdup(path);
+    if (NULL == path_copy) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    int directory_fd = open(dirname(path_copy), O_RDONLY | O_DIRECTORY);
+    free(path_copy);
+    if (directory_fd < 0) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    if (0 != fsync(directory_fd)) {
+        return_code = FAILURE_FILE_IO;
+    }
+    close(directory_fd);
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_rewrite_log(blockchain_t *blockchain, char *outfile) {
+    return_code_t return_code = SUCCESS;
+    char *log_path = strdup(outfile);
+    if (NULL == log_path) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    size_t temporary_path_length = strlen(outfile) + sizeof(".tmp");
+    char *temporary_path = malloc(temporary_path_length);
+    if (NULL == temporary_path) {
+        free(log_path);
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    snprintf(temporary_path, temporary_path_length, "%s.tmp", outfile);
+    FILE *f = fopen(temporary_path, "wb");
+    if (NULL == f) {
+        return_code = FAILURE_FILE_IO;
+        goto cleanup;
+    }
+    // Until the rename succeeds, outfile holds no log that this blockchain
+    // can append to.
+    free(blockchain->log_path);
+    blockchain->log_path = NULL;
+    blockchain->log_size = 0;
+    blockchain->num_logged_keys = 0;
+    blockchain->last_logged_block_node = NULL;
+    return_code = _blockchain_append_to_log(blockchain, f);
+    // The new log must be on disk before it replaces the old one.
+    if (SUCCESS == return_code) {
+        return_code = _blockchain_sync_log(blockchain, f);
+    }
+    if (0 != fclose(f) && SUCCESS == return_code) {
+        return_code = FAILURE_FILE_IO;
+    }
+    if (SUCCESS != return_code) {
+        remove(temporary_path);
+        goto cleanup;
+    }
+    if (0 != rename(temporary_path, outfile)) {
+        remove(temporary_path);
+        return_code = FAILURE_FILE_IO;
+        goto cleanup;
+    }
+    return_code = _blockchain_sync_parent_directory(outfile);
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    blockchain->log_path = log_path;
+    log_path = NULL;
+cleanup:
+    free(temporary_path);
+    free(log_path);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_write_to_file_with_sync_policy(
+    blockchain_t *blockchain,
+    char *outfile,
+    blockchain_sync_policy_t sync_policy
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || NULL == outfile) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    FILE *f = NULL;
+    if (NULL != blockchain->log_path &&
+        0 == strcmp(blockchain->log_path, outfile)) {
+        f = fopen(outfile, "r+b");
+        // If anything else wrote to the log, or an earlier write failed
+        // partway, the log no longer ends where this blockchain expects.
+        if (NULL != f &&
+            (0 != fseek(f, 0, SEEK_END) ||
+            (uint64_t)ftell(f) != blockchain->log_size)) {
+            fclose(f);
+            f = NULL;
+        }
+    }
+    if (NULL == f) {
+        return_code = _blockchain_rewrite_log(blockchain, outfile);
+        goto end;
+    }
+    return_code = _blockchain_append_to_log(blockchain, f);
+    struct timespec now = {0};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (SUCCESS == return_code &&
+        _blockchain_should_sync_log(blockchain, sync_policy, &now)) {
+        return_code = _blockchain_sync_log(blockchain, f);
+    }
+    if (0 != fclose(f) && SUCCESS == return_code) {
+        return_code = FAILURE_FILE_IO;
+    }
+end:
+    return return_code;
+}
+
+return_code_t blockchain_write_to_file(
+    blockchain_t *blockchain,
+    char *outfile
+) {
+    blockchain_sync_policy_t sync_policy = {0};
+    sync_policy.mode = BLOCKCHAIN_SYNC_EVERY_BLOCK;
+    return blockchain_write_to_file_with_sync_policy(
+        blockchain, outfile, sync_policy);
+}
+
+/**
+ * @brief Builds a blockchain from the blocks that a decoder hands it.
+ * 
+ * @param decoder The decoder.
+ * @param blockchain The blockchain, created from the decoder's target when the
+ * first block arrives.
+ */
+typedef struct blockchain_builder_t {
+    blockchain_decoder_t *decoder;
+    blockchain_t *blockchain;
+} blockchain_builder_t;
+
+return_code_t _blockchain_builder_create_blockchain(
+    blockchain_builder_t *builder
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == builder->blockchain) {
+        return_code = blockchain_create_with_target(
+            &builder->blockchain, builder->decoder->target);
+    }
+    return return_code;
+}
+
+return_code_t _blockchain_builder_add_block(block_t *block, void *args) {
+    blockchain_builder_t *builder = (blockchain_builder_t *)args;
+    return_code_t return_code = _blockchain_builder_create_blockchain(builder);
+    if (SUCCESS != return_code) {
+        block_destroy(block);
+        goto end;
+    }
+    return_code = blockchain_add_block(builder->blockchain, block);
+    if (SUCCESS != return_code) {
+        block_destroy(block);
+        goto end;
+    }
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_builder_finish(
+    blockchain_builder_t *builder,
+    blockchain_t **blockchain
+) {
+    return_code_t return_code = blockchain_decoder_finish(builder->decoder);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    // A chain without blocks never reaches _blockchain_builder_add_block.
+    return_code = _blockchain_builder_create_blockchain(builder);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    *blockchain = builder->blockchain;
+    builder->blockchain = NULL;
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_replay_log(
+    blockchain_t **blockchain,
+    unsigned char *buffer,
+    size_t buffer_size
+) {
+    return_code_t return_code = SUCCESS;
+    blockchain_builder_t builder = {0};
+    return_code = blockchain_decoder_create(
+        &builder.decoder, _blockchain_builder_add_block, &builder);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    return_code = blockchain_decoder_write(
+        builder.decoder, buffer, buffer_size);
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    blockchain_t *new_blockchain = NULL;
+    return_code = _blockchain_builder_finish(&builder, &new_blockchain);
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    // The next save appends after the last valid record.
+    new_blockchain->log_size = builder.decoder->num_bytes_decoded;
+    new_blockchain->num_logged_keys = new_blockchain->key_table->num_keys;
+    for (node_t *block_node = new_blockchain->block_list->head;
+        NULL != block_node;
+        block_node = block_node->next) {
+        new_blockchain->last_logged_block_node = block_node;
+    }
+    *blockchain = new_blockchain;
+cleanup:
+    if (NULL != builder.blockchain) {
+        blockchain_destroy(builder.blockchain);
+    }
+    blockchain_decoder_destroy(builder.decoder);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_read_from_file(
+    blockchain_t **blockchain,
+    char *infile
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || NULL == infile) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    int fd = open(infile, O_RDONLY);
+    if (fd < 0) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    struct stat file_stats = {0};
+    if (0 != fstat(fd, &file_stats)) {
+        return_code = FAILURE_FILE_IO;
+        close(fd);
+        goto end;
+    }
+    uint64_t buffer_size = file_stats.st_size;
+    if (buffer_size < sizeof(uint64_t)) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        close(fd);
+        goto end;
+    }
+    // Map the file rather than reading it into a heap buffer, so that loading
+    // a chain does not hold a second copy of it in memory. The pages are read
+    // once, front to back, and the kernel may drop them as soon as they have
+    // been parsed.
+    unsigned char *buffer = mmap(
+        NULL, buffer_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (MAP_FAILED == buffer) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    madvise(buffer, buffer_size, MADV_SEQUENTIAL);
+    if (BLOCKCHAIN_LOG_MAGIC == betoh64(*(uint64_t *)buffer)) {
+        char *log_path = strdup(infile);
+        if (NULL == log_path) {
+            return_code = FAILURE_COULD_NOT_MALLOC;
+            goto cleanup;
+        }
+        return_code = _blockchain_replay_log(blockchain, buffer, buffer_size);
+        if (SUCCESS != return_code) {
+            free(log_path);
+            goto cleanup;
+        }
+        (*blockchain)->log_path = log_path;
+    } else {
+        return_code = blockchain_deserialize(blockchain, buffer, buffer_size);
+    }
+cleanup:
+    munmap(buffer, buffer_size);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_read_from_fd(blockchain_t **blockchain, int fd) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || fd < 0) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    unsigned char *chunk = malloc(BLOCKCHAIN_READ_CHUNK_SIZE);
+    if (NULL == chunk) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    blockchain_builder_t builder = {0};
+    return_code = blockchain_decoder_create(
+        &builder.decoder, _blockchain_builder_add_block, &builder);
+    if (SUCCESS != return_code) {
+        free(chunk);
+        goto end;
+    }
+    while (true) {
+        ssize_t num_bytes_read = read(fd, chunk, BLOCKCHAIN_READ_CHUNK_SIZE);
+        if (num_bytes_read < 0 && EINTR == errno) {
+            continue;
+        }
+        if (num_bytes_read < 0) {
+            return_code = FAILURE_FILE_IO;
+            goto cleanup;
+        }
+        if (0 == num_bytes_read) {
+            break;
+        }
+        return_code = blockchain_decoder_write(
+            builder.decoder, chunk, num_bytes_read);
+        if (SUCCESS != return_code) {
+            goto cleanup;
+        }
+    }
+    return_code = _blockchain_builder_finish(&builder, blockchain);
+cleanup:
+    if (NULL != builder.blockchain) {
+        blockchain_destroy(builder.blockchain);
+    }
+    blockchain_decoder_destroy(builder.decoder);
+    free(chunk);
 end:
     return return_code;
 }
 
-return_code_t blockchain_serialize(
-    blockchain_t *blockchain,
-    unsigned char **buffer,
-    uint64_t *buffer_size
+return_code_t _blockchain_view_add_block(
+    blockchain_view_t *view,
+    uint64_t *capacity,
+    uint64_t block_offset,
+    uint64_t block_size
 ) {
     return_code_t return_code = SUCCESS;
-    if (NULL == blockchain || NULL == buffer || NULL == buffer_size) {
-        return_code = FAILURE_INVALID_INPUT;
-        goto end;
-    }
-    uint64_t num_blocks = 0;
-    return_code = linked_list_length(blockchain->block_list, &num_blocks);
-    if (SUCCESS != return_code) {
-        goto end;
-    }
-    uint64_t size =
-        sizeof(blockchain->num_leading_zero_bytes_required_in_block_hash) +
-        sizeof(num_blocks);
-    unsigned char *serialization_buffer = calloc(1, size);
-    if (NULL == serialization_buffer) {
-        return_code = FAILURE_COULD_NOT_MALLOC;
-        goto end;
-    }
-    unsigned char *next_spot_in_buffer = serialization_buffer;
-    *(uint64_t *)next_spot_in_buffer = htobe64(
-        blockchain->num_leading_zero_bytes_required_in_block_hash);
-    next_spot_in_buffer += sizeof(
-        blockchain->num_leading_zero_bytes_required_in_block_hash);
-    *(uint64_t *)next_spot_in_buffer = htobe64(num_blocks);
-    next_spot_in_buffer += sizeof(num_blocks);
-    for (node_t *block_node = blockchain->block_list->head;
-        NULL != block_node;
-        block_node = block_node->next) {
-        block_t *block = (block_t *)block_node->data;
-        uint64_t num_transactions_in_block = 0;
-        return_code = linked_list_length(
-            block->transaction_list, &num_transactions_in_block);
-        if (SUCCESS != return_code) {
-            free(serialization_buffer);
+    if (view->num_blocks == *capacity) {
+        uint64_t new_capacity = 0 == *capacity ? 64 : 2 * *capacity;
+        uint64_t *new_block_offsets = realloc(
+            view->block_offsets, new_capacity * sizeof(uint64_t));
+        if (NULL == new_block_offsets) {
+            return_code = FAILURE_COULD_NOT_MALLOC;
             goto end;
         }
-        uint64_t next_spot_in_buffer_offset = size;
-        size += sizeof(block->created_at);
-        size += sizeof(block->previous_block_hash);
-        size += sizeof(block->proof_of_work);
-        size += sizeof(num_transactions_in_block);
-        serialization_buffer = realloc(serialization_buffer, size);
-        if (NULL == serialization_buffer) {
+        view->block_offsets = new_block_offsets;
+        uint64_t *new_block_sizes = realloc(
+            view->block_sizes, new_capacity * sizeof(uint64_t));
+        if (NULL == new_block_sizes) {
+            return_code = FAILURE_COULD_NOT_MALLOC;
             goto end;
         }
-        // When we realloc, serialization_buffer may move. We need to use an
-        // offset so we can get the next memory location to write.
-        next_spot_in_buffer = serialization_buffer + next_spot_in_buffer_offset;
-        *(uint64_t *)next_spot_in_buffer = htobe64(block->created_at);
-        next_spot_in_buffer += sizeof(block->created_at);
-        for (size_t idx = 0; idx < sizeof(block->previous_block_hash); idx++) {
-            *next_spot_in_buffer = block->previous_block_hash.digest[idx];
-            next_spot_in_buffer++;
-        }
-        *(uint64_t *)next_spot_in_buffer = htobe64(block->proof_of_work);
-        next_spot_in_buffer += sizeof(block->proof_of_work);
-        *(uint64_t *)next_spot_in_buffer = htobe64(num_transactions_in_block);
-        next_spot_in_buffer += sizeof(num_transactions_in_block);
-        for (node_t *transaction_node = block->transaction_list->head;
-            NULL != transaction_node;
-            transaction_node = transaction_node->next) {
-            transaction_t *transaction = (transaction_t *)
-                transaction_node->data;
-            next_spot_in_buffer_offset = size;
-            size += sizeof(transaction->created_at);
-            size += sizeof(transaction->sender_public_key);
-            size += sizeof(transaction->recipient_public_key);
-            size += sizeof(transaction->amount);
-            size += sizeof(transaction->sender_signature.length);
-            size += sizeof(transaction->sender_signature.bytes);
-            serialization_buffer = realloc(serialization_buffer, size);
-            if (NULL == serialization_buffer) {
-                goto end;
-            }
-            // When we realloc, serialization_buffer may move. We need to use an
-            // offset so we can get the next memory location to write.
-            next_spot_in_buffer =
-                serialization_buffer + next_spot_in_buffer_offset;
-            *(uint64_t *)next_spot_in_buffer = htobe64(transaction->created_at);
-            next_spot_in_buffer += sizeof(transaction->created_at);
-            for (size_t idx = 0;
-                 idx < sizeof(transaction->sender_public_key);
-                 idx++) {
-                *next_spot_in_buffer =
-                    transaction->sender_public_key.bytes[idx];
-                next_spot_in_buffer++;
-            }
-            for (size_t idx = 0;
-                 idx < sizeof(transaction->recipient_public_key);
-                 idx++) {
-                *next_spot_in_buffer =
-                    transaction->recipient_public_key.bytes[idx];
-                next_spot_in_buffer++;
-            }
-            *(uint64_t *)next_spot_in_buffer = htobe64(transaction->amount);
-            next_spot_in_buffer += sizeof(transaction->amount);
-            *(uint64_t *)next_spot_in_buffer = htobe64(
-                transaction->sender_signature.length);
-            next_spot_in_buffer += sizeof(transaction->sender_signature.length);
-            for (size_t idx = 0;
-                idx < sizeof(transaction->sender_signature.bytes);
-                idx++) {
-                *next_spot_in_buffer = transaction->sender_signature.bytes[idx];
-                next_spot_in_buffer++;
-            }
-        }
+        view->block_sizes = new_block_sizes;
+        *capacity = new_capacity;
     }
-    *buffer = serialization_buffer;
-    *buffer_size = size;
+    view->block_offsets[view->num_blocks] = block_offset;
+    view->block_sizes[view->num_blocks] = block_size;
+    view->num_blocks++;
 end:
     return return_code;
 }
 
-return_code_t blockchain_deserialize(
-    blockchain_t **blockchain,
-    unsigned char *buffer,
-    uint64_t buffer_size
+return_code_t _blockchain_view_index_serialized_blocks(
+    blockchain_view_t *view
 ) {
     return_code_t return_code = SUCCESS;
-    if (NULL == blockchain || NULL == buffer) {
-        return_code = FAILURE_INVALID_INPUT;
-        goto end;
-    }
-    unsigned char *next_spot_in_buffer = buffer;
-    ptrdiff_t total_read_size = next_spot_in_buffer + sizeof(uint64_t) - buffer;
-    if (total_read_size > buffer_size) {
-        return_code = FAILURE_BUFFER_TOO_SMALL;
+    unsigned char *next_spot_in_buffer = view->buffer + sizeof(uint64_t);
+    unsigned char *buffer_end = view->buffer + view->buffer_size;
+    size_t num_bytes_read = 0;
+    return_code = _blockchain_deserialize_target(
+        &view->target,
+        next_spot_in_buffer,
+        buffer_end - next_spot_in_buffer,
+        &num_bytes_read);
+    if (SUCCESS != return_code) {
         goto end;
     }
-    uint64_t num_leading_zero_bytes_required_in_block_hash = betoh64(
-        *(uint64_t *)next_spot_in_buffer);
-    next_spot_in_buffer += sizeof(
-        num_leading_zero_bytes_required_in_block_hash);
-    blockchain_t *new_blockchain = NULL;
-    return_code = blockchain_create(
-        &new_blockchain, num_leading_zero_bytes_required_in_block_hash);
+    next_spot_in_buffer += num_bytes_read;
+    return_code = _blockchain_deserialize_key_table(
+        view->key_table,
+        next_spot_in_buffer,
+        buffer_end - next_spot_in_buffer,
+        &num_bytes_read);
     if (SUCCESS != return_code) {
         goto end;
     }
-    total_read_size = next_spot_in_buffer + sizeof(uint64_t) - buffer;
-    if (total_read_size > buffer_size) {
+    next_spot_in_buffer += num_bytes_read;
+    if ((size_t)(buffer_end - next_spot_in_buffer) < sizeof(uint64_t)) {
         return_code = FAILURE_BUFFER_TOO_SMALL;
-        blockchain_destroy(new_blockchain);
         goto end;
     }
     uint64_t num_blocks = betoh64(*(uint64_t *)next_spot_in_buffer);
     next_spot_in_buffer += sizeof(num_blocks);
+    uint64_t capacity = 0;
     for (uint64_t block_idx = 0; block_idx < num_blocks; block_idx++) {
-        block_t *block = NULL;
-        total_read_size = next_spot_in_buffer + sizeof(uint64_t) - buffer;
-        if (total_read_size > buffer_size) {
-            return_code = FAILURE_BUFFER_TOO_SMALL;
-            blockchain_destroy(new_blockchain);
-            goto end;
-        }
-        time_t block_created_at = betoh64(*(uint64_t *)next_spot_in_buffer);
-        next_spot_in_buffer += sizeof(block_created_at);
-        total_read_size = next_spot_in_buffer + sizeof(sha_256_t) - buffer;
-        if (total_read_size > buffer_size) {
-            return_code = FAILURE_BUFFER_TOO_SMALL;
-            blockchain_destroy(new_blockchain);
+        size_t block_size = 0;
+        size_t num_bytes_needed = 0;
+        return_code = _blockchain_get_block_size_in_buffer(
+            next_spot_in_buffer,
+            buffer_end - next_spot_in_buffer,
+            &block_size,
+            &num_bytes_needed);
+        if (SUCCESS != return_code) {
             goto end;
         }
-        sha_256_t previous_block_hash = {0};
-        for (size_t idx = 0; idx < sizeof(previous_block_hash); idx++) {
-            previous_block_hash.digest[idx] = *next_spot_in_buffer;
-            next_spot_in_buffer++;
-        }
-        total_read_size = next_spot_in_buffer + sizeof(uint64_t) - buffer;
-        if (total_read_size > buffer_size) {
+        if (0 == block_size) {
             return_code = FAILURE_BUFFER_TOO_SMALL;
-            blockchain_destroy(new_blockchain);
             goto end;
         }
-        uint64_t proof_of_work = betoh64(*(uint64_t *)next_spot_in_buffer);
-        next_spot_in_buffer += sizeof(proof_of_work);
-        total_read_size = next_spot_in_buffer + sizeof(uint64_t) - buffer;
-        if (total_read_size > buffer_size) {
-            return_code = FAILURE_BUFFER_TOO_SMALL;
-            blockchain_destroy(new_blockchain);
+        return_code = _blockchain_view_add_block(
+            view, &capacity, next_spot_in_buffer - view->buffer, block_size);
+        if (SUCCESS != return_code) {
             goto end;
         }
-        uint64_t num_transactions = betoh64(*(uint64_t *)next_spot_in_buffer);
-        next_spot_in_buffer += sizeof(num_transactions);
-        linked_list_t *transaction_list = NULL;
-        return_code = linked_list_create(
-            &transaction_list, (free_function_t *)transaction_destroy, NULL);
+        next_spot_in_buffer += block_size;
+    }
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_view_index_log(blockchain_view_t *view) {
+    return_code_t return_code = SUCCESS;
+    unsigned char *next_spot_in_buffer = view->buffer + sizeof(uint64_t);
+    unsigned char *buffer_end = view->buffer + view->buffer_size;
+    bool has_target = false;
+    uint64_t capacity = 0;
+    while (next_spot_in_buffer < buffer_end) {
+        size_t record_size = 0;
+        size_t num_bytes_needed = 0;
+        bool is_intact_record = false;
+        return_code = _blockchain_check_log_record(
+            next_spot_in_buffer,
+            buffer_end - next_spot_in_buffer,
+            &record_size,
+            &num_bytes_needed,
+            &is_intact_record);
         if (SUCCESS != return_code) {
-            blockchain_destroy(new_blockchain);
             goto end;
         }
-        for (uint64_t transaction_idx = 0;
-            transaction_idx < num_transactions;
-            transaction_idx++) {
-            transaction_t *transaction = calloc(1, sizeof(transaction_t));
-            if (NULL == transaction) {
-                return_code = FAILURE_COULD_NOT_MALLOC;
-                blockchain_destroy(new_blockchain);
-                linked_list_destroy(transaction_list);
-                goto end;
-            }
-            total_read_size = next_spot_in_buffer + sizeof(uint64_t) - buffer;
-            if (total_read_size > buffer_size) {
-                return_code = FAILURE_BUFFER_TOO_SMALL;
-                blockchain_destroy(new_blockchain);
-                linked_list_destroy(transaction_list);
-                free(transaction);
-                goto end;
-            }
-            transaction->created_at = betoh64(*(uint64_t *)next_spot_in_buffer);
-            next_spot_in_buffer += sizeof(transaction->created_at);
-            total_read_size = next_spot_in_buffer + sizeof(ssh_key_t) - buffer;
-            if (total_read_size > buffer_size) {
-                return_code = FAILURE_BUFFER_TOO_SMALL;
-                blockchain_destroy(new_blockchain);
-                linked_list_destroy(transaction_list);
-                free(transaction);
-                goto end;
-            }
-            for (size_t idx = 0;
-                idx < sizeof(transaction->sender_public_key);
-                idx++) {
-                transaction->sender_public_key.bytes[idx] =
-                    *next_spot_in_buffer;
-                next_spot_in_buffer++;
-            }
-            total_read_size = next_spot_in_buffer + sizeof(ssh_key_t) - buffer;
-            if (total_read_size > buffer_size) {
-                return_code = FAILURE_BUFFER_TOO_SMALL;
-                blockchain_destroy(new_blockchain);
-                linked_list_destroy(transaction_list);
-                free(transaction);
-                goto end;
-            }
-            for (size_t idx = 0;
-                idx < sizeof(transaction->recipient_public_key);
-                idx++) {
-                transaction->recipient_public_key.bytes[idx] =
-                    *next_spot_in_buffer;
-                next_spot_in_buffer++;
-            }
-            total_read_size = next_spot_in_buffer + sizeof(uint64_t) - buffer;
-            if (total_read_size > buffer_size) {
-                return_code = FAILURE_BUFFER_TOO_SMALL;
-                blockchain_destroy(new_blockchain);
-                linked_list_destroy(transaction_list);
-                free(transaction);
-                goto end;
-            }
-            transaction->amount = betoh64(*(uint64_t *)next_spot_in_buffer);
-            next_spot_in_buffer += sizeof(transaction->amount);
-            total_read_size = next_spot_in_buffer + sizeof(uint64_t) - buffer;
-            if (total_read_size > buffer_size) {
-                return_code = FAILURE_BUFFER_TOO_SMALL;
-                blockchain_destroy(new_blockchain);
-                linked_list_destroy(transaction_list);
-                free(transaction);
-                goto end;
-            }
-            transaction->sender_signature.length = betoh64(
-                *(uint64_t *)next_spot_in_buffer);
-            next_spot_in_buffer += sizeof(transaction->sender_signature.length);
-            if (transaction->sender_signature.length > MAX_SSH_KEY_LENGTH) {
-                return_code = FAILURE_SIGNATURE_TOO_LONG;
-                blockchain_destroy(new_blockchain);
-                linked_list_destroy(transaction_list);
-                free(transaction);
+        // Leave out an incomplete or corrupt last record, as
+        // blockchain_read_from_file does.
+        if (0 == record_size) {
+            break;
+        }
+        if (!is_intact_record) {
+            if (next_spot_in_buffer + record_size != buffer_end) {
+                return_code = FAILURE_INVALID_BLOCKCHAIN;
                 goto end;
             }
-            total_read_size =
-                next_spot_in_buffer +
-                transaction->sender_signature.length -
-                buffer;
-            if (total_read_size > buffer_size) {
-                return_code = FAILURE_BUFFER_TOO_SMALL;
-                blockchain_destroy(new_blockchain);
-                linked_list_destroy(transaction_list);
-                free(transaction);
+            break;
+        }
+        uint64_t type = betoh64(
+            *(uint64_t *)(next_spot_in_buffer + sizeof(uint64_t)));
+        unsigned char *body = next_spot_in_buffer + 2 * sizeof(uint64_t);
+        size_t body_size = record_size - BLOCKCHAIN_LOG_RECORD_OVERHEAD;
+        size_t num_bytes_read = 0;
+        if (!has_target) {
+            if (BLOCKCHAIN_LOG_RECORD_TARGET != type) {
+                return_code = FAILURE_INVALID_BLOCKCHAIN;
                 goto end;
             }
-            for (size_t idx = 0;
-                idx < sizeof(transaction->sender_signature.bytes);
-                idx++) {
-                transaction->sender_signature.bytes[idx] = *next_spot_in_buffer;
-                next_spot_in_buffer++;
-            }
-            return_code = linked_list_append(transaction_list, transaction);
-            if (SUCCESS != return_code) {
-                blockchain_destroy(new_blockchain);
-                linked_list_destroy(transaction_list);
-                free(transaction);
-                goto end;
+            return_code = _blockchain_deserialize_target(
+                &view->target, body, body_size, &num_bytes_read);
+            has_target = SUCCESS == return_code;
+        } else if (BLOCKCHAIN_LOG_RECORD_KEYS == type) {
+            return_code = _blockchain_deserialize_key_table(
+                view->key_table, body, body_size, &num_bytes_read);
+        } else if (BLOCKCHAIN_LOG_RECORD_BLOCK == type) {
+            return_code = _blockchain_get_block_size_in_buffer(
+                body, body_size, &num_bytes_read, &num_bytes_needed);
+            if (SUCCESS == return_code && body_size == num_bytes_read) {
+                return_code = _blockchain_view_add_block(
+                    view, &capacity, body - view->buffer, body_size);
             }
+        } else {
+            return_code = FAILURE_INVALID_BLOCKCHAIN;
         }
-        return_code = block_create(
-            &block, transaction_list, proof_of_work, previous_block_hash);
         if (SUCCESS != return_code) {
-            blockchain_destroy(new_blockchain);
-            linked_list_destroy(transaction_list);
             goto end;
         }
-        block->created_at = block_created_at;
-        return_code = blockchain_add_block(new_blockchain, block);
-        if (SUCCESS != return_code) {
-            blockchain_destroy(new_blockchain);
-            block_destroy(block);
+        if (num_bytes_read != body_size) {
+            return_code = FAILURE_INVALID_BLOCKCHAIN;
             goto end;
         }
+        next_spot_in_buffer += record_size;
+    }
+    if (!has_target) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
     }
-    *blockchain = new_blockchain;
 end:
     return return_code;
 }
 
-return_code_t blockchain_write_to_file(
-    blockchain_t *blockchain,
-    char *outfile
-) {
+return_code_t blockchain_view_open(blockchain_view_t **view, char *infile) {
     return_code_t return_code = SUCCESS;
-    if (NULL == blockchain || NULL == outfile) {
+    if (NULL == view || NULL == infile) {
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
-    unsigned char *buffer = NULL;
-    size_t buffer_size = 0;
-    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
-    if (SUCCESS != return_code) {
+    int fd = open(infile, O_RDONLY);
+    if (fd < 0) {
+        return_code = FAILURE_FILE_IO;
         goto end;
     }
-    FILE *f = fopen(outfile, "wb");
-    if (NULL == f) {
+    struct stat file_stats = {0};
+    if (0 != fstat(fd, &file_stats)) {
         return_code = FAILURE_FILE_IO;
+        close(fd);
+        goto end;
+    }
+    uint64_t buffer_size = file_stats.st_size;
+    if (buffer_size < sizeof(uint64_t)) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        close(fd);
         goto end;
     }
-    size_t bytes_written = fwrite(buffer, 1, buffer_size, f);
-    fclose(f);
-    free(buffer);
-    if (bytes_written != buffer_size) {
+    unsigned char *buffer = mmap(
+        NULL, buffer_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (MAP_FAILED == buffer) {
         return_code = FAILURE_FILE_IO;
         goto end;
     }
+    blockchain_view_t *new_view = calloc(1, sizeof(blockchain_view_t));
+    if (NULL == new_view) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        munmap(buffer, buffer_size);
+        goto end;
+    }
+    new_view->buffer = buffer;
+    new_view->buffer_size = buffer_size;
+    return_code = key_table_create(&new_view->key_table);
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    uint64_t magic = betoh64(*(uint64_t *)buffer);
+    if (BLOCKCHAIN_SERIALIZATION_MAGIC == magic) {
+        return_code = _blockchain_view_index_serialized_blocks(new_view);
+    } else if (BLOCKCHAIN_LOG_MAGIC == magic) {
+        return_code = _blockchain_view_index_log(new_view);
+    } else {
+        return_code = FAILURE_INVALID_BLOCKCHAIN;
+    }
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    *view = new_view;
+    goto end;
+cleanup:
+    blockchain_view_close(new_view);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_view_close(blockchain_view_t *view) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == view) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    munmap(view->buffer, view->buffer_size);
+    if (NULL != view->key_table) {
+        key_table_destroy(view->key_table);
+    }
+    free(view->block_offsets);
+    free(view->block_sizes);
+    free(view);
 end:
     return return_code;
 }
 
-return_code_t blockchain_read_from_file(
-    blockchain_t **blockchain,
-    char *infile
+return_code_t blockchain_view_get_block(
+    blockchain_view_t *view,
+    uint64_t block_idx,
+    block_view_t *block
 ) {
     return_code_t return_code = SUCCESS;
-    if (NULL == blockchain || NULL == infile) {
+    if (NULL == view || NULL == block || block_idx >= view->num_blocks) {
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
-    FILE *f = fopen(infile, "rb");
-    if (NULL == f) {
-        return_code = FAILURE_FILE_IO;
+    return_code = _blockchain_deserialize_block_header(
+        block,
+        view->buffer + view->block_offsets[block_idx],
+        view->block_sizes[block_idx]);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_view_read_transaction(
+    blockchain_view_t *view,
+    block_view_t *block,
+    size_t *offset,
+    transaction_t *transaction
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == view ||
+        NULL == block ||
+        NULL == offset ||
+        NULL == transaction ||
+        *offset > block->transactions_size) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    size_t num_bytes_read = 0;
+    return_code = _blockchain_deserialize_transaction_fields(
+        transaction,
+        block->transactions + *offset,
+        block->transactions_size - *offset,
+        view->key_table,
+        &num_bytes_read);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    *offset += num_bytes_read;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_view_block_hash(
+    blockchain_view_t *view,
+    block_view_t *block,
+    sha_256_t *hash
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == view || NULL == block || NULL == hash) {
+        return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
-    fseek(f, 0, SEEK_END);
-    uint64_t buffer_size = ftell(f);
-    fseek(f, 0, SEEK_SET);
-    unsigned char *buffer = malloc(buffer_size);
-    if (NULL == buffer) {
+    // Allocate at least one element so that an empty block is not an error.
+    sha_256_t *transaction_hashes = malloc(
+        (block->num_transactions + 1) * sizeof(sha_256_t));
+    if (NULL == transaction_hashes) {
         return_code = FAILURE_COULD_NOT_MALLOC;
         goto end;
     }
-    size_t read_size = fread(buffer, 1, buffer_size, f);
-    if (read_size != (size_t)buffer_size) {
-        return_code = FAILURE_FILE_IO;
+    size_t offset = 0;
+    for (uint64_t idx = 0; idx < block->num_transactions; idx++) {
+        transaction_t transaction = {0};
+        return_code = blockchain_view_read_transaction(
+            view, block, &offset, &transaction);
+        if (SUCCESS != return_code) {
+            goto cleanup;
+        }
+        return_code = transaction_hash(&transaction, &transaction_hashes[idx]);
+        if (SUCCESS != return_code) {
+            goto cleanup;
+        }
+    }
+    block_header_t header = {0};
+    header.created_at = block->created_at;
+    header.previous_block_hash = block->previous_block_hash;
+    header.extra_nonce = block->extra_nonce;
+    header.proof_of_work = block->proof_of_work;
+    return_code = block_merkle_root_from_transaction_hashes(
+        transaction_hashes, block->num_transactions, &header.merkle_root);
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    return_code = block_header_hash(&header, hash);
+cleanup:
+    free(transaction_hashes);
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_view_verify_queued_signatures(
+    signature_verification_t *verification,
+    uint64_t *first_invalid_block_idx
+) {
+    return_code_t return_code = _blockchain_verify_signatures(verification);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    uint64_t invalid_block_idx = atomic_load(
+        &verification->first_invalid_block_idx);
+    if (invalid_block_idx < *first_invalid_block_idx) {
+        *first_invalid_block_idx = invalid_block_idx;
+    }
+    verification->num_transactions = 0;
+    atomic_store(&verification->next_transaction_idx, 0);
+    atomic_store(&verification->first_invalid_block_idx, UINT64_MAX);
+end:
+    return return_code;
+}
+
+return_code_t _blockchain_view_verify_blocks(
+    blockchain_view_t *view,
+    uint64_t *first_invalid_block_idx
+) {
+    return_code_t return_code = SUCCESS;
+    // Check the genesis block, which is unique.
+    block_view_t genesis_block = {0};
+    return_code = blockchain_view_get_block(view, 0, &genesis_block);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    if (!_blockchain_is_valid_genesis_block(
+            &genesis_block.previous_block_hash,
+            genesis_block.proof_of_work,
+            genesis_block.num_transactions)) {
+        *first_invalid_block_idx = 0;
+        goto end;
+    }
+    sha_256_t previous_block_hash = {0};
+    return_code = blockchain_view_block_hash(
+        view, &genesis_block, &previous_block_hash);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    // Check the remaining blocks.
+    transaction_t *transactions = calloc(
+        BLOCKCHAIN_VIEW_VERIFICATION_CHUNK_SIZE, sizeof(transaction_t));
+    signature_verification_t verification = {0};
+    verification.transactions = calloc(
+        BLOCKCHAIN_VIEW_VERIFICATION_CHUNK_SIZE, sizeof(transaction_t *));
+    verification.block_indices = calloc(
+        BLOCKCHAIN_VIEW_VERIFICATION_CHUNK_SIZE, sizeof(uint64_t));
+    atomic_init(&verification.next_transaction_idx, 0);
+    atomic_init(&verification.first_invalid_block_idx, UINT64_MAX);
+    atomic_init(&verification.return_code, SUCCESS);
+    if (NULL == transactions ||
+        NULL == verification.transactions ||
+        NULL == verification.block_indices) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto cleanup;
+    }
+    for (size_t idx = 0; idx < BLOCKCHAIN_VIEW_VERIFICATION_CHUNK_SIZE; idx++) {
+        verification.transactions[idx] = &transactions[idx];
+    }
+    return_code = blockchain_get_verified_signature_cache(&verification.cache);
+    if (SUCCESS != return_code) {
         goto cleanup;
     }
-    return_code = blockchain_deserialize(blockchain, buffer, buffer_size);
+    // Run the structural checks in chain order and verify the queued
+    // signatures whenever the scratch buffer fills. Queued signatures all
+    // belong to blocks before any structurally invalid block, so the first
+    // invalid block is the earlier of the two.
+    uint64_t structurally_invalid_block_idx = UINT64_MAX;
+    uint64_t signature_invalid_block_idx = UINT64_MAX;
+    for (uint64_t block_idx = 1;
+        block_idx < view->num_blocks &&
+        UINT64_MAX == structurally_invalid_block_idx &&
+        UINT64_MAX == signature_invalid_block_idx;
+        block_idx++) {
+        block_view_t block = {0};
+        return_code = blockchain_view_get_block(view, block_idx, &block);
+        if (SUCCESS != return_code) {
+            goto cleanup;
+        }
+        sha_256_t block_hash = {0};
+        return_code = blockchain_view_block_hash(view, &block, &block_hash);
+        if (SUCCESS != return_code) {
+            goto cleanup;
+        }
+        // Read the minting transaction ahead of the others so that the block
+        // checks see it before its signature is queued.
+        transaction_t minting_transaction = {0};
+        if (block.num_transactions > 0) {
+            size_t minting_transaction_offset = 0;
+            return_code = blockchain_view_read_transaction(
+                view,
+                &block,
+                &minting_transaction_offset,
+                &minting_transaction);
+            if (SUCCESS != return_code) {
+                goto cleanup;
+            }
+        }
+        bool is_valid_block = false;
+        return_code = _blockchain_is_valid_block(
+            &view->target,
+            &previous_block_hash,
+            &block.previous_block_hash,
+            &block_hash,
+            block.num_transactions > 0 ? &minting_transaction : NULL,
+            &is_valid_block);
+        if (SUCCESS != return_code) {
+            goto cleanup;
+        }
+        if (!is_valid_block) {
+            structurally_invalid_block_idx = block_idx;
+            break;
+        }
+        size_t offset = 0;
+        for (uint64_t transaction_idx = 0;
+            transaction_idx < block.num_transactions;
+            transaction_idx++) {
+            if (BLOCKCHAIN_VIEW_VERIFICATION_CHUNK_SIZE ==
+                verification.num_transactions) {
+                return_code = _blockchain_view_verify_queued_signatures(
+                    &verification, &signature_invalid_block_idx);
+                if (SUCCESS != return_code) {
+                    goto cleanup;
+                }
+                if (UINT64_MAX != signature_invalid_block_idx) {
+                    break;
+                }
+            }
+            transaction_t *transaction =
+                &transactions[verification.num_transactions];
+            return_code = blockchain_view_read_transaction(
+                view, &block, &offset, transaction);
+            if (SUCCESS != return_code) {
+                goto cleanup;
+            }
+            verification.block_indices[verification.num_transactions] =
+                block_idx;
+            verification.num_transactions++;
+        }
+        previous_block_hash = block_hash;
+    }
+    if (UINT64_MAX == signature_invalid_block_idx) {
+        return_code = _blockchain_view_verify_queued_signatures(
+            &verification, &signature_invalid_block_idx);
+        if (SUCCESS != return_code) {
+            goto cleanup;
+        }
+    }
+    *first_invalid_block_idx = signature_invalid_block_idx;
+    if (structurally_invalid_block_idx < signature_invalid_block_idx) {
+        *first_invalid_block_idx = structurally_invalid_block_idx;
+    }
 cleanup:
-    fclose(f);
-    free(buffer);
+    free(transactions);
+    free(verification.transactions);
+    free(verification.block_indices);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_view_verify(
+    blockchain_view_t *view,
+    bool *is_valid_blockchain,
+    uint64_t *first_invalid_block_idx
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == view || NULL == is_valid_blockchain) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    uint64_t invalid_block_idx = UINT64_MAX;
+    if (view->num_blocks > 0) {
+        return_code = _blockchain_view_verify_blocks(view, &invalid_block_idx);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+    }
+    *is_valid_blockchain = UINT64_MAX == invalid_block_idx;
+    if (!*is_valid_blockchain && NULL != first_invalid_block_idx) {
+        *first_invalid_block_idx = invalid_block_idx;
+    }
+end:
+    return return_code;
+}
+
+return_code_t blockchain_view_materialize_block(
+    blockchain_view_t *view,
+    uint64_t block_idx,
+    block_t **block
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == view || NULL == block || block_idx >= view->num_blocks) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    size_t num_bytes_read = 0;
+    return_code = _blockchain_deserialize_block(
+        block,
+        view->buffer + view->block_offsets[block_idx],
+        view->block_sizes[block_idx],
+        view->key_table,
+        &num_bytes_read);
 end:
     return return_code;
 }
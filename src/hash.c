@@ -1,6 +1,40 @@
+#include <pthread.h>
 #include <stdio.h>
+#include <string.h>
+#include <openssl/evp.h>
 #include "include/hash.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HASH_SHA_NI_BACKEND
+#include <immintrin.h>
+#endif
+
+#define ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static const uint32_t SHA_256_INITIAL_STATE[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+static const uint32_t SHA_256_ROUND_CONSTANTS[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
 void hash_print(sha_256_t *hash) {
     if (NULL == hash) {
         return;
@@ -10,3 +44,429 @@ void hash_print(sha_256_t *hash) {
     }
     printf("\n");
 }
+
+size_t hash_bucket_index(sha_256_t *hash, size_t num_buckets) {
+    size_t index = 0;
+    memcpy(&index, hash->digest, sizeof(index));
+    return index & (num_buckets - 1);
+}
+
+void _hash_sha_256_compress_block_portable(
+    uint32_t state[8],
+    const unsigned char *block
+) {
+    uint32_t w[64];
+    for (size_t idx = 0; idx < 16; idx++) {
+        w[idx] = (uint32_t)block[4 * idx] << 24 |
+            (uint32_t)block[4 * idx + 1] << 16 |
+            (uint32_t)block[4 * idx + 2] << 8 |
+            (uint32_t)block[4 * idx + 3];
+    }
+    for (size_t idx = 16; idx < 64; idx++) {
+        uint32_t s0 = ROTR32(w[idx - 15], 7) ^
+            ROTR32(w[idx - 15], 18) ^
+            (w[idx - 15] >> 3);
+        uint32_t s1 = ROTR32(w[idx - 2], 17) ^
+            ROTR32(w[idx - 2], 19) ^
+            (w[idx - 2] >> 10);
+        w[idx] = w[idx - 16] + s0 + w[idx - 7] + s1;
+    }
+    uint32_t a = state[0];
+    uint32_t b = state[1];
+    uint32_t c = state[2];
+    uint32_t d = state[3];
+    uint32_t e = state[4];
+    uint32_t f = state[5];
+    uint32_t g = state[6];
+    uint32_t h = state[7];
+    for (size_t idx = 0; idx < 64; idx++) {
+        uint32_t s1 = ROTR32(e, 6) ^ ROTR32(e, 11) ^ ROTR32(e, 25);
+        uint32_t ch = (e & f) ^ (~e & g);
+        uint32_t temp1 = h + s1 + ch + SHA_256_ROUND_CONSTANTS[idx] + w[idx];
+        uint32_t s0 = ROTR32(a, 2) ^ ROTR32(a, 13) ^ ROTR32(a, 22);
+        uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t temp2 = s0 + maj;
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+void _hash_sha_256_compress_portable(
+    uint32_t state[8],
+    const unsigned char *blocks,
+    size_t num_blocks
+) {
+    for (size_t idx = 0; idx < num_blocks; idx++) {
+        _hash_sha_256_compress_block_portable(
+            state, blocks + idx * SHA_256_BLOCK_LENGTH);
+    }
+}
+
+bool _hash_openssl_is_supported(void) {
+    return true;
+}
+
+static pthread_key_t thread_context_key;
+static EVP_MD *sha_256_md = NULL;
+static return_code_t thread_context_init_return_code = SUCCESS;
+static pthread_once_t thread_context_once = PTHREAD_ONCE_INIT;
+
+void _hash_free_thread_context(void *context) {
+    EVP_MD_CTX_free((EVP_MD_CTX *)context);
+}
+
+void _hash_init_thread_contexts(void) {
+    if (0 != pthread_key_create(
+            &thread_context_key, _hash_free_thread_context)) {
+        thread_context_init_return_code = FAILURE_PTHREAD_FUNCTION;
+        return;
+    }
+    sha_256_md = EVP_MD_fetch(NULL, "SHA256", NULL);
+    if (NULL == sha_256_md) {
+        thread_context_init_return_code = FAILURE_OPENSSL_FUNCTION;
+    }
+}
+
+return_code_t hash_get_thread_context(EVP_MD_CTX **context) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == context) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    pthread_once(&thread_context_once, _hash_init_thread_contexts);
+    return_code = thread_context_init_return_code;
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    EVP_MD_CTX *thread_context = pthread_getspecific(thread_context_key);
+    if (NULL == thread_context) {
+        thread_context = EVP_MD_CTX_new();
+        if (NULL == thread_context) {
+            return_code = FAILURE_OPENSSL_FUNCTION;
+            goto end;
+        }
+        if (0 != pthread_setspecific(thread_context_key, thread_context)) {
+            EVP_MD_CTX_free(thread_context);
+            return_code = FAILURE_PTHREAD_FUNCTION;
+            goto end;
+        }
+    } else if (1 != EVP_MD_CTX_reset(thread_context)) {
+        return_code = FAILURE_OPENSSL_FUNCTION;
+        goto end;
+    }
+    *context = thread_context;
+end:
+    return return_code;
+}
+
+return_code_t hash_get_sha_256_md(const EVP_MD **md) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == md) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    pthread_once(&thread_context_once, _hash_init_thread_contexts);
+    return_code = thread_context_init_return_code;
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    *md = sha_256_md;
+end:
+    return return_code;
+}
+
+return_code_t _hash_sha_256_openssl(
+    const unsigned char *message,
+    size_t message_length,
+    sha_256_t *hash
+) {
+    return_code_t return_code = SUCCESS;
+    EVP_MD_CTX *context = NULL;
+    return_code = hash_get_thread_context(&context);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    if (1 != EVP_DigestInit_ex(context, sha_256_md, NULL) ||
+        1 != EVP_DigestUpdate(context, message, message_length) ||
+        1 != EVP_DigestFinal_ex(context, hash->digest, NULL)) {
+        return_code = FAILURE_OPENSSL_FUNCTION;
+        goto end;
+    }
+end:
+    return return_code;
+}
+
+#ifdef HASH_SHA_NI_BACKEND
+
+bool _hash_sha_ni_is_supported(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1");
+}
+
+__attribute__((target("sha,sse4.1")))
+void _hash_sha_256_compress_sha_ni(
+    uint32_t state[8],
+    const unsigned char *blocks,
+    size_t num_blocks
+) {
+    // The SHA instructions keep the state as ABEF and CDGH rather than ABCD
+    // and EFGH, and read message words in big endian.
+    const __m128i byte_swap_mask = _mm_set_epi64x(
+        0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i cdab = _mm_shuffle_epi32(
+        _mm_loadu_si128((const __m128i *)&state[0]), 0xb1);
+    __m128i efgh = _mm_shuffle_epi32(
+        _mm_loadu_si128((const __m128i *)&state[4]), 0x1b);
+    __m128i abef = _mm_alignr_epi8(cdab, efgh, 8);
+    __m128i cdgh = _mm_blend_epi16(efgh, cdab, 0xf0);
+    for (size_t block_idx = 0; block_idx < num_blocks; block_idx++) {
+        const unsigned char *block = blocks + block_idx * SHA_256_BLOCK_LENGTH;
+        __m128i abef_saved = abef;
+        __m128i cdgh_saved = cdgh;
+        // Each of the 16 groups runs four rounds. w holds the last 16 message
+        // schedule words, four per vector.
+        __m128i w[4];
+        for (size_t group = 0; group < 16; group++) {
+            size_t current = group % 4;
+            if (group < 4) {
+                w[current] = _mm_shuffle_epi8(
+                    _mm_loadu_si128((const __m128i *)(block + 16 * group)),
+                    byte_swap_mask);
+            } else {
+                __m128i w7 = _mm_alignr_epi8(
+                    w[(current + 3) % 4], w[(current + 2) % 4], 4);
+                w[current] = _mm_sha256msg2_epu32(
+                    _mm_add_epi32(
+                        _mm_sha256msg1_epu32(
+                            w[current], w[(current + 1) % 4]),
+                        w7),
+                    w[(current + 3) % 4]);
+            }
+            __m128i message = _mm_add_epi32(
+                w[current],
+                _mm_loadu_si128(
+                    (const __m128i *)&SHA_256_ROUND_CONSTANTS[4 * group]));
+            cdgh = _mm_sha256rnds2_epu32(cdgh, abef, message);
+            message = _mm_shuffle_epi32(message, 0x0e);
+            abef = _mm_sha256rnds2_epu32(abef, cdgh, message);
+        }
+        abef = _mm_add_epi32(abef, abef_saved);
+        cdgh = _mm_add_epi32(cdgh, cdgh_saved);
+    }
+    __m128i feba = _mm_shuffle_epi32(abef, 0x1b);
+    __m128i dchg = _mm_shuffle_epi32(cdgh, 0xb1);
+    _mm_storeu_si128(
+        (__m128i *)&state[0], _mm_blend_epi16(feba, dchg, 0xf0));
+    _mm_storeu_si128(
+        (__m128i *)&state[4], _mm_alignr_epi8(dchg, feba, 8));
+}
+
+return_code_t _hash_sha_256_sha_ni(
+    const unsigned char *message,
+    size_t message_length,
+    sha_256_t *hash
+) {
+    return_code_t return_code = SUCCESS;
+    sha_256_midstate_t midstate = {0};
+    size_t prefix_length =
+        message_length - message_length % SHA_256_BLOCK_LENGTH;
+    return_code = hash_midstate_create(&midstate, message, prefix_length);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    return_code = hash_midstate_finalize(
+        &midstate,
+        message + prefix_length,
+        message_length - prefix_length,
+        hash);
+end:
+    return return_code;
+}
+
+#endif  // HASH_SHA_NI_BACKEND
+
+static const hash_backend_t HASH_BACKENDS[] = {
+#ifdef HASH_SHA_NI_BACKEND
+    {
+        "sha-ni",
+        _hash_sha_ni_is_supported,
+        _hash_sha_256_compress_sha_ni,
+        _hash_sha_256_sha_ni
+    },
+#endif
+    {
+        "openssl",
+        _hash_openssl_is_supported,
+        _hash_sha_256_compress_portable,
+        _hash_sha_256_openssl
+    },
+};
+
+static const hash_backend_t *selected_backend = NULL;
+static pthread_once_t selected_backend_once = PTHREAD_ONCE_INIT;
+
+void _hash_select_backend(void) {
+    size_t num_backends = sizeof(HASH_BACKENDS) / sizeof(HASH_BACKENDS[0]);
+    // The OpenSSL backend is last and always supported.
+    for (size_t idx = 0; idx < num_backends; idx++) {
+        if (HASH_BACKENDS[idx].is_supported()) {
+            selected_backend = &HASH_BACKENDS[idx];
+            break;
+        }
+    }
+}
+
+const hash_backend_t *_hash_get_selected_backend(void) {
+    pthread_once(&selected_backend_once, _hash_select_backend);
+    return selected_backend;
+}
+
+return_code_t hash_get_backends(
+    const hash_backend_t **backends,
+    size_t *num_backends
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == backends || NULL == num_backends) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    *backends = HASH_BACKENDS;
+    *num_backends = sizeof(HASH_BACKENDS) / sizeof(HASH_BACKENDS[0]);
+end:
+    return return_code;
+}
+
+return_code_t hash_get_backend(const hash_backend_t **backend) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == backend) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    *backend = _hash_get_selected_backend();
+end:
+    return return_code;
+}
+
+void hash_sha_256_compress(uint32_t state[8], const unsigned char *block) {
+    _hash_get_selected_backend()->compress(state, block, 1);
+}
+
+return_code_t hash_sha_256(
+    const unsigned char *message,
+    size_t message_length,
+    sha_256_t *hash
+) {
+    return_code_t return_code = SUCCESS;
+    if ((NULL == message && 0 != message_length) || NULL == hash) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    return_code = _hash_get_selected_backend()->digest(
+        message, message_length, hash);
+end:
+    return return_code;
+}
+
+return_code_t hash_midstate_create(
+    sha_256_midstate_t *midstate,
+    const unsigned char *prefix,
+    size_t prefix_length
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == midstate ||
+        (NULL == prefix && 0 != prefix_length) ||
+        0 != prefix_length % SHA_256_BLOCK_LENGTH) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    memcpy(midstate->state, SHA_256_INITIAL_STATE, sizeof(midstate->state));
+    _hash_get_selected_backend()->compress(
+        midstate->state, prefix, prefix_length / SHA_256_BLOCK_LENGTH);
+    midstate->num_bytes = prefix_length;
+end:
+    return return_code;
+}
+
+return_code_t hash_midstate_finalize(
+    const sha_256_midstate_t *midstate,
+    const unsigned char *suffix,
+    size_t suffix_length,
+    sha_256_t *hash
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == midstate ||
+        (NULL == suffix && 0 != suffix_length) ||
+        NULL == hash) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    uint32_t state[8];
+    memcpy(state, midstate->state, sizeof(state));
+    const hash_backend_t *backend = _hash_get_selected_backend();
+    size_t offset = suffix_length - suffix_length % SHA_256_BLOCK_LENGTH;
+    backend->compress(state, suffix, offset / SHA_256_BLOCK_LENGTH);
+    // Pad the rest of the suffix with a one bit, zeroes, and the message
+    // length in bits. This takes one more block, or two if the length does not
+    // fit after the remaining suffix bytes.
+    unsigned char final_blocks[2 * SHA_256_BLOCK_LENGTH] = {0};
+    size_t remaining_length = suffix_length - offset;
+    memcpy(final_blocks, suffix + offset, remaining_length);
+    final_blocks[remaining_length] = 0x80;
+    size_t num_final_blocks =
+        remaining_length + 1 + sizeof(uint64_t) <= SHA_256_BLOCK_LENGTH ? 1 : 2;
+    uint64_t num_bits = (midstate->num_bytes + suffix_length) * 8;
+    unsigned char *length_spot =
+        final_blocks + num_final_blocks * SHA_256_BLOCK_LENGTH;
+    for (size_t idx = 1; idx <= sizeof(num_bits); idx++) {
+        *(length_spot - idx) = (unsigned char)(num_bits >> (8 * (idx - 1)));
+    }
+    backend->compress(state, final_blocks, num_final_blocks);
+    for (size_t idx = 0; idx < 8; idx++) {
+        hash->digest[4 * idx] = (unsigned char)(state[idx] >> 24);
+        hash->digest[4 * idx + 1] = (unsigned char)(state[idx] >> 16);
+        hash->digest[4 * idx + 2] = (unsigned char)(state[idx] >> 8);
+        hash->digest[4 * idx + 3] = (unsigned char)state[idx];
+    }
+end:
+    return return_code;
+}
+
+return_code_t hash_midstate_final_block(
+    const sha_256_midstate_t *midstate,
+    const unsigned char *suffix,
+    size_t suffix_length,
+    unsigned char *final_block
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == midstate ||
+        (NULL == suffix && 0 != suffix_length) ||
+        NULL == final_block ||
+        suffix_length + 1 + sizeof(uint64_t) > SHA_256_BLOCK_LENGTH) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    memset(final_block, 0, SHA_256_BLOCK_LENGTH);
+    memcpy(final_block, suffix, suffix_length);
+    final_block[suffix_length] = 0x80;
+    uint64_t num_bits = (midstate->num_bytes + suffix_length) * 8;
+    for (size_t idx = 1; idx <= sizeof(num_bits); idx++) {
+        final_block[SHA_256_BLOCK_LENGTH - idx] =
+            (unsigned char)(num_bits >> (8 * (idx - 1)));
+    }
+end:
+    return return_code;
+}
@@ -0,0 +1,381 @@
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include "include/hash_batch.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HASH_BATCH_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+static const uint32_t SHA_256_ROUND_CONSTANTS[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+#define ROTR_LANES(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+// The body of a batch kernel over lanes_t, a GCC vector of num_lanes 32-bit
+// words. Each lane runs the same SHA-256 compression with a different counter.
+// Vector operations with a scalar operand apply the scalar to every lane.
+// Each kernel function expands this body under its own target attribute so
+// that the compiler emits that instruction set's vector instructions.
+#define HASH_BATCH_KERNEL_BODY(lanes_t, num_lanes) \
+    lanes_t w[16]; \
+    for (size_t idx = 0; idx < 16; idx++) { \
+        w[idx] = (lanes_t){0} + block_words[idx]; \
+    } \
+    uint32_t counter_high[num_lanes]; \
+    uint32_t counter_low[num_lanes]; \
+    for (size_t lane = 0; lane < (num_lanes); lane++) { \
+        uint64_t counter = first_counter + lane; \
+        counter_high[lane] = (uint32_t)(counter >> 32); \
+        counter_low[lane] = (uint32_t)counter; \
+    } \
+    memcpy(&w[counter_word], counter_high, sizeof(counter_high)); \
+    memcpy(&w[counter_word + 1], counter_low, sizeof(counter_low)); \
+    lanes_t a = (lanes_t){0} + state[0]; \
+    lanes_t b = (lanes_t){0} + state[1]; \
+    lanes_t c = (lanes_t){0} + state[2]; \
+    lanes_t d = (lanes_t){0} + state[3]; \
+    lanes_t e = (lanes_t){0} + state[4]; \
+    lanes_t f = (lanes_t){0} + state[5]; \
+    lanes_t g = (lanes_t){0} + state[6]; \
+    lanes_t h = (lanes_t){0} + state[7]; \
+    for (size_t idx = 0; idx < 64; idx++) { \
+        if (idx >= 16) { \
+            lanes_t w15 = w[(idx - 15) % 16]; \
+            lanes_t w2 = w[(idx - 2) % 16]; \
+            lanes_t s0 = ROTR_LANES(w15, 7) ^ ROTR_LANES(w15, 18) ^ \
+                (w15 >> 3); \
+            lanes_t s1 = ROTR_LANES(w2, 17) ^ ROTR_LANES(w2, 19) ^ \
+                (w2 >> 10); \
+            w[idx % 16] += s0 + w[(idx - 7) % 16] + s1; \
+        } \
+        lanes_t s1 = ROTR_LANES(e, 6) ^ ROTR_LANES(e, 11) ^ \
+            ROTR_LANES(e, 25); \
+        lanes_t ch = (e & f) ^ (~e & g); \
+        lanes_t temp1 = h + s1 + ch + SHA_256_ROUND_CONSTANTS[idx] + \
+            w[idx % 16]; \
+        lanes_t s0 = ROTR_LANES(a, 2) ^ ROTR_LANES(a, 13) ^ \
+            ROTR_LANES(a, 22); \
+        lanes_t maj = (a & b) ^ (a & c) ^ (b & c); \
+        lanes_t temp2 = s0 + maj; \
+        h = g; \
+        g = f; \
+        f = e; \
+        e = d + temp1; \
+        d = c; \
+        c = b; \
+        b = a; \
+        a = temp1 + temp2; \
+    } \
+    lanes_t output[8] = { \
+        a + state[0], b + state[1], c + state[2], d + state[3], \
+        e + state[4], f + state[5], g + state[6], h + state[7]}; \
+    memcpy(output_states, output, sizeof(output));
+
+bool _hash_batch_scalar_is_supported(void) {
+    return true;
+}
+
+void _hash_batch_scalar(
+    const uint32_t *state,
+    const uint32_t *block_words,
+    size_t counter_word,
+    uint64_t first_counter,
+    uint32_t *output_states
+) {
+    unsigned char block[SHA_256_BLOCK_LENGTH];
+    for (size_t idx = 0; idx < 16; idx++) {
+        uint32_t word = block_words[idx];
+        if (counter_word == idx) {
+            word = (uint32_t)(first_counter >> 32);
+        } else if (counter_word + 1 == idx) {
+            word = (uint32_t)first_counter;
+        }
+        block[4 * idx] = (unsigned char)(word >> 24);
+        block[4 * idx + 1] = (unsigned char)(word >> 16);
+        block[4 * idx + 2] = (unsigned char)(word >> 8);
+        block[4 * idx + 3] = (unsigned char)word;
+    }
+    memcpy(output_states, state, 8 * sizeof(uint32_t));
+    hash_sha_256_compress(output_states, block);
+}
+
+#ifdef HASH_BATCH_X86_KERNELS
+
+typedef uint32_t lanes_4_t __attribute__((vector_size(16)));
+typedef uint32_t lanes_8_t __attribute__((vector_size(32)));
+typedef uint32_t lanes_16_t __attribute__((vector_size(64)));
+
+bool _hash_batch_sse41_is_supported(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.1");
+}
+
+__attribute__((target("sse4.1")))
+void _hash_batch_sse41(
+    const uint32_t *state,
+    const uint32_t *block_words,
+    size_t counter_word,
+    uint64_t first_counter,
+    uint32_t *output_states
+) {
+    HASH_BATCH_KERNEL_BODY(lanes_4_t, 4)
+}
+
+bool _hash_batch_avx2_is_supported(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+__attribute__((target("avx2")))
+void _hash_batch_avx2(
+    const uint32_t *state,
+    const uint32_t *block_words,
+    size_t counter_word,
+    uint64_t first_counter,
+    uint32_t *output_states
+) {
+    HASH_BATCH_KERNEL_BODY(lanes_8_t, 8)
+}
+
+bool _hash_batch_avx512_is_supported(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f");
+}
+
+__attribute__((target("avx512f")))
+void _hash_batch_avx512(
+    const uint32_t *state,
+    const uint32_t *block_words,
+    size_t counter_word,
+    uint64_t first_counter,
+    uint32_t *output_states
+) {
+    HASH_BATCH_KERNEL_BODY(lanes_16_t, 16)
+}
+
+bool _hash_batch_sha_ni_is_supported(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1");
+}
+
+__attribute__((target("sha,sse4.1")))
+void _hash_batch_sha_ni(
+    const uint32_t *state,
+    const uint32_t *block_words,
+    size_t counter_word,
+    uint64_t first_counter,
+    uint32_t *output_states
+) {
+    // This runs the same rounds as the SHA-NI hash backend, but for two
+    // counters at once. The two compressions are independent, so the CPU
+    // overlaps one lane's round instructions with the other's.
+    uint32_t words[2][16];
+    for (size_t lane = 0; lane < 2; lane++) {
+        uint64_t counter = first_counter + lane;
+        memcpy(words[lane], block_words, sizeof(words[lane]));
+        words[lane][counter_word] = (uint32_t)(counter >> 32);
+        words[lane][counter_word + 1] = (uint32_t)counter;
+    }
+    // The SHA instructions keep the state as ABEF and CDGH rather than ABCD
+    // and EFGH.
+    __m128i cdab = _mm_shuffle_epi32(
+        _mm_loadu_si128((const __m128i *)&state[0]), 0xb1);
+    __m128i efgh = _mm_shuffle_epi32(
+        _mm_loadu_si128((const __m128i *)&state[4]), 0x1b);
+    __m128i abef_saved = _mm_alignr_epi8(cdab, efgh, 8);
+    __m128i cdgh_saved = _mm_blend_epi16(efgh, cdab, 0xf0);
+    __m128i abef[2] = {abef_saved, abef_saved};
+    __m128i cdgh[2] = {cdgh_saved, cdgh_saved};
+    __m128i w[2][4];
+    for (size_t group = 0; group < 16; group++) {
+        size_t current = group % 4;
+        __m128i round_constants = _mm_loadu_si128(
+            (const __m128i *)&SHA_256_ROUND_CONSTANTS[4 * group]);
+        for (size_t lane = 0; lane < 2; lane++) {
+            if (group < 4) {
+                w[lane][current] = _mm_loadu_si128(
+                    (const __m128i *)&words[lane][4 * group]);
+            } else {
+                __m128i w7 = _mm_alignr_epi8(
+                    w[lane][(current + 3) % 4], w[lane][(current + 2) % 4], 4);
+                w[lane][current] = _mm_sha256msg2_epu32(
+                    _mm_add_epi32(
+                        _mm_sha256msg1_epu32(
+                            w[lane][current], w[lane][(current + 1) % 4]),
+                        w7),
+                    w[lane][(current + 3) % 4]);
+            }
+            __m128i message = _mm_add_epi32(w[lane][current], round_constants);
+            cdgh[lane] = _mm_sha256rnds2_epu32(cdgh[lane], abef[lane], message);
+            message = _mm_shuffle_epi32(message, 0x0e);
+            abef[lane] = _mm_sha256rnds2_epu32(abef[lane], cdgh[lane], message);
+        }
+    }
+    for (size_t lane = 0; lane < 2; lane++) {
+        __m128i feba = _mm_shuffle_epi32(
+            _mm_add_epi32(abef[lane], abef_saved), 0x1b);
+        __m128i dchg = _mm_shuffle_epi32(
+            _mm_add_epi32(cdgh[lane], cdgh_saved), 0xb1);
+        uint32_t lane_state[8];
+        _mm_storeu_si128(
+            (__m128i *)&lane_state[0], _mm_blend_epi16(feba, dchg, 0xf0));
+        _mm_storeu_si128(
+            (__m128i *)&lane_state[4], _mm_alignr_epi8(dchg, feba, 8));
+        for (size_t idx = 0; idx < 8; idx++) {
+            output_states[idx * 2 + lane] = lane_state[idx];
+        }
+    }
+}
+
+#endif  // HASH_BATCH_X86_KERNELS
+
+static const hash_batch_kernel_t HASH_BATCH_KERNELS[] = {
+#ifdef HASH_BATCH_X86_KERNELS
+    {"avx512", 16, _hash_batch_avx512_is_supported, _hash_batch_avx512},
+    {"avx2", 8, _hash_batch_avx2_is_supported, _hash_batch_avx2},
+    {"sse4.1", 4, _hash_batch_sse41_is_supported, _hash_batch_sse41},
+    {"sha-ni", 2, _hash_batch_sha_ni_is_supported, _hash_batch_sha_ni},
+#endif
+    {"scalar", 1, _hash_batch_scalar_is_supported, _hash_batch_scalar},
+};
+
+return_code_t hash_batch_get_kernels(
+    const hash_batch_kernel_t **kernels,
+    size_t *num_kernels
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == kernels || NULL == num_kernels) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    *kernels = HASH_BATCH_KERNELS;
+    *num_kernels = sizeof(HASH_BATCH_KERNELS) / sizeof(HASH_BATCH_KERNELS[0]);
+end:
+    return return_code;
+}
+
+static const hash_batch_kernel_t *best_kernel = NULL;
+static pthread_once_t best_kernel_once = PTHREAD_ONCE_INIT;
+
+double _hash_batch_measure_kernel(const hash_batch_kernel_t *kernel) {
+    uint32_t state[8] = {0};
+    uint32_t block_words[16] = {0};
+    uint32_t output_states[8 * HASH_BATCH_MAX_LANES];
+    double best_rate = 0;
+    for (size_t trial = 0; trial < HASH_BATCH_CALIBRATION_TRIALS; trial++) {
+        struct timespec start_time = {0};
+        struct timespec end_time = {0};
+        clock_gettime(CLOCK_MONOTONIC, &start_time);
+        uint64_t counter = 0;
+        while (counter < HASH_BATCH_CALIBRATION_HASHES) {
+            kernel->function(
+                state, block_words, 0, counter, output_states);
+            counter += kernel->num_lanes;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end_time);
+        double elapsed = (double)(end_time.tv_sec - start_time.tv_sec) +
+            (double)(end_time.tv_nsec - start_time.tv_nsec) / 1e9;
+        double rate = (double)counter / (elapsed > 0 ? elapsed : 1e-9);
+        if (rate > best_rate) {
+            best_rate = rate;
+        }
+    }
+    return best_rate;
+}
+
+void _hash_batch_select_best_kernel(void) {
+    // More lanes do not always mean more hashes. On some CPUs the SHA
+    // extensions outrun every software kernel, and on others a wide vector
+    // kernel outruns the SHA extensions, so time each supported kernel.
+    size_t num_kernels =
+        sizeof(HASH_BATCH_KERNELS) / sizeof(HASH_BATCH_KERNELS[0]);
+    double best_rate = 0;
+    for (size_t idx = 0; idx < num_kernels; idx++) {
+        const hash_batch_kernel_t *kernel = &HASH_BATCH_KERNELS[idx];
+        if (!kernel->is_supported()) {
+            continue;
+        }
+        double rate = _hash_batch_measure_kernel(kernel);
+        if (NULL == best_kernel || rate > best_rate) {
+            best_kernel = kernel;
+            best_rate = rate;
+        }
+    }
+}
+
+return_code_t hash_batch_get_best_kernel(const hash_batch_kernel_t **kernel) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == kernel) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    // The scalar kernel is always supported, so there is always a best kernel.
+    pthread_once(&best_kernel_once, _hash_batch_select_best_kernel);
+    *kernel = best_kernel;
+end:
+    return return_code;
+}
+
+return_code_t hash_batch_finalize(
+    const hash_batch_kernel_t *kernel,
+    const sha_256_midstate_t *midstate,
+    const unsigned char *final_block,
+    size_t counter_offset,
+    uint64_t first_counter,
+    sha_256_t *hashes
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == kernel ||
+        NULL == midstate ||
+        NULL == final_block ||
+        NULL == hashes ||
+        0 != counter_offset % sizeof(uint32_t) ||
+        counter_offset + sizeof(uint64_t) > SHA_256_BLOCK_LENGTH ||
+        kernel->num_lanes > HASH_BATCH_MAX_LANES) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    uint32_t block_words[16];
+    for (size_t idx = 0; idx < 16; idx++) {
+        block_words[idx] = (uint32_t)final_block[4 * idx] << 24 |
+            (uint32_t)final_block[4 * idx + 1] << 16 |
+            (uint32_t)final_block[4 * idx + 2] << 8 |
+            (uint32_t)final_block[4 * idx + 3];
+    }
+    uint32_t output_states[8 * HASH_BATCH_MAX_LANES];
+    kernel->function(
+        midstate->state,
+        block_words,
+        counter_offset / sizeof(uint32_t),
+        first_counter,
+        output_states);
+    for (size_t lane = 0; lane < kernel->num_lanes; lane++) {
+        for (size_t idx = 0; idx < 8; idx++) {
+            uint32_t word = output_states[idx * kernel->num_lanes + lane];
+            hashes[lane].digest[4 * idx] = (unsigned char)(word >> 24);
+            hashes[lane].digest[4 * idx + 1] = (unsigned char)(word >> 16);
+            hashes[lane].digest[4 * idx + 2] = (unsigned char)(word >> 8);
+            hashes[lane].digest[4 * idx + 3] = (unsigned char)word;
+        }
+    }
+end:
+    return return_code;
+}
@@ -0,0 +1,150 @@
+#include <stdlib.h>
+#include <string.h>
+#include "include/key_table.h"
+
+size_t _key_table_find_bucket(
+    size_t *buckets,
+    size_t num_buckets,
+    public_key_t **keys,
+    sha_256_t *id
+) {
+    size_t bucket_idx = hash_bucket_index(id, num_buckets);
+    // The table is at most half full, so probing always reaches an empty
+    // bucket.
+    while (0 != buckets[bucket_idx] &&
+        0 != memcmp(
+            keys[buckets[bucket_idx] - 1]->id.digest,
+            id->digest,
+            sizeof(id->digest))) {
+        bucket_idx = (bucket_idx + 1) & (num_buckets - 1);
+    }
+    return bucket_idx;
+}
+
+return_code_t _key_table_grow(key_table_t *table) {
+    return_code_t return_code = SUCCESS;
+    size_t capacity = 2 * table->capacity;
+    size_t num_buckets = 2 * table->num_buckets;
+    public_key_t **keys = realloc(table->keys, capacity * sizeof(*keys));
+    if (NULL == keys) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    table->keys = keys;
+    size_t *buckets = calloc(num_buckets, sizeof(size_t));
+    if (NULL == buckets) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    for (size_t key_idx = 0; key_idx < table->num_keys; key_idx++) {
+        size_t bucket_idx = _key_table_find_bucket(
+            buckets, num_buckets, keys, &keys[key_idx]->id);
+        buckets[bucket_idx] = key_idx + 1;
+    }
+    free(table->buckets);
+    table->capacity = capacity;
+    table->num_buckets = num_buckets;
+    table->buckets = buckets;
+end:
+    return return_code;
+}
+
+return_code_t key_table_create(key_table_t **table) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == table) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    key_table_t *new_table = calloc(1, sizeof(key_table_t));
+    if (NULL == new_table) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    new_table->capacity = KEY_TABLE_INITIAL_CAPACITY;
+    new_table->num_buckets = 2 * KEY_TABLE_INITIAL_CAPACITY;
+    new_table->keys = malloc(new_table->capacity * sizeof(public_key_t *));
+    new_table->buckets = calloc(new_table->num_buckets, sizeof(size_t));
+    if (NULL == new_table->keys || NULL == new_table->buckets) {
+        free(new_table->keys);
+        free(new_table->buckets);
+        free(new_table);
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    *table = new_table;
+end:
+    return return_code;
+}
+
+return_code_t key_table_destroy(key_table_t *table) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == table) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    for (size_t idx = 0; idx < table->num_keys; idx++) {
+        public_key_release(table->keys[idx]);
+    }
+    free(table->keys);
+    free(table->buckets);
+    free(table);
+end:
+    return return_code;
+}
+
+return_code_t key_table_intern(
+    key_table_t *table,
+    public_key_t *public_key,
+    public_key_t **interned_key
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == table || NULL == public_key || NULL == interned_key) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    size_t bucket_idx = _key_table_find_bucket(
+        table->buckets, table->num_buckets, table->keys, &public_key->id);
+    if (0 == table->buckets[bucket_idx]) {
+        if (table->num_keys == table->capacity) {
+            return_code = _key_table_grow(table);
+            if (SUCCESS != return_code) {
+                goto end;
+            }
+            bucket_idx = _key_table_find_bucket(
+                table->buckets,
+                table->num_buckets,
+                table->keys,
+                &public_key->id);
+        }
+        public_key_retain(public_key);
+        table->keys[table->num_keys] = public_key;
+        table->num_keys++;
+        table->buckets[bucket_idx] = table->num_keys;
+    }
+    public_key_t *table_key = table->keys[table->buckets[bucket_idx] - 1];
+    public_key_retain(table_key);
+    *interned_key = table_key;
+end:
+    return return_code;
+}
+
+return_code_t key_table_find(
+    key_table_t *table,
+    sha_256_t *id,
+    public_key_t **public_key,
+    bool *is_found
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == table || NULL == id || NULL == public_key || NULL == is_found) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    size_t bucket_idx = _key_table_find_bucket(
+        table->buckets, table->num_buckets, table->keys, id);
+    *is_found = 0 != table->buckets[bucket_idx];
+    if (*is_found) {
+        *public_key = table->keys[table->buckets[bucket_idx] - 1];
+    }
+end:
+    return return_code;
+}
@@ -0,0 +1,197 @@
+#include <stdlib.h>
+#include <string.h>
+#include "include/lru_cache.h"
+
+lru_cache_entry_t *_lru_cache_find(lru_cache_t *cache, sha_256_t *key) {
+    lru_cache_entry_t *entry =
+        cache->buckets[hash_bucket_index(key, cache->num_buckets)];
+    while (NULL != entry &&
+        0 != memcmp(entry->key.digest, key->digest, sizeof(key->digest))) {
+        entry = entry->next_in_bucket;
+    }
+    return entry;
+}
+
+void _lru_cache_unlink(lru_cache_t *cache, lru_cache_entry_t *entry) {
+    if (NULL == entry->newer) {
+        cache->newest = entry->older;
+    } else {
+        entry->newer->older = entry->older;
+    }
+    if (NULL == entry->older) {
+        cache->oldest = entry->newer;
+    } else {
+        entry->older->newer = entry->newer;
+    }
+    entry->newer = NULL;
+    entry->older = NULL;
+}
+
+void _lru_cache_link_newest(lru_cache_t *cache, lru_cache_entry_t *entry) {
+    entry->newer = NULL;
+    entry->older = cache->newest;
+    if (NULL == cache->newest) {
+        cache->oldest = entry;
+    } else {
+        cache->newest->newer = entry;
+    }
+    cache->newest = entry;
+}
+
+void _lru_cache_free_value(lru_cache_t *cache, void *value) {
+    if (NULL != cache->free_function && NULL != value) {
+        cache->free_function(value);
+    }
+}
+
+void _lru_cache_evict_oldest(lru_cache_t *cache) {
+    lru_cache_entry_t *entry = cache->oldest;
+    _lru_cache_unlink(cache, entry);
+    lru_cache_entry_t **link =
+        &cache->buckets[hash_bucket_index(&entry->key, cache->num_buckets)];
+    while (*link != entry) {
+        link = &(*link)->next_in_bucket;
+    }
+    *link = entry->next_in_bucket;
+    _lru_cache_free_value(cache, entry->value);
+    free(entry);
+    cache->num_entries--;
+}
+
+return_code_t lru_cache_create(
+    lru_cache_t **cache,
+    size_t capacity,
+    free_function_t *free_function,
+    retain_function_t *retain_function
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == cache || 0 == capacity) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    lru_cache_t *new_cache = calloc(1, sizeof(lru_cache_t));
+    if (NULL == new_cache) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    // Keep the load factor at or below one half so chains stay short.
+    size_t num_buckets = 1;
+    while (num_buckets < 2 * capacity) {
+        num_buckets *= 2;
+    }
+    new_cache->buckets = calloc(num_buckets, sizeof(lru_cache_entry_t *));
+    if (NULL == new_cache->buckets) {
+        free(new_cache);
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    if (0 != pthread_mutex_init(&new_cache->mutex, NULL)) {
+        free(new_cache->buckets);
+        free(new_cache);
+        return_code = FAILURE_PTHREAD_FUNCTION;
+        goto end;
+    }
+    new_cache->capacity = capacity;
+    new_cache->num_buckets = num_buckets;
+    new_cache->free_function = free_function;
+    new_cache->retain_function = retain_function;
+    *cache = new_cache;
+end:
+    return return_code;
+}
+
+return_code_t lru_cache_destroy(lru_cache_t *cache) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == cache) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    lru_cache_entry_t *entry = cache->newest;
+    while (NULL != entry) {
+        lru_cache_entry_t *older = entry->older;
+        _lru_cache_free_value(cache, entry->value);
+        free(entry);
+        entry = older;
+    }
+    pthread_mutex_destroy(&cache->mutex);
+    free(cache->buckets);
+    free(cache);
+end:
+    return return_code;
+}
+
+return_code_t lru_cache_get(
+    lru_cache_t *cache,
+    sha_256_t *key,
+    void **value,
+    bool *is_found
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == cache || NULL == key || NULL == is_found) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    if (0 != pthread_mutex_lock(&cache->mutex)) {
+        return_code = FAILURE_PTHREAD_FUNCTION;
+        goto end;
+    }
+    lru_cache_entry_t *entry = _lru_cache_find(cache, key);
+    if (NULL != entry) {
+        _lru_cache_unlink(cache, entry);
+        _lru_cache_link_newest(cache, entry);
+        if (NULL != value) {
+            if (NULL != cache->retain_function && NULL != entry->value) {
+                cache->retain_function(entry->value);
+            }
+            *value = entry->value;
+        }
+    }
+    *is_found = NULL != entry;
+    pthread_mutex_unlock(&cache->mutex);
+end:
+    return return_code;
+}
+
+return_code_t lru_cache_put(lru_cache_t *cache, sha_256_t *key, void *value) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == cache || NULL == key) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    // Allocate outside the lock; a concurrent put of the same key wastes the
+    // allocation but never blocks other threads on malloc.
+    lru_cache_entry_t *new_entry = calloc(1, sizeof(lru_cache_entry_t));
+    if (NULL == new_entry) {
+        _lru_cache_free_value(cache, value);
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    new_entry->key = *key;
+    new_entry->value = value;
+    if (0 != pthread_mutex_lock(&cache->mutex)) {
+        _lru_cache_free_value(cache, value);
+        free(new_entry);
+        return_code = FAILURE_PTHREAD_FUNCTION;
+        goto end;
+    }
+    lru_cache_entry_t *entry = _lru_cache_find(cache, key);
+    if (NULL != entry) {
+        _lru_cache_unlink(cache, entry);
+        _lru_cache_link_newest(cache, entry);
+        pthread_mutex_unlock(&cache->mutex);
+        _lru_cache_free_value(cache, value);
+        free(new_entry);
+        goto end;
+    }
+    if (cache->num_entries == cache->capacity) {
+        _lru_cache_evict_oldest(cache);
+    }
+    size_t bucket_index = hash_bucket_index(key, cache->num_buckets);
+    new_entry->next_in_bucket = cache->buckets[bucket_index];
+    cache->buckets[bucket_index] = new_entry;
+    _lru_cache_link_newest(cache, new_entry);
+    cache->num_entries++;
+    pthread_mutex_unlock(&cache->mutex);
+end:
+    return return_code;
+}
@@ -2,6 +2,9 @@
  * @brief Runs the app.
  */
 
+#include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -11,12 +14,15 @@
 #include "include/base64.h"
 #include "include/blockchain.h"
 #include "include/block.h"
+#include "include/hash.h"
+#include "include/hash_batch.h"
 #include "include/miner.h"
 #include "include/transaction.h"
 
 #define NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH 3
 #define PRIVATE_KEY_ENVIRONMENT_VARIABLE "LEOCOIN_PRIVATE_KEY"
 #define PUBLIC_KEY_ENVIRONMENT_VARIABLE "LEOCOIN_PUBLIC_KEY"
+#define MAX_NUM_MINING_THREADS 1024
 
 void print_usage_statement(char *program_name) {
     if (NULL == program_name) {
@@ -26,7 +32,9 @@ void print_usage_statement(char *program_name) {
         stderr,
         "Usage: %s "
         "-p <private_key_file_base64_encoded_contents> "
-        "-k <public_key_file_base64_encoded_contents>\n",
+        "-k <public_key_file_base64_encoded_contents> "
+        "[-t <num_mining_threads>] "
+        "[-s <num_blocks_between_syncs> | -i <milliseconds_between_syncs>]\n",
         program_name);
     fprintf(
         stderr,
@@ -36,14 +44,43 @@ void print_usage_statement(char *program_name) {
 end:
 }
 
+return_code_t parse_unsigned_integer(
+    char *string,
+    uint64_t max_value,
+    uint64_t *value
+) {
+    return_code_t return_code = SUCCESS;
+    // strtoull skips leading whitespace and negates a leading minus sign, so
+    // only accept strings that start with a digit.
+    if (!isdigit((unsigned char)string[0])) {
+        return_code = FAILURE_INVALID_COMMAND_LINE_ARGS;
+        goto end;
+    }
+    char *end_of_number = NULL;
+    errno = 0;
+    unsigned long long parsed_value = strtoull(string, &end_of_number, 10);
+    if (ERANGE == errno || '\0' != *end_of_number ||
+        parsed_value > max_value) {
+        return_code = FAILURE_INVALID_COMMAND_LINE_ARGS;
+        goto end;
+    }
+    *value = parsed_value;
+end:
+    return return_code;
+}
+
 int main(int argc, char **argv) {
     return_code_t return_code = SUCCESS;
     blockchain_t *blockchain = NULL;
     block_t *genesis_block = NULL;
     char *ssh_private_key_contents_base64 = NULL;
     char *ssh_public_key_contents_base64 = NULL;
+    // Zero means one mining thread per online processor.
+    size_t num_mining_threads = 0;
+    // By default, sync every saved block to disk.
+    blockchain_sync_policy_t sync_policy = {0};
     int opt;
-    while ((opt = getopt(argc, argv, "p:k:")) != -1) {
+    while ((opt = getopt(argc, argv, "p:k:t:s:i:")) != -1) {
         switch (opt) {
             case 'p':
                 printf("Using private key from argv\n");
@@ -53,12 +90,62 @@ int main(int argc, char **argv) {
                 printf("Using public key from argv\n");
                 ssh_public_key_contents_base64 = optarg;
                 break;
+            case 't': {
+                uint64_t parsed_num_mining_threads = 0;
+                return_code = parse_unsigned_integer(
+                    optarg, MAX_NUM_MINING_THREADS, &parsed_num_mining_threads);
+                if (SUCCESS != return_code) {
+                    print_usage_statement(argv[0]);
+                    goto end;
+                }
+                num_mining_threads = parsed_num_mining_threads;
+                printf("Using %zu mining threads\n", num_mining_threads);
+                break;
+            }
+            case 's':
+                sync_policy.mode = BLOCKCHAIN_SYNC_EVERY_NUM_BLOCKS;
+                return_code = parse_unsigned_integer(
+                    optarg, UINT64_MAX, &sync_policy.num_blocks_between_syncs);
+                if (SUCCESS != return_code) {
+                    print_usage_statement(argv[0]);
+                    goto end;
+                }
+                printf(
+                    "Syncing every %"PRIu64" blocks\n",
+                    sync_policy.num_blocks_between_syncs);
+                break;
+            case 'i':
+                sync_policy.mode = BLOCKCHAIN_SYNC_EVERY_INTERVAL;
+                return_code = parse_unsigned_integer(
+                    optarg,
+                    UINT64_MAX,
+                    &sync_policy.milliseconds_between_syncs);
+                if (SUCCESS != return_code) {
+                    print_usage_statement(argv[0]);
+                    goto end;
+                }
+                printf(
+                    "Syncing every %"PRIu64" milliseconds\n",
+                    sync_policy.milliseconds_between_syncs);
+                break;
             default:
                 print_usage_statement(argv[0]);
                 return_code = FAILURE_INVALID_COMMAND_LINE_ARGS;
                 goto end;
         }
     }
+    const hash_backend_t *hash_backend = NULL;
+    return_code = hash_get_backend(&hash_backend);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    printf("Using %s hash backend\n", hash_backend->name);
+    const hash_batch_kernel_t *hash_batch_kernel = NULL;
+    return_code = hash_batch_get_best_kernel(&hash_batch_kernel);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    printf("Using %s mining kernel\n", hash_batch_kernel->name);
     if (NULL == ssh_private_key_contents_base64) {
         printf(
             "No private key found in argv, searching env for %s\n",
@@ -139,7 +226,9 @@ int main(int argc, char **argv) {
     args.miner_public_key = &miner_public_key;
     args.miner_private_key = &miner_private_key;
     args.print_progress = true;
+    args.num_threads = num_mining_threads;
     args.outfile = "blockchain.bin";
+    args.outfile_sync_policy = sync_policy;
     args.should_stop = &should_stop;
     bool exit_ready = false;
     args.exit_ready = &exit_ready;
@@ -172,5 +261,6 @@ int main(int argc, char **argv) {
     pthread_mutex_destroy(&args.sync_version_currently_mined_mutex);
     synchronized_blockchain_destroy(sync);
 end:
+    mining_pools_destroy_shared();
     return return_code;
 }
@@ -5,10 +5,30 @@
 
 return_code_t *mine_blocks(mine_blocks_args_t *args) {
     return_code_t return_code = SUCCESS;
+    mining_pool_t *pool = NULL;
+    transaction_signer_t *signer = NULL;
+    public_key_t *miner_public_key = NULL;
     if (NULL == args) {
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
+    // Keep the mining workers alive across blocks and chain switches so that
+    // starting on a new block never waits for thread creation.
+    return_code = mining_pool_create(&pool, args->num_threads);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    // Parse the miner's private key once rather than for every minting
+    // transaction, and let every minting transaction share one public key.
+    return_code = transaction_signer_create(&signer, args->miner_private_key);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    return_code = transaction_public_key_create(
+        &miner_public_key, args->miner_public_key, TRANSACTION_VERSION_RSA);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
     synchronized_blockchain_t *sync = args->sync;
     if (0 != pthread_mutex_lock(&sync->mutex)) {
         return_code = FAILURE_PTHREAD_FUNCTION;
@@ -53,7 +73,9 @@ return_code_t *mine_blocks(mine_blocks_args_t *args) {
         }
         bool is_valid_blockchain = false;
         block_t *first_invalid_block = NULL;
-        return_code = blockchain_verify(
+        // Only the blocks added since the last iteration need checking. After a
+        // switch to a new blockchain, this verifies the whole new chain once.
+        return_code = blockchain_verify_incremental(
             blockchain, &is_valid_blockchain, &first_invalid_block);
         if (SUCCESS != return_code) {
             goto end;
@@ -82,17 +104,18 @@ return_code_t *mine_blocks(mine_blocks_args_t *args) {
             goto end;
         }
         linked_list_t *transaction_list = NULL;
-        return_code = linked_list_create(&transaction_list, free, NULL);
+        return_code = linked_list_create(
+            &transaction_list, (free_function_t *)transaction_destroy, NULL);
         if (SUCCESS != return_code) {
             goto end;
         }
         transaction_t *mint_coin_transaction = NULL;
-        return_code = transaction_create(
+        return_code = transaction_create_with_signer(
             &mint_coin_transaction,
-            args->miner_public_key,
-            args->miner_public_key,
+            miner_public_key,
+            miner_public_key,
             AMOUNT_GENERATED_DURING_MINTING,
-            args->miner_private_key);
+            signer);
         if (SUCCESS != return_code) {
             linked_list_destroy(transaction_list);
             goto end;
@@ -111,12 +134,13 @@ return_code_t *mine_blocks(mine_blocks_args_t *args) {
             linked_list_destroy(transaction_list);
             goto end;
         }
-        return_code = synchronized_blockchain_mine_block(
+        return_code = synchronized_blockchain_mine_block_with_pool(
             sync,
             next_block,
             args->print_progress,
             args->should_stop,
-            args->sync_version_currently_mined);
+            args->sync_version_currently_mined,
+            pool);
         if (SUCCESS != return_code) {
             block_destroy(next_block);
             if (FAILURE_COULD_NOT_FIND_VALID_PROOF_OF_WORK == return_code) {
@@ -147,7 +171,8 @@ return_code_t *mine_blocks(mine_blocks_args_t *args) {
                 blockchain_print(blockchain);
             }
             if (NULL != args->outfile) {
-                blockchain_write_to_file(blockchain, args->outfile);
+                blockchain_write_to_file_with_sync_policy(
+                    blockchain, args->outfile, args->outfile_sync_policy);
             }
         }
     }
@@ -156,6 +181,15 @@ return_code_t *mine_blocks(mine_blocks_args_t *args) {
     pthread_cond_signal(&args->exit_ready_cond);
     pthread_mutex_unlock(&args->exit_ready_mutex);
 end:
+    if (NULL != pool) {
+        mining_pool_destroy(pool);
+    }
+    if (NULL != signer) {
+        transaction_signer_destroy(signer);
+    }
+    if (NULL != miner_public_key) {
+        public_key_release(miner_public_key);
+    }
     return_code_t *return_code_ptr = malloc(sizeof(return_code_t));
     *return_code_ptr = return_code;
     return return_code_ptr;
@@ -0,0 +1,76 @@
+#include <stdlib.h>
+#include <string.h>
+#include "include/public_key.h"
+
+return_code_t public_key_create(
+    public_key_t **public_key,
+    const unsigned char *bytes,
+    size_t length
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == public_key || (NULL == bytes && 0 != length)) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    public_key_t *new_public_key = malloc(sizeof(public_key_t) + length);
+    if (NULL == new_public_key) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    atomic_init(&new_public_key->num_references, 1);
+    new_public_key->length = length;
+    if (0 != length) {
+        memcpy(new_public_key->bytes, bytes, length);
+    }
+    return_code = hash_sha_256(
+        new_public_key->bytes, length, &new_public_key->id);
+    if (SUCCESS != return_code) {
+        free(new_public_key);
+        goto end;
+    }
+    *public_key = new_public_key;
+end:
+    return return_code;
+}
+
+return_code_t public_key_retain(public_key_t *public_key) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == public_key) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    atomic_fetch_add(&public_key->num_references, 1);
+end:
+    return return_code;
+}
+
+return_code_t public_key_release(public_key_t *public_key) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == public_key) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    if (1 == atomic_fetch_sub(&public_key->num_references, 1)) {
+        free(public_key);
+    }
+end:
+    return return_code;
+}
+
+return_code_t public_key_equals(
+    public_key_t *public_key1,
+    public_key_t *public_key2,
+    bool *is_equal
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == public_key1 || NULL == public_key2 || NULL == is_equal) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    *is_equal = public_key1 == public_key2 ||
+        (public_key1->length == public_key2->length &&
+        0 == memcmp(
+            &public_key1->id, &public_key2->id, sizeof(public_key1->id)));
+end:
+    return return_code;
+}
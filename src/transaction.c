@@ -6,8 +6,149 @@
 #include <openssl/rsa.h>
 #include <openssl/pem.h>
 #include <openssl/bio.h>
+#include "include/endian.h"
+#include "include/lru_cache.h"
 #include "include/transaction.h"
 
+static lru_cache_t *public_key_cache = NULL;
+static return_code_t public_key_cache_init_return_code = SUCCESS;
+static pthread_once_t public_key_cache_once = PTHREAD_ONCE_INIT;
+
+void _transaction_write_le64(unsigned char *buffer, uint64_t data) {
+    for (size_t idx = 0; idx < sizeof(uint64_t); idx++) {
+        buffer[idx] = (unsigned char)(data >> (8 * idx));
+    }
+}
+
+size_t _transaction_key_length(public_key_t *public_key) {
+    return NULL == public_key ? 0 : public_key->length;
+}
+
+bool _transaction_is_canonical_rsa_key(public_key_t *public_key) {
+    return NULL == public_key ||
+        0 == public_key->length ||
+        0 != public_key->bytes[public_key->length - 1];
+}
+
+bool _transaction_has_valid_keys(transaction_t *transaction) {
+    size_t sender_length = _transaction_key_length(
+        transaction->sender_public_key);
+    size_t recipient_length = _transaction_key_length(
+        transaction->recipient_public_key);
+    if (TRANSACTION_VERSION_ED25519 == transaction->version) {
+        return ED25519_KEY_LENGTH == sender_length &&
+            ED25519_KEY_LENGTH == recipient_length;
+    }
+    return sender_length <= MAX_SSH_KEY_LENGTH &&
+        recipient_length <= MAX_SSH_KEY_LENGTH &&
+        _transaction_is_canonical_rsa_key(transaction->sender_public_key) &&
+        _transaction_is_canonical_rsa_key(transaction->recipient_public_key);
+}
+
+bool _transaction_is_zero(unsigned char *bytes, size_t length) {
+    for (size_t idx = 0; idx < length; idx++) {
+        if (0 != bytes[idx]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void _transaction_rsa_message(
+    transaction_t *transaction,
+    unsigned char *message
+) {
+    // This is the memory layout that transaction_t had when it stored keys in
+    // fixed-size buffers on little endian hosts, which is what RSA signatures
+    // have always covered.
+    memset(message, 0, TRANSACTION_RSA_MESSAGE_LENGTH);
+    unsigned char *next_spot_in_message = message;
+    _transaction_write_le64(next_spot_in_message, transaction->created_at);
+    next_spot_in_message += sizeof(uint64_t);
+    if (NULL != transaction->sender_public_key) {
+        memcpy(
+            next_spot_in_message,
+            transaction->sender_public_key->bytes,
+            transaction->sender_public_key->length);
+    }
+    next_spot_in_message += MAX_SSH_KEY_LENGTH;
+    if (NULL != transaction->recipient_public_key) {
+        memcpy(
+            next_spot_in_message,
+            transaction->recipient_public_key->bytes,
+            transaction->recipient_public_key->length);
+    }
+    next_spot_in_message += MAX_SSH_KEY_LENGTH;
+    _transaction_write_le64(next_spot_in_message, transaction->amount);
+}
+
+void _transaction_ed25519_message(
+    transaction_t *transaction,
+    unsigned char *message
+) {
+    unsigned char *next_spot_in_message = message;
+    *(uint64_t *)next_spot_in_message = htobe64(transaction->version);
+    next_spot_in_message += sizeof(uint64_t);
+    *(uint64_t *)next_spot_in_message = htobe64(transaction->created_at);
+    next_spot_in_message += sizeof(uint64_t);
+    memcpy(
+        next_spot_in_message,
+        transaction->sender_public_key->bytes,
+        ED25519_KEY_LENGTH);
+    next_spot_in_message += ED25519_KEY_LENGTH;
+    memcpy(
+        next_spot_in_message,
+        transaction->recipient_public_key->bytes,
+        ED25519_KEY_LENGTH);
+    next_spot_in_message += ED25519_KEY_LENGTH;
+    *(uint64_t *)next_spot_in_message = htobe64(transaction->amount);
+}
+
+return_code_t transaction_public_key_create(
+    public_key_t **public_key,
+    ssh_key_t *ssh_key,
+    uint64_t version
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == public_key || NULL == ssh_key) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    // PEM keys are strings padded with zeros, and the padding was never part of
+    // the key. Raw Ed25519 keys may end in zero bytes, so they keep their
+    // fixed length.
+    size_t length = ED25519_KEY_LENGTH;
+    if (TRANSACTION_VERSION_ED25519 != version) {
+        length = MAX_SSH_KEY_LENGTH;
+        while (length > 0 && 0 == ssh_key->bytes[length - 1]) {
+            length--;
+        }
+    }
+    return_code = public_key_create(
+        public_key, (unsigned char *)ssh_key->bytes, length);
+end:
+    return return_code;
+}
+
+return_code_t transaction_has_canonical_keys(
+    transaction_t *transaction,
+    bool *has_canonical_keys
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == transaction || NULL == has_canonical_keys) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    *has_canonical_keys =
+        TRANSACTION_VERSION_ED25519 == transaction->version || (
+            _transaction_is_canonical_rsa_key(
+                transaction->sender_public_key) &&
+            _transaction_is_canonical_rsa_key(
+                transaction->recipient_public_key));
+end:
+    return return_code;
+}
+
 return_code_t transaction_create(
     transaction_t **transaction,
     ssh_key_t *sender_public_key,
@@ -23,26 +164,76 @@ return_code_t transaction_create(
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
+    public_key_t *sender_key = NULL;
+    public_key_t *recipient_key = NULL;
+    transaction_signer_t *signer = NULL;
+    return_code = transaction_public_key_create(
+        &sender_key, sender_public_key, TRANSACTION_VERSION_RSA);
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    return_code = transaction_public_key_create(
+        &recipient_key, recipient_public_key, TRANSACTION_VERSION_RSA);
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    return_code = transaction_signer_create(&signer, sender_private_key);
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    return_code = transaction_create_with_signer(
+        transaction,
+        sender_key,
+        recipient_key,
+        amount,
+        signer);
+cleanup:
+    if (NULL != signer) {
+        transaction_signer_destroy(signer);
+    }
+    if (NULL != recipient_key) {
+        public_key_release(recipient_key);
+    }
+    if (NULL != sender_key) {
+        public_key_release(sender_key);
+    }
+end:
+    return return_code;
+}
+
+return_code_t transaction_create_with_signer(
+    transaction_t **transaction,
+    public_key_t *sender_public_key,
+    public_key_t *recipient_public_key,
+    uint64_t amount,
+    transaction_signer_t *signer
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == transaction ||
+        NULL == sender_public_key ||
+        NULL == recipient_public_key ||
+        NULL == signer) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
     transaction_t *new_transaction = calloc(1, sizeof(transaction_t));
     if (NULL == new_transaction) {
         return_code = FAILURE_COULD_NOT_MALLOC;
         goto end;
     }
     new_transaction->created_at = time(NULL);
-    memcpy(
-        &new_transaction->sender_public_key,
-        sender_public_key,
-        MAX_SSH_KEY_LENGTH);
-    memcpy(
-        &new_transaction->recipient_public_key,
-        recipient_public_key,
-        MAX_SSH_KEY_LENGTH);
+    public_key_retain(sender_public_key);
+    new_transaction->sender_public_key = sender_public_key;
+    public_key_retain(recipient_public_key);
+    new_transaction->recipient_public_key = recipient_public_key;
     new_transaction->amount = amount;
-    return_code = transaction_generate_signature(
+    new_transaction->version = signer->version;
+    return_code = transaction_signer_sign(
         &new_transaction->sender_signature,
         new_transaction,
-        sender_private_key);
+        signer);
     if (SUCCESS != return_code) {
+        transaction_destroy(new_transaction);
         goto end;
     }
     *transaction = new_transaction;
@@ -56,132 +247,425 @@ return_code_t transaction_destroy(transaction_t *transaction) {
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
+    if (NULL != transaction->sender_public_key) {
+        public_key_release(transaction->sender_public_key);
+    }
+    if (NULL != transaction->recipient_public_key) {
+        public_key_release(transaction->recipient_public_key);
+    }
     free(transaction);
 end:
     return return_code;
 }
 
-return_code_t transaction_generate_signature(
-    ssh_signature_t *signature,
-    transaction_t *transaction,
-    ssh_key_t *sender_private_key
+return_code_t transaction_copy(
+    transaction_t **copy,
+    transaction_t *transaction
 ) {
     return_code_t return_code = SUCCESS;
-    if (NULL == signature ||
-        NULL == transaction ||
-        NULL == sender_private_key) {
+    if (NULL == copy || NULL == transaction) {
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
-    BIO *mem_bio = BIO_new_mem_buf(
-        sender_private_key->bytes, MAX_SSH_KEY_LENGTH);
+    transaction_t *new_transaction = malloc(sizeof(transaction_t));
+    if (NULL == new_transaction) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    *new_transaction = *transaction;
+    if (NULL != new_transaction->sender_public_key) {
+        public_key_retain(new_transaction->sender_public_key);
+    }
+    if (NULL != new_transaction->recipient_public_key) {
+        public_key_retain(new_transaction->recipient_public_key);
+    }
+    *copy = new_transaction;
+end:
+    return return_code;
+}
+
+return_code_t transaction_signer_create(
+    transaction_signer_t **signer,
+    ssh_key_t *private_key
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == signer || NULL == private_key) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    BIO *mem_bio = BIO_new_mem_buf(private_key->bytes, MAX_SSH_KEY_LENGTH);
     if (!mem_bio) {
         fprintf(stderr, "Error creating BIO object.\n");
         return_code = FAILURE_OPENSSL_FUNCTION;
         goto end;
     }
-    EVP_PKEY *private_key = PEM_read_bio_PrivateKey(mem_bio, NULL, NULL, NULL);
+    EVP_PKEY *parsed_private_key = PEM_read_bio_PrivateKey(
+        mem_bio, NULL, NULL, NULL);
     BIO_free(mem_bio);
-    if (!private_key) {
+    if (!parsed_private_key) {
         fprintf(stderr, "Error reading private key.\n");
         return_code = FAILURE_OPENSSL_FUNCTION;
         goto end;
     }
-    if (EVP_PKEY_base_id(private_key) != EVP_PKEY_RSA) {
+    if (EVP_PKEY_base_id(parsed_private_key) != EVP_PKEY_RSA) {
         fprintf(stderr, "The provided key is not an RSA key.\n");
-        EVP_PKEY_free(private_key);
-        BIO_free(mem_bio);
+        EVP_PKEY_free(parsed_private_key);
         return_code = FAILURE_OPENSSL_FUNCTION;
         goto end;
     }
+    if (EVP_PKEY_get_size(parsed_private_key) > MAX_SSH_SIGNATURE_LENGTH) {
+        EVP_PKEY_free(parsed_private_key);
+        return_code = FAILURE_SIGNATURE_TOO_LONG;
+        goto end;
+    }
+    const EVP_MD *md = NULL;
+    return_code = hash_get_sha_256_md(&md);
+    if (SUCCESS != return_code) {
+        EVP_PKEY_free(parsed_private_key);
+        goto end;
+    }
     EVP_MD_CTX *md_ctx = EVP_MD_CTX_new();
-    if (!md_ctx) {
-        fprintf(stderr, "Error creating message digest context.\n");
-        EVP_PKEY_free(private_key);
+    if (NULL == md_ctx) {
+        EVP_PKEY_free(parsed_private_key);
         return_code = FAILURE_OPENSSL_FUNCTION;
         goto end;
     }
-    if (EVP_DigestSignInit(
-            md_ctx, NULL, EVP_sha256(), NULL, private_key) <= 0) {
+    if (EVP_DigestSignInit(md_ctx, NULL, md, NULL, parsed_private_key) <= 0) {
         fprintf(stderr, "Error initializing digest signing.\n");
-        EVP_PKEY_free(private_key);
         EVP_MD_CTX_free(md_ctx);
+        EVP_PKEY_free(parsed_private_key);
         return_code = FAILURE_OPENSSL_FUNCTION;
         goto end;
     }
-    size_t size_without_signature = offsetof(transaction_t, sender_signature);
-    if (EVP_DigestSignUpdate(
-            md_ctx, transaction, size_without_signature) <= 0) {
-        fprintf(stderr, "Error updating digest signing.\n");
-        EVP_PKEY_free(private_key);
+    transaction_signer_t *new_signer = malloc(sizeof(transaction_signer_t));
+    if (NULL == new_signer) {
         EVP_MD_CTX_free(md_ctx);
+        EVP_PKEY_free(parsed_private_key);
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    new_signer->version = TRANSACTION_VERSION_RSA;
+    new_signer->private_key = parsed_private_key;
+    new_signer->md_ctx = md_ctx;
+    *signer = new_signer;
+end:
+    return return_code;
+}
+
+return_code_t transaction_signer_create_ed25519(
+    transaction_signer_t **signer,
+    ssh_key_t *private_key
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == signer || NULL == private_key) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    EVP_PKEY *parsed_private_key = EVP_PKEY_new_raw_private_key(
+        EVP_PKEY_ED25519,
+        NULL,
+        (unsigned char *)private_key->bytes,
+        ED25519_KEY_LENGTH);
+    if (NULL == parsed_private_key) {
+        fprintf(stderr, "Error reading private key.\n");
+        return_code = FAILURE_OPENSSL_FUNCTION;
+        goto end;
+    }
+    // Ed25519 hashes the message itself, so the context has no digest.
+    EVP_MD_CTX *md_ctx = EVP_MD_CTX_new();
+    if (NULL == md_ctx) {
+        EVP_PKEY_free(parsed_private_key);
         return_code = FAILURE_OPENSSL_FUNCTION;
         goto end;
     }
-    size_t sig_len = 0;
-    if (EVP_DigestSignFinal(md_ctx, NULL, &sig_len) <= 0) {
-        fprintf(stderr, "Error obtaining signature length.\n");
-        EVP_PKEY_free(private_key);
+    if (EVP_DigestSignInit(
+            md_ctx, NULL, NULL, NULL, parsed_private_key) <= 0) {
+        fprintf(stderr, "Error initializing digest signing.\n");
         EVP_MD_CTX_free(md_ctx);
+        EVP_PKEY_free(parsed_private_key);
         return_code = FAILURE_OPENSSL_FUNCTION;
         goto end;
     }
-    if (EVP_DigestSignFinal(md_ctx, signature->bytes, &sig_len) <= 0) {
-        fprintf(stderr, "Error generating signature.\n");
-        EVP_PKEY_free(private_key);
+    transaction_signer_t *new_signer = malloc(sizeof(transaction_signer_t));
+    if (NULL == new_signer) {
         EVP_MD_CTX_free(md_ctx);
+        EVP_PKEY_free(parsed_private_key);
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    new_signer->version = TRANSACTION_VERSION_ED25519;
+    new_signer->private_key = parsed_private_key;
+    new_signer->md_ctx = md_ctx;
+    *signer = new_signer;
+end:
+    return return_code;
+}
+
+return_code_t transaction_signer_destroy(transaction_signer_t *signer) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == signer) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    EVP_MD_CTX_free(signer->md_ctx);
+    EVP_PKEY_free(signer->private_key);
+    free(signer);
+end:
+    return return_code;
+}
+
+return_code_t transaction_signer_sign(
+    ssh_signature_t *signature,
+    transaction_t *transaction,
+    transaction_signer_t *signer
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == signature ||
+        NULL == transaction ||
+        NULL == signer ||
+        transaction->version != signer->version ||
+        !_transaction_has_valid_keys(transaction)) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    // Start from a copy of the signer's initialized context so that the key
+    // setup happens once per signer, not once per signature, and so that
+    // threads can share one signer.
+    EVP_MD_CTX *md_ctx = NULL;
+    return_code = hash_get_thread_context(&md_ctx);
+    if (SUCCESS != return_code) {
+        fprintf(stderr, "Error getting message digest context.\n");
+        goto end;
+    }
+    if (1 != EVP_MD_CTX_copy_ex(md_ctx, signer->md_ctx)) {
+        fprintf(stderr, "Error copying digest signing context.\n");
         return_code = FAILURE_OPENSSL_FUNCTION;
         goto end;
     }
+    size_t sig_len = sizeof(signature->bytes);
+    if (TRANSACTION_VERSION_ED25519 == signer->version) {
+        unsigned char message[TRANSACTION_ED25519_MESSAGE_LENGTH];
+        _transaction_ed25519_message(transaction, message);
+        // Ed25519 only supports one-shot signing.
+        if (EVP_DigestSign(
+                md_ctx,
+                signature->bytes,
+                &sig_len,
+                message,
+                sizeof(message)) <= 0) {
+            fprintf(stderr, "Error generating signature.\n");
+            EVP_MD_CTX_reset(md_ctx);
+            return_code = FAILURE_OPENSSL_FUNCTION;
+            goto end;
+        }
+    } else {
+        unsigned char message[TRANSACTION_RSA_MESSAGE_LENGTH];
+        _transaction_rsa_message(transaction, message);
+        if (EVP_DigestSignUpdate(md_ctx, message, sizeof(message)) <= 0) {
+            fprintf(stderr, "Error updating digest signing.\n");
+            EVP_MD_CTX_reset(md_ctx);
+            return_code = FAILURE_OPENSSL_FUNCTION;
+            goto end;
+        }
+        if (EVP_DigestSignFinal(md_ctx, signature->bytes, &sig_len) <= 0) {
+            fprintf(stderr, "Error generating signature.\n");
+            EVP_MD_CTX_reset(md_ctx);
+            return_code = FAILURE_OPENSSL_FUNCTION;
+            goto end;
+        }
+    }
+    // Clear any bytes left from a longer signature so that the transaction's
+    // hash depends only on the signature itself.
+    memset(signature->bytes + sig_len, 0, sizeof(signature->bytes) - sig_len);
     signature->length = sig_len;
-    EVP_PKEY_free(private_key);
-    EVP_MD_CTX_free(md_ctx);
+    EVP_MD_CTX_reset(md_ctx);
 end:
     return return_code;
 }
 
-return_code_t transaction_verify_signature(
-    bool *is_valid_signature,
-    transaction_t *transaction
+return_code_t transaction_generate_signature(
+    ssh_signature_t *signature,
+    transaction_t *transaction,
+    ssh_key_t *sender_private_key
 ) {
     return_code_t return_code = SUCCESS;
-    if (NULL == is_valid_signature || NULL == transaction) {
+    if (NULL == signature ||
+        NULL == transaction ||
+        NULL == sender_private_key) {
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
-    BIO *bio = BIO_new_mem_buf(
-        transaction->sender_public_key.bytes, MAX_SSH_KEY_LENGTH);
-    if (bio == NULL) {
-        fprintf(stderr, "Error creating BIO object.\n");
-        return_code = FAILURE_OPENSSL_FUNCTION;
+    transaction_signer_t *signer = NULL;
+    return_code = transaction_signer_create(&signer, sender_private_key);
+    if (SUCCESS != return_code) {
         goto end;
     }
-    EVP_PKEY *public_key = PEM_read_bio_PUBKEY(bio, NULL, NULL, NULL);
-    BIO_free(bio);
-    if (public_key == NULL) {
+    return_code = transaction_signer_sign(signature, transaction, signer);
+    transaction_signer_destroy(signer);
+end:
+    return return_code;
+}
+
+void _transaction_free_public_key(void *public_key) {
+    EVP_PKEY_free((EVP_PKEY *)public_key);
+}
+
+void _transaction_retain_public_key(void *public_key) {
+    EVP_PKEY_up_ref((EVP_PKEY *)public_key);
+}
+
+void _transaction_init_public_key_cache(void) {
+    public_key_cache_init_return_code = lru_cache_create(
+        &public_key_cache,
+        TRANSACTION_PUBLIC_KEY_CACHE_CAPACITY,
+        _transaction_free_public_key,
+        _transaction_retain_public_key);
+}
+
+return_code_t _transaction_get_public_key(
+    EVP_PKEY **public_key,
+    public_key_t *transaction_public_key,
+    uint64_t version
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == public_key || NULL == transaction_public_key) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    pthread_once(&public_key_cache_once, _transaction_init_public_key_cache);
+    return_code = public_key_cache_init_return_code;
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    // The key's ID is the hash of its bytes, so looking it up costs no
+    // hashing. Raw Ed25519 keys are shorter than any PEM key, so the two kinds
+    // of keys cannot share a cache entry.
+    sha_256_t key_hash = transaction_public_key->id;
+    bool is_found = false;
+    void *cached_public_key = NULL;
+    return_code = lru_cache_get(
+        public_key_cache, &key_hash, &cached_public_key, &is_found);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    if (is_found) {
+        *public_key = cached_public_key;
+        goto end;
+    }
+    EVP_PKEY *parsed_public_key = NULL;
+    if (TRANSACTION_VERSION_ED25519 == version) {
+        parsed_public_key = EVP_PKEY_new_raw_public_key(
+            EVP_PKEY_ED25519,
+            NULL,
+            transaction_public_key->bytes,
+            transaction_public_key->length);
+    } else {
+        BIO *bio = BIO_new_mem_buf(
+            transaction_public_key->bytes,
+            (int)transaction_public_key->length);
+        if (bio == NULL) {
+            fprintf(stderr, "Error creating BIO object.\n");
+            return_code = FAILURE_OPENSSL_FUNCTION;
+            goto end;
+        }
+        parsed_public_key = PEM_read_bio_PUBKEY(bio, NULL, NULL, NULL);
+        BIO_free(bio);
+    }
+    if (parsed_public_key == NULL) {
         fprintf(stderr, "Error reading public key.\n");
         return_code = FAILURE_OPENSSL_FUNCTION;
         goto end;
     }
-    size_t size_without_signature = offsetof(transaction_t, sender_signature);
-    EVP_MD_CTX *md_ctx = EVP_MD_CTX_new();
-    if (!md_ctx) {
-        fprintf(stderr, "Error creating message digest context.\n");
-        EVP_PKEY_free(public_key);
+    // One reference goes to the cache and one to the caller.
+    if (1 != EVP_PKEY_up_ref(parsed_public_key)) {
+        EVP_PKEY_free(parsed_public_key);
         return_code = FAILURE_OPENSSL_FUNCTION;
         goto end;
     }
-    if (EVP_VerifyInit(md_ctx, EVP_sha256()) <= 0) {
+    return_code = lru_cache_put(public_key_cache, &key_hash, parsed_public_key);
+    if (SUCCESS != return_code) {
+        EVP_PKEY_free(parsed_public_key);
+        goto end;
+    }
+    *public_key = parsed_public_key;
+end:
+    return return_code;
+}
+
+return_code_t _transaction_verify_ed25519_signature(
+    bool *is_valid_signature,
+    transaction_t *transaction,
+    EVP_PKEY *public_key
+) {
+    return_code_t return_code = SUCCESS;
+    // Bytes past the signature are not signed, so they must be zero. Otherwise
+    // anyone could change the transaction's hash without invalidating its
+    // signature.
+    if (ED25519_SIGNATURE_LENGTH != transaction->sender_signature.length ||
+        !_transaction_has_valid_keys(transaction) ||
+        !_transaction_is_zero(
+            transaction->sender_signature.bytes +
+                ED25519_SIGNATURE_LENGTH,
+            MAX_SSH_SIGNATURE_LENGTH - ED25519_SIGNATURE_LENGTH)) {
+        *is_valid_signature = false;
+        goto end;
+    }
+    EVP_MD_CTX *md_ctx = NULL;
+    return_code = hash_get_thread_context(&md_ctx);
+    if (SUCCESS != return_code) {
+        fprintf(stderr, "Error getting message digest context.\n");
+        goto end;
+    }
+    if (EVP_DigestVerifyInit(md_ctx, NULL, NULL, NULL, public_key) <= 0) {
         fprintf(stderr, "Error initializing digest verification.\n");
-        EVP_PKEY_free(public_key);
-        EVP_MD_CTX_free(md_ctx);
+        EVP_MD_CTX_reset(md_ctx);
+        return_code = FAILURE_OPENSSL_FUNCTION;
+        goto end;
+    }
+    unsigned char message[TRANSACTION_ED25519_MESSAGE_LENGTH];
+    _transaction_ed25519_message(transaction, message);
+    *is_valid_signature = 1 == EVP_DigestVerify(
+        md_ctx,
+        transaction->sender_signature.bytes,
+        transaction->sender_signature.length,
+        message,
+        sizeof(message));
+    EVP_MD_CTX_reset(md_ctx);
+end:
+    return return_code;
+}
+
+return_code_t _transaction_verify_rsa_signature(
+    bool *is_valid_signature,
+    transaction_t *transaction,
+    EVP_PKEY *public_key
+) {
+    return_code_t return_code = SUCCESS;
+    if (!_transaction_has_valid_keys(transaction)) {
+        *is_valid_signature = false;
+        goto end;
+    }
+    EVP_MD_CTX *md_ctx = NULL;
+    const EVP_MD *md = NULL;
+    return_code = hash_get_thread_context(&md_ctx);
+    if (SUCCESS == return_code) {
+        return_code = hash_get_sha_256_md(&md);
+    }
+    if (SUCCESS != return_code) {
+        fprintf(stderr, "Error getting message digest context.\n");
+        goto end;
+    }
+    if (EVP_VerifyInit(md_ctx, md) <= 0) {
+        fprintf(stderr, "Error initializing digest verification.\n");
+        EVP_MD_CTX_reset(md_ctx);
         return_code = FAILURE_OPENSSL_FUNCTION;
         goto end;
     }
-    if (EVP_VerifyUpdate(md_ctx, transaction, size_without_signature) <= 0) {
+    unsigned char message[TRANSACTION_RSA_MESSAGE_LENGTH];
+    _transaction_rsa_message(transaction, message);
+    if (EVP_VerifyUpdate(md_ctx, message, sizeof(message)) <= 0) {
         fprintf(stderr, "Error updating digest verification.\n");
-        EVP_PKEY_free(public_key);
-        EVP_MD_CTX_free(md_ctx);
+        EVP_MD_CTX_reset(md_ctx);
         return_code = FAILURE_OPENSSL_FUNCTION;
         goto end;
     }
@@ -194,8 +678,397 @@ return_code_t transaction_verify_signature(
     } else {
         *is_valid_signature = false;
     }
-    EVP_MD_CTX_free(md_ctx);
-    EVP_PKEY_free(public_key);
+    EVP_MD_CTX_reset(md_ctx);
+end:
+    return return_code;
+}
+
+return_code_t transaction_verify_signature(
+    bool *is_valid_signature,
+    transaction_t *transaction
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == is_valid_signature || NULL == transaction) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    return_code = transaction_verify_signatures(
+        is_valid_signature, &transaction, 1);
+end:
+    return return_code;
+}
+
+return_code_t transaction_verify_signatures(
+    bool *are_valid_signatures,
+    transaction_t **transactions,
+    size_t num_transactions
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == are_valid_signatures || NULL == transactions) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    // Consecutive transactions often share a sender, such as a wallet's batch
+    // of payments, so keep the last key instead of looking it up again.
+    EVP_PKEY *public_key = NULL;
+    transaction_t *public_key_transaction = NULL;
+    for (size_t idx = 0; idx < num_transactions; idx++) {
+        transaction_t *transaction = transactions[idx];
+        if (NULL == transaction) {
+            return_code = FAILURE_INVALID_INPUT;
+            goto cleanup;
+        }
+        are_valid_signatures[idx] = false;
+        if (TRANSACTION_VERSION_RSA != transaction->version &&
+            TRANSACTION_VERSION_ED25519 != transaction->version) {
+            continue;
+        }
+        if (NULL == transaction->sender_public_key) {
+            continue;
+        }
+        bool is_same_sender = false;
+        if (NULL != public_key_transaction &&
+            public_key_transaction->version == transaction->version) {
+            return_code = public_key_equals(
+                public_key_transaction->sender_public_key,
+                transaction->sender_public_key,
+                &is_same_sender);
+            if (SUCCESS != return_code) {
+                goto cleanup;
+            }
+        }
+        if (!is_same_sender) {
+            if (NULL != public_key) {
+                EVP_PKEY_free(public_key);
+                public_key = NULL;
+                public_key_transaction = NULL;
+            }
+            return_code = _transaction_get_public_key(
+                &public_key,
+                transaction->sender_public_key,
+                transaction->version);
+            if (SUCCESS != return_code) {
+                goto cleanup;
+            }
+            public_key_transaction = transaction;
+        }
+        if (TRANSACTION_VERSION_ED25519 == transaction->version) {
+            return_code = _transaction_verify_ed25519_signature(
+                &are_valid_signatures[idx], transaction, public_key);
+        } else {
+            return_code = _transaction_verify_rsa_signature(
+                &are_valid_signatures[idx], transaction, public_key);
+        }
+        if (SUCCESS != return_code) {
+            goto cleanup;
+        }
+    }
+cleanup:
+    if (NULL != public_key) {
+        EVP_PKEY_free(public_key);
+    }
+end:
+    return return_code;
+}
+
+return_code_t transaction_generate_ed25519_key_pair(
+    ssh_key_t *public_key,
+    ssh_key_t *private_key
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == public_key || NULL == private_key) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    EVP_PKEY *key_pair = EVP_PKEY_Q_keygen(NULL, NULL, "ED25519");
+    if (NULL == key_pair) {
+        fprintf(stderr, "Error generating key pair.\n");
+        return_code = FAILURE_OPENSSL_FUNCTION;
+        goto end;
+    }
+    memset(public_key, 0, sizeof(ssh_key_t));
+    memset(private_key, 0, sizeof(ssh_key_t));
+    size_t public_key_length = ED25519_KEY_LENGTH;
+    size_t private_key_length = ED25519_KEY_LENGTH;
+    if (1 != EVP_PKEY_get_raw_public_key(
+            key_pair, (unsigned char *)public_key->bytes, &public_key_length) ||
+        1 != EVP_PKEY_get_raw_private_key(
+            key_pair,
+            (unsigned char *)private_key->bytes,
+            &private_key_length)) {
+        fprintf(stderr, "Error reading key pair.\n");
+        return_code = FAILURE_OPENSSL_FUNCTION;
+    }
+    EVP_PKEY_free(key_pair);
+end:
+    return return_code;
+}
+
+return_code_t transaction_hash(transaction_t *transaction, sha_256_t *hash) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == transaction || NULL == hash) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    if (TRANSACTION_VERSION_RSA != transaction->version) {
+        size_t size = 0;
+        return_code = transaction_get_serialized_size(transaction, &size);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        unsigned char *buffer = malloc(size);
+        if (NULL == buffer) {
+            return_code = FAILURE_COULD_NOT_MALLOC;
+            goto end;
+        }
+        return_code = transaction_serialize(transaction, buffer, size, &size);
+        if (SUCCESS == return_code) {
+            return_code = hash_sha_256(buffer, size, hash);
+        }
+        free(buffer);
+        goto end;
+    }
+    // RSA transactions hash the bytes that transaction_t held when it stored
+    // keys in fixed-size buffers, so the hashes of existing blocks are the same
+    // as before keys became variable-length objects.
+    if (!_transaction_has_valid_keys(transaction)) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    unsigned char message[TRANSACTION_RSA_MESSAGE_LENGTH +
+        sizeof(uint64_t) + MAX_SSH_SIGNATURE_LENGTH];
+    _transaction_rsa_message(transaction, message);
+    unsigned char *signature = message + TRANSACTION_RSA_MESSAGE_LENGTH;
+    _transaction_write_le64(signature, transaction->sender_signature.length);
+    memcpy(
+        signature + sizeof(uint64_t),
+        transaction->sender_signature.bytes,
+        MAX_SSH_SIGNATURE_LENGTH);
+    return_code = hash_sha_256(message, sizeof(message), hash);
+end:
+    return return_code;
+}
+
+return_code_t transaction_get_serialized_size(
+    transaction_t *transaction,
+    size_t *size
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == transaction || NULL == size) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    if (transaction->sender_signature.length > MAX_SSH_SIGNATURE_LENGTH) {
+        return_code = FAILURE_SIGNATURE_TOO_LONG;
+        goto end;
+    }
+    // version, created_at, two key lengths, amount, and signature length.
+    *size = 6 * sizeof(uint64_t) +
+        _transaction_key_length(transaction->sender_public_key) +
+        _transaction_key_length(transaction->recipient_public_key) +
+        transaction->sender_signature.length;
+end:
+    return return_code;
+}
+
+void _transaction_serialize_key(
+    unsigned char **next_spot_in_buffer,
+    public_key_t *public_key
+) {
+    size_t length = _transaction_key_length(public_key);
+    *(uint64_t *)*next_spot_in_buffer = htobe64(length);
+    *next_spot_in_buffer += sizeof(uint64_t);
+    if (length > 0) {
+        memcpy(*next_spot_in_buffer, public_key->bytes, length);
+        *next_spot_in_buffer += length;
+    }
+}
+
+return_code_t transaction_serialize(
+    transaction_t *transaction,
+    unsigned char *buffer,
+    size_t buffer_size,
+    size_t *num_bytes_written
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == transaction || NULL == buffer || NULL == num_bytes_written) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    size_t size = 0;
+    return_code = transaction_get_serialized_size(transaction, &size);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    if (buffer_size < size) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    unsigned char *next_spot_in_buffer = buffer;
+    *(uint64_t *)next_spot_in_buffer = htobe64(transaction->version);
+    next_spot_in_buffer += sizeof(uint64_t);
+    *(uint64_t *)next_spot_in_buffer = htobe64(transaction->created_at);
+    next_spot_in_buffer += sizeof(uint64_t);
+    _transaction_serialize_key(
+        &next_spot_in_buffer, transaction->sender_public_key);
+    _transaction_serialize_key(
+        &next_spot_in_buffer, transaction->recipient_public_key);
+    *(uint64_t *)next_spot_in_buffer = htobe64(transaction->amount);
+    next_spot_in_buffer += sizeof(uint64_t);
+    *(uint64_t *)next_spot_in_buffer = htobe64(
+        transaction->sender_signature.length);
+    next_spot_in_buffer += sizeof(uint64_t);
+    memcpy(
+        next_spot_in_buffer,
+        transaction->sender_signature.bytes,
+        transaction->sender_signature.length);
+    *num_bytes_written = size;
+end:
+    return return_code;
+}
+
+return_code_t _transaction_deserialize_u64(
+    uint64_t *data,
+    unsigned char **next_spot_in_buffer,
+    unsigned char *buffer_end
+) {
+    return_code_t return_code = SUCCESS;
+    if ((size_t)(buffer_end - *next_spot_in_buffer) < sizeof(uint64_t)) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    *data = betoh64(*(uint64_t *)*next_spot_in_buffer);
+    *next_spot_in_buffer += sizeof(uint64_t);
+end:
+    return return_code;
+}
+
+return_code_t _transaction_deserialize_key(
+    public_key_t **public_key,
+    unsigned char **next_spot_in_buffer,
+    unsigned char *buffer_end
+) {
+    return_code_t return_code = SUCCESS;
+    uint64_t length = 0;
+    return_code = _transaction_deserialize_u64(
+        &length, next_spot_in_buffer, buffer_end);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    if (length > MAX_SSH_KEY_LENGTH) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    if ((size_t)(buffer_end - *next_spot_in_buffer) < length) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    return_code = public_key_create(public_key, *next_spot_in_buffer, length);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    *next_spot_in_buffer += length;
+end:
+    return return_code;
+}
+
+return_code_t transaction_deserialize(
+    transaction_t **transaction,
+    unsigned char *buffer,
+    size_t buffer_size,
+    size_t *num_bytes_read
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == transaction || NULL == buffer || NULL == num_bytes_read) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    transaction_t *new_transaction = calloc(1, sizeof(transaction_t));
+    if (NULL == new_transaction) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    unsigned char *next_spot_in_buffer = buffer;
+    unsigned char *buffer_end = buffer + buffer_size;
+    uint64_t created_at = 0;
+    uint64_t signature_length = 0;
+    return_code = _transaction_deserialize_u64(
+        &new_transaction->version, &next_spot_in_buffer, buffer_end);
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    return_code = _transaction_deserialize_u64(
+        &created_at, &next_spot_in_buffer, buffer_end);
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    new_transaction->created_at = (time_t)created_at;
+    return_code = _transaction_deserialize_key(
+        &new_transaction->sender_public_key, &next_spot_in_buffer, buffer_end);
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    return_code = _transaction_deserialize_key(
+        &new_transaction->recipient_public_key,
+        &next_spot_in_buffer,
+        buffer_end);
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    bool has_canonical_keys = false;
+    return_code = transaction_has_canonical_keys(
+        new_transaction, &has_canonical_keys);
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    if (!has_canonical_keys) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto cleanup;
+    }
+    // Payments to oneself, such as change, then hold the key only once.
+    bool is_same_key = false;
+    return_code = public_key_equals(
+        new_transaction->sender_public_key,
+        new_transaction->recipient_public_key,
+        &is_same_key);
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    if (is_same_key) {
+        public_key_release(new_transaction->recipient_public_key);
+        public_key_retain(new_transaction->sender_public_key);
+        new_transaction->recipient_public_key =
+            new_transaction->sender_public_key;
+    }
+    return_code = _transaction_deserialize_u64(
+        &new_transaction->amount, &next_spot_in_buffer, buffer_end);
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    return_code = _transaction_deserialize_u64(
+        &signature_length, &next_spot_in_buffer, buffer_end);
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    if (signature_length > MAX_SSH_SIGNATURE_LENGTH) {
+        return_code = FAILURE_SIGNATURE_TOO_LONG;
+        goto cleanup;
+    }
+    if ((size_t)(buffer_end - next_spot_in_buffer) < signature_length) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto cleanup;
+    }
+    new_transaction->sender_signature.length = signature_length;
+    memcpy(
+        new_transaction->sender_signature.bytes,
+        next_spot_in_buffer,
+        signature_length);
+    next_spot_in_buffer += signature_length;
+    *transaction = new_transaction;
+    *num_bytes_read = next_spot_in_buffer - buffer;
+    goto end;
+cleanup:
+    transaction_destroy(new_transaction);
 end:
     return return_code;
 }
@@ -12,6 +12,7 @@
     #include <sys/stat.h>
     #include <unistd.h>
 #endif
+#include "include/blockchain.h"
 #include "include/return_codes.h"
 #include "tests/file_paths.h"
 #include "tests/test_linked_list.h"
@@ -21,6 +22,11 @@
 #include "tests/test_base64.h"
 #include "tests/test_endian.h"
 #include "tests/test_miner.h"
+#include "tests/test_hash.h"
+#include "tests/test_hash_batch.h"
+#include "tests/test_lru_cache.h"
+#include "tests/test_public_key.h"
+#include "tests/test_key_table.h"
 
 int _unlink_callback(
     const char *fpath,
@@ -137,9 +143,35 @@ int main(int argc, char **argv) {
         cmocka_unit_test(test_block_hash_proof_of_work_included_in_hash),
         cmocka_unit_test(test_block_hash_previous_block_hash_included_in_hash),
         cmocka_unit_test(test_block_hash_fails_on_invalid_input),
+        cmocka_unit_test(test_block_merkle_root_is_zero_for_empty_block),
+        cmocka_unit_test(test_block_merkle_root_combines_transaction_hashes),
+        cmocka_unit_test(
+            test_block_merkle_root_changes_when_last_transaction_repeats),
+        cmocka_unit_test(test_block_merkle_root_fails_on_invalid_input),
+        cmocka_unit_test(test_block_get_header_gives_block_fields),
+        cmocka_unit_test(test_block_get_header_fails_on_invalid_input),
+        cmocka_unit_test(test_block_header_hash_matches_block_hash),
+        cmocka_unit_test(test_block_header_hash_fails_on_invalid_input),
+        cmocka_unit_test(
+            test_block_header_hash_from_midstate_matches_block_header_hash),
+        cmocka_unit_test(
+            test_block_header_hash_from_midstate_fails_on_invalid_input),
+        cmocka_unit_test(
+            test_block_header_final_block_batch_matches_block_header_hash),
+        cmocka_unit_test(
+            test_block_header_final_block_rolls_extra_nonce_in_place),
+        cmocka_unit_test(test_block_header_final_block_fails_on_invalid_input),
         // test_blockchain.h
         cmocka_unit_test(test_blockchain_create_gives_blockchain),
         cmocka_unit_test(test_blockchain_create_fails_on_invalid_input),
+        cmocka_unit_test(test_blockchain_create_with_target_gives_blockchain),
+        cmocka_unit_test(
+            test_blockchain_create_with_target_fails_on_invalid_input),
+        cmocka_unit_test(
+            test_blockchain_target_from_num_leading_zero_bits_gives_target),
+        cmocka_unit_test(
+            test_blockchain_target_from_num_leading_zero_bytes_matches_bits),
+        cmocka_unit_test(test_blockchain_target_fails_on_invalid_input),
         cmocka_unit_test(test_blockchain_destroy_returns_success),
         cmocka_unit_test(test_blockchain_destroy_fails_on_invalid_input),
         cmocka_unit_test(test_synchronized_blockchain_create_gives_blockchain),
@@ -150,15 +182,37 @@ int main(int argc, char **argv) {
             test_synchronized_blockchain_destroy_fails_on_invalid_input),
         cmocka_unit_test(test_blockchain_add_block_appends_block),
         cmocka_unit_test(test_blockchain_add_block_fails_on_invalid_input),
+        cmocka_unit_test(test_blockchain_add_block_interns_keys),
         cmocka_unit_test(
             test_blockchain_is_valid_block_hash_true_on_valid_hash),
         cmocka_unit_test(
             test_blockchain_is_valid_block_hash_false_on_invalid_hash),
         cmocka_unit_test(
             test_blockchain_is_valid_block_hash_fails_on_invalid_input),
+        cmocka_unit_test(
+            test_blockchain_is_valid_block_hash_compares_hash_with_target),
         cmocka_unit_test(
             test_blockchain_mine_block_produces_block_with_valid_hash),
+        cmocka_unit_test(
+            test_blockchain_mine_block_multithreaded_gives_same_proof_of_work),
+        cmocka_unit_test(
+            test_blockchain_mine_block_reuses_pools_across_concurrent_calls),
         cmocka_unit_test(test_blockchain_mine_block_fails_on_invalid_input),
+        cmocka_unit_test(
+            test_blockchain_search_for_proof_of_work_ignores_batch_size),
+        cmocka_unit_test(
+            test_blockchain_search_for_proof_of_work_returns_abort_code),
+        cmocka_unit_test(
+            test_blockchain_search_for_proof_of_work_fails_on_invalid_input),
+        cmocka_unit_test(
+            test_blockchain_search_for_proof_of_work_rolls_extra_nonce),
+        cmocka_unit_test(test_mining_pools_destroy_shared_stops_idle_pools),
+        cmocka_unit_test(test_mining_pool_create_gives_pool),
+        cmocka_unit_test(test_mining_pool_create_fails_on_invalid_input),
+        cmocka_unit_test(
+            test_mining_pool_search_for_proof_of_work_reuses_workers),
+        cmocka_unit_test(
+            test_mining_pool_search_for_proof_of_work_fails_on_invalid_input),
         cmocka_unit_test(test_blockchain_verify_succeeds_on_valid_blockchain),
         cmocka_unit_test(test_blockchain_verify_fails_on_invalid_genesis_block),
         cmocka_unit_test(test_blockchain_verify_fails_on_invalid_proof_of_work),
@@ -166,18 +220,58 @@ int main(int argc, char **argv) {
             test_blockchain_verify_fails_on_invalid_previous_block_hash),
         cmocka_unit_test(
             test_blockchain_verify_fails_on_invalid_transaction_signature),
+        cmocka_unit_test(
+            test_blockchain_verify_finds_first_invalid_signature_in_parallel),
+        cmocka_unit_test(test_blockchain_verify_caches_only_valid_signatures),
+        cmocka_unit_test(
+            test_blockchain_verify_accepts_mixed_signature_versions),
+        cmocka_unit_test(
+            test_blockchain_get_verified_signature_cache_fails_on_null),
+        cmocka_unit_test(test_blockchain_verify_records_watermark),
+        cmocka_unit_test(
+            test_blockchain_verify_incremental_only_checks_new_blocks),
+        cmocka_unit_test(
+            test_blockchain_verify_incremental_fails_on_invalid_input),
         cmocka_unit_test(test_blockchain_verify_fails_on_invalid_input),
         cmocka_unit_test(test_blockchain_serialize_creates_nonempty_buffer),
         cmocka_unit_test(test_blockchain_serialize_fails_on_invalid_input),
+        cmocka_unit_test(test_blockchain_serialize_stores_each_key_once),
+        cmocka_unit_test(test_blockchain_serialize_to_sink_matches_serialize),
+        cmocka_unit_test(
+            test_blockchain_serialize_to_sink_fails_on_invalid_input),
+        cmocka_unit_test(test_blockchain_serialize_to_fd_round_trips),
         cmocka_unit_test(test_blockchain_deserialize_reconstructs_blockchain),
+        cmocka_unit_test(
+            test_blockchain_deserialize_reconstructs_custom_target),
         cmocka_unit_test(
             test_blockchain_deserialize_fails_on_attempted_read_past_buffer),
         cmocka_unit_test(test_blockchain_deserialize_fails_on_invalid_input),
+        cmocka_unit_test(test_blockchain_deserialize_fails_on_unknown_format),
+        cmocka_unit_test(test_blockchain_deserialize_fails_on_padded_key),
+        cmocka_unit_test(test_blockchain_decoder_decodes_chunks_of_any_size),
+        cmocka_unit_test(test_blockchain_decoder_fails_on_invalid_input),
+        cmocka_unit_test(test_blockchain_decoder_rejects_oversized_records),
         cmocka_unit_test(test_blockchain_write_to_file_creates_nonempty_file),
         cmocka_unit_test(test_blockchain_write_to_file_fails_on_invalid_input),
+        cmocka_unit_test(test_blockchain_write_to_file_appends_new_blocks),
+        cmocka_unit_test(test_blockchain_write_to_file_rewrites_changed_file),
+        cmocka_unit_test(
+            test_blockchain_write_to_file_replaces_file_with_renamed_log),
+        cmocka_unit_test(
+            test_blockchain_write_to_file_with_sync_policy_follows_policy),
         cmocka_unit_test(
             test_blockchain_read_from_file_reconstructs_blockchain),
         cmocka_unit_test(test_blockchain_read_from_file_fails_on_invalid_input),
+        cmocka_unit_test(test_blockchain_read_from_file_fails_on_empty_file),
+        cmocka_unit_test(test_blockchain_read_from_fd_reads_block_log),
+        cmocka_unit_test(
+            test_blockchain_read_from_file_ignores_interrupted_append),
+        cmocka_unit_test(
+            test_blockchain_read_from_file_fails_on_corrupt_record),
+        cmocka_unit_test(test_blockchain_view_matches_read_blockchain),
+        cmocka_unit_test(test_blockchain_view_verify_finds_first_invalid_block),
+        cmocka_unit_test(test_blockchain_view_open_fails_on_unsupported_format),
+        cmocka_unit_test(test_blockchain_view_fails_on_invalid_input),
         cmocka_unit_test(
             test_blockchain_serialization_does_not_alter_block_hash),
         // test_transaction.h
@@ -188,18 +282,92 @@ int main(int argc, char **argv) {
         cmocka_unit_test(test_transaction_generate_signature_gives_signature),
         cmocka_unit_test(
             test_transaction_generate_signature_fails_on_invalid_input),
+        cmocka_unit_test(test_transaction_signer_create_gives_signer),
+        cmocka_unit_test(
+            test_transaction_signer_create_fails_on_invalid_input),
+        cmocka_unit_test(test_transaction_signer_sign_gives_valid_signatures),
+        cmocka_unit_test(test_transaction_signer_sign_fails_on_invalid_input),
+        cmocka_unit_test(
+            test_transaction_generate_ed25519_key_pair_gives_raw_keys),
+        cmocka_unit_test(
+            test_transaction_signer_create_ed25519_gives_valid_signatures),
+        cmocka_unit_test(
+            test_transaction_verify_signature_rejects_bad_ed25519_signature),
+        cmocka_unit_test(
+            test_transaction_verify_signatures_verifies_mixed_versions),
         cmocka_unit_test(
             test_transaction_verify_signature_identifies_valid_signature),
         cmocka_unit_test(
             test_transaction_verify_signature_identifies_invalid_signature),
+        cmocka_unit_test(
+            test_transaction_verify_signature_reuses_cached_public_key),
         cmocka_unit_test(
             test_transaction_verify_signature_fails_on_invalid_input),
+        cmocka_unit_test(test_transaction_hash_covers_signature),
+        cmocka_unit_test(test_transaction_hash_fails_on_invalid_input),
+        cmocka_unit_test(test_transaction_copy_shares_keys),
+        cmocka_unit_test(test_transaction_hash_matches_fixed_size_layout),
+        cmocka_unit_test(test_transaction_serialize_round_trips),
+        cmocka_unit_test(test_transaction_serialize_fails_on_invalid_input),
+        cmocka_unit_test(test_transaction_rejects_rsa_keys_with_trailing_zeros),
         // test_base64.h
         cmocka_unit_test(test_base64_decode_correctly_decodes),
         cmocka_unit_test(test_base64_decode_fails_on_invalid_input),
         // test_endian.h
         cmocka_unit_test(test_htobe64_correctly_encodes_data),
         cmocka_unit_test(test_betoh64_correctly_decodes_data),
+        // test_hash.h
+        cmocka_unit_test(test_hash_midstate_finalize_matches_openssl),
+        cmocka_unit_test(test_hash_midstate_finalize_does_not_modify_midstate),
+        cmocka_unit_test(test_hash_midstate_create_fails_on_invalid_input),
+        cmocka_unit_test(test_hash_midstate_finalize_fails_on_invalid_input),
+        cmocka_unit_test(test_hash_midstate_final_block_matches_finalize),
+        cmocka_unit_test(test_hash_midstate_final_block_fails_on_invalid_input),
+        cmocka_unit_test(test_hash_sha_256_matches_openssl_for_every_backend),
+        cmocka_unit_test(test_hash_get_backend_gives_supported_backend),
+        cmocka_unit_test(test_hash_sha_256_fails_on_invalid_input),
+        cmocka_unit_test(test_hash_bucket_index_uses_leading_bytes),
+        cmocka_unit_test(
+            test_hash_get_thread_context_reuses_context_within_thread),
+        cmocka_unit_test(
+            test_hash_get_thread_context_gives_each_thread_its_own_context),
+        cmocka_unit_test(test_hash_get_thread_context_fails_on_invalid_input),
+        // test_hash_batch.h
+        cmocka_unit_test(
+            test_hash_batch_finalize_matches_midstate_finalize_for_every_kernel),
+        cmocka_unit_test(test_hash_batch_get_best_kernel_gives_supported_kernel),
+        cmocka_unit_test(
+            test_hash_batch_get_kernels_has_sha_ni_kernel_with_sha_ni_backend),
+        cmocka_unit_test(test_hash_batch_get_kernels_ends_with_scalar_kernel),
+        cmocka_unit_test(test_hash_batch_finalize_fails_on_invalid_input),
+        // test_lru_cache.h
+        cmocka_unit_test(test_lru_cache_create_gives_lru_cache),
+        cmocka_unit_test(test_lru_cache_create_fails_on_invalid_input),
+        cmocka_unit_test(test_lru_cache_destroy_frees_values),
+        cmocka_unit_test(test_lru_cache_destroy_fails_on_invalid_input),
+        cmocka_unit_test(test_lru_cache_get_finds_put_value),
+        cmocka_unit_test(test_lru_cache_get_misses_absent_key),
+        cmocka_unit_test(test_lru_cache_get_retains_value),
+        cmocka_unit_test(test_lru_cache_get_fails_on_invalid_input),
+        cmocka_unit_test(test_lru_cache_put_evicts_least_recently_used),
+        cmocka_unit_test(
+            test_lru_cache_put_keeps_existing_value_for_duplicate_key),
+        cmocka_unit_test(test_lru_cache_put_fails_on_invalid_input),
+        // test_public_key.h
+        cmocka_unit_test(test_public_key_create_gives_public_key),
+        cmocka_unit_test(test_public_key_create_fails_on_invalid_input),
+        cmocka_unit_test(test_public_key_retain_keeps_key_alive),
+        cmocka_unit_test(test_public_key_retain_fails_on_invalid_input),
+        cmocka_unit_test(test_public_key_equals_compares_bytes),
+        cmocka_unit_test(test_public_key_equals_fails_on_invalid_input),
+        // test_key_table.h
+        cmocka_unit_test(test_key_table_create_gives_key_table),
+        cmocka_unit_test(test_key_table_create_fails_on_invalid_input),
+        cmocka_unit_test(test_key_table_intern_gives_one_object_per_key),
+        cmocka_unit_test(test_key_table_intern_grows_table),
+        cmocka_unit_test(test_key_table_intern_fails_on_invalid_input),
+        cmocka_unit_test(test_key_table_find_finds_interned_key),
+        cmocka_unit_test(test_key_table_find_fails_on_invalid_input),
         // test_miner.h
         // These multithreaded tests are incredibly slow in valgrind.
         // They run very fast outside of valgrind.
@@ -210,6 +378,7 @@ int main(int argc, char **argv) {
         # endif
     };
     return_code = cmocka_run_group_tests(tests, NULL, NULL);
+    mining_pools_destroy_shared();
 end:
     return return_code;
 }
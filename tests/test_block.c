@@ -4,7 +4,9 @@
 #include <string.h>
 #include "include/base64.h"
 #include "include/block.h"
+#include "include/endian.h"
 #include "include/hash.h"
+#include "include/hash_batch.h"
 #include "include/transaction.h"
 #include "include/return_codes.h"
 #include "tests/test_block.h"
@@ -354,8 +356,9 @@ void test_block_hash_multiple_transactions_included_in_hash() {
     assert_true(SUCCESS == return_code);
     // transaction2 is a copy of transaction1. We need to use a different memory
     // location to protect against race conditions when destroying both blocks.
-    transaction_t *transaction2 = malloc(sizeof(transaction_t));
-    memcpy(transaction2, transaction1, sizeof(transaction_t));
+    transaction_t *transaction2 = NULL;
+    return_code = transaction_copy(&transaction2, transaction1);
+    assert_true(SUCCESS == return_code);
     return_code = linked_list_prepend(transaction_list1, transaction1);
     assert_true(SUCCESS == return_code);
     transaction_t *transaction3 = NULL;
@@ -524,3 +527,392 @@ void test_block_hash_fails_on_invalid_input() {
     assert_true(FAILURE_INVALID_INPUT == return_code);
     block_destroy(block);
 }
+
+void test_block_merkle_root_is_zero_for_empty_block() {
+    linked_list_t *transaction_list = NULL;
+    return_code_t return_code = linked_list_create(
+        &transaction_list,
+        (free_function_t *)transaction_destroy,
+        NULL);
+    assert_true(SUCCESS == return_code);
+    block_t *block = NULL;
+    sha_256_t previous_block_hash = {0};
+    return_code = block_create(
+        &block,
+        transaction_list,
+        123,
+        previous_block_hash);
+    assert_true(SUCCESS == return_code);
+    sha_256_t merkle_root = {0};
+    merkle_root.digest[0] = 'A';
+    return_code = block_merkle_root(block, &merkle_root);
+    assert_true(SUCCESS == return_code);
+    sha_256_t empty_hash = {0};
+    assert_true(0 == memcmp(&merkle_root, &empty_hash, sizeof(sha_256_t)));
+    block_destroy(block);
+}
+
+void test_block_merkle_root_combines_transaction_hashes() {
+    linked_list_t *transaction_list = NULL;
+    return_code_t return_code = linked_list_create(
+        &transaction_list,
+        (free_function_t *)transaction_destroy,
+        NULL);
+    assert_true(SUCCESS == return_code);
+    // The Merkle root does not check signatures, so unsigned transactions with
+    // different amounts are enough to get different leaves.
+    transaction_t *transactions[3] = {0};
+    sha_256_t leaves[3] = {0};
+    for (size_t idx = 0; idx < 3; idx++) {
+        transactions[idx] = calloc(1, sizeof(transaction_t));
+        transactions[idx]->amount = idx + 1;
+        return_code = transaction_hash(transactions[idx], &leaves[idx]);
+        assert_true(SUCCESS == return_code);
+    }
+    block_t *block = NULL;
+    sha_256_t previous_block_hash = {0};
+    return_code = block_create(
+        &block,
+        transaction_list,
+        123,
+        previous_block_hash);
+    assert_true(SUCCESS == return_code);
+    // With one transaction, the root commits to the count and the leaf.
+    sha_256_t leaf_hashes[3] = {0};
+    for (size_t idx = 0; idx < 3; idx++) {
+        unsigned char leaf[1 + sizeof(sha_256_t)];
+        leaf[0] = BLOCK_MERKLE_LEAF_PREFIX;
+        memcpy(leaf + 1, &leaves[idx], sizeof(sha_256_t));
+        SHA256(leaf, sizeof(leaf), leaf_hashes[idx].digest);
+    }
+    return_code = linked_list_append(transaction_list, transactions[0]);
+    assert_true(SUCCESS == return_code);
+    unsigned char root[sizeof(uint64_t) + sizeof(sha_256_t)];
+    *(uint64_t *)root = htobe64(1);
+    memcpy(root + sizeof(uint64_t), &leaf_hashes[0], sizeof(sha_256_t));
+    sha_256_t expected_merkle_root = {0};
+    SHA256(root, sizeof(root), expected_merkle_root.digest);
+    sha_256_t merkle_root = {0};
+    return_code = block_merkle_root(block, &merkle_root);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(
+        &merkle_root, &expected_merkle_root, sizeof(sha_256_t)));
+    // With three transactions, the last leaf moves up unchanged.
+    return_code = linked_list_append(transaction_list, transactions[1]);
+    assert_true(SUCCESS == return_code);
+    return_code = linked_list_append(transaction_list, transactions[2]);
+    assert_true(SUCCESS == return_code);
+    unsigned char parent[1 + 2 * sizeof(sha_256_t)];
+    parent[0] = BLOCK_MERKLE_NODE_PREFIX;
+    memcpy(parent + 1, leaf_hashes, 2 * sizeof(sha_256_t));
+    sha_256_t children[2] = {0};
+    SHA256(parent, sizeof(parent), children[0].digest);
+    children[1] = leaf_hashes[2];
+    memcpy(parent + 1, children, 2 * sizeof(sha_256_t));
+    sha_256_t top = {0};
+    SHA256(parent, sizeof(parent), top.digest);
+    *(uint64_t *)root = htobe64(3);
+    memcpy(root + sizeof(uint64_t), &top, sizeof(sha_256_t));
+    SHA256(root, sizeof(root), expected_merkle_root.digest);
+    return_code = block_merkle_root(block, &merkle_root);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(
+        &merkle_root, &expected_merkle_root, sizeof(sha_256_t)));
+    block_destroy(block);
+}
+
+void test_block_merkle_root_changes_when_last_transaction_repeats() {
+    linked_list_t *transaction_list = NULL;
+    return_code_t return_code = linked_list_create(
+        &transaction_list,
+        (free_function_t *)transaction_destroy,
+        NULL);
+    assert_true(SUCCESS == return_code);
+    block_t *block = NULL;
+    sha_256_t previous_block_hash = {0};
+    return_code = block_create(
+        &block,
+        transaction_list,
+        123,
+        previous_block_hash);
+    assert_true(SUCCESS == return_code);
+    for (size_t idx = 0; idx < 3; idx++) {
+        transaction_t *transaction = calloc(1, sizeof(transaction_t));
+        transaction->amount = idx + 1;
+        return_code = linked_list_append(transaction_list, transaction);
+        assert_true(SUCCESS == return_code);
+    }
+    sha_256_t merkle_root = {0};
+    return_code = block_merkle_root(block, &merkle_root);
+    assert_true(SUCCESS == return_code);
+    // If the odd leaf were paired with itself, [A, B, C] and [A, B, C, C]
+    // would share a root, and so would the headers and proofs of work.
+    transaction_t *repeated_transaction = calloc(1, sizeof(transaction_t));
+    repeated_transaction->amount = 3;
+    return_code = linked_list_append(transaction_list, repeated_transaction);
+    assert_true(SUCCESS == return_code);
+    sha_256_t repeated_merkle_root = {0};
+    return_code = block_merkle_root(block, &repeated_merkle_root);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 != memcmp(
+        &merkle_root, &repeated_merkle_root, sizeof(sha_256_t)));
+    block_destroy(block);
+}
+
+void test_block_merkle_root_fails_on_invalid_input() {
+    linked_list_t *transaction_list = NULL;
+    return_code_t return_code = linked_list_create(
+        &transaction_list,
+        (free_function_t *)transaction_destroy,
+        NULL);
+    assert_true(SUCCESS == return_code);
+    block_t *block = NULL;
+    sha_256_t previous_block_hash = {0};
+    return_code = block_create(
+        &block,
+        transaction_list,
+        123,
+        previous_block_hash);
+    assert_true(SUCCESS == return_code);
+    sha_256_t merkle_root = {0};
+    return_code = block_merkle_root(NULL, &merkle_root);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = block_merkle_root(block, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    block_destroy(block);
+}
+
+void test_block_get_header_gives_block_fields() {
+    linked_list_t *transaction_list = NULL;
+    return_code_t return_code = linked_list_create(
+        &transaction_list,
+        (free_function_t *)transaction_destroy,
+        NULL);
+    assert_true(SUCCESS == return_code);
+    block_t *block = NULL;
+    sha_256_t previous_block_hash = {0};
+    previous_block_hash.digest[0] = 'A';
+    return_code = block_create(
+        &block,
+        transaction_list,
+        123,
+        previous_block_hash);
+    assert_true(SUCCESS == return_code);
+    block_header_t header = {0};
+    return_code = block_get_header(block, &header);
+    assert_true(SUCCESS == return_code);
+    assert_true(block->created_at == header.created_at);
+    assert_true(123 == header.proof_of_work);
+    assert_true(0 == memcmp(
+        &header.previous_block_hash, &previous_block_hash, sizeof(sha_256_t)));
+    sha_256_t merkle_root = {0};
+    return_code = block_merkle_root(block, &merkle_root);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(
+        &header.merkle_root, &merkle_root, sizeof(sha_256_t)));
+    block_destroy(block);
+}
+
+void test_block_get_header_fails_on_invalid_input() {
+    linked_list_t *transaction_list = NULL;
+    return_code_t return_code = linked_list_create(
+        &transaction_list,
+        (free_function_t *)transaction_destroy,
+        NULL);
+    assert_true(SUCCESS == return_code);
+    block_t *block = NULL;
+    sha_256_t previous_block_hash = {0};
+    return_code = block_create(
+        &block,
+        transaction_list,
+        123,
+        previous_block_hash);
+    assert_true(SUCCESS == return_code);
+    block_header_t header = {0};
+    return_code = block_get_header(NULL, &header);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = block_get_header(block, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    block_destroy(block);
+}
+
+void test_block_header_hash_matches_block_hash() {
+    linked_list_t *transaction_list = NULL;
+    return_code_t return_code = linked_list_create(
+        &transaction_list,
+        (free_function_t *)transaction_destroy,
+        NULL);
+    assert_true(SUCCESS == return_code);
+    transaction_t *transaction = calloc(1, sizeof(transaction_t));
+    transaction->amount = 5;
+    return_code = linked_list_append(transaction_list, transaction);
+    assert_true(SUCCESS == return_code);
+    block_t *block = NULL;
+    sha_256_t previous_block_hash = {0};
+    return_code = block_create(
+        &block,
+        transaction_list,
+        123,
+        previous_block_hash);
+    assert_true(SUCCESS == return_code);
+    block_header_t header = {0};
+    return_code = block_get_header(block, &header);
+    assert_true(SUCCESS == return_code);
+    sha_256_t header_hash = {0};
+    return_code = block_header_hash(&header, &header_hash);
+    assert_true(SUCCESS == return_code);
+    sha_256_t hash = {0};
+    return_code = block_hash(block, &hash);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(&header_hash, &hash, sizeof(sha_256_t)));
+    block_destroy(block);
+}
+
+void test_block_header_hash_fails_on_invalid_input() {
+    block_header_t header = {0};
+    sha_256_t hash = {0};
+    return_code_t return_code = block_header_hash(NULL, &hash);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = block_header_hash(&header, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_block_header_hash_from_midstate_matches_block_header_hash() {
+    block_header_t header = {0};
+    header.created_at = 1;
+    header.previous_block_hash.digest[0] = 'A';
+    for (size_t idx = 0; idx < sizeof(header.merkle_root); idx++) {
+        header.merkle_root.digest[idx] = (unsigned char)idx;
+    }
+    sha_256_midstate_t midstate = {0};
+    return_code_t return_code = block_header_midstate(&header, &midstate);
+    assert_true(SUCCESS == return_code);
+    // The midstate stays valid as the proof of work changes.
+    for (uint64_t proof_of_work = 0; proof_of_work < 100; proof_of_work++) {
+        header.proof_of_work = proof_of_work;
+        sha_256_t expected_hash = {0};
+        return_code = block_header_hash(&header, &expected_hash);
+        assert_true(SUCCESS == return_code);
+        sha_256_t hash = {0};
+        return_code = block_header_hash_from_midstate(
+            &midstate, &header, &hash);
+        assert_true(SUCCESS == return_code);
+        assert_true(0 == memcmp(&hash, &expected_hash, sizeof(sha_256_t)));
+    }
+}
+
+void test_block_header_hash_from_midstate_fails_on_invalid_input() {
+    block_header_t header = {0};
+    sha_256_midstate_t midstate = {0};
+    return_code_t return_code = block_header_midstate(&header, &midstate);
+    assert_true(SUCCESS == return_code);
+    return_code = block_header_midstate(NULL, &midstate);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = block_header_midstate(&header, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    sha_256_t hash = {0};
+    return_code = block_header_hash_from_midstate(NULL, &header, &hash);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = block_header_hash_from_midstate(&midstate, NULL, &hash);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = block_header_hash_from_midstate(&midstate, &header, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_block_header_final_block_batch_matches_block_header_hash() {
+    block_header_t header = {0};
+    header.created_at = 1;
+    header.previous_block_hash.digest[0] = 'A';
+    for (size_t idx = 0; idx < sizeof(header.merkle_root); idx++) {
+        header.merkle_root.digest[idx] = (unsigned char)idx;
+    }
+    sha_256_midstate_t midstate = {0};
+    return_code_t return_code = block_header_midstate(&header, &midstate);
+    assert_true(SUCCESS == return_code);
+    unsigned char final_block[SHA_256_BLOCK_LENGTH];
+    return_code = block_header_final_block(&midstate, &header, final_block);
+    assert_true(SUCCESS == return_code);
+    const hash_batch_kernel_t *kernel = NULL;
+    return_code = hash_batch_get_best_kernel(&kernel);
+    assert_true(SUCCESS == return_code);
+    for (uint64_t first_proof = 0;
+        first_proof < 100;
+        first_proof += kernel->num_lanes) {
+        sha_256_t hashes[HASH_BATCH_MAX_LANES];
+        return_code = hash_batch_finalize(
+            kernel,
+            &midstate,
+            final_block,
+            BLOCK_HEADER_FINAL_BLOCK_PROOF_OF_WORK_OFFSET,
+            first_proof,
+            hashes);
+        assert_true(SUCCESS == return_code);
+        for (size_t lane = 0; lane < kernel->num_lanes; lane++) {
+            header.proof_of_work = first_proof + lane;
+            sha_256_t expected_hash = {0};
+            return_code = block_header_hash(&header, &expected_hash);
+            assert_true(SUCCESS == return_code);
+            assert_true(0 == memcmp(
+                &hashes[lane], &expected_hash, sizeof(sha_256_t)));
+        }
+    }
+}
+
+void test_block_header_final_block_rolls_extra_nonce_in_place() {
+    block_header_t header = {0};
+    header.created_at = 1;
+    header.previous_block_hash.digest[0] = 'A';
+    for (size_t idx = 0; idx < sizeof(header.merkle_root); idx++) {
+        header.merkle_root.digest[idx] = (unsigned char)idx;
+    }
+    sha_256_midstate_t midstate = {0};
+    return_code_t return_code = block_header_midstate(&header, &midstate);
+    assert_true(SUCCESS == return_code);
+    unsigned char final_block[SHA_256_BLOCK_LENGTH];
+    return_code = block_header_final_block(&midstate, &header, final_block);
+    assert_true(SUCCESS == return_code);
+    const hash_batch_kernel_t *kernel = NULL;
+    return_code = hash_batch_get_best_kernel(&kernel);
+    assert_true(SUCCESS == return_code);
+    // Overwriting the extra nonce in the final block should give the same
+    // hashes as a header with that extra nonce, without a new midstate.
+    sha_256_t previous_hash = {0};
+    for (uint64_t extra_nonce = 1; extra_nonce < 4; extra_nonce++) {
+        uint64_t extra_nonce_big_endian = htobe64(extra_nonce);
+        memcpy(
+            final_block + BLOCK_HEADER_FINAL_BLOCK_EXTRA_NONCE_OFFSET,
+            &extra_nonce_big_endian,
+            sizeof(extra_nonce_big_endian));
+        sha_256_t hashes[HASH_BATCH_MAX_LANES];
+        return_code = hash_batch_finalize(
+            kernel,
+            &midstate,
+            final_block,
+            BLOCK_HEADER_FINAL_BLOCK_PROOF_OF_WORK_OFFSET,
+            0,
+            hashes);
+        assert_true(SUCCESS == return_code);
+        header.extra_nonce = extra_nonce;
+        header.proof_of_work = 0;
+        sha_256_t expected_hash = {0};
+        return_code = block_header_hash(&header, &expected_hash);
+        assert_true(SUCCESS == return_code);
+        assert_true(0 == memcmp(&hashes[0], &expected_hash, sizeof(sha_256_t)));
+        assert_true(0 != memcmp(&hashes[0], &previous_hash, sizeof(sha_256_t)));
+        previous_hash = hashes[0];
+    }
+}
+
+void test_block_header_final_block_fails_on_invalid_input() {
+    block_header_t header = {0};
+    sha_256_midstate_t midstate = {0};
+    return_code_t return_code = block_header_midstate(&header, &midstate);
+    assert_true(SUCCESS == return_code);
+    unsigned char final_block[SHA_256_BLOCK_LENGTH];
+    return_code = block_header_final_block(NULL, &header, final_block);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = block_header_final_block(&midstate, NULL, final_block);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = block_header_final_block(&midstate, &header, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
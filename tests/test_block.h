@@ -37,4 +37,30 @@ void test_block_hash_previous_block_hash_included_in_hash();
 
 void test_block_hash_fails_on_invalid_input();
 
+void test_block_merkle_root_is_zero_for_empty_block();
+
+void test_block_merkle_root_combines_transaction_hashes();
+
+void test_block_merkle_root_changes_when_last_transaction_repeats();
+
+void test_block_merkle_root_fails_on_invalid_input();
+
+void test_block_get_header_gives_block_fields();
+
+void test_block_get_header_fails_on_invalid_input();
+
+void test_block_header_hash_matches_block_hash();
+
+void test_block_header_hash_fails_on_invalid_input();
+
+void test_block_header_hash_from_midstate_matches_block_header_hash();
+
+void test_block_header_hash_from_midstate_fails_on_invalid_input();
+
+void test_block_header_final_block_batch_matches_block_header_hash();
+
+void test_block_header_final_block_rolls_extra_nonce_in_place();
+
+void test_block_header_final_block_fails_on_invalid_input();
+
 #endif  // TESTS_TEST_BLOCK_H_
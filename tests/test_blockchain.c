@@ -1,18 +1,29 @@
+#include <fcntl.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include "include/base64.h"
 #include "include/block.h"
 #include "include/blockchain.h"
+#include "include/endian.h"
 #include "include/hash.h"
 #include "include/linked_list.h"
 #include "include/transaction.h"
 #include "tests/file_paths.h"
 #include "tests/test_blockchain.h"
+#include "tests/test_cryptography.h"
 
 #define NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH 2
-#define EXPERIMENTALLY_FOUND_PROOF_OF_WORK 90797
+#define EXPERIMENTALLY_FOUND_PROOF_OF_WORK 126384
+#define EXPERIMENTALLY_FOUND_PROOF_OF_WORK_AFTER_EXTRA_NONCE_ROLL 91133
+// The size of a block header in a serialized blockchain: created_at, the
+// previous block hash, extra_nonce, proof_of_work, and the number of
+// transactions.
+#define SERIALIZED_BLOCK_HEADER_SIZE 64
 
 void test_blockchain_create_gives_blockchain() {
     blockchain_t *blockchain = NULL;
@@ -32,6 +43,92 @@ void test_blockchain_create_fails_on_invalid_input() {
     assert_true(FAILURE_INVALID_INPUT == return_code);
 }
 
+void test_blockchain_create_with_target_gives_blockchain() {
+    blockchain_target_t target = {0};
+    return_code_t return_code = blockchain_target_from_num_leading_zero_bits(
+        12, &target);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *blockchain = NULL;
+    return_code = blockchain_create_with_target(&blockchain, target);
+    assert_true(SUCCESS == return_code);
+    assert_true(NULL != blockchain);
+    assert_true(NULL != blockchain->block_list);
+    assert_true(0 == memcmp(
+        &target, &blockchain->target, sizeof(blockchain_target_t)));
+    // 12 bits is not a whole number of bytes.
+    assert_true(NUM_LEADING_ZERO_BYTES_CUSTOM_TARGET ==
+        blockchain->num_leading_zero_bytes_required_in_block_hash);
+    blockchain_destroy(blockchain);
+    return_code = blockchain_target_from_num_leading_zero_bits(16, &target);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_create_with_target(&blockchain, target);
+    assert_true(SUCCESS == return_code);
+    assert_true(2 == blockchain->num_leading_zero_bytes_required_in_block_hash);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_create_with_target_fails_on_invalid_input() {
+    blockchain_target_t target = {0};
+    return_code_t return_code = blockchain_create_with_target(NULL, target);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    // A hash cannot have more leading zero bytes than its length.
+    blockchain_t *blockchain = NULL;
+    return_code = blockchain_create(&blockchain, sizeof(sha_256_t) + 1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_blockchain_target_from_num_leading_zero_bits_gives_target() {
+    blockchain_target_t target = {0};
+    return_code_t return_code = blockchain_target_from_num_leading_zero_bits(
+        0, &target);
+    assert_true(SUCCESS == return_code);
+    for (size_t idx = 0; idx < BLOCKCHAIN_TARGET_NUM_WORDS; idx++) {
+        assert_true(UINT64_MAX == target.words[idx]);
+    }
+    return_code = blockchain_target_from_num_leading_zero_bits(70, &target);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == target.words[0]);
+    assert_true(UINT64_MAX >> 6 == target.words[1]);
+    assert_true(UINT64_MAX == target.words[2]);
+    assert_true(UINT64_MAX == target.words[3]);
+    return_code = blockchain_target_from_num_leading_zero_bits(
+        8 * sizeof(sha_256_t), &target);
+    assert_true(SUCCESS == return_code);
+    for (size_t idx = 0; idx < BLOCKCHAIN_TARGET_NUM_WORDS; idx++) {
+        assert_true(0 == target.words[idx]);
+    }
+}
+
+void test_blockchain_target_from_num_leading_zero_bytes_matches_bits() {
+    for (size_t num_bytes = 0; num_bytes <= sizeof(sha_256_t); num_bytes++) {
+        blockchain_target_t byte_target = {0};
+        return_code_t return_code =
+            blockchain_target_from_num_leading_zero_bytes(
+                num_bytes, &byte_target);
+        assert_true(SUCCESS == return_code);
+        blockchain_target_t bit_target = {0};
+        return_code = blockchain_target_from_num_leading_zero_bits(
+            8 * num_bytes, &bit_target);
+        assert_true(SUCCESS == return_code);
+        assert_true(0 == memcmp(
+            &byte_target, &bit_target, sizeof(blockchain_target_t)));
+    }
+}
+
+void test_blockchain_target_fails_on_invalid_input() {
+    blockchain_target_t target = {0};
+    return_code_t return_code = blockchain_target_from_num_leading_zero_bits(
+        8 * sizeof(sha_256_t) + 1, &target);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_target_from_num_leading_zero_bits(0, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_target_from_num_leading_zero_bytes(
+        sizeof(sha_256_t) + 1, &target);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_target_from_num_leading_zero_bytes(0, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
 void test_blockchain_destroy_returns_success() {
     blockchain_t *blockchain = NULL;
     return_code_t return_code = blockchain_create(
@@ -243,6 +340,40 @@ void test_blockchain_is_valid_block_hash_fails_on_invalid_input() {
     blockchain_destroy(blockchain);
 }
 
+void test_blockchain_is_valid_block_hash_compares_hash_with_target() {
+    blockchain_target_t target = {0};
+    target.words[0] = 0x0000123400000000;
+    target.words[1] = 5;
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create_with_target(
+        &blockchain, target);
+    assert_true(SUCCESS == return_code);
+    // A hash equal to the target meets it.
+    sha_256_t hash = {0};
+    hash.digest[2] = 0x12;
+    hash.digest[3] = 0x34;
+    hash.digest[15] = 5;
+    bool is_valid_block_hash = false;
+    return_code = blockchain_is_valid_block_hash(
+        blockchain, hash, &is_valid_block_hash);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid_block_hash);
+    // A hash one more than the target does not.
+    hash.digest[31] = 1;
+    return_code = blockchain_is_valid_block_hash(
+        blockchain, hash, &is_valid_block_hash);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid_block_hash);
+    // A smaller first word decides the comparison on its own.
+    hash.digest[3] = 0x33;
+    hash.digest[8] = 0xff;
+    return_code = blockchain_is_valid_block_hash(
+        blockchain, hash, &is_valid_block_hash);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid_block_hash);
+    blockchain_destroy(blockchain);
+}
+
 void test_blockchain_mine_block_produces_block_with_valid_hash() {
     blockchain_t *blockchain = NULL;
     return_code_t return_code = blockchain_create(
@@ -262,7 +393,7 @@ void test_blockchain_mine_block_produces_block_with_valid_hash() {
     block1->created_at = 0;
     atomic_bool should_stop = false;
     return_code = blockchain_mine_block(
-        blockchain, block1, false, &should_stop);
+        blockchain, block1, false, &should_stop, 1);
     assert_true(SUCCESS == return_code);
     assert_true(0 != block1->proof_of_work);
     assert_true(EXPERIMENTALLY_FOUND_PROOF_OF_WORK == block1->proof_of_work);
@@ -278,7 +409,7 @@ void test_blockchain_mine_block_produces_block_with_valid_hash() {
     blockchain_destroy(blockchain);
 }
 
-void test_blockchain_mine_block_fails_on_invalid_input() {
+void test_blockchain_mine_block_multithreaded_gives_same_proof_of_work() {
     blockchain_t *blockchain = NULL;
     return_code_t return_code = blockchain_create(
         &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
@@ -293,209 +424,1464 @@ void test_blockchain_mine_block_fails_on_invalid_input() {
         transaction_list1,
         0,
         previous_block_hash);
+    // Manually set created_at to get a consistent hash.
+    block1->created_at = 0;
     atomic_bool should_stop = false;
-    return_code = blockchain_mine_block(NULL, block1, false, &should_stop);
-    assert_true(FAILURE_INVALID_INPUT == return_code);
-    return_code = blockchain_mine_block(blockchain, NULL, false, &should_stop);
-    assert_true(FAILURE_INVALID_INPUT == return_code);
-    return_code = blockchain_mine_block(blockchain, block1, false, NULL);
-    assert_true(FAILURE_INVALID_INPUT == return_code);
+    // Workers search disjoint stripes of the nonce space, but the result
+    // should still be the smallest valid proof of work.
+    return_code = blockchain_mine_block(
+        blockchain, block1, false, &should_stop, 4);
+    assert_true(SUCCESS == return_code);
+    assert_true(EXPERIMENTALLY_FOUND_PROOF_OF_WORK == block1->proof_of_work);
     block_destroy(block1);
     blockchain_destroy(blockchain);
 }
 
-void test_blockchain_verify_succeeds_on_valid_blockchain() {
-    char fixture_directory[TESTS_MAX_PATH];
-    get_fixture_directory(fixture_directory);
-    char infile[TESTS_MAX_PATH];
-    int return_value = snprintf(
-        infile,
-        TESTS_MAX_PATH,
-        "%s/%s",
-        fixture_directory,
-        "blockchain_4_blocks_no_transactions");
-    assert_true(return_value < TESTS_MAX_PATH);
-    blockchain_t *blockchain = NULL;
-    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+void *_mine_block_from_thread(void *args) {
+    blockchain_t *blockchain = (blockchain_t *)args;
+    linked_list_t *transaction_list = NULL;
+    return_code_t return_code = linked_list_create(
+        &transaction_list, free, NULL);
     assert_true(SUCCESS == return_code);
-    bool is_valid = false;
-    block_t *first_invalid_block = NULL;
-    return_code = blockchain_verify(
-        blockchain, &is_valid, &first_invalid_block);
+    block_t *block = NULL;
+    sha_256_t previous_block_hash = {0};
+    return_code = block_create(
+        &block, transaction_list, 0, previous_block_hash);
     assert_true(SUCCESS == return_code);
-    assert_true(is_valid);
-    assert_true(NULL == first_invalid_block);
-    blockchain_destroy(blockchain);
+    block->created_at = 0;
+    atomic_bool should_stop = false;
+    for (size_t idx = 0; idx < 3; idx++) {
+        block->proof_of_work = 0;
+        return_code = blockchain_mine_block(
+            blockchain, block, false, &should_stop, 2);
+        assert_true(SUCCESS == return_code);
+        assert_true(
+            EXPERIMENTALLY_FOUND_PROOF_OF_WORK == block->proof_of_work);
+    }
+    block_destroy(block);
+    return NULL;
 }
 
-void test_blockchain_verify_fails_on_invalid_genesis_block() {
-    char fixture_directory[TESTS_MAX_PATH];
-    get_fixture_directory(fixture_directory);
-    char infile[TESTS_MAX_PATH];
-    int return_value = snprintf(
-        infile,
-        TESTS_MAX_PATH,
-        "%s/%s",
-        fixture_directory,
-        "blockchain_4_blocks_no_transactions");
-    assert_true(return_value < TESTS_MAX_PATH);
+void test_blockchain_mine_block_reuses_pools_across_concurrent_calls() {
     blockchain_t *blockchain = NULL;
-    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
-    assert_true(SUCCESS == return_code);
-    block_t *genesis_block = (block_t *)blockchain->block_list->head->data;
-    genesis_block->proof_of_work += 1;
-    bool is_valid = false;
-    block_t *first_invalid_block = NULL;
-    return_code = blockchain_verify(
-        blockchain, &is_valid, &first_invalid_block);
-    assert_true(SUCCESS == return_code);
-    assert_true(!is_valid);
-    assert_true(first_invalid_block == genesis_block);
-    genesis_block->proof_of_work = GENESIS_BLOCK_PROOF_OF_WORK;
-    genesis_block->previous_block_hash.digest[0] = 'A';
-    is_valid = false;
-    first_invalid_block = NULL;
-    return_code = blockchain_verify(
-        blockchain, &is_valid, &first_invalid_block);
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
     assert_true(SUCCESS == return_code);
-    assert_true(!is_valid);
-    assert_true(first_invalid_block == genesis_block);
+    // Calls reuse idle pools, but two calls must never search on the same pool
+    // at once.
+    pthread_t threads[2];
+    for (size_t idx = 0; idx < 2; idx++) {
+        assert_true(0 == pthread_create(
+            &threads[idx], NULL, _mine_block_from_thread, blockchain));
+    }
+    for (size_t idx = 0; idx < 2; idx++) {
+        pthread_join(threads[idx], NULL);
+    }
     blockchain_destroy(blockchain);
 }
 
-void test_blockchain_verify_fails_on_invalid_proof_of_work() {
-    char fixture_directory[TESTS_MAX_PATH];
-    get_fixture_directory(fixture_directory);
-    char infile[TESTS_MAX_PATH];
-    int return_value = snprintf(
-        infile,
-        TESTS_MAX_PATH,
-        "%s/%s",
-        fixture_directory,
-        "blockchain_4_blocks_no_transactions");
-    assert_true(return_value < TESTS_MAX_PATH);
+void test_blockchain_mine_block_fails_on_invalid_input() {
     blockchain_t *blockchain = NULL;
-    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
     assert_true(SUCCESS == return_code);
-    block_t *block = (block_t *)blockchain->block_list->head->next->data;
-    block->proof_of_work += 1;
-    bool is_valid = false;
-    block_t *first_invalid_block = NULL;
-    return_code = blockchain_verify(
-        blockchain, &is_valid, &first_invalid_block);
+    linked_list_t *transaction_list1 = NULL;
+    return_code = linked_list_create(&transaction_list1, free, NULL);
     assert_true(SUCCESS == return_code);
-    assert_true(!is_valid);
-    assert_true(first_invalid_block == block);
+    block_t *block1 = NULL;
+    sha_256_t previous_block_hash = {0};
+    return_code = block_create(
+        &block1,
+        transaction_list1,
+        0,
+        previous_block_hash);
+    atomic_bool should_stop = false;
+    return_code = blockchain_mine_block(
+        NULL, block1, false, &should_stop, 1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_mine_block(
+        blockchain, NULL, false, &should_stop, 1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_mine_block(blockchain, block1, false, NULL, 1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    block_destroy(block1);
     blockchain_destroy(blockchain);
 }
 
-void test_blockchain_verify_fails_on_invalid_previous_block_hash() {
-    char fixture_directory[TESTS_MAX_PATH];
-    get_fixture_directory(fixture_directory);
-    char infile[TESTS_MAX_PATH];
-    int return_value = snprintf(
-        infile,
-        TESTS_MAX_PATH,
-        "%s/%s",
-        fixture_directory,
-        "blockchain_4_blocks_no_transactions");
-    assert_true(return_value < TESTS_MAX_PATH);
-    blockchain_t *blockchain = NULL;
-    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
-    assert_true(SUCCESS == return_code);
-    block_t *block = (block_t *)blockchain->block_list->head->next->next->data;
-    block->previous_block_hash.digest[0] = 'A';
-    block->previous_block_hash.digest[1] = 'A';
-    block->previous_block_hash.digest[2] = 'A';
-    bool is_valid = false;
-    block_t *first_invalid_block = NULL;
-    return_code = blockchain_verify(
-        blockchain, &is_valid, &first_invalid_block);
-    assert_true(SUCCESS == return_code);
-    assert_true(!is_valid);
-    assert_true(first_invalid_block == block);
-    blockchain_destroy(blockchain);
+return_code_t _never_abort(void *args) {
+    (void)args;
+    return SUCCESS;
 }
 
-void test_blockchain_verify_fails_on_invalid_transaction_signature() {
-    char fixture_directory[TESTS_MAX_PATH];
-    get_fixture_directory(fixture_directory);
-    char infile[TESTS_MAX_PATH];
-    int return_value = snprintf(
-        infile,
-        TESTS_MAX_PATH,
-        "%s/%s",
-        fixture_directory,
-        "blockchain_4_blocks_no_transactions");
-    assert_true(return_value < TESTS_MAX_PATH);
-    blockchain_t *blockchain = NULL;
-    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
-    assert_true(SUCCESS == return_code);
-    block_t *block = (block_t *)blockchain->block_list->head->next->next->data;
-    transaction_t *minting_transaction =
-        (transaction_t *)block->transaction_list->head->data;
-    minting_transaction->sender_signature.bytes[0] = 'A';
-    minting_transaction->sender_signature.bytes[1] = 'A';
-    minting_transaction->sender_signature.bytes[2] = 'A';
-    bool is_valid = false;
-    block_t *first_invalid_block = NULL;
-    return_code = blockchain_verify(
-        blockchain, &is_valid, &first_invalid_block);
-    assert_true(SUCCESS == return_code);
-    assert_true(!is_valid);
-    assert_true(first_invalid_block == block);
-    blockchain_destroy(blockchain);
+return_code_t _always_abort(void *args) {
+    size_t *num_calls = (size_t *)args;
+    (*num_calls)++;
+    return FAILURE_STOPPED_EARLY;
 }
 
-void test_blockchain_verify_fails_on_invalid_input() {
-    char fixture_directory[TESTS_MAX_PATH];
-    get_fixture_directory(fixture_directory);
-    char infile[TESTS_MAX_PATH];
-    int return_value = snprintf(
-        infile,
-        TESTS_MAX_PATH,
-        "%s/%s",
-        fixture_directory,
-        "blockchain_4_blocks_no_transactions");
-    assert_true(return_value < TESTS_MAX_PATH);
+void test_blockchain_search_for_proof_of_work_ignores_batch_size() {
     blockchain_t *blockchain = NULL;
-    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
     assert_true(SUCCESS == return_code);
-    bool is_valid = false;
-    block_t *first_invalid_block = NULL;
-    return_code = blockchain_verify(
-        NULL, &is_valid, &first_invalid_block);
-    assert_true(FAILURE_INVALID_INPUT == return_code);
-    return_code = blockchain_verify(
-        blockchain, NULL, &first_invalid_block);
-    assert_true(FAILURE_INVALID_INPUT == return_code);
+    linked_list_t *transaction_list1 = NULL;
+    return_code = linked_list_create(&transaction_list1, free, NULL);
+    assert_true(SUCCESS == return_code);
+    block_t *block1 = NULL;
+    sha_256_t previous_block_hash = {0};
+    return_code = block_create(
+        &block1,
+        transaction_list1,
+        0,
+        previous_block_hash);
+    assert_true(SUCCESS == return_code);
+    // Manually set created_at to get a consistent hash.
+    block1->created_at = 0;
+    // The result should be the smallest valid proof of work regardless of
+    // how the nonce space is split into batches.
+    uint64_t batch_sizes[] = {0, 1, 1000, MINING_DEFAULT_BATCH_SIZE * 4};
+    for (size_t idx = 0; idx < sizeof(batch_sizes) / sizeof(uint64_t); idx++) {
+        block1->proof_of_work = 0;
+        return_code = blockchain_search_for_proof_of_work(
+            blockchain, block1, false, 2, batch_sizes[idx], _never_abort, NULL);
+        assert_true(SUCCESS == return_code);
+        assert_true(
+            EXPERIMENTALLY_FOUND_PROOF_OF_WORK == block1->proof_of_work);
+    }
+    block_destroy(block1);
     blockchain_destroy(blockchain);
 }
 
-void test_blockchain_serialize_creates_nonempty_buffer() {
+void test_blockchain_search_for_proof_of_work_returns_abort_code() {
     blockchain_t *blockchain = NULL;
     return_code_t return_code = blockchain_create(
         &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
     assert_true(SUCCESS == return_code);
-    block_t *genesis_block = NULL;
-    return_code = block_create_genesis_block(&genesis_block);
+    linked_list_t *transaction_list1 = NULL;
+    return_code = linked_list_create(&transaction_list1, free, NULL);
     assert_true(SUCCESS == return_code);
-    return_code = blockchain_add_block(blockchain, genesis_block);
+    block_t *block1 = NULL;
+    sha_256_t previous_block_hash = {0};
+    return_code = block_create(
+        &block1,
+        transaction_list1,
+        0,
+        previous_block_hash);
+    assert_true(SUCCESS == return_code);
+    block1->created_at = 0;
+    size_t num_calls = 0;
+    return_code = blockchain_search_for_proof_of_work(
+        blockchain, block1, false, 1, 1, _always_abort, &num_calls);
+    assert_true(FAILURE_STOPPED_EARLY == return_code);
+    // The single worker checks before its first batch and then stops.
+    assert_true(1 == num_calls);
+    block_destroy(block1);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_search_for_proof_of_work_fails_on_invalid_input() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    linked_list_t *transaction_list1 = NULL;
+    return_code = linked_list_create(&transaction_list1, free, NULL);
+    assert_true(SUCCESS == return_code);
+    block_t *block1 = NULL;
+    sha_256_t previous_block_hash = {0};
+    return_code = block_create(
+        &block1,
+        transaction_list1,
+        0,
+        previous_block_hash);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_search_for_proof_of_work(
+        NULL, block1, false, 1, 0, _never_abort, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_search_for_proof_of_work(
+        blockchain, NULL, false, 1, 0, _never_abort, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_search_for_proof_of_work(
+        blockchain, block1, false, 1, 0, NULL, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    block_destroy(block1);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_search_for_proof_of_work_rolls_extra_nonce() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    linked_list_t *transaction_list1 = NULL;
+    return_code = linked_list_create(&transaction_list1, free, NULL);
+    assert_true(SUCCESS == return_code);
+    block_t *block1 = NULL;
+    sha_256_t previous_block_hash = {0};
+    return_code = block_create(
+        &block1,
+        transaction_list1,
+        0,
+        previous_block_hash);
+    assert_true(SUCCESS == return_code);
+    // Manually set created_at to get a consistent hash.
+    block1->created_at = 0;
+    // Start just before the end of the proof of work space. No valid proof of
+    // work remains there, so the search should move on to the next extra
+    // nonce instead of failing.
+    uint64_t batch_sizes[] = {1, 16, 0};
+    for (size_t idx = 0; idx < sizeof(batch_sizes) / sizeof(uint64_t); idx++) {
+        block1->extra_nonce = 0;
+        block1->proof_of_work = UINT64_MAX - 15;
+        return_code = blockchain_search_for_proof_of_work(
+            blockchain, block1, false, 2, batch_sizes[idx], _never_abort, NULL);
+        assert_true(SUCCESS == return_code);
+        assert_true(1 == block1->extra_nonce);
+        assert_true(
+            EXPERIMENTALLY_FOUND_PROOF_OF_WORK_AFTER_EXTRA_NONCE_ROLL ==
+            block1->proof_of_work);
+        sha_256_t hash = {0};
+        return_code = block_hash(block1, &hash);
+        assert_true(SUCCESS == return_code);
+        bool is_valid_block_hash = false;
+        return_code = blockchain_is_valid_block_hash(
+            blockchain, hash, &is_valid_block_hash);
+        assert_true(SUCCESS == return_code);
+        assert_true(is_valid_block_hash);
+    }
+    block_destroy(block1);
+    blockchain_destroy(blockchain);
+}
+
+void test_mining_pools_destroy_shared_stops_idle_pools() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    linked_list_t *transaction_list1 = NULL;
+    return_code = linked_list_create(&transaction_list1, free, NULL);
+    assert_true(SUCCESS == return_code);
+    block_t *block1 = NULL;
+    sha_256_t previous_block_hash = {0};
+    return_code = block_create(
+        &block1,
+        transaction_list1,
+        0,
+        previous_block_hash);
+    assert_true(SUCCESS == return_code);
+    block1->created_at = 0;
+    // Mining must still work after the idle pools are gone.
+    for (size_t idx = 0; idx < 2; idx++) {
+        block1->proof_of_work = 0;
+        return_code = blockchain_search_for_proof_of_work(
+            blockchain, block1, false, 2, 0, _never_abort, NULL);
+        assert_true(SUCCESS == return_code);
+        assert_true(
+            EXPERIMENTALLY_FOUND_PROOF_OF_WORK == block1->proof_of_work);
+        return_code = mining_pools_destroy_shared();
+        assert_true(SUCCESS == return_code);
+    }
+    return_code = mining_pools_destroy_shared();
+    assert_true(SUCCESS == return_code);
+    block_destroy(block1);
+    blockchain_destroy(blockchain);
+}
+
+void test_mining_pool_create_gives_pool() {
+    mining_pool_t *pool = NULL;
+    return_code_t return_code = mining_pool_create(&pool, 3);
+    assert_true(SUCCESS == return_code);
+    assert_true(NULL != pool);
+    assert_true(3 == pool->num_workers);
+    assert_true(NULL == pool->search);
+    return_code = mining_pool_destroy(pool);
+    assert_true(SUCCESS == return_code);
+}
+
+void test_mining_pool_create_fails_on_invalid_input() {
+    return_code_t return_code = mining_pool_create(NULL, 1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = mining_pool_destroy(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_mining_pool_search_for_proof_of_work_reuses_workers() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    linked_list_t *transaction_list1 = NULL;
+    return_code = linked_list_create(&transaction_list1, free, NULL);
+    assert_true(SUCCESS == return_code);
+    block_t *block1 = NULL;
+    sha_256_t previous_block_hash = {0};
+    return_code = block_create(
+        &block1,
+        transaction_list1,
+        0,
+        previous_block_hash);
+    assert_true(SUCCESS == return_code);
+    // Manually set created_at to get a consistent hash.
+    block1->created_at = 0;
+    mining_pool_t *pool = NULL;
+    return_code = mining_pool_create(&pool, 2);
+    assert_true(SUCCESS == return_code);
+    // The same workers should run every search, including after an abort.
+    size_t num_calls = 0;
+    return_code = mining_pool_search_for_proof_of_work(
+        pool, blockchain, block1, false, 0, _always_abort, &num_calls);
+    assert_true(FAILURE_STOPPED_EARLY == return_code);
+    for (size_t idx = 0; idx < 3; idx++) {
+        block1->proof_of_work = 0;
+        return_code = mining_pool_search_for_proof_of_work(
+            pool, blockchain, block1, false, 0, _never_abort, NULL);
+        assert_true(SUCCESS == return_code);
+        assert_true(
+            EXPERIMENTALLY_FOUND_PROOF_OF_WORK == block1->proof_of_work);
+    }
+    assert_true(NULL == pool->search);
+    mining_pool_destroy(pool);
+    block_destroy(block1);
+    blockchain_destroy(blockchain);
+}
+
+void test_mining_pool_search_for_proof_of_work_fails_on_invalid_input() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    linked_list_t *transaction_list1 = NULL;
+    return_code = linked_list_create(&transaction_list1, free, NULL);
+    assert_true(SUCCESS == return_code);
+    block_t *block1 = NULL;
+    sha_256_t previous_block_hash = {0};
+    return_code = block_create(
+        &block1,
+        transaction_list1,
+        0,
+        previous_block_hash);
+    assert_true(SUCCESS == return_code);
+    mining_pool_t *pool = NULL;
+    return_code = mining_pool_create(&pool, 1);
+    assert_true(SUCCESS == return_code);
+    return_code = mining_pool_search_for_proof_of_work(
+        NULL, blockchain, block1, false, 0, _never_abort, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = mining_pool_search_for_proof_of_work(
+        pool, NULL, block1, false, 0, _never_abort, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = mining_pool_search_for_proof_of_work(
+        pool, blockchain, NULL, false, 0, _never_abort, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = mining_pool_search_for_proof_of_work(
+        pool, blockchain, block1, false, 0, NULL, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    mining_pool_destroy(pool);
+    block_destroy(block1);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_verify_succeeds_on_valid_blockchain() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_no_transactions_v3");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    bool is_valid = false;
+    block_t *first_invalid_block = NULL;
+    return_code = blockchain_verify(
+        blockchain, &is_valid, &first_invalid_block);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid);
+    assert_true(NULL == first_invalid_block);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_verify_fails_on_invalid_genesis_block() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_no_transactions_v3");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = (block_t *)blockchain->block_list->head->data;
+    genesis_block->proof_of_work += 1;
+    bool is_valid = false;
+    block_t *first_invalid_block = NULL;
+    return_code = blockchain_verify(
+        blockchain, &is_valid, &first_invalid_block);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid);
+    assert_true(first_invalid_block == genesis_block);
+    genesis_block->proof_of_work = GENESIS_BLOCK_PROOF_OF_WORK;
+    genesis_block->previous_block_hash.digest[0] = 'A';
+    is_valid = false;
+    first_invalid_block = NULL;
+    return_code = blockchain_verify(
+        blockchain, &is_valid, &first_invalid_block);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid);
+    assert_true(first_invalid_block == genesis_block);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_verify_fails_on_invalid_proof_of_work() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_no_transactions_v3");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    block_t *block = (block_t *)blockchain->block_list->head->next->data;
+    block->proof_of_work += 1;
+    bool is_valid = false;
+    block_t *first_invalid_block = NULL;
+    return_code = blockchain_verify(
+        blockchain, &is_valid, &first_invalid_block);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid);
+    assert_true(first_invalid_block == block);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_verify_fails_on_invalid_previous_block_hash() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_no_transactions_v3");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    block_t *block = (block_t *)blockchain->block_list->head->next->next->data;
+    block->previous_block_hash.digest[0] = 'A';
+    block->previous_block_hash.digest[1] = 'A';
+    block->previous_block_hash.digest[2] = 'A';
+    bool is_valid = false;
+    block_t *first_invalid_block = NULL;
+    return_code = blockchain_verify(
+        blockchain, &is_valid, &first_invalid_block);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid);
+    assert_true(first_invalid_block == block);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_verify_fails_on_invalid_transaction_signature() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_no_transactions_v3");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    block_t *block = (block_t *)blockchain->block_list->head->next->next->data;
+    transaction_t *minting_transaction =
+        (transaction_t *)block->transaction_list->head->data;
+    minting_transaction->sender_signature.bytes[0] = 'A';
+    minting_transaction->sender_signature.bytes[1] = 'A';
+    minting_transaction->sender_signature.bytes[2] = 'A';
+    bool is_valid = false;
+    block_t *first_invalid_block = NULL;
+    return_code = blockchain_verify(
+        blockchain, &is_valid, &first_invalid_block);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid);
+    assert_true(first_invalid_block == block);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_verify_finds_first_invalid_signature_in_parallel() {
+    char *ssh_public_key_contents_base64 = getenv(
+        TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t public_key = {0};
+    return_code_t return_code = base64_decode(
+        ssh_public_key_contents_base64,
+        strlen(ssh_public_key_contents_base64),
+        public_key.bytes);
+    assert_true(SUCCESS == return_code);
+    char *ssh_private_key_contents_base64 = getenv(
+        TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t private_key = {0};
+    return_code = base64_decode(
+        ssh_private_key_contents_base64,
+        strlen(ssh_private_key_contents_base64),
+        private_key.bytes);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *blockchain = NULL;
+    return_code = blockchain_create(&blockchain, 1);
+    assert_true(SUCCESS == return_code);
+    block_t *previous_block = NULL;
+    return_code = block_create_genesis_block(&previous_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, previous_block);
+    assert_true(SUCCESS == return_code);
+    // Blocks 2 and 4 each contain one bad signature, but are otherwise valid.
+    // Signatures are checked on many threads, but the result should still be
+    // the earliest block with a bad signature.
+    size_t num_blocks = 4;
+    size_t num_transactions_per_block = 10;
+    block_t *blocks[4] = {0};
+    for (size_t block_idx = 0; block_idx < num_blocks; block_idx++) {
+        linked_list_t *transaction_list = NULL;
+        return_code = linked_list_create(
+            &transaction_list, (free_function_t *)transaction_destroy, NULL);
+        assert_true(SUCCESS == return_code);
+        for (size_t transaction_idx = 0;
+            transaction_idx < num_transactions_per_block;
+            transaction_idx++) {
+            transaction_t *transaction = NULL;
+            return_code = transaction_create(
+                &transaction,
+                &public_key,
+                &public_key,
+                AMOUNT_GENERATED_DURING_MINTING,
+                &private_key);
+            assert_true(SUCCESS == return_code);
+            return_code = linked_list_append(transaction_list, transaction);
+            assert_true(SUCCESS == return_code);
+        }
+        if (1 == block_idx || 3 == block_idx) {
+            node_t *last_node = NULL;
+            return_code = linked_list_get_last(transaction_list, &last_node);
+            assert_true(SUCCESS == return_code);
+            transaction_t *transaction = (transaction_t *)last_node->data;
+            transaction->sender_signature.bytes[0] ^= 0xff;
+        }
+        sha_256_t previous_block_hash = {0};
+        return_code = block_hash(previous_block, &previous_block_hash);
+        assert_true(SUCCESS == return_code);
+        return_code = block_create(
+            &blocks[block_idx], transaction_list, 0, previous_block_hash);
+        assert_true(SUCCESS == return_code);
+        atomic_bool should_stop = false;
+        return_code = blockchain_mine_block(
+            blockchain, blocks[block_idx], false, &should_stop, 1);
+        assert_true(SUCCESS == return_code);
+        return_code = blockchain_add_block(blockchain, blocks[block_idx]);
+        assert_true(SUCCESS == return_code);
+        previous_block = blocks[block_idx];
+    }
+    bool is_valid = true;
+    block_t *first_invalid_block = NULL;
+    return_code = blockchain_verify(
+        blockchain, &is_valid, &first_invalid_block);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid);
+    assert_true(first_invalid_block == blocks[1]);
+    // The genesis block and the first mined block are valid.
+    assert_true(2 == blockchain->num_verified_blocks);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_verify_caches_only_valid_signatures() {
+    char *ssh_public_key_contents_base64 = getenv(
+        TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t public_key = {0};
+    return_code_t return_code = base64_decode(
+        ssh_public_key_contents_base64,
+        strlen(ssh_public_key_contents_base64),
+        public_key.bytes);
+    assert_true(SUCCESS == return_code);
+    char *ssh_private_key_contents_base64 = getenv(
+        TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t private_key = {0};
+    return_code = base64_decode(
+        ssh_private_key_contents_base64,
+        strlen(ssh_private_key_contents_base64),
+        private_key.bytes);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *blockchain = NULL;
+    return_code = blockchain_create(&blockchain, 1);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    linked_list_t *transaction_list = NULL;
+    return_code = linked_list_create(
+        &transaction_list, (free_function_t *)transaction_destroy, NULL);
+    assert_true(SUCCESS == return_code);
+    transaction_t *transactions[2] = {0};
+    for (size_t idx = 0; idx < 2; idx++) {
+        return_code = transaction_create(
+            &transactions[idx],
+            &public_key,
+            &public_key,
+            AMOUNT_GENERATED_DURING_MINTING,
+            &private_key);
+        assert_true(SUCCESS == return_code);
+        return_code = linked_list_append(transaction_list, transactions[idx]);
+        assert_true(SUCCESS == return_code);
+    }
+    transactions[1]->sender_signature.bytes[0] ^= 0xff;
+    sha_256_t genesis_block_hash = {0};
+    return_code = block_hash(genesis_block, &genesis_block_hash);
+    assert_true(SUCCESS == return_code);
+    block_t *block = NULL;
+    return_code = block_create(
+        &block, transaction_list, 0, genesis_block_hash);
+    assert_true(SUCCESS == return_code);
+    atomic_bool should_stop = false;
+    return_code = blockchain_mine_block(
+        blockchain, block, false, &should_stop, 1);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, block);
+    assert_true(SUCCESS == return_code);
+    // Verifying twice gives the same result; the second time the valid
+    // signature comes from the cache and the invalid one is checked again.
+    for (size_t attempt = 0; attempt < 2; attempt++) {
+        bool is_valid = true;
+        block_t *first_invalid_block = NULL;
+        return_code = blockchain_verify(
+            blockchain, &is_valid, &first_invalid_block);
+        assert_true(SUCCESS == return_code);
+        assert_true(!is_valid);
+        assert_true(first_invalid_block == block);
+    }
+    lru_cache_t *cache = NULL;
+    return_code = blockchain_get_verified_signature_cache(&cache);
+    assert_true(SUCCESS == return_code);
+    assert_true(NULL != cache);
+    sha_256_t transaction_hash_value = {0};
+    bool is_found = false;
+    return_code = transaction_hash(transactions[0], &transaction_hash_value);
+    assert_true(SUCCESS == return_code);
+    return_code = lru_cache_get(
+        cache, &transaction_hash_value, NULL, &is_found);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_found);
+    return_code = transaction_hash(transactions[1], &transaction_hash_value);
+    assert_true(SUCCESS == return_code);
+    return_code = lru_cache_get(
+        cache, &transaction_hash_value, NULL, &is_found);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_found);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_verify_accepts_mixed_signature_versions() {
+    char *ssh_public_key_contents_base64 = getenv(
+        TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t rsa_public_key = {0};
+    return_code_t return_code = base64_decode(
+        ssh_public_key_contents_base64,
+        strlen(ssh_public_key_contents_base64),
+        rsa_public_key.bytes);
+    assert_true(SUCCESS == return_code);
+    char *ssh_private_key_contents_base64 = getenv(
+        TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t rsa_private_key = {0};
+    return_code = base64_decode(
+        ssh_private_key_contents_base64,
+        strlen(ssh_private_key_contents_base64),
+        rsa_private_key.bytes);
+    assert_true(SUCCESS == return_code);
+    ssh_key_t ed25519_public_key = {0};
+    ssh_key_t ed25519_private_key = {0};
+    return_code = transaction_generate_ed25519_key_pair(
+        &ed25519_public_key, &ed25519_private_key);
+    assert_true(SUCCESS == return_code);
+    transaction_signer_t *ed25519_signer = NULL;
+    return_code = transaction_signer_create_ed25519(
+        &ed25519_signer, &ed25519_private_key);
+    assert_true(SUCCESS == return_code);
+    public_key_t *raw_public_key = NULL;
+    return_code = transaction_public_key_create(
+        &raw_public_key, &ed25519_public_key, TRANSACTION_VERSION_ED25519);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *blockchain = NULL;
+    return_code = blockchain_create(&blockchain, 1);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    // An RSA minting transaction followed by an Ed25519 transfer.
+    linked_list_t *transaction_list = NULL;
+    return_code = linked_list_create(
+        &transaction_list, (free_function_t *)transaction_destroy, NULL);
+    assert_true(SUCCESS == return_code);
+    transaction_t *minting_transaction = NULL;
+    return_code = transaction_create(
+        &minting_transaction,
+        &rsa_public_key,
+        &rsa_public_key,
+        AMOUNT_GENERATED_DURING_MINTING,
+        &rsa_private_key);
+    assert_true(SUCCESS == return_code);
+    return_code = linked_list_append(transaction_list, minting_transaction);
+    assert_true(SUCCESS == return_code);
+    transaction_t *ed25519_transaction = NULL;
+    return_code = transaction_create_with_signer(
+        &ed25519_transaction,
+        raw_public_key,
+        raw_public_key,
+        7,
+        ed25519_signer);
+    assert_true(SUCCESS == return_code);
+    return_code = linked_list_append(transaction_list, ed25519_transaction);
+    assert_true(SUCCESS == return_code);
+    public_key_release(raw_public_key);
+    transaction_signer_destroy(ed25519_signer);
+    sha_256_t genesis_block_hash = {0};
+    return_code = block_hash(genesis_block, &genesis_block_hash);
+    assert_true(SUCCESS == return_code);
+    block_t *block = NULL;
+    return_code = block_create(
+        &block, transaction_list, 0, genesis_block_hash);
+    assert_true(SUCCESS == return_code);
+    atomic_bool should_stop = false;
+    return_code = blockchain_mine_block(
+        blockchain, block, false, &should_stop, 1);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, block);
+    assert_true(SUCCESS == return_code);
+    bool is_valid = false;
+    return_code = blockchain_verify(blockchain, &is_valid, NULL);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid);
+    // Versions survive serialization, so the chain stays valid.
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *deserialized_blockchain = NULL;
+    return_code = blockchain_deserialize(
+        &deserialized_blockchain, buffer, buffer_size);
+    assert_true(SUCCESS == return_code);
+    node_t *node = NULL;
+    return_code = linked_list_get_last(
+        deserialized_blockchain->block_list, &node);
+    assert_true(SUCCESS == return_code);
+    block_t *deserialized_block = (block_t *)node->data;
+    return_code = linked_list_get_last(
+        deserialized_block->transaction_list, &node);
+    assert_true(SUCCESS == return_code);
+    transaction_t *deserialized_transaction = (transaction_t *)node->data;
+    assert_true(
+        ed25519_transaction->version == deserialized_transaction->version);
+    sha_256_t transaction_hash1 = {0};
+    return_code = transaction_hash(ed25519_transaction, &transaction_hash1);
+    assert_true(SUCCESS == return_code);
+    sha_256_t transaction_hash2 = {0};
+    return_code = transaction_hash(
+        deserialized_transaction, &transaction_hash2);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(
+        &transaction_hash1, &transaction_hash2, sizeof(sha_256_t)));
+    is_valid = false;
+    return_code = blockchain_verify(deserialized_blockchain, &is_valid, NULL);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid);
+    free(buffer);
+    blockchain_destroy(deserialized_blockchain);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_get_verified_signature_cache_fails_on_null() {
+    return_code_t return_code = blockchain_get_verified_signature_cache(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_blockchain_verify_records_watermark() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_no_transactions_v3");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == blockchain->num_verified_blocks);
+    bool is_valid = false;
+    return_code = blockchain_verify(blockchain, &is_valid, NULL);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid);
+    assert_true(4 == blockchain->num_verified_blocks);
+    node_t *last_node = NULL;
+    return_code = linked_list_get_last(blockchain->block_list, &last_node);
+    assert_true(SUCCESS == return_code);
+    sha_256_t last_block_hash = {0};
+    return_code = block_hash((block_t *)last_node->data, &last_block_hash);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(
+        &last_block_hash,
+        &blockchain->last_verified_block_hash,
+        sizeof(sha_256_t)));
+    // An invalid block moves the watermark back to the block before it.
+    block_t *block = (block_t *)blockchain->block_list->head->next->next->data;
+    block->proof_of_work += 1;
+    return_code = blockchain_verify(blockchain, &is_valid, NULL);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid);
+    assert_true(2 == blockchain->num_verified_blocks);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_verify_incremental_only_checks_new_blocks() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_no_transactions_v3");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    // Without a watermark, the function checks the whole chain.
+    bool is_valid = false;
+    return_code = blockchain_verify_incremental(blockchain, &is_valid, NULL);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid);
+    assert_true(4 == blockchain->num_verified_blocks);
+    // Blocks below the last verified block are not checked again.
+    transaction_t *transaction = (transaction_t *)
+        ((block_t *)blockchain->block_list->head->next->data)
+        ->transaction_list->head->data;
+    transaction->amount += 1;
+    return_code = blockchain_verify_incremental(blockchain, &is_valid, NULL);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid);
+    return_code = blockchain_verify(blockchain, &is_valid, NULL);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid);
+    transaction->amount -= 1;
+    return_code = blockchain_verify(blockchain, &is_valid, NULL);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid);
+    // A new block past the watermark is checked.
+    node_t *last_node = NULL;
+    return_code = linked_list_get_last(blockchain->block_list, &last_node);
+    assert_true(SUCCESS == return_code);
+    sha_256_t previous_block_hash = {0};
+    return_code = block_hash((block_t *)last_node->data, &previous_block_hash);
+    assert_true(SUCCESS == return_code);
+    linked_list_t *transaction_list = NULL;
+    return_code = linked_list_create(
+        &transaction_list, (free_function_t *)transaction_destroy, NULL);
+    assert_true(SUCCESS == return_code);
+    block_t *new_block = NULL;
+    return_code = block_create(
+        &new_block, transaction_list, 0, previous_block_hash);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, new_block);
+    assert_true(SUCCESS == return_code);
+    block_t *first_invalid_block = NULL;
+    return_code = blockchain_verify_incremental(
+        blockchain, &is_valid, &first_invalid_block);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid);
+    assert_true(4 == blockchain->num_verified_blocks);
+    // If the block at the watermark changed, the function checks everything.
+    block_t *last_verified_block = (block_t *)last_node->data;
+    last_verified_block->proof_of_work += 1;
+    first_invalid_block = NULL;
+    return_code = blockchain_verify_incremental(
+        blockchain, &is_valid, &first_invalid_block);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid);
+    assert_true(first_invalid_block == last_verified_block);
+    assert_true(3 == blockchain->num_verified_blocks);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_verify_incremental_fails_on_invalid_input() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    bool is_valid = false;
+    return_code = blockchain_verify_incremental(NULL, &is_valid, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_verify_incremental(blockchain, NULL, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_verify_fails_on_invalid_input() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_no_transactions_v3");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    bool is_valid = false;
+    block_t *first_invalid_block = NULL;
+    return_code = blockchain_verify(
+        NULL, &is_valid, &first_invalid_block);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_verify(
+        blockchain, NULL, &first_invalid_block);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_serialize_creates_nonempty_buffer() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    assert_true(NULL != buffer);
+    assert_true(0 != buffer_size);
+    unsigned char *empty_buffer = calloc(buffer_size, 1);
+    assert_true(0 != memcmp(buffer, empty_buffer, buffer_size));
+    free(buffer);
+    free(empty_buffer);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_serialize_fails_on_invalid_input() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(NULL, &buffer, &buffer_size);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_serialize(blockchain, NULL, &buffer_size);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_serialize(blockchain, &buffer, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_deserialize_reconstructs_blockchain() {
+    // See test_blockchain_read_from_file_reconstructs_blockchain. Since
+    // blockchain_read_from_file calls blockchain_deserialize, the
+    // aforementioned test already covers deserialization fairly well. Here we
+    // will just test on a single-block blockchain to preserve compute and add
+    // diversity to the tests.
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *deserialized_blockchain = NULL;
+    return_code = blockchain_deserialize(
+        &deserialized_blockchain, buffer, buffer_size);
+    assert_true(SUCCESS == return_code);
+    assert_true(NULL != deserialized_blockchain);
+    uint64_t num_blocks = 0;
+    return_code = linked_list_length(
+        deserialized_blockchain->block_list, &num_blocks);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == num_blocks);
+    block_t *deserialized_genesis_block =
+        (block_t *)deserialized_blockchain->block_list->head->data;
+    assert_true(
+        genesis_block->created_at == deserialized_genesis_block->created_at);
+    assert_true(0 == memcmp(
+        &genesis_block->previous_block_hash,
+        &deserialized_genesis_block->previous_block_hash,
+        sizeof(sha_256_t)));
+    assert_true(
+        genesis_block->extra_nonce == deserialized_genesis_block->extra_nonce);
+    assert_true(
+        genesis_block->proof_of_work ==
+        deserialized_genesis_block->proof_of_work);
+    bool is_empty = false;
+    return_code = linked_list_is_empty(
+        deserialized_genesis_block->transaction_list, &is_empty);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_empty);
+    free(buffer);
+    blockchain_destroy(blockchain);
+    blockchain_destroy(deserialized_blockchain);
+}
+
+void test_blockchain_deserialize_reconstructs_custom_target() {
+    blockchain_target_t target = {0};
+    return_code_t return_code = blockchain_target_from_num_leading_zero_bits(
+        13, &target);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *blockchain = NULL;
+    return_code = blockchain_create_with_target(&blockchain, target);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *deserialized_blockchain = NULL;
+    return_code = blockchain_deserialize(
+        &deserialized_blockchain, buffer, buffer_size);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(
+        &target,
+        &deserialized_blockchain->target,
+        sizeof(blockchain_target_t)));
+    assert_true(NUM_LEADING_ZERO_BYTES_CUSTOM_TARGET ==
+        deserialized_blockchain->num_leading_zero_bytes_required_in_block_hash);
+    uint64_t num_blocks = 0;
+    return_code = linked_list_length(
+        deserialized_blockchain->block_list, &num_blocks);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == num_blocks);
+    // Cutting off part of the target fails.
+    blockchain_t *truncated_blockchain = NULL;
+    return_code = blockchain_deserialize(
+        &truncated_blockchain, buffer, sizeof(uint64_t) + 8);
+    assert_true(FAILURE_BUFFER_TOO_SMALL == return_code);
+    free(buffer);
+    blockchain_destroy(blockchain);
+    blockchain_destroy(deserialized_blockchain);
+}
+
+void test_blockchain_deserialize_fails_on_attempted_read_past_buffer() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *deserialized_blockchain = NULL;
+    return_code = blockchain_deserialize(
+        &deserialized_blockchain, buffer, buffer_size - 50);
+    assert_true(FAILURE_BUFFER_TOO_SMALL == return_code);
+    free(buffer);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_deserialize_fails_on_invalid_input() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *deserialized_blockchain = NULL;
+    return_code = blockchain_deserialize(NULL, buffer, buffer_size);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_deserialize(
+        &deserialized_blockchain, NULL, buffer_size);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    free(buffer);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_deserialize_fails_on_unknown_format() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    // Neither is a magic number or a number of leading zero bytes.
+    uint64_t unknown_formats[] = {
+        BLOCKCHAIN_SERIALIZATION_MAGIC - 1, sizeof(sha_256_t) + 1};
+    for (size_t idx = 0;
+        idx < sizeof(unknown_formats) / sizeof(uint64_t);
+        idx++) {
+        *(uint64_t *)buffer = htobe64(unknown_formats[idx]);
+        blockchain_t *deserialized_blockchain = NULL;
+        return_code = blockchain_deserialize(
+            &deserialized_blockchain, buffer, buffer_size);
+        assert_true(FAILURE_INVALID_BLOCKCHAIN == return_code);
+    }
+    free(buffer);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_deserialize_fails_on_padded_key() {
+    // An empty blockchain whose key table holds one three-byte key.
+    unsigned char buffer[5 * sizeof(uint64_t) + 3] = {0};
+    unsigned char *next_spot_in_buffer = buffer;
+    *(uint64_t *)next_spot_in_buffer = htobe64(BLOCKCHAIN_SERIALIZATION_MAGIC);
+    next_spot_in_buffer += sizeof(uint64_t);
+    *(uint64_t *)next_spot_in_buffer = htobe64(
+        NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    next_spot_in_buffer += sizeof(uint64_t);
+    *(uint64_t *)next_spot_in_buffer = htobe64(1);
+    next_spot_in_buffer += sizeof(uint64_t);
+    *(uint64_t *)next_spot_in_buffer = htobe64(3);
+    next_spot_in_buffer += sizeof(uint64_t);
+    unsigned char *key = next_spot_in_buffer;
+    memcpy(key, "abc", 3);
+    next_spot_in_buffer += 3;
+    *(uint64_t *)next_spot_in_buffer = htobe64(0);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_deserialize(
+        &blockchain, buffer, sizeof(buffer));
+    assert_true(SUCCESS == return_code);
+    blockchain_destroy(blockchain);
+    // Only an RSA key can be this short, and RSA keys never end in padding.
+    key[2] = 0;
+    return_code = blockchain_deserialize(&blockchain, buffer, sizeof(buffer));
+    assert_true(FAILURE_INVALID_BLOCKCHAIN == return_code);
+}
+
+void _add_block_with_minted_transaction(blockchain_t *blockchain) {
+    char *ssh_public_key_contents_base64 = getenv(
+        TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t public_key = {0};
+    return_code_t return_code = base64_decode(
+        ssh_public_key_contents_base64,
+        strlen(ssh_public_key_contents_base64),
+        public_key.bytes);
+    assert_true(SUCCESS == return_code);
+    char *ssh_private_key_contents_base64 = getenv(
+        TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t private_key = {0};
+    return_code = base64_decode(
+        ssh_private_key_contents_base64,
+        strlen(ssh_private_key_contents_base64),
+        private_key.bytes);
+    assert_true(SUCCESS == return_code);
+    linked_list_t *transaction_list = NULL;
+    return_code = linked_list_create(
+        &transaction_list, (free_function_t *)transaction_destroy, NULL);
+    assert_true(SUCCESS == return_code);
+    transaction_t *transaction = NULL;
+    return_code = transaction_create(
+        &transaction,
+        &public_key,
+        &public_key,
+        AMOUNT_GENERATED_DURING_MINTING,
+        &private_key);
+    assert_true(SUCCESS == return_code);
+    return_code = linked_list_append(transaction_list, transaction);
+    assert_true(SUCCESS == return_code);
+    sha_256_t empty_hash = {0};
+    block_t *block = NULL;
+    return_code = block_create(&block, transaction_list, 0, empty_hash);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, block);
+    assert_true(SUCCESS == return_code);
+}
+
+return_code_t _append_decoded_block(block_t *block, void *args) {
+    linked_list_t *block_list = (linked_list_t *)args;
+    return_code_t return_code = linked_list_append(block_list, block);
+    if (SUCCESS != return_code) {
+        block_destroy(block);
+    }
+    return return_code;
+}
+
+void _assert_same_block_hashes(
+    linked_list_t *block_list1,
+    linked_list_t *block_list2
+) {
+    uint64_t num_blocks1 = 0;
+    return_code_t return_code = linked_list_length(block_list1, &num_blocks1);
+    assert_true(SUCCESS == return_code);
+    uint64_t num_blocks2 = 0;
+    return_code = linked_list_length(block_list2, &num_blocks2);
+    assert_true(SUCCESS == return_code);
+    assert_true(num_blocks1 == num_blocks2);
+    node_t *block_node2 = block_list2->head;
+    for (node_t *block_node1 = block_list1->head;
+        NULL != block_node1;
+        block_node1 = block_node1->next) {
+        sha_256_t block_hash1 = {0};
+        return_code = block_hash((block_t *)block_node1->data, &block_hash1);
+        assert_true(SUCCESS == return_code);
+        sha_256_t block_hash2 = {0};
+        return_code = block_hash((block_t *)block_node2->data, &block_hash2);
+        assert_true(SUCCESS == return_code);
+        assert_true(0 == memcmp(&block_hash1, &block_hash2, sizeof(sha_256_t)));
+        block_node2 = block_node2->next;
+    }
+}
+
+void test_blockchain_decoder_decodes_chunks_of_any_size() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    size_t num_blocks = 3;
+    for (size_t idx = 0; idx < num_blocks; idx++) {
+        _add_block_with_minted_transaction(blockchain);
+    }
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    // The largest item the decoder may have to hold is the key or a block.
+    transaction_t *transaction = (transaction_t *)
+        ((block_t *)blockchain->block_list->head->data)->
+        transaction_list->head->data;
+    size_t max_item_size =
+        4 * sizeof(uint64_t) + sizeof(sha_256_t) +
+        4 * sizeof(uint64_t) + 2 * sizeof(sha_256_t) +
+        transaction->sender_signature.length;
+    size_t key_size =
+        sizeof(uint64_t) + transaction->sender_public_key->length;
+    if (key_size > max_item_size) {
+        max_item_size = key_size;
+    }
+    assert_true(2 * max_item_size < buffer_size);
+    size_t chunk_sizes[] = {1, 7, 100, buffer_size};
+    for (size_t idx = 0; idx < sizeof(chunk_sizes) / sizeof(size_t); idx++) {
+        size_t chunk_size = chunk_sizes[idx];
+        linked_list_t *block_list = NULL;
+        return_code = linked_list_create(
+            &block_list, (free_function_t *)block_destroy, NULL);
+        assert_true(SUCCESS == return_code);
+        blockchain_decoder_t *decoder = NULL;
+        return_code = blockchain_decoder_create(
+            &decoder, _append_decoded_block, block_list);
+        assert_true(SUCCESS == return_code);
+        for (size_t offset = 0; offset < buffer_size; offset += chunk_size) {
+            size_t size = buffer_size - offset < chunk_size ?
+                buffer_size - offset : chunk_size;
+            return_code = blockchain_decoder_write(
+                decoder, buffer + offset, size);
+            assert_true(SUCCESS == return_code);
+            // The decoder only holds one incomplete item and one chunk, with
+            // room to grow.
+            assert_true(
+                decoder->buffer_capacity <= 2 * (max_item_size + chunk_size));
+        }
+        return_code = blockchain_decoder_finish(decoder);
+        assert_true(SUCCESS == return_code);
+        assert_true(0 == memcmp(
+            &blockchain->target, &decoder->target, sizeof(decoder->target)));
+        _assert_same_block_hashes(blockchain->block_list, block_list);
+        blockchain_decoder_destroy(decoder);
+        linked_list_destroy(block_list);
+    }
+    free(buffer);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_decoder_fails_on_invalid_input() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
     assert_true(SUCCESS == return_code);
+    _add_block_with_minted_transaction(blockchain);
     unsigned char *buffer = NULL;
     uint64_t buffer_size = 0;
     return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
     assert_true(SUCCESS == return_code);
-    assert_true(NULL != buffer);
-    assert_true(0 != buffer_size);
-    unsigned char *empty_buffer = calloc(buffer_size, 1);
-    assert_true(0 != memcmp(buffer, empty_buffer, buffer_size));
-    free(buffer);
-    free(empty_buffer);
+    linked_list_t *block_list = NULL;
+    return_code = linked_list_create(
+        &block_list, (free_function_t *)block_destroy, NULL);
+    assert_true(SUCCESS == return_code);
+    blockchain_decoder_t *decoder = NULL;
+    return_code = blockchain_decoder_create(
+        NULL, _append_decoded_block, block_list);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_decoder_create(&decoder, NULL, block_list);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    // A serialized blockchain must be complete.
+    return_code = blockchain_decoder_create(
+        &decoder, _append_decoded_block, block_list);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_decoder_write(decoder, NULL, buffer_size);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_decoder_write(decoder, buffer, buffer_size - 1);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_decoder_finish(decoder);
+    assert_true(FAILURE_BUFFER_TOO_SMALL == return_code);
+    blockchain_decoder_destroy(decoder);
+    // Nothing may follow the last block.
+    return_code = blockchain_decoder_create(
+        &decoder, _append_decoded_block, block_list);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_decoder_write(decoder, buffer, buffer_size);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_decoder_write(decoder, buffer, 1);
+    assert_true(FAILURE_INVALID_BLOCKCHAIN == return_code);
+    blockchain_decoder_destroy(decoder);
+    // Older formats have no magic number that the decoder knows.
+    return_code = blockchain_decoder_create(
+        &decoder, _append_decoded_block, block_list);
+    assert_true(SUCCESS == return_code);
+    buffer[0] ^= 0xff;
+    return_code = blockchain_decoder_write(decoder, buffer, buffer_size);
+    assert_true(FAILURE_INVALID_BLOCKCHAIN == return_code);
+    blockchain_decoder_destroy(decoder);
+    assert_true(FAILURE_INVALID_INPUT == blockchain_decoder_finish(NULL));
+    assert_true(FAILURE_INVALID_INPUT == blockchain_decoder_destroy(NULL));
+    linked_list_destroy(block_list);
+    free(buffer);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_decoder_rejects_oversized_records() {
+    linked_list_t *block_list = NULL;
+    return_code_t return_code = linked_list_create(
+        &block_list, (free_function_t *)block_destroy, NULL);
+    assert_true(SUCCESS == return_code);
+    // A log record that claims a body larger than any block.
+    unsigned char log[sizeof(uint64_t) + BLOCKCHAIN_LOG_RECORD_OVERHEAD] = {0};
+    *(uint64_t *)log = htobe64(BLOCKCHAIN_LOG_MAGIC);
+    *(uint64_t *)(log + sizeof(uint64_t)) = htobe64(
+        BLOCKCHAIN_MAX_RECORD_SIZE + 1);
+    *(uint64_t *)(log + 2 * sizeof(uint64_t)) = htobe64(
+        BLOCKCHAIN_LOG_RECORD_BLOCK);
+    blockchain_decoder_t *decoder = NULL;
+    return_code = blockchain_decoder_create(
+        &decoder, _append_decoded_block, block_list);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_decoder_write(decoder, log, 3 * sizeof(uint64_t));
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_decoder_write(
+        decoder,
+        log + 3 * sizeof(uint64_t),
+        sizeof(log) - 3 * sizeof(uint64_t));
+    assert_true(FAILURE_INVALID_BLOCKCHAIN == return_code);
+    assert_true(decoder->buffer_capacity <= sizeof(log));
+    blockchain_decoder_destroy(decoder);
+    // A serialized block whose header claims too many transactions.
+    unsigned char serialized[
+        4 * sizeof(uint64_t) + SERIALIZED_BLOCK_HEADER_SIZE] = {0};
+    unsigned char *next_spot_in_buffer = serialized;
+    *(uint64_t *)next_spot_in_buffer = htobe64(BLOCKCHAIN_SERIALIZATION_MAGIC);
+    next_spot_in_buffer += sizeof(uint64_t);
+    *(uint64_t *)next_spot_in_buffer = htobe64(
+        NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    next_spot_in_buffer += sizeof(uint64_t);
+    // No keys and one block.
+    next_spot_in_buffer += sizeof(uint64_t);
+    *(uint64_t *)next_spot_in_buffer = htobe64(1);
+    next_spot_in_buffer += sizeof(uint64_t);
+    next_spot_in_buffer += SERIALIZED_BLOCK_HEADER_SIZE;
+    *(uint64_t *)(next_spot_in_buffer - sizeof(uint64_t)) = htobe64(
+        BLOCKCHAIN_MAX_RECORD_SIZE);
+    return_code = blockchain_decoder_create(
+        &decoder, _append_decoded_block, block_list);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_decoder_write(
+        decoder, serialized, sizeof(serialized));
+    assert_true(FAILURE_INVALID_BLOCKCHAIN == return_code);
+    assert_true(decoder->buffer_capacity <= sizeof(serialized));
+    blockchain_decoder_destroy(decoder);
+    linked_list_destroy(block_list);
+}
+
+void test_blockchain_write_to_file_creates_nonempty_file() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    char output_directory[TESTS_MAX_PATH];
+    get_output_directory(output_directory);
+    char outfile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        outfile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        output_directory,
+        "blockchain_test_blockchain_write_to_file_creates_nonempty_file");
+    assert_true(return_value < TESTS_MAX_PATH);
+    struct stat file_stats = {0};
+    assert_true(0 != stat(outfile, &file_stats));
+    return_code = blockchain_write_to_file(blockchain, outfile);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == stat(outfile, &file_stats));
+    assert_true(0 != file_stats.st_size);
     blockchain_destroy(blockchain);
 }
 
-void test_blockchain_serialize_fails_on_invalid_input() {
+void test_blockchain_write_to_file_fails_on_invalid_input() {
     blockchain_t *blockchain = NULL;
     return_code_t return_code = blockchain_create(
         &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
@@ -505,123 +1891,407 @@ void test_blockchain_serialize_fails_on_invalid_input() {
     assert_true(SUCCESS == return_code);
     return_code = blockchain_add_block(blockchain, genesis_block);
     assert_true(SUCCESS == return_code);
-    unsigned char *buffer = NULL;
-    uint64_t buffer_size = 0;
-    return_code = blockchain_serialize(NULL, &buffer, &buffer_size);
-    assert_true(FAILURE_INVALID_INPUT == return_code);
-    return_code = blockchain_serialize(blockchain, NULL, &buffer_size);
+    char output_directory[TESTS_MAX_PATH];
+    get_output_directory(output_directory);
+    char outfile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        outfile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        output_directory,
+        "blockchain_test_blockchain_write_to_file_fails_on_invalid_input");
+    assert_true(return_value < TESTS_MAX_PATH);
+    return_code = blockchain_write_to_file(blockchain, NULL);
     assert_true(FAILURE_INVALID_INPUT == return_code);
-    return_code = blockchain_serialize(blockchain, &buffer, NULL);
+    return_code = blockchain_write_to_file(NULL, outfile);
     assert_true(FAILURE_INVALID_INPUT == return_code);
     blockchain_destroy(blockchain);
 }
 
-void test_blockchain_deserialize_reconstructs_blockchain() {
-    // See test_blockchain_read_from_file_reconstructs_blockchain. Since
-    // blockchain_read_from_file calls blockchain_deserialize, the
-    // aforementioned test already covers deserialization fairly well. Here we
-    // will just test on a single-block blockchain to preserve compute and add
-    // diversity to the tests.
+void test_blockchain_write_to_file_appends_new_blocks() {
     blockchain_t *blockchain = NULL;
     return_code_t return_code = blockchain_create(
         &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
     assert_true(SUCCESS == return_code);
-    block_t *genesis_block = NULL;
-    return_code = block_create_genesis_block(&genesis_block);
+    _add_block_with_minted_transaction(blockchain);
+    char output_directory[TESTS_MAX_PATH];
+    get_output_directory(output_directory);
+    char outfile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        outfile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        output_directory,
+        "blockchain_test_blockchain_write_to_file_appends_new_blocks");
+    assert_true(return_value < TESTS_MAX_PATH);
+    return_code = blockchain_write_to_file(blockchain, outfile);
     assert_true(SUCCESS == return_code);
-    return_code = blockchain_add_block(blockchain, genesis_block);
+    struct stat file_stats = {0};
+    assert_true(0 == stat(outfile, &file_stats));
+    uint64_t first_size = file_stats.st_size;
+    // The second block uses the same key, so the append is only its record.
+    _add_block_with_minted_transaction(blockchain);
+    transaction_t *transaction = (transaction_t *)
+        ((block_t *)blockchain->block_list->head->next->data)->
+        transaction_list->head->data;
+    size_t block_record_size =
+        BLOCKCHAIN_LOG_RECORD_OVERHEAD +
+        4 * sizeof(uint64_t) + sizeof(sha_256_t) +
+        4 * sizeof(uint64_t) + 2 * sizeof(sha_256_t) +
+        transaction->sender_signature.length;
+    return_code = blockchain_write_to_file(blockchain, outfile);
     assert_true(SUCCESS == return_code);
-    unsigned char *buffer = NULL;
-    uint64_t buffer_size = 0;
-    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(0 == stat(outfile, &file_stats));
+    assert_true(first_size + block_record_size == file_stats.st_size);
+    // Saving again without new blocks writes nothing.
+    return_code = blockchain_write_to_file(blockchain, outfile);
     assert_true(SUCCESS == return_code);
-    blockchain_t *deserialized_blockchain = NULL;
-    return_code = blockchain_deserialize(
-        &deserialized_blockchain, buffer, buffer_size);
+    assert_true(0 == stat(outfile, &file_stats));
+    assert_true(first_size + block_record_size == file_stats.st_size);
+    blockchain_t *read_blockchain = NULL;
+    return_code = blockchain_read_from_file(&read_blockchain, outfile);
     assert_true(SUCCESS == return_code);
-    assert_true(NULL != deserialized_blockchain);
     uint64_t num_blocks = 0;
-    return_code = linked_list_length(
-        deserialized_blockchain->block_list, &num_blocks);
+    return_code = linked_list_length(read_blockchain->block_list, &num_blocks);
+    assert_true(SUCCESS == return_code);
+    assert_true(2 == num_blocks);
+    assert_true(1 == read_blockchain->key_table->num_keys);
+    node_t *read_block_node = read_blockchain->block_list->head;
+    for (node_t *block_node = blockchain->block_list->head;
+        NULL != block_node;
+        block_node = block_node->next) {
+        sha_256_t block_hash1 = {0};
+        return_code = block_hash((block_t *)block_node->data, &block_hash1);
+        assert_true(SUCCESS == return_code);
+        sha_256_t block_hash2 = {0};
+        return_code = block_hash(
+            (block_t *)read_block_node->data, &block_hash2);
+        assert_true(SUCCESS == return_code);
+        assert_true(0 == memcmp(&block_hash1, &block_hash2, sizeof(sha_256_t)));
+        read_block_node = read_block_node->next;
+    }
+    blockchain_destroy(read_blockchain);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_write_to_file_rewrites_changed_file() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
     assert_true(SUCCESS == return_code);
-    assert_true(1 == num_blocks);
-    block_t *deserialized_genesis_block =
-        (block_t *)deserialized_blockchain->block_list->head->data;
-    assert_true(
-        genesis_block->created_at == deserialized_genesis_block->created_at);
-    assert_true(0 == memcmp(
-        &genesis_block->previous_block_hash,
-        &deserialized_genesis_block->previous_block_hash,
-        sizeof(sha_256_t)));
-    assert_true(
-        genesis_block->proof_of_work ==
-        deserialized_genesis_block->proof_of_work);
-    bool is_empty = false;
-    return_code = linked_list_is_empty(
-        deserialized_genesis_block->transaction_list, &is_empty);
+    _add_block_with_minted_transaction(blockchain);
+    char output_directory[TESTS_MAX_PATH];
+    get_output_directory(output_directory);
+    char outfile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        outfile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        output_directory,
+        "blockchain_test_blockchain_write_to_file_rewrites_changed_file");
+    assert_true(return_value < TESTS_MAX_PATH);
+    return_code = blockchain_write_to_file(blockchain, outfile);
     assert_true(SUCCESS == return_code);
-    assert_true(is_empty);
-    free(buffer);
+    FILE *f = fopen(outfile, "ab");
+    assert_true(NULL != f);
+    assert_true(1 == fwrite("x", 1, 1, f));
+    fclose(f);
+    _add_block_with_minted_transaction(blockchain);
+    return_code = blockchain_write_to_file(blockchain, outfile);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *read_blockchain = NULL;
+    return_code = blockchain_read_from_file(&read_blockchain, outfile);
+    assert_true(SUCCESS == return_code);
+    uint64_t num_blocks = 0;
+    return_code = linked_list_length(read_blockchain->block_list, &num_blocks);
+    assert_true(SUCCESS == return_code);
+    assert_true(2 == num_blocks);
+    blockchain_destroy(read_blockchain);
     blockchain_destroy(blockchain);
-    blockchain_destroy(deserialized_blockchain);
 }
 
-void test_blockchain_deserialize_fails_on_attempted_read_past_buffer() {
+void test_blockchain_write_to_file_replaces_file_with_renamed_log() {
     blockchain_t *blockchain = NULL;
     return_code_t return_code = blockchain_create(
         &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
     assert_true(SUCCESS == return_code);
-    block_t *genesis_block = NULL;
-    return_code = block_create_genesis_block(&genesis_block);
+    _add_block_with_minted_transaction(blockchain);
+    char output_directory[TESTS_MAX_PATH];
+    get_output_directory(output_directory);
+    char outfile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        outfile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        output_directory,
+        "blockchain_test_blockchain_write_to_file_replaces_file_with_renamed_"
+        "log");
+    assert_true(return_value < TESTS_MAX_PATH);
+    char temporary_file[TESTS_MAX_PATH];
+    return_value = snprintf(
+        temporary_file, TESTS_MAX_PATH, "%s.tmp", outfile);
+    assert_true(return_value < TESTS_MAX_PATH);
+    FILE *f = fopen(outfile, "wb");
+    assert_true(NULL != f);
+    assert_true(1 == fwrite("x", 1, 1, f));
+    fclose(f);
+    return_code = blockchain_write_to_file(blockchain, outfile);
     assert_true(SUCCESS == return_code);
-    return_code = blockchain_add_block(blockchain, genesis_block);
+    struct stat file_stats = {0};
+    assert_true(0 != stat(temporary_file, &file_stats));
+    assert_true(0 == blockchain->num_unsynced_logged_blocks);
+    blockchain_t *read_blockchain = NULL;
+    return_code = blockchain_read_from_file(&read_blockchain, outfile);
     assert_true(SUCCESS == return_code);
-    unsigned char *buffer = NULL;
-    uint64_t buffer_size = 0;
-    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    uint64_t num_blocks = 0;
+    return_code = linked_list_length(read_blockchain->block_list, &num_blocks);
     assert_true(SUCCESS == return_code);
-    blockchain_t *deserialized_blockchain = NULL;
-    return_code = blockchain_deserialize(
-        &deserialized_blockchain, buffer, buffer_size - 50);
-    assert_true(FAILURE_BUFFER_TOO_SMALL == return_code);
-    free(buffer);
+    assert_true(1 == num_blocks);
+    blockchain_destroy(read_blockchain);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_write_to_file_with_sync_policy_follows_policy() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    _add_block_with_minted_transaction(blockchain);
+    char output_directory[TESTS_MAX_PATH];
+    get_output_directory(output_directory);
+    char outfile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        outfile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        output_directory,
+        "blockchain_test_blockchain_write_to_file_with_sync_policy_follows_"
+        "policy");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_sync_policy_t sync_policy = {0};
+    sync_policy.mode = BLOCKCHAIN_SYNC_EVERY_NUM_BLOCKS;
+    sync_policy.num_blocks_between_syncs = 2;
+    // Rewrites always sync.
+    return_code = blockchain_write_to_file_with_sync_policy(
+        blockchain, outfile, sync_policy);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == blockchain->num_unsynced_logged_blocks);
+    _add_block_with_minted_transaction(blockchain);
+    return_code = blockchain_write_to_file_with_sync_policy(
+        blockchain, outfile, sync_policy);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == blockchain->num_unsynced_logged_blocks);
+    _add_block_with_minted_transaction(blockchain);
+    return_code = blockchain_write_to_file_with_sync_policy(
+        blockchain, outfile, sync_policy);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == blockchain->num_unsynced_logged_blocks);
+    sync_policy.mode = BLOCKCHAIN_SYNC_EVERY_INTERVAL;
+    sync_policy.milliseconds_between_syncs = 3600000;
+    _add_block_with_minted_transaction(blockchain);
+    return_code = blockchain_write_to_file_with_sync_policy(
+        blockchain, outfile, sync_policy);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == blockchain->num_unsynced_logged_blocks);
+    sync_policy.milliseconds_between_syncs = 0;
+    _add_block_with_minted_transaction(blockchain);
+    return_code = blockchain_write_to_file_with_sync_policy(
+        blockchain, outfile, sync_policy);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == blockchain->num_unsynced_logged_blocks);
+    sync_policy.mode = BLOCKCHAIN_SYNC_EVERY_BLOCK;
+    _add_block_with_minted_transaction(blockchain);
+    return_code = blockchain_write_to_file_with_sync_policy(
+        blockchain, outfile, sync_policy);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == blockchain->num_unsynced_logged_blocks);
+    return_code = blockchain_write_to_file_with_sync_policy(
+        NULL, outfile, sync_policy);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_write_to_file_with_sync_policy(
+        blockchain, NULL, sync_policy);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_read_from_file_reconstructs_blockchain() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_no_transactions");
+    assert_true(return_value < TESTS_MAX_PATH);
+    // The fixture is an unversioned blockchain.
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    assert_true(NULL != blockchain);
+    assert_true(blockchain->num_leading_zero_bytes_required_in_block_hash != 0);
+    assert_true(NULL != blockchain->block_list);
+    uint64_t num_blocks = 0;
+    return_code = linked_list_length(blockchain->block_list, &num_blocks);
+    assert_true(SUCCESS == return_code);
+    assert_true(4 == num_blocks);
+    block_t *block1 = (block_t *)blockchain->block_list->head->data;
+    assert_true(GENESIS_BLOCK_PROOF_OF_WORK == block1->proof_of_work);
+    sha_256_t empty_block_hash = {0};
+    assert_true(0 == memcmp(
+        &block1->previous_block_hash, &empty_block_hash, sizeof(sha_256_t)));
+    bool transaction_list_is_empty = true;
+    return_code = linked_list_is_empty(
+        block1->transaction_list, &transaction_list_is_empty);
+    assert_true(SUCCESS == return_code);
+    assert_true(transaction_list_is_empty);
+    block_t *block2 = (block_t *)blockchain->block_list->head->next->data;
+    assert_true(0 != block2->proof_of_work);
+    assert_true(0 != block2->created_at);
+    assert_true(0 != memcmp(
+        &block2->previous_block_hash, &empty_block_hash, sizeof(sha_256_t)));
+    uint64_t num_transactions = 0;
+    return_code = linked_list_length(
+        block2->transaction_list, &num_transactions);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == num_transactions);
+    transaction_t *transaction =
+        (transaction_t *)block2->transaction_list->head->data;
+    assert_true(AMOUNT_GENERATED_DURING_MINTING == transaction->amount);
+    assert_true(0 != transaction->created_at);
+    assert_true(0 != transaction->sender_public_key->length);
+    bool is_equal = false;
+    return_code = public_key_equals(
+        transaction->sender_public_key,
+        transaction->recipient_public_key,
+        &is_equal);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_equal);
+    ssh_signature_t empty_signature = {0};
+    assert_true(0 != memcmp(
+        &transaction->sender_signature,
+        &empty_signature,
+        sizeof(ssh_signature_t)));
+    block_t *block3 = (block_t *)blockchain->block_list->head->next->next->data;
+    assert_true(0 != block3->proof_of_work);
+    assert_true(0 != block3->created_at);
+    assert_true(0 != memcmp(
+        &block3->previous_block_hash, &empty_block_hash, sizeof(sha_256_t)));
+    return_code = linked_list_length(
+        block3->transaction_list, &num_transactions);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == num_transactions);
+    transaction = (transaction_t *)block3->transaction_list->head->data;
+    assert_true(AMOUNT_GENERATED_DURING_MINTING == transaction->amount);
+    assert_true(0 != transaction->created_at);
+    assert_true(0 != transaction->sender_public_key->length);
+    return_code = public_key_equals(
+        transaction->sender_public_key,
+        transaction->recipient_public_key,
+        &is_equal);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_equal);
+    assert_true(0 != memcmp(
+        &transaction->sender_signature,
+        &empty_signature,
+        sizeof(ssh_signature_t)));
+    // Its blocks were mined against the old block hash.
+    bool is_valid_blockchain = true;
+    return_code = blockchain_verify(blockchain, &is_valid_blockchain, NULL);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid_blockchain);
     blockchain_destroy(blockchain);
 }
-
-void test_blockchain_deserialize_fails_on_invalid_input() {
+
+void test_blockchain_read_from_file_fails_on_invalid_input() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_no_transactions");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(NULL, infile);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_read_from_file(&blockchain, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+void test_blockchain_read_from_file_fails_on_empty_file() {
+    char output_directory[TESTS_MAX_PATH];
+    get_output_directory(output_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        output_directory,
+        "blockchain_test_blockchain_read_from_file_fails_on_empty_file");
+    assert_true(return_value < TESTS_MAX_PATH);
+    FILE *f = fopen(infile, "wb");
+    assert_true(NULL != f);
+    fclose(f);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(FAILURE_BUFFER_TOO_SMALL == return_code);
+    return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        output_directory,
+        "blockchain_test_blockchain_read_from_file_fails_on_empty_file_"
+        "missing");
+    assert_true(return_value < TESTS_MAX_PATH);
+    return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(FAILURE_FILE_IO == return_code);
+}
+void test_blockchain_read_from_fd_reads_block_log() {
     blockchain_t *blockchain = NULL;
     return_code_t return_code = blockchain_create(
         &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
     assert_true(SUCCESS == return_code);
-    block_t *genesis_block = NULL;
-    return_code = block_create_genesis_block(&genesis_block);
-    assert_true(SUCCESS == return_code);
-    return_code = blockchain_add_block(blockchain, genesis_block);
+    _add_block_with_minted_transaction(blockchain);
+    _add_block_with_minted_transaction(blockchain);
+    char output_directory[TESTS_MAX_PATH];
+    get_output_directory(output_directory);
+    char outfile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        outfile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        output_directory,
+        "blockchain_test_blockchain_read_from_fd_reads_block_log");
+    assert_true(return_value < TESTS_MAX_PATH);
+    return_code = blockchain_write_to_file(blockchain, outfile);
     assert_true(SUCCESS == return_code);
-    unsigned char *buffer = NULL;
-    uint64_t buffer_size = 0;
-    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    int fd = open(outfile, O_RDONLY);
+    assert_true(fd >= 0);
+    blockchain_t *read_blockchain = NULL;
+    return_code = blockchain_read_from_fd(&read_blockchain, fd);
+    close(fd);
     assert_true(SUCCESS == return_code);
-    blockchain_t *deserialized_blockchain = NULL;
-    return_code = blockchain_deserialize(NULL, buffer, buffer_size);
+    assert_true(1 == read_blockchain->key_table->num_keys);
+    _assert_same_block_hashes(
+        blockchain->block_list, read_blockchain->block_list);
+    return_code = blockchain_read_from_fd(NULL, 0);
     assert_true(FAILURE_INVALID_INPUT == return_code);
-    return_code = blockchain_deserialize(
-        &deserialized_blockchain, NULL, buffer_size);
+    return_code = blockchain_read_from_fd(&read_blockchain, -1);
     assert_true(FAILURE_INVALID_INPUT == return_code);
-    free(buffer);
+    blockchain_destroy(read_blockchain);
     blockchain_destroy(blockchain);
 }
 
-void test_blockchain_write_to_file_creates_nonempty_file() {
+
+void test_blockchain_read_from_file_ignores_interrupted_append() {
     blockchain_t *blockchain = NULL;
     return_code_t return_code = blockchain_create(
         &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
     assert_true(SUCCESS == return_code);
-    block_t *genesis_block = NULL;
-    return_code = block_create_genesis_block(&genesis_block);
-    assert_true(SUCCESS == return_code);
-    return_code = blockchain_add_block(blockchain, genesis_block);
-    assert_true(SUCCESS == return_code);
+    _add_block_with_minted_transaction(blockchain);
     char output_directory[TESTS_MAX_PATH];
     get_output_directory(output_directory);
     char outfile[TESTS_MAX_PATH];
@@ -630,27 +2300,61 @@ void test_blockchain_write_to_file_creates_nonempty_file() {
         TESTS_MAX_PATH,
         "%s/%s",
         output_directory,
-        "blockchain_test_blockchain_write_to_file_creates_nonempty_file");
+        "blockchain_test_blockchain_read_from_file_ignores_interrupted_append");
     assert_true(return_value < TESTS_MAX_PATH);
+    return_code = blockchain_write_to_file(blockchain, outfile);
+    assert_true(SUCCESS == return_code);
     struct stat file_stats = {0};
-    assert_true(0 != stat(outfile, &file_stats));
+    assert_true(0 == stat(outfile, &file_stats));
+    uint64_t first_size = file_stats.st_size;
+    _add_block_with_minted_transaction(blockchain);
     return_code = blockchain_write_to_file(blockchain, outfile);
     assert_true(SUCCESS == return_code);
     assert_true(0 == stat(outfile, &file_stats));
-    assert_true(0 != file_stats.st_size);
+    // Cut the second block's record short, as a crash mid-append would.
+    size_t file_size = file_stats.st_size;
+    unsigned char *contents = malloc(file_size);
+    assert_true(NULL != contents);
+    FILE *f = fopen(outfile, "rb");
+    assert_true(NULL != f);
+    assert_true(file_size == fread(contents, 1, file_size, f));
+    fclose(f);
+    f = fopen(outfile, "wb");
+    assert_true(NULL != f);
+    assert_true(file_size - 1 == fwrite(contents, 1, file_size - 1, f));
+    fclose(f);
+    free(contents);
+    blockchain_t *read_blockchain = NULL;
+    return_code = blockchain_read_from_file(&read_blockchain, outfile);
+    assert_true(SUCCESS == return_code);
+    uint64_t num_blocks = 0;
+    return_code = linked_list_length(read_blockchain->block_list, &num_blocks);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == num_blocks);
+    assert_true(first_size == read_blockchain->log_size);
+    // The next save replaces the partial record.
+    _add_block_with_minted_transaction(read_blockchain);
+    return_code = blockchain_write_to_file(read_blockchain, outfile);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *reread_blockchain = NULL;
+    return_code = blockchain_read_from_file(&reread_blockchain, outfile);
+    assert_true(SUCCESS == return_code);
+    return_code = linked_list_length(
+        reread_blockchain->block_list, &num_blocks);
+    assert_true(SUCCESS == return_code);
+    assert_true(2 == num_blocks);
+    blockchain_destroy(reread_blockchain);
+    blockchain_destroy(read_blockchain);
     blockchain_destroy(blockchain);
 }
 
-void test_blockchain_write_to_file_fails_on_invalid_input() {
+void test_blockchain_read_from_file_fails_on_corrupt_record() {
     blockchain_t *blockchain = NULL;
     return_code_t return_code = blockchain_create(
         &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
     assert_true(SUCCESS == return_code);
-    block_t *genesis_block = NULL;
-    return_code = block_create_genesis_block(&genesis_block);
-    assert_true(SUCCESS == return_code);
-    return_code = blockchain_add_block(blockchain, genesis_block);
-    assert_true(SUCCESS == return_code);
+    _add_block_with_minted_transaction(blockchain);
+    _add_block_with_minted_transaction(blockchain);
     char output_directory[TESTS_MAX_PATH];
     get_output_directory(output_directory);
     char outfile[TESTS_MAX_PATH];
@@ -659,16 +2363,28 @@ void test_blockchain_write_to_file_fails_on_invalid_input() {
         TESTS_MAX_PATH,
         "%s/%s",
         output_directory,
-        "blockchain_test_blockchain_write_to_file_fails_on_invalid_input");
+        "blockchain_test_blockchain_read_from_file_fails_on_corrupt_record");
     assert_true(return_value < TESTS_MAX_PATH);
-    return_code = blockchain_write_to_file(blockchain, NULL);
-    assert_true(FAILURE_INVALID_INPUT == return_code);
-    return_code = blockchain_write_to_file(NULL, outfile);
-    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_write_to_file(blockchain, outfile);
+    assert_true(SUCCESS == return_code);
+    // Flip a byte in the target record, which is not the last record.
+    FILE *f = fopen(outfile, "r+b");
+    assert_true(NULL != f);
+    long offset = sizeof(uint64_t) + 2 * sizeof(uint64_t);
+    assert_true(0 == fseek(f, offset, SEEK_SET));
+    int byte = fgetc(f);
+    assert_true(EOF != byte);
+    assert_true(0 == fseek(f, offset, SEEK_SET));
+    assert_true(EOF != fputc(byte ^ 0xff, f));
+    fclose(f);
+    blockchain_t *read_blockchain = NULL;
+    return_code = blockchain_read_from_file(&read_blockchain, outfile);
+    assert_true(FAILURE_INVALID_BLOCKCHAIN == return_code);
     blockchain_destroy(blockchain);
 }
 
-void test_blockchain_read_from_file_reconstructs_blockchain() {
+
+void _read_fixture_blockchain(blockchain_t **blockchain) {
     char fixture_directory[TESTS_MAX_PATH];
     get_fixture_directory(fixture_directory);
     char infile[TESTS_MAX_PATH];
@@ -677,80 +2393,135 @@ void test_blockchain_read_from_file_reconstructs_blockchain() {
         TESTS_MAX_PATH,
         "%s/%s",
         fixture_directory,
-        "blockchain_4_blocks_no_transactions");
+        "blockchain_4_blocks_no_transactions_v3");
     assert_true(return_value < TESTS_MAX_PATH);
-    blockchain_t *blockchain = NULL;
-    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    return_code_t return_code = blockchain_read_from_file(blockchain, infile);
     assert_true(SUCCESS == return_code);
-    assert_true(NULL != blockchain);
-    assert_true(blockchain->num_leading_zero_bytes_required_in_block_hash != 0);
-    assert_true(NULL != blockchain->block_list);
+}
+
+void _assert_view_matches_blockchain(
+    blockchain_view_t *view,
+    blockchain_t *blockchain
+) {
     uint64_t num_blocks = 0;
-    return_code = linked_list_length(blockchain->block_list, &num_blocks);
+    return_code_t return_code = linked_list_length(
+        blockchain->block_list, &num_blocks);
+    assert_true(SUCCESS == return_code);
+    assert_true(num_blocks == view->num_blocks);
+    uint64_t block_idx = 0;
+    for (node_t *block_node = blockchain->block_list->head;
+        NULL != block_node;
+        block_node = block_node->next, block_idx++) {
+        sha_256_t expected_hash = {0};
+        return_code = block_hash((block_t *)block_node->data, &expected_hash);
+        assert_true(SUCCESS == return_code);
+        block_view_t block = {0};
+        return_code = blockchain_view_get_block(view, block_idx, &block);
+        assert_true(SUCCESS == return_code);
+        sha_256_t view_hash = {0};
+        return_code = blockchain_view_block_hash(view, &block, &view_hash);
+        assert_true(SUCCESS == return_code);
+        assert_true(0 == memcmp(&expected_hash, &view_hash, sizeof(sha_256_t)));
+        block_t *materialized_block = NULL;
+        return_code = blockchain_view_materialize_block(
+            view, block_idx, &materialized_block);
+        assert_true(SUCCESS == return_code);
+        sha_256_t materialized_hash = {0};
+        return_code = block_hash(materialized_block, &materialized_hash);
+        assert_true(SUCCESS == return_code);
+        assert_true(0 == memcmp(
+            &expected_hash, &materialized_hash, sizeof(sha_256_t)));
+        block_destroy(materialized_block);
+    }
+}
+
+void test_blockchain_view_matches_read_blockchain() {
+    blockchain_t *blockchain = NULL;
+    _read_fixture_blockchain(&blockchain);
+    char output_directory[TESTS_MAX_PATH];
+    get_output_directory(output_directory);
+    char log_outfile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        log_outfile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        output_directory,
+        "blockchain_test_blockchain_view_matches_read_blockchain_log");
+    assert_true(return_value < TESTS_MAX_PATH);
+    return_code_t return_code = blockchain_write_to_file(
+        blockchain, log_outfile);
     assert_true(SUCCESS == return_code);
-    assert_true(4 == num_blocks);
-    block_t *block1 = (block_t *)blockchain->block_list->head->data;
-    assert_true(GENESIS_BLOCK_PROOF_OF_WORK == block1->proof_of_work);
-    sha_256_t empty_block_hash = {0};
-    assert_true(0 == memcmp(
-        &block1->previous_block_hash, &empty_block_hash, sizeof(sha_256_t)));
-    bool transaction_list_is_empty = true;
-    return_code = linked_list_is_empty(
-        block1->transaction_list, &transaction_list_is_empty);
+    char serialized_outfile[TESTS_MAX_PATH];
+    return_value = snprintf(
+        serialized_outfile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        output_directory,
+        "blockchain_test_blockchain_view_matches_read_blockchain_serialized");
+    assert_true(return_value < TESTS_MAX_PATH);
+    int fd = open(serialized_outfile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    assert_true(fd >= 0);
+    return_code = blockchain_serialize_to_fd(blockchain, fd);
+    close(fd);
+    assert_true(SUCCESS == return_code);
+    char *outfiles[] = {log_outfile, serialized_outfile};
+    for (size_t idx = 0; idx < sizeof(outfiles) / sizeof(outfiles[0]); idx++) {
+        blockchain_view_t *view = NULL;
+        return_code = blockchain_view_open(&view, outfiles[idx]);
+        assert_true(SUCCESS == return_code);
+        assert_true(1 == view->key_table->num_keys);
+        _assert_view_matches_blockchain(view, blockchain);
+        bool is_valid = false;
+        return_code = blockchain_view_verify(view, &is_valid, NULL);
+        assert_true(SUCCESS == return_code);
+        assert_true(is_valid);
+        blockchain_view_close(view);
+    }
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_view_verify_finds_first_invalid_block() {
+    blockchain_t *blockchain = NULL;
+    _read_fixture_blockchain(&blockchain);
+    block_t *block = (block_t *)blockchain->block_list->head->next->next->data;
+    transaction_t *minting_transaction =
+        (transaction_t *)block->transaction_list->head->data;
+    minting_transaction->sender_signature.bytes[0] ^= 0xff;
+    // Both verifiers apply the same rules, so they find the same block.
+    bool is_valid = true;
+    block_t *first_invalid_block = NULL;
+    return_code_t return_code = blockchain_verify(
+        blockchain, &is_valid, &first_invalid_block);
     assert_true(SUCCESS == return_code);
-    assert_true(transaction_list_is_empty);
-    block_t *block2 = (block_t *)blockchain->block_list->head->next->data;
-    assert_true(0 != block2->proof_of_work);
-    assert_true(0 != block2->created_at);
-    assert_true(0 != memcmp(
-        &block2->previous_block_hash, &empty_block_hash, sizeof(sha_256_t)));
-    uint64_t num_transactions = 0;
-    return_code = linked_list_length(
-        block2->transaction_list, &num_transactions);
+    assert_true(!is_valid);
+    assert_true(block == first_invalid_block);
+    char output_directory[TESTS_MAX_PATH];
+    get_output_directory(output_directory);
+    char outfile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        outfile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        output_directory,
+        "blockchain_test_blockchain_view_verify_finds_first_invalid_block");
+    assert_true(return_value < TESTS_MAX_PATH);
+    return_code = blockchain_write_to_file(blockchain, outfile);
     assert_true(SUCCESS == return_code);
-    assert_true(1 == num_transactions);
-    transaction_t *transaction =
-        (transaction_t *)block2->transaction_list->head->data;
-    assert_true(AMOUNT_GENERATED_DURING_MINTING == transaction->amount);
-    assert_true(0 != transaction->created_at);
-    ssh_key_t empty_key = {0};
-    assert_true(0 != memcmp(
-        &transaction->sender_public_key, &empty_key, sizeof(ssh_key_t)));
-    assert_true(0 == memcmp(
-        &transaction->sender_public_key,
-        &transaction->recipient_public_key,
-        sizeof(ssh_key_t)));
-    ssh_signature_t empty_signature = {0};
-    assert_true(0 != memcmp(
-        &transaction->sender_signature,
-        &empty_signature,
-        sizeof(ssh_signature_t)));
-    block_t *block3 = (block_t *)blockchain->block_list->head->next->next->data;
-    assert_true(0 != block3->proof_of_work);
-    assert_true(0 != block3->created_at);
-    assert_true(0 != memcmp(
-        &block3->previous_block_hash, &empty_block_hash, sizeof(sha_256_t)));
-    return_code = linked_list_length(
-        block3->transaction_list, &num_transactions);
+    blockchain_view_t *view = NULL;
+    return_code = blockchain_view_open(&view, outfile);
     assert_true(SUCCESS == return_code);
-    assert_true(1 == num_transactions);
-    transaction = (transaction_t *)block3->transaction_list->head->data;
-    assert_true(AMOUNT_GENERATED_DURING_MINTING == transaction->amount);
-    assert_true(0 != transaction->created_at);
-    assert_true(0 != memcmp(
-        &transaction->sender_public_key, &empty_key, sizeof(ssh_key_t)));
-    assert_true(0 == memcmp(
-        &transaction->sender_public_key,
-        &transaction->recipient_public_key,
-        sizeof(ssh_key_t)));
-    assert_true(0 != memcmp(
-        &transaction->sender_signature,
-        &empty_signature,
-        sizeof(ssh_signature_t)));
+    is_valid = true;
+    uint64_t first_invalid_block_idx = 0;
+    return_code = blockchain_view_verify(
+        view, &is_valid, &first_invalid_block_idx);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid);
+    assert_true(2 == first_invalid_block_idx);
+    blockchain_view_close(view);
     blockchain_destroy(blockchain);
 }
 
-void test_blockchain_read_from_file_fails_on_invalid_input() {
+void test_blockchain_view_open_fails_on_unsupported_format() {
     char fixture_directory[TESTS_MAX_PATH];
     get_fixture_directory(fixture_directory);
     char infile[TESTS_MAX_PATH];
@@ -761,11 +2532,56 @@ void test_blockchain_read_from_file_fails_on_invalid_input() {
         fixture_directory,
         "blockchain_4_blocks_no_transactions");
     assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_view_t *view = NULL;
+    return_code_t return_code = blockchain_view_open(&view, infile);
+    assert_true(FAILURE_INVALID_BLOCKCHAIN == return_code);
+}
+
+void test_blockchain_view_fails_on_invalid_input() {
     blockchain_t *blockchain = NULL;
-    return_code_t return_code = blockchain_read_from_file(NULL, infile);
+    _read_fixture_blockchain(&blockchain);
+    char output_directory[TESTS_MAX_PATH];
+    get_output_directory(output_directory);
+    char outfile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        outfile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        output_directory,
+        "blockchain_test_blockchain_view_fails_on_invalid_input");
+    assert_true(return_value < TESTS_MAX_PATH);
+    return_code_t return_code = blockchain_write_to_file(blockchain, outfile);
+    assert_true(SUCCESS == return_code);
+    blockchain_view_t *view = NULL;
+    return_code = blockchain_view_open(NULL, outfile);
     assert_true(FAILURE_INVALID_INPUT == return_code);
-    return_code = blockchain_read_from_file(&blockchain, NULL);
+    return_code = blockchain_view_open(&view, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_view_open(&view, outfile);
+    assert_true(SUCCESS == return_code);
+    block_view_t block = {0};
+    return_code = blockchain_view_get_block(view, view->num_blocks, &block);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    block_t *materialized_block = NULL;
+    return_code = blockchain_view_materialize_block(
+        view, view->num_blocks, &materialized_block);
     assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_view_get_block(view, 0, &block);
+    assert_true(SUCCESS == return_code);
+    size_t offset = block.transactions_size + 1;
+    transaction_t transaction = {0};
+    return_code = blockchain_view_read_transaction(
+        view, &block, &offset, &transaction);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    bool is_valid = false;
+    return_code = blockchain_view_verify(NULL, &is_valid, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_view_verify(view, NULL, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_view_close(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    blockchain_view_close(view);
+    blockchain_destroy(blockchain);
 }
 
 void test_blockchain_serialization_does_not_alter_block_hash() {
@@ -808,3 +2624,296 @@ void test_blockchain_serialization_does_not_alter_block_hash() {
     blockchain_destroy(blockchain);
     blockchain_destroy(deserialized_blockchain);
 }
+
+void test_blockchain_add_block_interns_keys() {
+    char *ssh_public_key_contents_base64 = getenv(
+        TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t public_key = {0};
+    return_code_t return_code = base64_decode(
+        ssh_public_key_contents_base64,
+        strlen(ssh_public_key_contents_base64),
+        public_key.bytes);
+    char *ssh_private_key_contents_base64 = getenv(
+        TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t private_key = {0};
+    return_code = base64_decode(
+        ssh_private_key_contents_base64,
+        strlen(ssh_private_key_contents_base64),
+        private_key.bytes);
+    blockchain_t *blockchain = NULL;
+    return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    // Each transaction_create call makes its own copies of the keys.
+    transaction_t *transactions[2] = {NULL};
+    sha_256_t empty_hash = {0};
+    for (size_t idx = 0; idx < 2; idx++) {
+        linked_list_t *transaction_list = NULL;
+        return_code = linked_list_create(
+            &transaction_list, (free_function_t *)transaction_destroy, NULL);
+        assert_true(SUCCESS == return_code);
+        return_code = transaction_create(
+            &transactions[idx],
+            &public_key,
+            &public_key,
+            AMOUNT_GENERATED_DURING_MINTING,
+            &private_key);
+        assert_true(SUCCESS == return_code);
+        return_code = linked_list_append(transaction_list, transactions[idx]);
+        assert_true(SUCCESS == return_code);
+        block_t *block = NULL;
+        return_code = block_create(&block, transaction_list, 0, empty_hash);
+        assert_true(SUCCESS == return_code);
+        return_code = blockchain_add_block(blockchain, block);
+        assert_true(SUCCESS == return_code);
+    }
+    assert_true(1 == blockchain->key_table->num_keys);
+    public_key_t *interned_key = blockchain->key_table->keys[0];
+    for (size_t idx = 0; idx < 2; idx++) {
+        assert_true(interned_key == transactions[idx]->sender_public_key);
+        assert_true(interned_key == transactions[idx]->recipient_public_key);
+    }
+    // The table and all four key fields hold references.
+    assert_true(5 == atomic_load(&interned_key->num_references));
+    blockchain_destroy(blockchain);
+}
+
+/**
+ * @brief The bytes a test sink has collected.
+ */
+typedef struct collected_bytes_t {
+    unsigned char *bytes;
+    size_t num_bytes;
+    size_t num_calls;
+    size_t max_num_bytes_per_call;
+} collected_bytes_t;
+
+return_code_t _collect_bytes(
+    unsigned char *bytes,
+    size_t num_bytes,
+    void *args
+) {
+    collected_bytes_t *collected_bytes = (collected_bytes_t *)args;
+    unsigned char *new_bytes = realloc(
+        collected_bytes->bytes, collected_bytes->num_bytes + num_bytes);
+    assert_true(NULL != new_bytes);
+    memcpy(new_bytes + collected_bytes->num_bytes, bytes, num_bytes);
+    collected_bytes->bytes = new_bytes;
+    collected_bytes->num_bytes += num_bytes;
+    collected_bytes->num_calls++;
+    if (num_bytes > collected_bytes->max_num_bytes_per_call) {
+        collected_bytes->max_num_bytes_per_call = num_bytes;
+    }
+    return SUCCESS;
+}
+
+return_code_t _refuse_bytes(
+    unsigned char *bytes,
+    size_t num_bytes,
+    void *args
+) {
+    (void)bytes;
+    (void)num_bytes;
+    (*(size_t *)args)++;
+    return FAILURE_FILE_IO;
+}
+
+void test_blockchain_serialize_to_sink_matches_serialize() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    _add_block_with_minted_transaction(blockchain);
+    block_t *first_block = (block_t *)blockchain->block_list->head->data;
+    transaction_t *first_transaction = (transaction_t *)
+        first_block->transaction_list->head->data;
+    // Enough blocks that the sink gets several full staging buffers.
+    size_t block_size =
+        4 * sizeof(uint64_t) + sizeof(sha_256_t) +
+        4 * sizeof(uint64_t) + 2 * sizeof(sha_256_t) +
+        first_transaction->sender_signature.length;
+    size_t num_blocks = 2 * BLOCKCHAIN_SERIALIZATION_STAGING_SIZE / block_size;
+    for (size_t idx = 1; idx < num_blocks; idx++) {
+        _add_block_with_minted_transaction(blockchain);
+    }
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    collected_bytes_t collected_bytes = {0};
+    return_code = blockchain_serialize_to_sink(
+        blockchain, _collect_bytes, &collected_bytes);
+    assert_true(SUCCESS == return_code);
+    assert_true(buffer_size == collected_bytes.num_bytes);
+    assert_true(0 == memcmp(buffer, collected_bytes.bytes, buffer_size));
+    assert_true(collected_bytes.num_calls > 1);
+    assert_true(collected_bytes.max_num_bytes_per_call <=
+        BLOCKCHAIN_SERIALIZATION_STAGING_SIZE);
+    // A sink's failure stops serialization.
+    size_t num_refusals = 0;
+    return_code = blockchain_serialize_to_sink(
+        blockchain, _refuse_bytes, &num_refusals);
+    assert_true(FAILURE_FILE_IO == return_code);
+    assert_true(1 == num_refusals);
+    free(collected_bytes.bytes);
+    free(buffer);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_serialize_to_sink_fails_on_invalid_input() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    _add_block_with_minted_transaction(blockchain);
+    collected_bytes_t collected_bytes = {0};
+    return_code = blockchain_serialize_to_sink(
+        NULL, _collect_bytes, &collected_bytes);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_serialize_to_sink(
+        blockchain, NULL, &collected_bytes);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_serialize_to_fd(NULL, 0);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_serialize_to_fd(blockchain, -1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    // An invalid block writes nothing, not a truncated blockchain.
+    _add_block_with_minted_transaction(blockchain);
+    block_t *last_block = (block_t *)blockchain->block_list->head->next->data;
+    transaction_t *transaction = (transaction_t *)
+        last_block->transaction_list->head->data;
+    transaction->sender_signature.length = MAX_SSH_SIGNATURE_LENGTH + 1;
+    return_code = blockchain_serialize_to_sink(
+        blockchain, _collect_bytes, &collected_bytes);
+    assert_true(FAILURE_SIGNATURE_TOO_LONG == return_code);
+    assert_true(0 == collected_bytes.num_calls);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_serialize_to_fd_round_trips() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    _add_block_with_minted_transaction(blockchain);
+    _add_block_with_minted_transaction(blockchain);
+    char output_directory[TESTS_MAX_PATH];
+    get_output_directory(output_directory);
+    char outfile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        outfile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        output_directory,
+        "blockchain_test_blockchain_serialize_to_fd_round_trips");
+    assert_true(return_value < TESTS_MAX_PATH);
+    int fd = open(outfile, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    assert_true(fd >= 0);
+    return_code = blockchain_serialize_to_fd(blockchain, fd);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == lseek(fd, 0, SEEK_SET));
+    blockchain_t *read_blockchain = NULL;
+    return_code = blockchain_read_from_fd(&read_blockchain, fd);
+    close(fd);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == read_blockchain->key_table->num_keys);
+    _assert_same_block_hashes(
+        blockchain->block_list, read_blockchain->block_list);
+    blockchain_destroy(read_blockchain);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_serialize_stores_each_key_once() {
+    char *ssh_public_key_contents_base64 = getenv(
+        TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t public_key = {0};
+    return_code_t return_code = base64_decode(
+        ssh_public_key_contents_base64,
+        strlen(ssh_public_key_contents_base64),
+        public_key.bytes);
+    char *ssh_private_key_contents_base64 = getenv(
+        TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t private_key = {0};
+    return_code = base64_decode(
+        ssh_private_key_contents_base64,
+        strlen(ssh_private_key_contents_base64),
+        private_key.bytes);
+    blockchain_t *blockchain = NULL;
+    return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    size_t num_blocks = 4;
+    size_t signature_length = 0;
+    sha_256_t empty_hash = {0};
+    for (size_t idx = 0; idx < num_blocks; idx++) {
+        linked_list_t *transaction_list = NULL;
+        return_code = linked_list_create(
+            &transaction_list, (free_function_t *)transaction_destroy, NULL);
+        assert_true(SUCCESS == return_code);
+        transaction_t *transaction = NULL;
+        return_code = transaction_create(
+            &transaction,
+            &public_key,
+            &public_key,
+            AMOUNT_GENERATED_DURING_MINTING,
+            &private_key);
+        assert_true(SUCCESS == return_code);
+        signature_length = transaction->sender_signature.length;
+        return_code = linked_list_append(transaction_list, transaction);
+        assert_true(SUCCESS == return_code);
+        block_t *block = NULL;
+        return_code = block_create(&block, transaction_list, 0, empty_hash);
+        assert_true(SUCCESS == return_code);
+        return_code = blockchain_add_block(blockchain, block);
+        assert_true(SUCCESS == return_code);
+    }
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    // The magic number, target, key count, and block count; the one key; and
+    // each block's header fields and transaction, which refers to the key by
+    // ID twice.
+    size_t expected_size =
+        4 * sizeof(uint64_t) +
+        sizeof(uint64_t) + strlen(public_key.bytes) +
+        num_blocks * (4 * sizeof(uint64_t) + sizeof(sha_256_t)) +
+        num_blocks * (
+            4 * sizeof(uint64_t) + 2 * sizeof(sha_256_t) + signature_length);
+    assert_true(expected_size == buffer_size);
+    blockchain_t *deserialized_blockchain = NULL;
+    return_code = blockchain_deserialize(
+        &deserialized_blockchain, buffer, buffer_size);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == deserialized_blockchain->key_table->num_keys);
+    public_key_t *interned_key = deserialized_blockchain->key_table->keys[0];
+    node_t *block_node = blockchain->block_list->head;
+    for (node_t *deserialized_block_node =
+            deserialized_blockchain->block_list->head;
+        NULL != deserialized_block_node;
+        deserialized_block_node = deserialized_block_node->next) {
+        block_t *block = (block_t *)block_node->data;
+        block_t *deserialized_block = (block_t *)deserialized_block_node->data;
+        transaction_t *transaction =
+            (transaction_t *)block->transaction_list->head->data;
+        transaction_t *deserialized_transaction =
+            (transaction_t *)deserialized_block->transaction_list->head->data;
+        assert_true(
+            interned_key == deserialized_transaction->sender_public_key);
+        assert_true(
+            interned_key == deserialized_transaction->recipient_public_key);
+        sha_256_t transaction_hash1 = {0};
+        return_code = transaction_hash(transaction, &transaction_hash1);
+        assert_true(SUCCESS == return_code);
+        sha_256_t transaction_hash2 = {0};
+        return_code = transaction_hash(
+            deserialized_transaction, &transaction_hash2);
+        assert_true(SUCCESS == return_code);
+        assert_true(0 == memcmp(
+            &transaction_hash1, &transaction_hash2, sizeof(sha_256_t)));
+        block_node = block_node->next;
+    }
+    free(buffer);
+    blockchain_destroy(deserialized_blockchain);
+    blockchain_destroy(blockchain);
+}
@@ -13,6 +13,16 @@ void test_blockchain_create_gives_blockchain();
 
 void test_blockchain_create_fails_on_invalid_input();
 
+void test_blockchain_create_with_target_gives_blockchain();
+
+void test_blockchain_create_with_target_fails_on_invalid_input();
+
+void test_blockchain_target_from_num_leading_zero_bits_gives_target();
+
+void test_blockchain_target_from_num_leading_zero_bytes_matches_bits();
+
+void test_blockchain_target_fails_on_invalid_input();
+
 void test_blockchain_destroy_returns_success();
 
 void test_blockchain_destroy_fails_on_invalid_input();
@@ -29,16 +39,42 @@ void test_blockchain_add_block_appends_block();
 
 void test_blockchain_add_block_fails_on_invalid_input();
 
+void test_blockchain_add_block_interns_keys();
+
 void test_blockchain_is_valid_block_hash_true_on_valid_hash();
 
 void test_blockchain_is_valid_block_hash_false_on_invalid_hash();
 
 void test_blockchain_is_valid_block_hash_fails_on_invalid_input();
 
+void test_blockchain_is_valid_block_hash_compares_hash_with_target();
+
 void test_blockchain_mine_block_produces_block_with_valid_hash();
 
+void test_blockchain_mine_block_multithreaded_gives_same_proof_of_work();
+
+void test_blockchain_mine_block_reuses_pools_across_concurrent_calls();
+
 void test_blockchain_mine_block_fails_on_invalid_input();
 
+void test_blockchain_search_for_proof_of_work_ignores_batch_size();
+
+void test_blockchain_search_for_proof_of_work_returns_abort_code();
+
+void test_blockchain_search_for_proof_of_work_fails_on_invalid_input();
+
+void test_blockchain_search_for_proof_of_work_rolls_extra_nonce();
+
+void test_mining_pools_destroy_shared_stops_idle_pools();
+
+void test_mining_pool_create_gives_pool();
+
+void test_mining_pool_create_fails_on_invalid_input();
+
+void test_mining_pool_search_for_proof_of_work_reuses_workers();
+
+void test_mining_pool_search_for_proof_of_work_fails_on_invalid_input();
+
 void test_blockchain_verify_succeeds_on_valid_blockchain();
 
 void test_blockchain_verify_fails_on_invalid_genesis_block();
@@ -49,26 +85,84 @@ void test_blockchain_verify_fails_on_invalid_previous_block_hash();
 
 void test_blockchain_verify_fails_on_invalid_transaction_signature();
 
+void test_blockchain_verify_finds_first_invalid_signature_in_parallel();
+
+void test_blockchain_verify_caches_only_valid_signatures();
+
+void test_blockchain_verify_accepts_mixed_signature_versions();
+
+void test_blockchain_get_verified_signature_cache_fails_on_null();
+
+void test_blockchain_verify_records_watermark();
+
+void test_blockchain_verify_incremental_only_checks_new_blocks();
+
+void test_blockchain_verify_incremental_fails_on_invalid_input();
+
 void test_blockchain_verify_fails_on_invalid_input();
 
 void test_blockchain_serialize_creates_nonempty_buffer();
 
 void test_blockchain_serialize_fails_on_invalid_input();
 
+void test_blockchain_serialize_stores_each_key_once();
+
+void test_blockchain_serialize_to_sink_matches_serialize();
+
+void test_blockchain_serialize_to_sink_fails_on_invalid_input();
+
+void test_blockchain_serialize_to_fd_round_trips();
+
 void test_blockchain_deserialize_reconstructs_blockchain();
 
+void test_blockchain_deserialize_reconstructs_custom_target();
+
 void test_blockchain_deserialize_fails_on_attempted_read_past_buffer();
 
 void test_blockchain_deserialize_fails_on_invalid_input();
 
+void test_blockchain_deserialize_fails_on_unknown_format();
+
+void test_blockchain_deserialize_fails_on_padded_key();
+
+void test_blockchain_decoder_decodes_chunks_of_any_size();
+
+void test_blockchain_decoder_fails_on_invalid_input();
+
+void test_blockchain_decoder_rejects_oversized_records();
+
 void test_blockchain_write_to_file_creates_nonempty_file();
 
 void test_blockchain_write_to_file_fails_on_invalid_input();
 
+void test_blockchain_write_to_file_appends_new_blocks();
+
+void test_blockchain_write_to_file_rewrites_changed_file();
+
+void test_blockchain_write_to_file_replaces_file_with_renamed_log();
+
+void test_blockchain_write_to_file_with_sync_policy_follows_policy();
+
 void test_blockchain_read_from_file_reconstructs_blockchain();
 
 void test_blockchain_read_from_file_fails_on_invalid_input();
 
+void test_blockchain_read_from_file_fails_on_empty_file();
+
+void test_blockchain_read_from_fd_reads_block_log();
+
+void test_blockchain_read_from_file_ignores_interrupted_append();
+
+void test_blockchain_read_from_file_fails_on_corrupt_record();
+
+void test_blockchain_view_matches_read_blockchain();
+
+void test_blockchain_view_verify_finds_first_invalid_block();
+
+void test_blockchain_view_open_fails_on_unsupported_format();
+
+void test_blockchain_view_fails_on_invalid_input();
+
 void test_blockchain_serialization_does_not_alter_block_hash();
 
 #endif  // TESTS_TEST_BLOCKCHAIN_H_
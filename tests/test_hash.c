@@ -0,0 +1,266 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "include/hash.h"
+#include "include/return_codes.h"
+#include "tests/test_hash.h"
+
+#define TEST_MESSAGE_LENGTH 300
+
+void test_hash_midstate_finalize_matches_openssl() {
+    unsigned char message[TEST_MESSAGE_LENGTH];
+    for (size_t idx = 0; idx < sizeof(message); idx++) {
+        message[idx] = (unsigned char)(idx * 7 + 3);
+    }
+    // Cover every split point between prefix and suffix, including suffixes
+    // that need one and two padding blocks.
+    for (size_t message_length = 0;
+        message_length <= sizeof(message);
+        message_length++) {
+        sha_256_t expected_hash = {0};
+        SHA256(message, message_length, expected_hash.digest);
+        for (size_t prefix_length = 0;
+            prefix_length <= message_length;
+            prefix_length += SHA_256_BLOCK_LENGTH) {
+            sha_256_midstate_t midstate = {0};
+            return_code_t return_code = hash_midstate_create(
+                &midstate, message, prefix_length);
+            assert_true(SUCCESS == return_code);
+            sha_256_t hash = {0};
+            return_code = hash_midstate_finalize(
+                &midstate,
+                message + prefix_length,
+                message_length - prefix_length,
+                &hash);
+            assert_true(SUCCESS == return_code);
+            assert_true(0 == memcmp(&hash, &expected_hash, sizeof(sha_256_t)));
+        }
+    }
+}
+
+void test_hash_midstate_finalize_does_not_modify_midstate() {
+    unsigned char message[SHA_256_BLOCK_LENGTH + 16] = {0};
+    message[0] = 'A';
+    sha_256_midstate_t midstate = {0};
+    return_code_t return_code = hash_midstate_create(
+        &midstate, message, SHA_256_BLOCK_LENGTH);
+    assert_true(SUCCESS == return_code);
+    sha_256_midstate_t midstate_copy = midstate;
+    sha_256_t hash1 = {0};
+    return_code = hash_midstate_finalize(
+        &midstate, message + SHA_256_BLOCK_LENGTH, 16, &hash1);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(
+        &midstate, &midstate_copy, sizeof(sha_256_midstate_t)));
+    sha_256_t hash2 = {0};
+    return_code = hash_midstate_finalize(
+        &midstate, message + SHA_256_BLOCK_LENGTH, 16, &hash2);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(&hash1, &hash2, sizeof(sha_256_t)));
+}
+
+void test_hash_midstate_create_fails_on_invalid_input() {
+    unsigned char prefix[SHA_256_BLOCK_LENGTH] = {0};
+    sha_256_midstate_t midstate = {0};
+    return_code_t return_code = hash_midstate_create(
+        NULL, prefix, sizeof(prefix));
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = hash_midstate_create(&midstate, NULL, sizeof(prefix));
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    // The prefix must be a whole number of SHA-256 blocks.
+    return_code = hash_midstate_create(&midstate, prefix, sizeof(prefix) - 1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_hash_midstate_finalize_fails_on_invalid_input() {
+    unsigned char suffix[16] = {0};
+    sha_256_midstate_t midstate = {0};
+    return_code_t return_code = hash_midstate_create(&midstate, NULL, 0);
+    assert_true(SUCCESS == return_code);
+    sha_256_t hash = {0};
+    return_code = hash_midstate_finalize(NULL, suffix, sizeof(suffix), &hash);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = hash_midstate_finalize(
+        &midstate, NULL, sizeof(suffix), &hash);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = hash_midstate_finalize(
+        &midstate, suffix, sizeof(suffix), NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_hash_midstate_final_block_matches_finalize() {
+    unsigned char message[SHA_256_BLOCK_LENGTH + 16];
+    for (size_t idx = 0; idx < sizeof(message); idx++) {
+        message[idx] = (unsigned char)(idx * 7 + 3);
+    }
+    sha_256_midstate_t midstate = {0};
+    return_code_t return_code = hash_midstate_create(
+        &midstate, message, SHA_256_BLOCK_LENGTH);
+    assert_true(SUCCESS == return_code);
+    unsigned char final_block[SHA_256_BLOCK_LENGTH];
+    return_code = hash_midstate_final_block(
+        &midstate, message + SHA_256_BLOCK_LENGTH, 16, final_block);
+    assert_true(SUCCESS == return_code);
+    uint32_t state[8];
+    memcpy(state, midstate.state, sizeof(state));
+    hash_sha_256_compress(state, final_block);
+    sha_256_t expected_hash = {0};
+    SHA256(message, sizeof(message), expected_hash.digest);
+    for (size_t idx = 0; idx < 8; idx++) {
+        assert_true(expected_hash.digest[4 * idx] == (state[idx] >> 24));
+        assert_true(
+            expected_hash.digest[4 * idx + 1] == ((state[idx] >> 16) & 0xff));
+        assert_true(
+            expected_hash.digest[4 * idx + 2] == ((state[idx] >> 8) & 0xff));
+        assert_true(expected_hash.digest[4 * idx + 3] == (state[idx] & 0xff));
+    }
+}
+
+void test_hash_midstate_final_block_fails_on_invalid_input() {
+    unsigned char suffix[SHA_256_BLOCK_LENGTH] = {0};
+    unsigned char final_block[SHA_256_BLOCK_LENGTH];
+    sha_256_midstate_t midstate = {0};
+    return_code_t return_code = hash_midstate_create(&midstate, NULL, 0);
+    assert_true(SUCCESS == return_code);
+    return_code = hash_midstate_final_block(NULL, suffix, 16, final_block);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = hash_midstate_final_block(&midstate, NULL, 16, final_block);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = hash_midstate_final_block(&midstate, suffix, 16, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    // The suffix, the one bit, and the length must fit in one block.
+    return_code = hash_midstate_final_block(
+        &midstate, suffix, SHA_256_BLOCK_LENGTH - 8, final_block);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_hash_sha_256_matches_openssl_for_every_backend() {
+    unsigned char message[TEST_MESSAGE_LENGTH];
+    for (size_t idx = 0; idx < sizeof(message); idx++) {
+        message[idx] = (unsigned char)(idx * 7 + 3);
+    }
+    const hash_backend_t *backends = NULL;
+    size_t num_backends = 0;
+    return_code_t return_code = hash_get_backends(&backends, &num_backends);
+    assert_true(SUCCESS == return_code);
+    assert_true(num_backends > 0);
+    // The last backend is always supported, so use its compression function
+    // as the reference.
+    const hash_backend_t *reference_backend = &backends[num_backends - 1];
+    assert_true(reference_backend->is_supported());
+    for (size_t backend_idx = 0; backend_idx < num_backends; backend_idx++) {
+        const hash_backend_t *backend = &backends[backend_idx];
+        if (!backend->is_supported()) {
+            continue;
+        }
+        for (size_t message_length = 0;
+            message_length <= sizeof(message);
+            message_length++) {
+            sha_256_t expected_hash = {0};
+            SHA256(message, message_length, expected_hash.digest);
+            sha_256_t hash = {0};
+            return_code = backend->digest(message, message_length, &hash);
+            assert_true(SUCCESS == return_code);
+            assert_true(0 == memcmp(&hash, &expected_hash, sizeof(sha_256_t)));
+        }
+        size_t num_blocks = sizeof(message) / SHA_256_BLOCK_LENGTH;
+        uint32_t state[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+        uint32_t expected_state[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+        backend->compress(state, message, num_blocks);
+        reference_backend->compress(expected_state, message, num_blocks);
+        assert_true(0 == memcmp(state, expected_state, sizeof(state)));
+    }
+}
+
+void test_hash_get_backend_gives_supported_backend() {
+    const hash_backend_t *backend = NULL;
+    return_code_t return_code = hash_get_backend(&backend);
+    assert_true(SUCCESS == return_code);
+    assert_true(NULL != backend);
+    assert_true(backend->is_supported());
+    // Every call gives the same backend.
+    const hash_backend_t *backend_again = NULL;
+    return_code = hash_get_backend(&backend_again);
+    assert_true(SUCCESS == return_code);
+    assert_true(backend == backend_again);
+}
+
+void test_hash_sha_256_fails_on_invalid_input() {
+    unsigned char message[16] = {0};
+    sha_256_t hash = {0};
+    return_code_t return_code = hash_sha_256(NULL, sizeof(message), &hash);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = hash_sha_256(message, sizeof(message), NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = hash_get_backend(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = hash_get_backends(NULL, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_hash_bucket_index_uses_leading_bytes() {
+    sha_256_t hash = {0};
+    for (size_t idx = 0; idx < sizeof(hash.digest); idx++) {
+        hash.digest[idx] = (unsigned char)(0xa5 + idx);
+    }
+    size_t leading_bytes = 0;
+    memcpy(&leading_bytes, hash.digest, sizeof(leading_bytes));
+    assert_true(0 == hash_bucket_index(&hash, 1));
+    for (size_t num_buckets = 2; num_buckets <= 1024; num_buckets *= 2) {
+        size_t bucket_index = hash_bucket_index(&hash, num_buckets);
+        assert_true(bucket_index < num_buckets);
+        assert_true((leading_bytes & (num_buckets - 1)) == bucket_index);
+    }
+}
+
+void test_hash_get_thread_context_reuses_context_within_thread() {
+    EVP_MD_CTX *context = NULL;
+    return_code_t return_code = hash_get_thread_context(&context);
+    assert_true(SUCCESS == return_code);
+    assert_true(NULL != context);
+    const EVP_MD *md = NULL;
+    return_code = hash_get_sha_256_md(&md);
+    assert_true(SUCCESS == return_code);
+    assert_true(NULL != md);
+    assert_true(1 == EVP_DigestInit_ex(context, md, NULL));
+    EVP_MD_CTX *context_again = NULL;
+    return_code = hash_get_thread_context(&context_again);
+    assert_true(SUCCESS == return_code);
+    assert_true(context == context_again);
+    // The context comes back reset, so hashing with it still works.
+    unsigned char message[] = "message";
+    sha_256_t expected_hash = {0};
+    SHA256(message, sizeof(message), expected_hash.digest);
+    sha_256_t hash = {0};
+    assert_true(1 == EVP_DigestInit_ex(context_again, md, NULL));
+    assert_true(1 == EVP_DigestUpdate(context_again, message, sizeof(message)));
+    assert_true(1 == EVP_DigestFinal_ex(context_again, hash.digest, NULL));
+    assert_true(0 == memcmp(&hash, &expected_hash, sizeof(sha_256_t)));
+}
+
+void *_get_thread_context(void *args) {
+    EVP_MD_CTX **context = (EVP_MD_CTX **)args;
+    hash_get_thread_context(context);
+    return NULL;
+}
+
+void test_hash_get_thread_context_gives_each_thread_its_own_context() {
+    EVP_MD_CTX *context = NULL;
+    return_code_t return_code = hash_get_thread_context(&context);
+    assert_true(SUCCESS == return_code);
+    EVP_MD_CTX *other_thread_context = NULL;
+    pthread_t thread;
+    assert_true(0 == pthread_create(
+        &thread, NULL, _get_thread_context, &other_thread_context));
+    pthread_join(thread, NULL);
+    assert_true(NULL != other_thread_context);
+    assert_true(context != other_thread_context);
+}
+
+void test_hash_get_thread_context_fails_on_invalid_input() {
+    return_code_t return_code = hash_get_thread_context(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = hash_get_sha_256_md(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
@@ -0,0 +1,38 @@
+/**
+ * @brief Tests hash.c.
+ */
+
+#ifndef TESTS_TEST_HASH_H_
+#define TESTS_TEST_HASH_H_
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+void test_hash_midstate_finalize_matches_openssl();
+
+void test_hash_midstate_finalize_does_not_modify_midstate();
+
+void test_hash_midstate_create_fails_on_invalid_input();
+
+void test_hash_midstate_finalize_fails_on_invalid_input();
+
+void test_hash_midstate_final_block_matches_finalize();
+
+void test_hash_midstate_final_block_fails_on_invalid_input();
+
+void test_hash_sha_256_matches_openssl_for_every_backend();
+
+void test_hash_get_backend_gives_supported_backend();
+
+void test_hash_sha_256_fails_on_invalid_input();
+
+void test_hash_bucket_index_uses_leading_bytes();
+
+void test_hash_get_thread_context_reuses_context_within_thread();
+
+void test_hash_get_thread_context_gives_each_thread_its_own_context();
+
+void test_hash_get_thread_context_fails_on_invalid_input();
+
+#endif  // TESTS_TEST_HASH_H_
@@ -0,0 +1,145 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "include/hash.h"
+#include "include/hash_batch.h"
+#include "include/return_codes.h"
+#include "tests/test_hash_batch.h"
+
+#define TEST_SUFFIX_LENGTH 16
+
+void test_hash_batch_finalize_matches_midstate_finalize_for_every_kernel() {
+    unsigned char prefix[SHA_256_BLOCK_LENGTH];
+    for (size_t idx = 0; idx < sizeof(prefix); idx++) {
+        prefix[idx] = (unsigned char)(idx * 7 + 3);
+    }
+    sha_256_midstate_t midstate = {0};
+    return_code_t return_code = hash_midstate_create(
+        &midstate, prefix, sizeof(prefix));
+    assert_true(SUCCESS == return_code);
+    const hash_batch_kernel_t *kernels = NULL;
+    size_t num_kernels = 0;
+    return_code = hash_batch_get_kernels(&kernels, &num_kernels);
+    assert_true(SUCCESS == return_code);
+    // Include counters whose lanes carry into the upper 32 bits.
+    uint64_t first_counters[] = {0, 13, 0xfffffffaULL, 0x123456789abcdefULL};
+    for (size_t kernel_idx = 0; kernel_idx < num_kernels; kernel_idx++) {
+        const hash_batch_kernel_t *kernel = &kernels[kernel_idx];
+        if (!kernel->is_supported()) {
+            continue;
+        }
+        for (size_t counter_offset = 0;
+            counter_offset + sizeof(uint64_t) <= TEST_SUFFIX_LENGTH;
+            counter_offset += sizeof(uint32_t)) {
+            unsigned char suffix[TEST_SUFFIX_LENGTH];
+            for (size_t idx = 0; idx < sizeof(suffix); idx++) {
+                suffix[idx] = (unsigned char)(idx * 11 + 5);
+            }
+            unsigned char final_block[SHA_256_BLOCK_LENGTH];
+            return_code = hash_midstate_final_block(
+                &midstate, suffix, sizeof(suffix), final_block);
+            assert_true(SUCCESS == return_code);
+            for (size_t counter_idx = 0;
+                counter_idx < sizeof(first_counters) / sizeof(uint64_t);
+                counter_idx++) {
+                sha_256_t hashes[HASH_BATCH_MAX_LANES];
+                return_code = hash_batch_finalize(
+                    kernel,
+                    &midstate,
+                    final_block,
+                    counter_offset,
+                    first_counters[counter_idx],
+                    hashes);
+                assert_true(SUCCESS == return_code);
+                for (size_t lane = 0; lane < kernel->num_lanes; lane++) {
+                    uint64_t counter = first_counters[counter_idx] + lane;
+                    for (size_t idx = 0; idx < sizeof(counter); idx++) {
+                        suffix[counter_offset + idx] = (unsigned char)(
+                            counter >> (8 * (sizeof(counter) - 1 - idx)));
+                    }
+                    sha_256_t expected_hash = {0};
+                    return_code = hash_midstate_finalize(
+                        &midstate, suffix, sizeof(suffix), &expected_hash);
+                    assert_true(SUCCESS == return_code);
+                    assert_true(0 == memcmp(
+                        &hashes[lane], &expected_hash, sizeof(sha_256_t)));
+                }
+            }
+        }
+    }
+}
+
+void test_hash_batch_get_best_kernel_gives_supported_kernel() {
+    const hash_batch_kernel_t *kernel = NULL;
+    return_code_t return_code = hash_batch_get_best_kernel(&kernel);
+    assert_true(SUCCESS == return_code);
+    assert_true(NULL != kernel);
+    assert_true(kernel->is_supported());
+    assert_true(kernel->num_lanes <= HASH_BATCH_MAX_LANES);
+    const hash_batch_kernel_t *same_kernel = NULL;
+    return_code = hash_batch_get_best_kernel(&same_kernel);
+    assert_true(SUCCESS == return_code);
+    assert_true(kernel == same_kernel);
+}
+
+void test_hash_batch_get_kernels_has_sha_ni_kernel_with_sha_ni_backend() {
+    const hash_backend_t *backend = NULL;
+    return_code_t return_code = hash_get_backend(&backend);
+    assert_true(SUCCESS == return_code);
+    if (0 != strcmp(backend->name, "sha-ni")) {
+        return;
+    }
+    const hash_batch_kernel_t *kernels = NULL;
+    size_t num_kernels = 0;
+    return_code = hash_batch_get_kernels(&kernels, &num_kernels);
+    assert_true(SUCCESS == return_code);
+    bool found_sha_ni_kernel = false;
+    for (size_t idx = 0; idx < num_kernels; idx++) {
+        if (0 == strcmp(kernels[idx].name, "sha-ni")) {
+            assert_true(kernels[idx].is_supported());
+            found_sha_ni_kernel = true;
+        }
+    }
+    assert_true(found_sha_ni_kernel);
+}
+
+void test_hash_batch_get_kernels_ends_with_scalar_kernel() {
+    const hash_batch_kernel_t *kernels = NULL;
+    size_t num_kernels = 0;
+    return_code_t return_code = hash_batch_get_kernels(&kernels, &num_kernels);
+    assert_true(SUCCESS == return_code);
+    assert_true(num_kernels > 0);
+    assert_true(1 == kernels[num_kernels - 1].num_lanes);
+    assert_true(kernels[num_kernels - 1].is_supported());
+    for (size_t idx = 1; idx < num_kernels; idx++) {
+        assert_true(kernels[idx].num_lanes < kernels[idx - 1].num_lanes);
+    }
+}
+
+void test_hash_batch_finalize_fails_on_invalid_input() {
+    const hash_batch_kernel_t *kernel = NULL;
+    return_code_t return_code = hash_batch_get_best_kernel(&kernel);
+    assert_true(SUCCESS == return_code);
+    sha_256_midstate_t midstate = {0};
+    return_code = hash_midstate_create(&midstate, NULL, 0);
+    assert_true(SUCCESS == return_code);
+    unsigned char final_block[SHA_256_BLOCK_LENGTH] = {0};
+    sha_256_t hashes[HASH_BATCH_MAX_LANES];
+    return_code = hash_batch_finalize(
+        NULL, &midstate, final_block, 0, 0, hashes);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = hash_batch_finalize(kernel, NULL, final_block, 0, 0, hashes);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = hash_batch_finalize(kernel, &midstate, NULL, 0, 0, hashes);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = hash_batch_finalize(
+        kernel, &midstate, final_block, 0, 0, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    // The counter must start on a word boundary and fit in the block.
+    return_code = hash_batch_finalize(
+        kernel, &midstate, final_block, 2, 0, hashes);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = hash_batch_finalize(
+        kernel, &midstate, final_block, SHA_256_BLOCK_LENGTH - 4, 0, hashes);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
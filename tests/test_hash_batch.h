@@ -0,0 +1,22 @@
+/**
+ * @brief Tests hash_batch.c.
+ */
+
+#ifndef TESTS_TEST_HASH_BATCH_H_
+#define TESTS_TEST_HASH_BATCH_H_
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+void test_hash_batch_finalize_matches_midstate_finalize_for_every_kernel();
+
+void test_hash_batch_get_best_kernel_gives_supported_kernel();
+
+void test_hash_batch_get_kernels_has_sha_ni_kernel_with_sha_ni_backend();
+
+void test_hash_batch_get_kernels_ends_with_scalar_kernel();
+
+void test_hash_batch_finalize_fails_on_invalid_input();
+
+#endif  // TESTS_TEST_HASH_BATCH_H_
@@ -0,0 +1,150 @@
+#include <stdbool.h>
+#include <string.h>
+#include "include/key_table.h"
+#include "include/return_codes.h"
+#include "tests/test_key_table.h"
+
+public_key_t *_key_table_test_key(unsigned char seed) {
+    unsigned char bytes[] = {seed, 1, 2, 3};
+    public_key_t *public_key = NULL;
+    public_key_create(&public_key, bytes, sizeof(bytes));
+    return public_key;
+}
+
+void test_key_table_create_gives_key_table() {
+    key_table_t *table = NULL;
+    return_code_t return_code = key_table_create(&table);
+    assert_true(SUCCESS == return_code);
+    assert_true(NULL != table);
+    assert_true(0 == table->num_keys);
+    assert_true(KEY_TABLE_INITIAL_CAPACITY == table->capacity);
+    assert_true(table->num_buckets >= 2 * table->capacity);
+    assert_true(0 == (table->num_buckets & (table->num_buckets - 1)));
+    return_code = key_table_destroy(table);
+    assert_true(SUCCESS == return_code);
+}
+
+void test_key_table_create_fails_on_invalid_input() {
+    return_code_t return_code = key_table_create(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = key_table_destroy(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_key_table_intern_gives_one_object_per_key() {
+    key_table_t *table = NULL;
+    return_code_t return_code = key_table_create(&table);
+    assert_true(SUCCESS == return_code);
+    public_key_t *public_key1 = _key_table_test_key(7);
+    public_key_t *public_key2 = _key_table_test_key(7);
+    public_key_t *interned_key1 = NULL;
+    return_code = key_table_intern(table, public_key1, &interned_key1);
+    assert_true(SUCCESS == return_code);
+    assert_true(public_key1 == interned_key1);
+    // An equal key in a different object gives the first object.
+    public_key_t *interned_key2 = NULL;
+    return_code = key_table_intern(table, public_key2, &interned_key2);
+    assert_true(SUCCESS == return_code);
+    assert_true(public_key1 == interned_key2);
+    assert_true(1 == table->num_keys);
+    // The caller, the table, and both interned pointers hold references.
+    assert_true(4 == atomic_load(&public_key1->num_references));
+    assert_true(1 == atomic_load(&public_key2->num_references));
+    public_key_release(interned_key2);
+    public_key_release(interned_key1);
+    public_key_release(public_key2);
+    public_key_release(public_key1);
+    key_table_destroy(table);
+}
+
+void test_key_table_intern_grows_table() {
+    key_table_t *table = NULL;
+    return_code_t return_code = key_table_create(&table);
+    assert_true(SUCCESS == return_code);
+    size_t num_keys = 3 * KEY_TABLE_INITIAL_CAPACITY;
+    for (size_t idx = 0; idx < num_keys; idx++) {
+        public_key_t *public_key = _key_table_test_key(idx);
+        public_key_t *interned_key = NULL;
+        return_code = key_table_intern(table, public_key, &interned_key);
+        assert_true(SUCCESS == return_code);
+        public_key_release(interned_key);
+        public_key_release(public_key);
+    }
+    assert_true(num_keys == table->num_keys);
+    assert_true(table->capacity >= num_keys);
+    assert_true(table->num_buckets >= 2 * table->capacity);
+    // Every key is still found after the table grows, in insertion order.
+    for (size_t idx = 0; idx < num_keys; idx++) {
+        public_key_t *public_key = _key_table_test_key(idx);
+        public_key_t *found_key = NULL;
+        bool is_found = false;
+        return_code = key_table_find(
+            table, &public_key->id, &found_key, &is_found);
+        assert_true(SUCCESS == return_code);
+        assert_true(is_found);
+        assert_true(table->keys[idx] == found_key);
+        public_key_release(public_key);
+    }
+    key_table_destroy(table);
+}
+
+void test_key_table_intern_fails_on_invalid_input() {
+    key_table_t *table = NULL;
+    return_code_t return_code = key_table_create(&table);
+    assert_true(SUCCESS == return_code);
+    public_key_t *public_key = _key_table_test_key(7);
+    public_key_t *interned_key = NULL;
+    return_code = key_table_intern(NULL, public_key, &interned_key);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = key_table_intern(table, NULL, &interned_key);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = key_table_intern(table, public_key, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    assert_true(0 == table->num_keys);
+    public_key_release(public_key);
+    key_table_destroy(table);
+}
+
+void test_key_table_find_finds_interned_key() {
+    key_table_t *table = NULL;
+    return_code_t return_code = key_table_create(&table);
+    assert_true(SUCCESS == return_code);
+    public_key_t *public_key = _key_table_test_key(7);
+    public_key_t *absent_key = _key_table_test_key(8);
+    public_key_t *interned_key = NULL;
+    return_code = key_table_intern(table, public_key, &interned_key);
+    assert_true(SUCCESS == return_code);
+    public_key_t *found_key = NULL;
+    bool is_found = false;
+    return_code = key_table_find(
+        table, &public_key->id, &found_key, &is_found);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_found);
+    assert_true(public_key == found_key);
+    return_code = key_table_find(
+        table, &absent_key->id, &found_key, &is_found);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_found);
+    public_key_release(absent_key);
+    public_key_release(interned_key);
+    public_key_release(public_key);
+    key_table_destroy(table);
+}
+
+void test_key_table_find_fails_on_invalid_input() {
+    key_table_t *table = NULL;
+    return_code_t return_code = key_table_create(&table);
+    assert_true(SUCCESS == return_code);
+    sha_256_t id = {0};
+    public_key_t *found_key = NULL;
+    bool is_found = false;
+    return_code = key_table_find(NULL, &id, &found_key, &is_found);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = key_table_find(table, NULL, &found_key, &is_found);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = key_table_find(table, &id, NULL, &is_found);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = key_table_find(table, &id, &found_key, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    key_table_destroy(table);
+}
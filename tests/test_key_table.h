@@ -0,0 +1,26 @@
+/**
+ * @brief Tests key_table.c
+ */
+
+#ifndef TESTS_TEST_KEY_TABLE_H_
+#define TESTS_TEST_KEY_TABLE_H_
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+void test_key_table_create_gives_key_table();
+
+void test_key_table_create_fails_on_invalid_input();
+
+void test_key_table_intern_gives_one_object_per_key();
+
+void test_key_table_intern_grows_table();
+
+void test_key_table_intern_fails_on_invalid_input();
+
+void test_key_table_find_finds_interned_key();
+
+void test_key_table_find_fails_on_invalid_input();
+
+#endif  // TESTS_TEST_KEY_TABLE_H_
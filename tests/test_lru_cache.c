@@ -0,0 +1,226 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "include/hash.h"
+#include "include/lru_cache.h"
+#include "include/return_codes.h"
+#include "tests/test_lru_cache.h"
+
+/**
+ * @brief A reference-counted test value.
+ */
+typedef struct counted_value_t {
+    size_t num_references;
+    size_t *num_freed;
+} counted_value_t;
+
+void _counted_value_release(void *value) {
+    counted_value_t *counted_value = value;
+    counted_value->num_references--;
+    if (0 == counted_value->num_references) {
+        (*counted_value->num_freed)++;
+    }
+}
+
+void _counted_value_retain(void *value) {
+    ((counted_value_t *)value)->num_references++;
+}
+
+sha_256_t _lru_cache_test_key(unsigned char seed) {
+    sha_256_t key = {0};
+    hash_sha_256(&seed, 1, &key);
+    return key;
+}
+
+void test_lru_cache_create_gives_lru_cache() {
+    lru_cache_t *cache = NULL;
+    return_code_t return_code = lru_cache_create(&cache, 4, NULL, NULL);
+    assert_true(SUCCESS == return_code);
+    assert_true(NULL != cache);
+    assert_true(4 == cache->capacity);
+    assert_true(0 == cache->num_entries);
+    assert_true(cache->num_buckets >= 8);
+    assert_true(0 == (cache->num_buckets & (cache->num_buckets - 1)));
+    lru_cache_destroy(cache);
+}
+
+void test_lru_cache_create_fails_on_invalid_input() {
+    lru_cache_t *cache = NULL;
+    return_code_t return_code = lru_cache_create(NULL, 4, NULL, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = lru_cache_create(&cache, 0, NULL, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    assert_true(NULL == cache);
+}
+
+void test_lru_cache_destroy_frees_values() {
+    lru_cache_t *cache = NULL;
+    return_code_t return_code = lru_cache_create(
+        &cache, 4, _counted_value_release, _counted_value_retain);
+    assert_true(SUCCESS == return_code);
+    size_t num_freed = 0;
+    counted_value_t values[3] = {
+        {1, &num_freed}, {1, &num_freed}, {1, &num_freed}};
+    for (unsigned char idx = 0; idx < 3; idx++) {
+        sha_256_t key = _lru_cache_test_key(idx);
+        return_code = lru_cache_put(cache, &key, &values[idx]);
+        assert_true(SUCCESS == return_code);
+    }
+    assert_true(0 == num_freed);
+    return_code = lru_cache_destroy(cache);
+    assert_true(SUCCESS == return_code);
+    assert_true(3 == num_freed);
+}
+
+void test_lru_cache_destroy_fails_on_invalid_input() {
+    return_code_t return_code = lru_cache_destroy(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_lru_cache_get_finds_put_value() {
+    lru_cache_t *cache = NULL;
+    return_code_t return_code = lru_cache_create(&cache, 4, NULL, NULL);
+    assert_true(SUCCESS == return_code);
+    int value = 7;
+    sha_256_t key = _lru_cache_test_key(0);
+    return_code = lru_cache_put(cache, &key, &value);
+    assert_true(SUCCESS == return_code);
+    void *found_value = NULL;
+    bool is_found = false;
+    return_code = lru_cache_get(cache, &key, &found_value, &is_found);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_found);
+    assert_true(&value == found_value);
+    lru_cache_destroy(cache);
+}
+
+void test_lru_cache_get_misses_absent_key() {
+    lru_cache_t *cache = NULL;
+    return_code_t return_code = lru_cache_create(&cache, 4, NULL, NULL);
+    assert_true(SUCCESS == return_code);
+    int value = 7;
+    sha_256_t key = _lru_cache_test_key(0);
+    return_code = lru_cache_put(cache, &key, &value);
+    assert_true(SUCCESS == return_code);
+    sha_256_t absent_key = _lru_cache_test_key(1);
+    void *found_value = NULL;
+    bool is_found = true;
+    return_code = lru_cache_get(cache, &absent_key, &found_value, &is_found);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_found);
+    assert_true(NULL == found_value);
+    lru_cache_destroy(cache);
+}
+
+void test_lru_cache_get_retains_value() {
+    lru_cache_t *cache = NULL;
+    return_code_t return_code = lru_cache_create(
+        &cache, 1, _counted_value_release, _counted_value_retain);
+    assert_true(SUCCESS == return_code);
+    size_t num_freed = 0;
+    counted_value_t value = {1, &num_freed};
+    sha_256_t key = _lru_cache_test_key(0);
+    return_code = lru_cache_put(cache, &key, &value);
+    assert_true(SUCCESS == return_code);
+    void *found_value = NULL;
+    bool is_found = false;
+    return_code = lru_cache_get(cache, &key, &found_value, &is_found);
+    assert_true(SUCCESS == return_code);
+    assert_true(2 == value.num_references);
+    // Evicting the value leaves the caller's reference alive.
+    counted_value_t other_value = {1, &num_freed};
+    sha_256_t other_key = _lru_cache_test_key(1);
+    return_code = lru_cache_put(cache, &other_key, &other_value);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == value.num_references);
+    assert_true(0 == num_freed);
+    _counted_value_release(found_value);
+    assert_true(1 == num_freed);
+    lru_cache_destroy(cache);
+}
+
+void test_lru_cache_get_fails_on_invalid_input() {
+    lru_cache_t *cache = NULL;
+    return_code_t return_code = lru_cache_create(&cache, 4, NULL, NULL);
+    assert_true(SUCCESS == return_code);
+    sha_256_t key = _lru_cache_test_key(0);
+    void *found_value = NULL;
+    bool is_found = false;
+    return_code = lru_cache_get(NULL, &key, &found_value, &is_found);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = lru_cache_get(cache, NULL, &found_value, &is_found);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = lru_cache_get(cache, &key, &found_value, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    lru_cache_destroy(cache);
+}
+
+void test_lru_cache_put_evicts_least_recently_used() {
+    lru_cache_t *cache = NULL;
+    return_code_t return_code = lru_cache_create(
+        &cache, 2, _counted_value_release, _counted_value_retain);
+    assert_true(SUCCESS == return_code);
+    size_t num_freed = 0;
+    counted_value_t values[3] = {
+        {1, &num_freed}, {1, &num_freed}, {1, &num_freed}};
+    sha_256_t keys[3];
+    for (unsigned char idx = 0; idx < 3; idx++) {
+        keys[idx] = _lru_cache_test_key(idx);
+    }
+    lru_cache_put(cache, &keys[0], &values[0]);
+    lru_cache_put(cache, &keys[1], &values[1]);
+    // Using the first key makes the second the least recently used.
+    bool is_found = false;
+    return_code = lru_cache_get(cache, &keys[0], NULL, &is_found);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_found);
+    return_code = lru_cache_put(cache, &keys[2], &values[2]);
+    assert_true(SUCCESS == return_code);
+    assert_true(2 == cache->num_entries);
+    assert_true(0 == values[1].num_references);
+    assert_true(1 == num_freed);
+    lru_cache_get(cache, &keys[1], NULL, &is_found);
+    assert_true(!is_found);
+    lru_cache_get(cache, &keys[0], NULL, &is_found);
+    assert_true(is_found);
+    lru_cache_get(cache, &keys[2], NULL, &is_found);
+    assert_true(is_found);
+    lru_cache_destroy(cache);
+}
+
+void test_lru_cache_put_keeps_existing_value_for_duplicate_key() {
+    lru_cache_t *cache = NULL;
+    return_code_t return_code = lru_cache_create(
+        &cache, 2, _counted_value_release, _counted_value_retain);
+    assert_true(SUCCESS == return_code);
+    size_t num_freed = 0;
+    counted_value_t value = {1, &num_freed};
+    counted_value_t duplicate_value = {1, &num_freed};
+    sha_256_t key = _lru_cache_test_key(0);
+    return_code = lru_cache_put(cache, &key, &value);
+    assert_true(SUCCESS == return_code);
+    return_code = lru_cache_put(cache, &key, &duplicate_value);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == cache->num_entries);
+    assert_true(0 == duplicate_value.num_references);
+    assert_true(1 == value.num_references);
+    void *found_value = NULL;
+    bool is_found = false;
+    lru_cache_get(cache, &key, &found_value, &is_found);
+    assert_true(&value == found_value);
+    _counted_value_release(found_value);
+    lru_cache_destroy(cache);
+}
+
+void test_lru_cache_put_fails_on_invalid_input() {
+    lru_cache_t *cache = NULL;
+    return_code_t return_code = lru_cache_create(&cache, 4, NULL, NULL);
+    assert_true(SUCCESS == return_code);
+    int value = 7;
+    sha_256_t key = _lru_cache_test_key(0);
+    return_code = lru_cache_put(NULL, &key, &value);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = lru_cache_put(cache, NULL, &value);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    lru_cache_destroy(cache);
+}
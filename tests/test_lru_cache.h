@@ -0,0 +1,34 @@
+/**
+ * @brief Tests lru_cache.c
+ */
+
+#ifndef TESTS_TEST_LRU_CACHE_H_
+#define TESTS_TEST_LRU_CACHE_H_
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+void test_lru_cache_create_gives_lru_cache();
+
+void test_lru_cache_create_fails_on_invalid_input();
+
+void test_lru_cache_destroy_frees_values();
+
+void test_lru_cache_destroy_fails_on_invalid_input();
+
+void test_lru_cache_get_finds_put_value();
+
+void test_lru_cache_get_misses_absent_key();
+
+void test_lru_cache_get_retains_value();
+
+void test_lru_cache_get_fails_on_invalid_input();
+
+void test_lru_cache_put_evicts_least_recently_used();
+
+void test_lru_cache_put_keeps_existing_value_for_duplicate_key();
+
+void test_lru_cache_put_fails_on_invalid_input();
+
+#endif  // TESTS_TEST_LRU_CACHE_H_
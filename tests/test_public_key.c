@@ -0,0 +1,109 @@
+#include <stdbool.h>
+#include <string.h>
+#include "include/public_key.h"
+#include "include/return_codes.h"
+#include "tests/test_public_key.h"
+
+void test_public_key_create_gives_public_key() {
+    unsigned char bytes[] = {1, 2, 3, 0, 5};
+    public_key_t *public_key = NULL;
+    return_code_t return_code = public_key_create(
+        &public_key, bytes, sizeof(bytes));
+    assert_true(SUCCESS == return_code);
+    assert_true(NULL != public_key);
+    assert_true(sizeof(bytes) == public_key->length);
+    assert_true(0 == memcmp(public_key->bytes, bytes, sizeof(bytes)));
+    assert_true(1 == atomic_load(&public_key->num_references));
+    sha_256_t id = {0};
+    return_code = hash_sha_256(bytes, sizeof(bytes), &id);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(&public_key->id, &id, sizeof(sha_256_t)));
+    return_code = public_key_release(public_key);
+    assert_true(SUCCESS == return_code);
+    // The empty key represents coins generated during mining.
+    return_code = public_key_create(&public_key, NULL, 0);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == public_key->length);
+    public_key_release(public_key);
+}
+
+void test_public_key_create_fails_on_invalid_input() {
+    unsigned char bytes[] = {1, 2, 3};
+    public_key_t *public_key = NULL;
+    return_code_t return_code = public_key_create(
+        NULL, bytes, sizeof(bytes));
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = public_key_create(&public_key, NULL, sizeof(bytes));
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    assert_true(NULL == public_key);
+}
+
+void test_public_key_retain_keeps_key_alive() {
+    unsigned char bytes[] = {1, 2, 3};
+    public_key_t *public_key = NULL;
+    return_code_t return_code = public_key_create(
+        &public_key, bytes, sizeof(bytes));
+    assert_true(SUCCESS == return_code);
+    return_code = public_key_retain(public_key);
+    assert_true(SUCCESS == return_code);
+    assert_true(2 == atomic_load(&public_key->num_references));
+    return_code = public_key_release(public_key);
+    assert_true(SUCCESS == return_code);
+    // The other holder can still read the key.
+    assert_true(1 == atomic_load(&public_key->num_references));
+    assert_true(0 == memcmp(public_key->bytes, bytes, sizeof(bytes)));
+    return_code = public_key_release(public_key);
+    assert_true(SUCCESS == return_code);
+}
+
+void test_public_key_retain_fails_on_invalid_input() {
+    return_code_t return_code = public_key_retain(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = public_key_release(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_public_key_equals_compares_bytes() {
+    unsigned char bytes[] = {1, 2, 3};
+    public_key_t *public_key1 = NULL;
+    return_code_t return_code = public_key_create(
+        &public_key1, bytes, sizeof(bytes));
+    assert_true(SUCCESS == return_code);
+    public_key_t *public_key2 = NULL;
+    return_code = public_key_create(&public_key2, bytes, sizeof(bytes));
+    assert_true(SUCCESS == return_code);
+    public_key_t *prefix_key = NULL;
+    return_code = public_key_create(&prefix_key, bytes, sizeof(bytes) - 1);
+    assert_true(SUCCESS == return_code);
+    bool is_equal = false;
+    return_code = public_key_equals(public_key1, public_key1, &is_equal);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_equal);
+    is_equal = false;
+    return_code = public_key_equals(public_key1, public_key2, &is_equal);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_equal);
+    // Keys of different lengths differ even if one is a prefix of the other.
+    return_code = public_key_equals(public_key1, prefix_key, &is_equal);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_equal);
+    public_key_release(prefix_key);
+    public_key_release(public_key2);
+    public_key_release(public_key1);
+}
+
+void test_public_key_equals_fails_on_invalid_input() {
+    unsigned char bytes[] = {1, 2, 3};
+    public_key_t *public_key = NULL;
+    return_code_t return_code = public_key_create(
+        &public_key, bytes, sizeof(bytes));
+    assert_true(SUCCESS == return_code);
+    bool is_equal = false;
+    return_code = public_key_equals(NULL, public_key, &is_equal);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = public_key_equals(public_key, NULL, &is_equal);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = public_key_equals(public_key, public_key, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    public_key_release(public_key);
+}
@@ -0,0 +1,24 @@
+/**
+ * @brief Tests public_key.c
+ */
+
+#ifndef TESTS_TEST_PUBLIC_KEY_H_
+#define TESTS_TEST_PUBLIC_KEY_H_
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+void test_public_key_create_gives_public_key();
+
+void test_public_key_create_fails_on_invalid_input();
+
+void test_public_key_retain_keeps_key_alive();
+
+void test_public_key_retain_fails_on_invalid_input();
+
+void test_public_key_equals_compares_bytes();
+
+void test_public_key_equals_fails_on_invalid_input();
+
+#endif  // TESTS_TEST_PUBLIC_KEY_H_
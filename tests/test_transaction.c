@@ -39,14 +39,21 @@ void test_transaction_create_gives_transaction() {
         amount,
         &sender_private_key);
     assert_true(SUCCESS == return_code);
+    // Keys hold the PEM string without its zero padding.
+    assert_true(
+        strlen(sender_public_key.bytes) ==
+        transaction->sender_public_key->length);
     assert_true(0 == memcmp(
-        &transaction->sender_public_key,
+        transaction->sender_public_key->bytes,
         &sender_public_key,
-        MAX_SSH_KEY_LENGTH));
+        transaction->sender_public_key->length));
+    assert_true(
+        strlen(recipient_public_key.bytes) ==
+        transaction->recipient_public_key->length);
     assert_true(0 == memcmp(
-        &transaction->recipient_public_key,
+        transaction->recipient_public_key->bytes,
         &recipient_public_key,
-        MAX_SSH_KEY_LENGTH));
+        transaction->recipient_public_key->length));
     assert_true(transaction->amount == amount);
     assert_true(0 != transaction->created_at);
     char empty_signature[MAX_SSH_SIGNATURE_LENGTH] = {0};
@@ -153,10 +160,16 @@ void test_transaction_generate_signature_gives_signature() {
     transaction_t transaction = {0};
     char *ssh_public_key_contents_base64 = getenv(
         TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t sender_public_key = {0};
     return_code_t return_code = base64_decode(
         ssh_public_key_contents_base64,
         strlen(ssh_public_key_contents_base64),
-        transaction.sender_public_key.bytes);
+        sender_public_key.bytes);
+    return_code = transaction_public_key_create(
+        &transaction.sender_public_key,
+        &sender_public_key,
+        TRANSACTION_VERSION_RSA);
+    assert_true(SUCCESS == return_code);
     char *ssh_private_key_contents_base64 = getenv(
         TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
     ssh_key_t sender_private_key = {0};
@@ -166,10 +179,8 @@ void test_transaction_generate_signature_gives_signature() {
         sender_private_key.bytes);
     transaction.created_at = time(NULL);
     // In these test transactions, the sender and recipient are the same.
-    memcpy(
-        &transaction.recipient_public_key,
-        &transaction.sender_public_key,
-        sizeof(transaction.recipient_public_key));
+    public_key_retain(transaction.sender_public_key);
+    transaction.recipient_public_key = transaction.sender_public_key;
     transaction.amount = 17;
     ssh_signature_t signature = {0};
     return_code = transaction_generate_signature(
@@ -184,16 +195,24 @@ void test_transaction_generate_signature_gives_signature() {
         &signature,
         empty_signature,
         MAX_SSH_SIGNATURE_LENGTH));
+    public_key_release(transaction.sender_public_key);
+    public_key_release(transaction.recipient_public_key);
 }
 
 void test_transaction_generate_signature_fails_on_invalid_input() {
     transaction_t transaction = {0};
     char *ssh_public_key_contents_base64 = getenv(
         TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t sender_public_key = {0};
     return_code_t return_code = base64_decode(
         ssh_public_key_contents_base64,
         strlen(ssh_public_key_contents_base64),
-        transaction.sender_public_key.bytes);
+        sender_public_key.bytes);
+    return_code = transaction_public_key_create(
+        &transaction.sender_public_key,
+        &sender_public_key,
+        TRANSACTION_VERSION_RSA);
+    assert_true(SUCCESS == return_code);
     char *ssh_private_key_contents_base64 = getenv(
         TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
     ssh_key_t sender_private_key = {0};
@@ -203,10 +222,8 @@ void test_transaction_generate_signature_fails_on_invalid_input() {
         sender_private_key.bytes);
     transaction.created_at = time(NULL);
     // In these test transactions, the sender and recipient are the same.
-    memcpy(
-        &transaction.recipient_public_key,
-        &transaction.sender_public_key,
-        sizeof(transaction.recipient_public_key));
+    public_key_retain(transaction.sender_public_key);
+    transaction.recipient_public_key = transaction.sender_public_key;
     transaction.amount = 17;
     ssh_signature_t signature = {0};
     return_code = transaction_generate_signature(
@@ -218,16 +235,319 @@ void test_transaction_generate_signature_fails_on_invalid_input() {
     return_code = transaction_generate_signature(
         &signature, &transaction, NULL);
     assert_true(FAILURE_INVALID_INPUT == return_code);
+    public_key_release(transaction.sender_public_key);
+    public_key_release(transaction.recipient_public_key);
+}
+
+void test_transaction_signer_create_gives_signer() {
+    char *ssh_private_key_contents_base64 = getenv(
+        TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t private_key = {0};
+    return_code_t return_code = base64_decode(
+        ssh_private_key_contents_base64,
+        strlen(ssh_private_key_contents_base64),
+        private_key.bytes);
+    transaction_signer_t *signer = NULL;
+    return_code = transaction_signer_create(&signer, &private_key);
+    assert_true(SUCCESS == return_code);
+    assert_true(NULL != signer);
+    assert_true(NULL != signer->private_key);
+    assert_true(NULL != signer->md_ctx);
+    return_code = transaction_signer_destroy(signer);
+    assert_true(SUCCESS == return_code);
+}
+
+void test_transaction_signer_create_fails_on_invalid_input() {
+    ssh_key_t private_key = {0};
+    transaction_signer_t *signer = NULL;
+    return_code_t return_code = transaction_signer_create(NULL, &private_key);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_signer_create(&signer, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    // An all-zero key is not a PEM private key.
+    return_code = transaction_signer_create(&signer, &private_key);
+    assert_true(FAILURE_OPENSSL_FUNCTION == return_code);
+    assert_true(NULL == signer);
+    return_code = transaction_signer_destroy(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_transaction_signer_sign_gives_valid_signatures() {
+    char *ssh_public_key_contents_base64 = getenv(
+        TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t ssh_public_key = {0};
+    return_code_t return_code = base64_decode(
+        ssh_public_key_contents_base64,
+        strlen(ssh_public_key_contents_base64),
+        ssh_public_key.bytes);
+    char *ssh_private_key_contents_base64 = getenv(
+        TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t private_key = {0};
+    return_code = base64_decode(
+        ssh_private_key_contents_base64,
+        strlen(ssh_private_key_contents_base64),
+        private_key.bytes);
+    public_key_t *public_key = NULL;
+    return_code = transaction_public_key_create(
+        &public_key, &ssh_public_key, TRANSACTION_VERSION_RSA);
+    assert_true(SUCCESS == return_code);
+    transaction_signer_t *signer = NULL;
+    return_code = transaction_signer_create(&signer, &private_key);
+    assert_true(SUCCESS == return_code);
+    // Reusing the signer must give an independent signature each time.
+    for (uint64_t amount = 1; amount <= 3; amount++) {
+        transaction_t *transaction = NULL;
+        return_code = transaction_create_with_signer(
+            &transaction, public_key, public_key, amount, signer);
+        assert_true(SUCCESS == return_code);
+        assert_true(amount == transaction->amount);
+        bool is_valid_signature = false;
+        return_code = transaction_verify_signature(
+            &is_valid_signature, transaction);
+        assert_true(SUCCESS == return_code);
+        assert_true(is_valid_signature);
+        ssh_signature_t signature = {0};
+        return_code = transaction_signer_sign(&signature, transaction, signer);
+        assert_true(SUCCESS == return_code);
+        assert_true(transaction->sender_signature.length == signature.length);
+        transaction_destroy(transaction);
+    }
+    // Each transaction held its own reference to the shared key.
+    assert_true(1 == atomic_load(&public_key->num_references));
+    public_key_release(public_key);
+    transaction_signer_destroy(signer);
+}
+
+void test_transaction_signer_sign_fails_on_invalid_input() {
+    char *ssh_private_key_contents_base64 = getenv(
+        TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t private_key = {0};
+    return_code_t return_code = base64_decode(
+        ssh_private_key_contents_base64,
+        strlen(ssh_private_key_contents_base64),
+        private_key.bytes);
+    transaction_signer_t *signer = NULL;
+    return_code = transaction_signer_create(&signer, &private_key);
+    assert_true(SUCCESS == return_code);
+    transaction_t transaction = {0};
+    ssh_signature_t signature = {0};
+    return_code = transaction_signer_sign(NULL, &transaction, signer);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_signer_sign(&signature, NULL, signer);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_signer_sign(&signature, &transaction, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    transaction_t *new_transaction = NULL;
+    return_code = transaction_create_with_signer(
+        &new_transaction,
+        transaction.sender_public_key,
+        transaction.recipient_public_key,
+        1,
+        NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    transaction_signer_destroy(signer);
+}
+
+void test_transaction_generate_ed25519_key_pair_gives_raw_keys() {
+    ssh_key_t public_key = {0};
+    ssh_key_t private_key = {0};
+    return_code_t return_code = transaction_generate_ed25519_key_pair(
+        &public_key, &private_key);
+    assert_true(SUCCESS == return_code);
+    char empty_key[MAX_SSH_KEY_LENGTH] = {0};
+    assert_true(0 != memcmp(public_key.bytes, empty_key, ED25519_KEY_LENGTH));
+    assert_true(0 != memcmp(private_key.bytes, empty_key, ED25519_KEY_LENGTH));
+    // Only the raw key bytes are set.
+    assert_true(0 == memcmp(
+        public_key.bytes + ED25519_KEY_LENGTH,
+        empty_key,
+        MAX_SSH_KEY_LENGTH - ED25519_KEY_LENGTH));
+    assert_true(0 == memcmp(
+        private_key.bytes + ED25519_KEY_LENGTH,
+        empty_key,
+        MAX_SSH_KEY_LENGTH - ED25519_KEY_LENGTH));
+    return_code = transaction_generate_ed25519_key_pair(NULL, &private_key);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_generate_ed25519_key_pair(&public_key, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_transaction_signer_create_ed25519_gives_valid_signatures() {
+    ssh_key_t public_key = {0};
+    ssh_key_t private_key = {0};
+    return_code_t return_code = transaction_generate_ed25519_key_pair(
+        &public_key, &private_key);
+    assert_true(SUCCESS == return_code);
+    transaction_signer_t *signer = NULL;
+    return_code = transaction_signer_create_ed25519(&signer, &private_key);
+    assert_true(SUCCESS == return_code);
+    assert_true(TRANSACTION_VERSION_ED25519 == signer->version);
+    public_key_t *raw_public_key = NULL;
+    return_code = transaction_public_key_create(
+        &raw_public_key, &public_key, TRANSACTION_VERSION_ED25519);
+    assert_true(SUCCESS == return_code);
+    assert_true(ED25519_KEY_LENGTH == raw_public_key->length);
+    for (uint64_t amount = 1; amount <= 3; amount++) {
+        transaction_t *transaction = NULL;
+        return_code = transaction_create_with_signer(
+            &transaction, raw_public_key, raw_public_key, amount, signer);
+        assert_true(SUCCESS == return_code);
+        assert_true(TRANSACTION_VERSION_ED25519 == transaction->version);
+        assert_true(
+            ED25519_SIGNATURE_LENGTH == transaction->sender_signature.length);
+        bool is_valid_signature = false;
+        return_code = transaction_verify_signature(
+            &is_valid_signature, transaction);
+        assert_true(SUCCESS == return_code);
+        assert_true(is_valid_signature);
+        transaction_destroy(transaction);
+    }
+    public_key_release(raw_public_key);
+    transaction_signer_destroy(signer);
+    return_code = transaction_signer_create_ed25519(NULL, &private_key);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_signer_create_ed25519(&signer, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_transaction_verify_signature_rejects_bad_ed25519_signature() {
+    ssh_key_t public_key = {0};
+    ssh_key_t private_key = {0};
+    return_code_t return_code = transaction_generate_ed25519_key_pair(
+        &public_key, &private_key);
+    assert_true(SUCCESS == return_code);
+    transaction_signer_t *signer = NULL;
+    return_code = transaction_signer_create_ed25519(&signer, &private_key);
+    assert_true(SUCCESS == return_code);
+    public_key_t *raw_public_key = NULL;
+    return_code = transaction_public_key_create(
+        &raw_public_key, &public_key, TRANSACTION_VERSION_ED25519);
+    assert_true(SUCCESS == return_code);
+    transaction_t *transaction = NULL;
+    return_code = transaction_create_with_signer(
+        &transaction, raw_public_key, raw_public_key, 5, signer);
+    assert_true(SUCCESS == return_code);
+    transaction_signer_destroy(signer);
+    transaction_t modified_transaction = *transaction;
+    modified_transaction.amount++;
+    bool is_valid_signature = true;
+    return_code = transaction_verify_signature(
+        &is_valid_signature, &modified_transaction);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid_signature);
+    // The signature covers the version, so an Ed25519 signature cannot pass
+    // for any other version.
+    modified_transaction = *transaction;
+    modified_transaction.version = TRANSACTION_VERSION_ED25519 + 1;
+    return_code = transaction_verify_signature(
+        &is_valid_signature, &modified_transaction);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid_signature);
+    // Keys must be raw Ed25519 keys.
+    public_key_t *short_public_key = NULL;
+    return_code = public_key_create(
+        &short_public_key, raw_public_key->bytes, ED25519_KEY_LENGTH - 1);
+    assert_true(SUCCESS == return_code);
+    modified_transaction = *transaction;
+    modified_transaction.recipient_public_key = short_public_key;
+    is_valid_signature = true;
+    return_code = transaction_verify_signature(
+        &is_valid_signature, &modified_transaction);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid_signature);
+    public_key_release(short_public_key);
+    // Unsigned signature padding must stay zero.
+    modified_transaction = *transaction;
+    modified_transaction.sender_signature.bytes[ED25519_SIGNATURE_LENGTH] = 1;
+    is_valid_signature = true;
+    return_code = transaction_verify_signature(
+        &is_valid_signature, &modified_transaction);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid_signature);
+    transaction_destroy(transaction);
+    public_key_release(raw_public_key);
+}
+
+void test_transaction_verify_signatures_verifies_mixed_versions() {
+    char *ssh_public_key_contents_base64 = getenv(
+        TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t rsa_public_key = {0};
+    return_code_t return_code = base64_decode(
+        ssh_public_key_contents_base64,
+        strlen(ssh_public_key_contents_base64),
+        rsa_public_key.bytes);
+    char *ssh_private_key_contents_base64 = getenv(
+        TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t rsa_private_key = {0};
+    return_code = base64_decode(
+        ssh_private_key_contents_base64,
+        strlen(ssh_private_key_contents_base64),
+        rsa_private_key.bytes);
+    ssh_key_t ed25519_public_key = {0};
+    ssh_key_t ed25519_private_key = {0};
+    return_code = transaction_generate_ed25519_key_pair(
+        &ed25519_public_key, &ed25519_private_key);
+    assert_true(SUCCESS == return_code);
+    transaction_signer_t *ed25519_signer = NULL;
+    return_code = transaction_signer_create_ed25519(
+        &ed25519_signer, &ed25519_private_key);
+    assert_true(SUCCESS == return_code);
+    public_key_t *raw_public_key = NULL;
+    return_code = transaction_public_key_create(
+        &raw_public_key, &ed25519_public_key, TRANSACTION_VERSION_ED25519);
+    assert_true(SUCCESS == return_code);
+    transaction_t *transactions[4] = {0};
+    return_code = transaction_create(
+        &transactions[0],
+        &rsa_public_key,
+        &rsa_public_key,
+        1,
+        &rsa_private_key);
+    assert_true(SUCCESS == return_code);
+    for (size_t idx = 1; idx < 4; idx++) {
+        return_code = transaction_create_with_signer(
+            &transactions[idx],
+            raw_public_key,
+            raw_public_key,
+            idx,
+            ed25519_signer);
+        assert_true(SUCCESS == return_code);
+    }
+    transactions[2]->sender_signature.bytes[0] ^= 0xff;
+    bool are_valid_signatures[4] = {false};
+    return_code = transaction_verify_signatures(
+        are_valid_signatures, transactions, 4);
+    assert_true(SUCCESS == return_code);
+    assert_true(are_valid_signatures[0]);
+    assert_true(are_valid_signatures[1]);
+    assert_true(!are_valid_signatures[2]);
+    assert_true(are_valid_signatures[3]);
+    return_code = transaction_verify_signatures(NULL, transactions, 4);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_verify_signatures(
+        are_valid_signatures, NULL, 4);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    for (size_t idx = 0; idx < 4; idx++) {
+        transaction_destroy(transactions[idx]);
+    }
+    public_key_release(raw_public_key);
+    transaction_signer_destroy(ed25519_signer);
 }
 
 void test_transaction_verify_signature_identifies_valid_signature() {
     transaction_t transaction = {0};
     char *ssh_public_key_contents_base64 = getenv(
         TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t sender_public_key = {0};
     return_code_t return_code = base64_decode(
         ssh_public_key_contents_base64,
         strlen(ssh_public_key_contents_base64),
-        transaction.sender_public_key.bytes);
+        sender_public_key.bytes);
+    return_code = transaction_public_key_create(
+        &transaction.sender_public_key,
+        &sender_public_key,
+        TRANSACTION_VERSION_RSA);
+    assert_true(SUCCESS == return_code);
     char *ssh_private_key_contents_base64 = getenv(
         TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
     ssh_key_t sender_private_key = {0};
@@ -237,10 +557,8 @@ void test_transaction_verify_signature_identifies_valid_signature() {
         sender_private_key.bytes);
     transaction.created_at = time(NULL);
     // In these test transactions, the sender and recipient are the same.
-    memcpy(
-        &transaction.recipient_public_key,
-        &transaction.sender_public_key,
-        sizeof(transaction.recipient_public_key));
+    public_key_retain(transaction.sender_public_key);
+    transaction.recipient_public_key = transaction.sender_public_key;
     transaction.amount = 17;
     return_code = transaction_generate_signature(
         &transaction.sender_signature, &transaction, &sender_private_key);
@@ -250,16 +568,24 @@ void test_transaction_verify_signature_identifies_valid_signature() {
         &is_valid_signature, &transaction);
     assert_true(SUCCESS == return_code);
     assert_true(is_valid_signature);
+    public_key_release(transaction.sender_public_key);
+    public_key_release(transaction.recipient_public_key);
 }
 
 void test_transaction_verify_signature_identifies_invalid_signature() {
     transaction_t transaction = {0};
     char *ssh_public_key_contents_base64 = getenv(
         TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t sender_public_key = {0};
     return_code_t return_code = base64_decode(
         ssh_public_key_contents_base64,
         strlen(ssh_public_key_contents_base64),
-        transaction.sender_public_key.bytes);
+        sender_public_key.bytes);
+    return_code = transaction_public_key_create(
+        &transaction.sender_public_key,
+        &sender_public_key,
+        TRANSACTION_VERSION_RSA);
+    assert_true(SUCCESS == return_code);
     char *ssh_private_key_contents_base64 = getenv(
         TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
     ssh_key_t sender_private_key = {0};
@@ -269,10 +595,8 @@ void test_transaction_verify_signature_identifies_invalid_signature() {
         sender_private_key.bytes);
     transaction.created_at = time(NULL);
     // In these test transactions, the sender and recipient are the same.
-    memcpy(
-        &transaction.recipient_public_key,
-        &transaction.sender_public_key,
-        sizeof(transaction.recipient_public_key));
+    public_key_retain(transaction.sender_public_key);
+    transaction.recipient_public_key = transaction.sender_public_key;
     transaction.amount = 17;
     // Fill the signature with garbage bytes.
     for (size_t idx = 0;
@@ -285,6 +609,49 @@ void test_transaction_verify_signature_identifies_invalid_signature() {
         &is_valid_signature, &transaction);
     assert_true(SUCCESS == return_code);
     assert_true(!is_valid_signature);
+    public_key_release(transaction.sender_public_key);
+    public_key_release(transaction.recipient_public_key);
+}
+
+void test_transaction_verify_signature_reuses_cached_public_key() {
+    transaction_t *transaction = NULL;
+    char *ssh_public_key_contents_base64 = getenv(
+        TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t sender_public_key = {0};
+    return_code_t return_code = base64_decode(
+        ssh_public_key_contents_base64,
+        strlen(ssh_public_key_contents_base64),
+        sender_public_key.bytes);
+    char *ssh_private_key_contents_base64 = getenv(
+        TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t sender_private_key = {0};
+    return_code = base64_decode(
+        ssh_private_key_contents_base64,
+        strlen(ssh_private_key_contents_base64),
+        sender_private_key.bytes);
+    return_code = transaction_create(
+        &transaction,
+        &sender_public_key,
+        &sender_public_key,
+        5,
+        &sender_private_key);
+    assert_true(SUCCESS == return_code);
+    // The first call may parse the key; later calls find it in the cache and
+    // must give the same results.
+    for (size_t idx = 0; idx < 3; idx++) {
+        bool is_valid_signature = false;
+        return_code = transaction_verify_signature(
+            &is_valid_signature, transaction);
+        assert_true(SUCCESS == return_code);
+        assert_true(is_valid_signature);
+    }
+    transaction->amount++;
+    bool is_valid_signature = true;
+    return_code = transaction_verify_signature(
+        &is_valid_signature, transaction);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid_signature);
+    transaction_destroy(transaction);
 }
 
 void test_transaction_verify_signature_fails_on_invalid_input() {
@@ -303,14 +670,12 @@ void test_transaction_verify_signature_fails_on_invalid_input() {
         ssh_public_key_contents,
         sizeof(ssh_public_key.bytes));
     transaction.created_at = time(NULL);
-    memcpy(
+    return_code = transaction_public_key_create(
         &transaction.sender_public_key,
         &ssh_public_key,
-        sizeof(transaction.sender_public_key));
-    memcpy(
-        &transaction.recipient_public_key,
-        &ssh_public_key,
-        sizeof(transaction.recipient_public_key));
+        TRANSACTION_VERSION_RSA);
+    assert_true(SUCCESS == return_code);
+    transaction.recipient_public_key = transaction.sender_public_key;
     transaction.amount = 17;
     ssh_signature_t signature = {0};
     // Fill the signature with garbage bytes.
@@ -324,4 +689,288 @@ void test_transaction_verify_signature_fails_on_invalid_input() {
     return_code = transaction_verify_signature(
         &is_valid_signature, NULL);
     assert_true(FAILURE_INVALID_INPUT == return_code);
+    public_key_release(transaction.sender_public_key);
+}
+
+void test_transaction_hash_covers_signature() {
+    transaction_t transaction = {0};
+    transaction.amount = 17;
+    sha_256_t hash1 = {0};
+    return_code_t return_code = transaction_hash(&transaction, &hash1);
+    assert_true(SUCCESS == return_code);
+    sha_256_t empty_hash = {0};
+    assert_true(0 != memcmp(&hash1, &empty_hash, sizeof(sha_256_t)));
+    transaction.sender_signature.bytes[0] = 'A';
+    sha_256_t hash2 = {0};
+    return_code = transaction_hash(&transaction, &hash2);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 != memcmp(&hash1, &hash2, sizeof(sha_256_t)));
+}
+
+void test_transaction_hash_fails_on_invalid_input() {
+    transaction_t transaction = {0};
+    sha_256_t hash = {0};
+    return_code_t return_code = transaction_hash(NULL, &hash);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_hash(&transaction, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_transaction_copy_shares_keys() {
+    char *ssh_public_key_contents_base64 = getenv(
+        TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t public_key = {0};
+    return_code_t return_code = base64_decode(
+        ssh_public_key_contents_base64,
+        strlen(ssh_public_key_contents_base64),
+        public_key.bytes);
+    char *ssh_private_key_contents_base64 = getenv(
+        TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t private_key = {0};
+    return_code = base64_decode(
+        ssh_private_key_contents_base64,
+        strlen(ssh_private_key_contents_base64),
+        private_key.bytes);
+    transaction_t *transaction = NULL;
+    return_code = transaction_create(
+        &transaction, &public_key, &public_key, 5, &private_key);
+    assert_true(SUCCESS == return_code);
+    transaction_t *copy = NULL;
+    return_code = transaction_copy(&copy, transaction);
+    assert_true(SUCCESS == return_code);
+    assert_true(copy != transaction);
+    assert_true(copy->sender_public_key == transaction->sender_public_key);
+    assert_true(
+        copy->recipient_public_key == transaction->recipient_public_key);
+    assert_true(copy->amount == transaction->amount);
+    assert_true(0 == memcmp(
+        &copy->sender_signature,
+        &transaction->sender_signature,
+        sizeof(ssh_signature_t)));
+    // The copy holds its own references, so it outlives the original.
+    transaction_destroy(transaction);
+    bool is_valid_signature = false;
+    return_code = transaction_verify_signature(&is_valid_signature, copy);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid_signature);
+    transaction_destroy(copy);
+    return_code = transaction_copy(NULL, copy);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_copy(&copy, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_transaction_hash_matches_fixed_size_layout() {
+    char *ssh_public_key_contents_base64 = getenv(
+        TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t public_key = {0};
+    return_code_t return_code = base64_decode(
+        ssh_public_key_contents_base64,
+        strlen(ssh_public_key_contents_base64),
+        public_key.bytes);
+    char *ssh_private_key_contents_base64 = getenv(
+        TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t private_key = {0};
+    return_code = base64_decode(
+        ssh_private_key_contents_base64,
+        strlen(ssh_private_key_contents_base64),
+        private_key.bytes);
+    transaction_t *transaction = NULL;
+    return_code = transaction_create(
+        &transaction, &public_key, &public_key, 5, &private_key);
+    assert_true(SUCCESS == return_code);
+    // RSA transactions hash the fields as transaction_t laid them out when it
+    // stored keys inline, so that existing blocks keep their hashes.
+    struct {
+        time_t created_at;
+        ssh_key_t sender_public_key;
+        ssh_key_t recipient_public_key;
+        uint64_t amount;
+        ssh_signature_t sender_signature;
+    } fixed_size_transaction = {0};
+    fixed_size_transaction.created_at = transaction->created_at;
+    fixed_size_transaction.sender_public_key = public_key;
+    fixed_size_transaction.recipient_public_key = public_key;
+    fixed_size_transaction.amount = transaction->amount;
+    fixed_size_transaction.sender_signature = transaction->sender_signature;
+    sha_256_t expected_hash = {0};
+    return_code = hash_sha_256(
+        (unsigned char *)&fixed_size_transaction,
+        sizeof(fixed_size_transaction),
+        &expected_hash);
+    assert_true(SUCCESS == return_code);
+    sha_256_t hash = {0};
+    return_code = transaction_hash(transaction, &hash);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(&hash, &expected_hash, sizeof(sha_256_t)));
+    transaction_destroy(transaction);
+}
+
+void test_transaction_serialize_round_trips() {
+    ssh_key_t public_key = {0};
+    ssh_key_t private_key = {0};
+    return_code_t return_code = transaction_generate_ed25519_key_pair(
+        &public_key, &private_key);
+    assert_true(SUCCESS == return_code);
+    transaction_signer_t *signer = NULL;
+    return_code = transaction_signer_create_ed25519(&signer, &private_key);
+    assert_true(SUCCESS == return_code);
+    public_key_t *raw_public_key = NULL;
+    return_code = transaction_public_key_create(
+        &raw_public_key, &public_key, TRANSACTION_VERSION_ED25519);
+    assert_true(SUCCESS == return_code);
+    transaction_t *transaction = NULL;
+    return_code = transaction_create_with_signer(
+        &transaction, raw_public_key, raw_public_key, 5, signer);
+    assert_true(SUCCESS == return_code);
+    size_t size = 0;
+    return_code = transaction_get_serialized_size(transaction, &size);
+    assert_true(SUCCESS == return_code);
+    // Keys and signatures take only their actual length.
+    assert_true(
+        6 * sizeof(uint64_t) + 2 * ED25519_KEY_LENGTH +
+        ED25519_SIGNATURE_LENGTH == size);
+    unsigned char buffer[1024] = {0};
+    size_t num_bytes_written = 0;
+    return_code = transaction_serialize(
+        transaction, buffer, sizeof(buffer), &num_bytes_written);
+    assert_true(SUCCESS == return_code);
+    assert_true(size == num_bytes_written);
+    transaction_t *deserialized_transaction = NULL;
+    size_t num_bytes_read = 0;
+    return_code = transaction_deserialize(
+        &deserialized_transaction, buffer, sizeof(buffer), &num_bytes_read);
+    assert_true(SUCCESS == return_code);
+    assert_true(size == num_bytes_read);
+    assert_true(transaction->version == deserialized_transaction->version);
+    assert_true(
+        transaction->created_at == deserialized_transaction->created_at);
+    assert_true(transaction->amount == deserialized_transaction->amount);
+    assert_true(0 == memcmp(
+        &transaction->sender_signature,
+        &deserialized_transaction->sender_signature,
+        sizeof(ssh_signature_t)));
+    bool is_equal = false;
+    return_code = public_key_equals(
+        transaction->sender_public_key,
+        deserialized_transaction->sender_public_key,
+        &is_equal);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_equal);
+    // Equal sender and recipient keys are read into one shared key.
+    assert_true(
+        deserialized_transaction->sender_public_key ==
+        deserialized_transaction->recipient_public_key);
+    bool is_valid_signature = false;
+    return_code = transaction_verify_signature(
+        &is_valid_signature, deserialized_transaction);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid_signature);
+    transaction_destroy(deserialized_transaction);
+    transaction_destroy(transaction);
+    public_key_release(raw_public_key);
+    transaction_signer_destroy(signer);
+}
+
+void test_transaction_serialize_fails_on_invalid_input() {
+    transaction_t transaction = {0};
+    transaction.amount = 17;
+    unsigned char buffer[1024] = {0};
+    size_t size = 0;
+    return_code_t return_code = transaction_get_serialized_size(NULL, &size);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_get_serialized_size(&transaction, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_serialize(NULL, buffer, sizeof(buffer), &size);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_serialize(
+        &transaction, NULL, sizeof(buffer), &size);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_serialize(
+        &transaction, buffer, sizeof(buffer), NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_serialize(&transaction, buffer, 8, &size);
+    assert_true(FAILURE_BUFFER_TOO_SMALL == return_code);
+    return_code = transaction_serialize(
+        &transaction, buffer, sizeof(buffer), &size);
+    assert_true(SUCCESS == return_code);
+    transaction_t *deserialized_transaction = NULL;
+    return_code = transaction_deserialize(
+        NULL, buffer, sizeof(buffer), &size);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_deserialize(
+        &deserialized_transaction, NULL, sizeof(buffer), &size);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_deserialize(
+        &deserialized_transaction, buffer, sizeof(buffer), NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_deserialize(
+        &deserialized_transaction, buffer, size - 1, &size);
+    assert_true(FAILURE_BUFFER_TOO_SMALL == return_code);
+    // Keys longer than any valid key are rejected before allocation.
+    *(uint64_t *)(buffer + 2 * sizeof(uint64_t)) = UINT64_MAX;
+    return_code = transaction_deserialize(
+        &deserialized_transaction, buffer, sizeof(buffer), &size);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_transaction_rejects_rsa_keys_with_trailing_zeros() {
+    char *ssh_public_key_contents_base64 = getenv(
+        TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t public_key = {0};
+    return_code_t return_code = base64_decode(
+        ssh_public_key_contents_base64,
+        strlen(ssh_public_key_contents_base64),
+        public_key.bytes);
+    char *ssh_private_key_contents_base64 = getenv(
+        TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t private_key = {0};
+    return_code = base64_decode(
+        ssh_private_key_contents_base64,
+        strlen(ssh_private_key_contents_base64),
+        private_key.bytes);
+    transaction_t *transaction = NULL;
+    return_code = transaction_create(
+        &transaction, &public_key, &public_key, 5, &private_key);
+    assert_true(SUCCESS == return_code);
+    bool has_canonical_keys = false;
+    return_code = transaction_has_canonical_keys(
+        transaction, &has_canonical_keys);
+    assert_true(SUCCESS == return_code);
+    assert_true(has_canonical_keys);
+    // The key with one byte of its zero padding signs the same message and
+    // gives the same hash, but serializes differently.
+    size_t length = transaction->sender_public_key->length;
+    public_key_t *padded_key = NULL;
+    return_code = public_key_create(
+        &padded_key, (unsigned char *)public_key.bytes, length + 1);
+    assert_true(SUCCESS == return_code);
+    public_key_release(transaction->sender_public_key);
+    transaction->sender_public_key = padded_key;
+    return_code = transaction_has_canonical_keys(
+        transaction, &has_canonical_keys);
+    assert_true(SUCCESS == return_code);
+    assert_true(!has_canonical_keys);
+    sha_256_t hash = {0};
+    return_code = transaction_hash(transaction, &hash);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    bool is_valid_signature = true;
+    return_code = transaction_verify_signature(
+        &is_valid_signature, transaction);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid_signature);
+    unsigned char buffer[3 * MAX_SSH_KEY_LENGTH] = {0};
+    size_t size = 0;
+    return_code = transaction_serialize(
+        transaction, buffer, sizeof(buffer), &size);
+    assert_true(SUCCESS == return_code);
+    transaction_t *deserialized_transaction = NULL;
+    return_code = transaction_deserialize(
+        &deserialized_transaction, buffer, size, &size);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_has_canonical_keys(NULL, &has_canonical_keys);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_has_canonical_keys(transaction, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    transaction_destroy(transaction);
 }
@@ -21,10 +21,42 @@ void test_transaction_generate_signature_gives_signature();
 
 void test_transaction_generate_signature_fails_on_invalid_input();
 
+void test_transaction_signer_create_gives_signer();
+
+void test_transaction_signer_create_fails_on_invalid_input();
+
+void test_transaction_signer_sign_gives_valid_signatures();
+
+void test_transaction_signer_sign_fails_on_invalid_input();
+
+void test_transaction_generate_ed25519_key_pair_gives_raw_keys();
+
+void test_transaction_signer_create_ed25519_gives_valid_signatures();
+
+void test_transaction_verify_signature_rejects_bad_ed25519_signature();
+
+void test_transaction_verify_signatures_verifies_mixed_versions();
+
 void test_transaction_verify_signature_identifies_valid_signature();
 
 void test_transaction_verify_signature_identifies_invalid_signature();
 
+void test_transaction_verify_signature_reuses_cached_public_key();
+
 void test_transaction_verify_signature_fails_on_invalid_input();
 
+void test_transaction_hash_covers_signature();
+
+void test_transaction_hash_fails_on_invalid_input();
+
+void test_transaction_copy_shares_keys();
+
+void test_transaction_hash_matches_fixed_size_layout();
+
+void test_transaction_serialize_round_trips();
+
+void test_transaction_serialize_fails_on_invalid_input();
+
+void test_transaction_rejects_rsa_keys_with_trailing_zeros();
+
 #endif  // TESTS_TEST_TRANSACTION_H_